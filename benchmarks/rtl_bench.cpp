@@ -0,0 +1,1350 @@
+#include "rtl.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <print>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <variant>
+#include <vector>
+
+using namespace rtl;
+
+namespace {
+enum class output_format {
+    csv,
+    json,
+};
+
+struct options {
+    output_format format{output_format::csv};
+    std::string_view filter{};
+    std::chrono::nanoseconds min_time{std::chrono::milliseconds{50}};
+    std::size_t samples{5};
+};
+
+struct result {
+    std::string name;
+    std::string_view type;
+    std::size_t elements;
+    std::size_t iterations;
+    double ns_per_iteration;
+    double ns_per_element;
+};
+
+template<typename T>
+auto do_not_optimise(const T& value) -> void {
+#if defined(_MSC_VER)
+    static const volatile void* sink;
+    sink = &value;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
+
+struct move_only {
+    std::uint64_t value{};
+
+    move_only() noexcept = default;
+
+    explicit move_only(std::uint64_t v) noexcept : value{v} {
+
+    }
+
+    move_only(const move_only&) = delete;
+    move_only(move_only&&) noexcept = default;
+    auto operator=(const move_only&) -> move_only& = delete;
+    auto operator=(move_only&&) noexcept -> move_only& = default;
+};
+
+template<typename T>
+constexpr auto type_name() noexcept -> std::string_view;
+
+template<>
+constexpr auto type_name<std::int64_t>() noexcept -> std::string_view {
+    return "trivial";
+}
+
+template<>
+constexpr auto type_name<std::int32_t>() noexcept -> std::string_view {
+    return "int32";
+}
+
+template<>
+constexpr auto type_name<float>() noexcept -> std::string_view {
+    return "float";
+}
+
+template<>
+constexpr auto type_name<std::string>() noexcept -> std::string_view {
+    return "string";
+}
+
+template<>
+constexpr auto type_name<move_only>() noexcept -> std::string_view {
+    return "move_only";
+}
+
+template<typename T>
+auto make_value(std::size_t i) -> T {
+    if constexpr (std::is_same_v<T, std::string>) {
+        // long enough to defeat the small string optimisation on every standard library
+        return std::string(32, static_cast<char>('a' + i % 26));
+    } else if constexpr (std::is_same_v<T, move_only>) {
+        return move_only{i};
+    } else {
+        return static_cast<T>(i);
+    }
+}
+
+// Unlike `make_value`, every `i` gives a distinct key.
+template<typename T>
+auto make_key(std::size_t i) -> T {
+    if constexpr (std::is_same_v<T, std::string>) {
+        auto key = std::to_string(i);
+        key.resize(32, '_');
+        return key;
+    } else {
+        return static_cast<T>(i);
+    }
+}
+
+template<typename T>
+auto value_weight(const T& value) noexcept -> std::size_t {
+    if constexpr (std::is_same_v<T, std::string>) {
+        return value.size();
+    } else if constexpr (std::is_same_v<T, move_only>) {
+        return value.value;
+    } else {
+        return static_cast<std::size_t>(value);
+    }
+}
+
+// Thin adapters so the same benchmark body can drive both rtl and std containers.
+
+template<typename T, typename Allocator, std::size_t N>
+auto push(collections::list<T, Allocator, N>& list, T&& value) -> void {
+    list.add(std::move(value));
+}
+
+template<typename T>
+auto push(std::vector<T>& vector, T&& value) -> void {
+    vector.push_back(std::move(value));
+}
+
+template<typename T>
+auto insert_at(collections::list<T>& list, std::size_t index, T&& value) -> void {
+    list.insert(index, std::move(value));
+}
+
+template<typename T>
+auto insert_at(std::vector<T>& vector, std::size_t index, T&& value) -> void {
+    vector.insert(vector.begin() + static_cast<std::ptrdiff_t>(index), std::move(value));
+}
+
+template<typename T>
+auto checked_at(const collections::list<T>& list, std::size_t index) -> const T& {
+    return list.at(index).value().get();
+}
+
+template<typename T>
+auto checked_at(const std::vector<T>& vector, std::size_t index) -> const T& {
+    return vector.at(index);
+}
+
+class runner {
+public:
+    explicit runner(options opts) : m_options{opts} {
+
+    }
+
+    // Runs `body` until at least `min_time` has elapsed, repeats that `samples` times and keeps the median.
+    // `body` performs one iteration over `elements` elements.
+    template<typename F>
+    auto run(std::string name, std::string_view type, std::size_t elements, F&& body) -> void {
+        if (!m_options.filter.empty() && name.find(m_options.filter) == std::string::npos) {
+            return;
+        }
+
+        std::size_t iterations = 1;
+        while (true) {
+            auto elapsed = time(iterations, body);
+            if (elapsed >= m_options.min_time) {
+                break;
+            }
+
+            iterations *= elapsed.count() == 0 ? 100 : std::max<std::size_t>(2, static_cast<std::size_t>(
+                1.2 * static_cast<double>(m_options.min_time.count()) / static_cast<double>(elapsed.count())));
+        }
+
+        std::vector<double> samples;
+        for (std::size_t i = 0; i < m_options.samples; i++) {
+            auto elapsed = time(iterations, body);
+            samples.push_back(static_cast<double>(elapsed.count()) / static_cast<double>(iterations));
+        }
+
+        std::ranges::sort(samples);
+        auto median = samples[samples.size() / 2];
+        m_results.push_back(result{
+            std::move(name),
+            type,
+            elements,
+            iterations,
+            median,
+            median / static_cast<double>(std::max<std::size_t>(elements, 1)),
+        });
+    }
+
+    auto print() const -> void {
+        switch (m_options.format) {
+            case output_format::csv:
+                std::println("name,type,elements,iterations,ns_per_iteration,ns_per_element");
+                for (const auto& r : m_results) {
+                    std::println("{},{},{},{},{:.3f},{:.3f}",
+                        r.name,
+                        r.type,
+                        r.elements,
+                        r.iterations,
+                        r.ns_per_iteration,
+                        r.ns_per_element);
+                }
+                break;
+            case output_format::json:
+                std::println("{{\"benchmarks\":[");
+                for (std::size_t i = 0; i < m_results.size(); i++) {
+                    const auto& r = m_results[i];
+                    std::println(
+                        "  {{\"name\":\"{}\",\"type\":\"{}\",\"elements\":{},\"iterations\":{},"
+                        "\"ns_per_iteration\":{:.3f},\"ns_per_element\":{:.3f}}}{}",
+                        r.name,
+                        r.type,
+                        r.elements,
+                        r.iterations,
+                        r.ns_per_iteration,
+                        r.ns_per_element,
+                        i + 1 == m_results.size() ? "" : ",");
+                }
+                std::println("]}}");
+                break;
+        }
+    }
+
+private:
+    template<typename F>
+    static auto time(std::size_t iterations, F& body) -> std::chrono::nanoseconds {
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < iterations; i++) {
+            body();
+        }
+        return std::chrono::steady_clock::now() - start;
+    }
+
+    options m_options;
+    std::vector<result> m_results;
+};
+
+template<typename Container>
+auto container_name() -> std::string_view {
+    if constexpr (std::is_same_v<Container, collections::list<typename Container::value_type>>) {
+        return "list";
+    } else {
+        return "vector";
+    }
+}
+
+template<typename Container>
+auto filled(std::size_t count) -> Container {
+    using T = typename Container::value_type;
+    Container container;
+    for (std::size_t i = 0; i < count; i++) {
+        push(container, make_value<T>(i));
+    }
+    return container;
+}
+
+template<typename Container>
+auto bench_sequence(runner& r) -> void {
+    using T = typename Container::value_type;
+    constexpr std::size_t large = 100'000;
+    constexpr std::size_t small = 1'000;
+    auto prefix = std::string{container_name<Container>()};
+    auto type = type_name<T>();
+
+    r.run(prefix + "/add", type, large, [] {
+        Container container;
+        for (std::size_t i = 0; i < large; i++) {
+            push(container, make_value<T>(i));
+        }
+        do_not_optimise(container);
+    });
+
+    r.run(prefix + "/insert_front", type, small, [] {
+        auto container = filled<Container>(1);
+        for (std::size_t i = 0; i < small; i++) {
+            insert_at(container, 0, make_value<T>(i));
+        }
+        do_not_optimise(container);
+    });
+
+    r.run(prefix + "/insert_middle", type, small, [] {
+        auto container = filled<Container>(1);
+        for (std::size_t i = 0; i < small; i++) {
+            insert_at(container, container.size() / 2, make_value<T>(i));
+        }
+        do_not_optimise(container);
+    });
+
+    auto source = filled<Container>(large);
+    r.run(prefix + "/reserve_shrink_to_fit", type, large, [&source] {
+        source.reserve(source.size() * 2);
+        source.shrink_to_fit();
+        do_not_optimise(source);
+    });
+
+    r.run(prefix + "/iterate", type, large, [&source] {
+        std::size_t total = 0;
+        for (const auto& value : source) {
+            total += value_weight(value);
+        }
+        do_not_optimise(total);
+    });
+
+    r.run(prefix + "/checked_at", type, large, [&source] {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < source.size(); i++) {
+            total += value_weight(checked_at(source, i));
+        }
+        do_not_optimise(total);
+    });
+
+    r.run(prefix + "/resize", type, large, [] {
+        Container container;
+        container.resize(large);
+        do_not_optimise(container);
+        container.resize(0);
+        do_not_optimise(container);
+    });
+}
+
+// Many short-lived containers holding a handful of elements, where the first allocation dominates.
+template<typename Container>
+auto bench_short_lived(runner& r, std::string_view name) -> void {
+    using T = typename Container::value_type;
+    constexpr std::size_t containers = 1'000;
+    constexpr std::size_t elements = 6;
+
+    r.run(std::string{name} + "/short_lived", type_name<T>(), containers * elements, [] {
+        for (std::size_t i = 0; i < containers; i++) {
+            Container container;
+            for (std::size_t j = 0; j < elements; j++) {
+                push(container, make_value<T>(j));
+            }
+            do_not_optimise(container);
+        }
+    });
+}
+
+// The short-lived pattern with every list drawing from one arena that is reset once per iteration.
+template<typename T>
+auto bench_short_lived_arena(runner& r) -> void {
+    constexpr std::size_t containers = 1'000;
+    constexpr std::size_t elements = 6;
+
+    memory::arena arena;
+    r.run("list_arena/short_lived", type_name<T>(), containers * elements, [&arena] {
+        arena.reset();
+        for (std::size_t i = 0; i < containers; i++) {
+            collections::list<T, memory::arena_allocator<T>> container{memory::arena_allocator<T>{arena}};
+            for (std::size_t j = 0; j < elements; j++) {
+                container.add(make_value<T>(j));
+            }
+            do_not_optimise(container);
+        }
+    });
+}
+
+// A large scratch buffer per iteration, only the start of which gets written: an arena buffer left uninitialised
+// against a zero-filled one from the heap.
+auto bench_scratch_buffer(runner& r) -> void {
+    constexpr std::size_t size = 256 * 1024;
+    constexpr std::size_t used = 1024;
+
+    memory::arena arena;
+    r.run("unique_ptr_arena/scratch_for_overwrite", "trivial", size, [&arena] {
+        arena.reset();
+        auto buffer = memory::allocate_unique_for_overwrite<char[]>(memory::arena_allocator<char>{arena}, size);
+        std::fill_n(buffer.get(), used, 'x');
+        do_not_optimise(buffer);
+    });
+
+    r.run("std_unique_ptr/scratch", "trivial", size, [] {
+        auto buffer = std::make_unique<char[]>(size);
+        std::fill_n(buffer.get(), used, 'x');
+        do_not_optimise(buffer);
+    });
+}
+
+// Every hardware thread repeatedly allocates and frees a batch of small objects.
+template<template<typename> typename Allocator>
+auto bench_allocator_churn(runner& r, std::string_view name) -> void {
+    struct node {
+        std::uint64_t key;
+        std::uint64_t value;
+        node* next;
+    };
+
+    constexpr std::size_t rounds = 50;
+    constexpr std::size_t batch = 256;
+    auto threads = std::max(1u, std::thread::hardware_concurrency());
+
+    r.run(std::string{name} + "/churn", "node", threads * rounds * batch, [threads] {
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; t++) {
+            workers.emplace_back([] {
+                Allocator<node> allocator;
+                std::vector<node*> nodes(batch);
+                for (std::size_t round = 0; round < rounds; round++) {
+                    for (auto& n : nodes) {
+                        n = allocator.allocate(1);
+                        do_not_optimise(n);
+                    }
+                    for (auto n : nodes) {
+                        allocator.deallocate(n, 1);
+                    }
+                }
+            });
+        }
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    });
+}
+
+template<typename T>
+auto bench_option(runner& r) -> void {
+    constexpr std::size_t count = 10'000;
+    auto type = type_name<T>();
+
+    r.run("option/construct_access", type, count, [] {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < count; i++) {
+            utilities::option<T> opt{make_value<T>(i)};
+            if (opt.has_value()) {
+                total += value_weight(opt.value());
+            }
+            do_not_optimise(opt);
+        }
+        do_not_optimise(total);
+    });
+
+    r.run("optional/construct_access", type, count, [] {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < count; i++) {
+            std::optional<T> opt{make_value<T>(i)};
+            if (opt.has_value()) {
+                total += value_weight(opt.value());
+            }
+            do_not_optimise(opt);
+        }
+        do_not_optimise(total);
+    });
+}
+
+template<typename T>
+auto bench_unique_ptr(runner& r) -> void {
+    constexpr std::size_t count = 10'000;
+    auto type = type_name<T>();
+
+    r.run("unique_ptr/make_access", type, count, [] {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < count; i++) {
+            auto ptr = memory::make_unique<T>(make_value<T>(i));
+            total += value_weight(*ptr.get());
+            do_not_optimise(ptr);
+        }
+        do_not_optimise(total);
+    });
+
+    r.run("std_unique_ptr/make_access", type, count, [] {
+        std::size_t total = 0;
+        for (std::size_t i = 0; i < count; i++) {
+            auto ptr = std::make_unique<T>(make_value<T>(i));
+            total += value_weight(*ptr.get());
+            do_not_optimise(ptr);
+        }
+        do_not_optimise(total);
+    });
+}
+
+// Make a shared object then copy and drop the pointer, which is where the reference count traffic is.
+template<typename T>
+auto bench_shared_ptr(runner& r) -> void {
+    constexpr std::size_t count = 10'000;
+    constexpr std::size_t copies = 8;
+    auto type = type_name<T>();
+
+    auto run = [&r, &type]<typename Make>(std::string_view name, Make make) {
+        r.run(std::string{name}, type, count, [make] {
+            std::size_t total = 0;
+            for (std::size_t i = 0; i < count; i++) {
+                auto ptr = make(make_value<T>(i));
+                for (std::size_t j = 0; j < copies; j++) {
+                    auto copy = ptr;
+                    do_not_optimise(copy);
+                }
+                total += value_weight(*ptr);
+            }
+            do_not_optimise(total);
+        });
+    };
+
+    run("shared_ptr/make_copy", [](T value) {
+        return memory::make_shared<T>(std::move(value));
+    });
+
+    run("shared_ptr_local/make_copy", [](T value) {
+        return memory::make_shared<T, memory::local_count>(std::move(value));
+    });
+
+    run("std_shared_ptr/make_copy", [](T value) {
+        return std::make_shared<T>(std::move(value));
+    });
+}
+
+// Stable element addresses: segmented_list against the list of unique_ptrs it replaces.
+template<typename T>
+auto bench_stable(runner& r) -> void {
+    constexpr std::size_t count = 100'000;
+    auto type = type_name<T>();
+
+    r.run("segmented_list/add", type, count, [] {
+        collections::segmented_list<T> container;
+        for (std::size_t i = 0; i < count; i++) {
+            container.add(make_value<T>(i));
+        }
+        do_not_optimise(container);
+    });
+
+    r.run("list_unique_ptr/add", type, count, [] {
+        collections::list<memory::unique_ptr<T>> container;
+        for (std::size_t i = 0; i < count; i++) {
+            container.add(memory::make_unique<T>(make_value<T>(i)));
+        }
+        do_not_optimise(container);
+    });
+
+    // every fourth element removed, so iteration has holes to skip
+    auto segmented = collections::segmented_list<T>{};
+    for (std::size_t i = 0; i < count; i++) {
+        segmented.add(make_value<T>(i));
+    }
+
+    std::size_t index = 0;
+    for (auto it = segmented.begin(); it != segmented.end(); index++) {
+        it = index % 4 == 0 ? segmented.remove(it) : std::next(it);
+    }
+
+    auto pointers = collections::list<memory::unique_ptr<T>>{};
+    for (std::size_t i = 0; i < count; i++) {
+        if (i % 4 != 0) {
+            pointers.add(memory::make_unique<T>(make_value<T>(i)));
+        }
+    }
+
+    r.run("segmented_list/iterate", type, segmented.size(), [&segmented] {
+        std::size_t total = 0;
+        for (const auto& value : segmented) {
+            total += value_weight(value);
+        }
+        do_not_optimise(total);
+    });
+
+    r.run("list_unique_ptr/iterate", type, pointers.size(), [&pointers] {
+        std::size_t total = 0;
+        for (const auto& pointer : pointers) {
+            total += value_weight(*pointer.get());
+        }
+        do_not_optimise(total);
+    });
+}
+
+template<typename T>
+auto bench_type(runner& r) -> void {
+    bench_sequence<collections::list<T>>(r);
+    bench_sequence<std::vector<T>>(r);
+    bench_short_lived<collections::list<T>>(r, "list");
+    bench_short_lived<collections::small_list<T, 8>>(r, "small_list");
+    bench_short_lived<std::vector<T>>(r, "vector");
+    bench_short_lived_arena<T>(r);
+    bench_option<T>(r);
+    bench_unique_ptr<T>(r);
+    bench_shared_ptr<T>(r);
+    bench_stable<T>(r);
+}
+
+template<typename Map>
+auto map_insert(Map& map, typename Map::key_type key, typename Map::mapped_type value) -> void {
+    if constexpr (requires { map.emplace(std::move(key), std::move(value)); }) {
+        map.emplace(std::move(key), std::move(value));
+    } else {
+        map.insert(std::move(key), std::move(value));
+    }
+}
+
+template<typename Map>
+auto map_contains(const Map& map, const typename Map::key_type& key) -> bool {
+    return map.contains(key);
+}
+
+template<typename Map>
+constexpr bool is_flat_map = requires(const Map& map) { map.keys(); };
+
+template<typename Map>
+auto bench_map(runner& r, std::string_view name) -> void {
+    using K = typename Map::key_type;
+    constexpr std::size_t count = 100'000;
+    auto type = type_name<K>();
+    auto prefix = std::string{name};
+
+    auto entries = std::vector<std::pair<K, std::int64_t>>{};
+    for (std::size_t i = 0; i < count; i++) {
+        // scatter the keys so sorted containers don't get sorted input for free
+        entries.emplace_back(make_key<K>((i * 7919) % count * 2), static_cast<std::int64_t>(i));
+    }
+
+    if constexpr (is_flat_map<Map>) {
+        // inserting one key at a time is quadratic, flat maps are meant to be built in bulk
+        r.run(prefix + "/bulk_build", type, count, [&entries] {
+            Map map(entries.begin(), entries.end());
+            do_not_optimise(map);
+        });
+    } else {
+        r.run(prefix + "/insert", type, count, [&entries] {
+            Map map;
+            for (const auto& [key, value] : entries) {
+                map_insert(map, key, value);
+            }
+            do_not_optimise(map);
+        });
+    }
+
+    auto source = Map{};
+    if constexpr (is_flat_map<Map>) {
+        source = Map(entries.begin(), entries.end());
+    } else {
+        for (const auto& [key, value] : entries) {
+            map_insert(source, key, value);
+        }
+    }
+
+    auto hits = std::vector<K>{};
+    auto misses = std::vector<K>{};
+    for (std::size_t i = 0; i < count; i++) {
+        // look keys up in a different order than they were inserted, so node based maps don't walk their nodes in
+        // allocation order
+        hits.push_back(make_key<K>((i * 104729) % count * 2));
+        misses.push_back(make_key<K>((i * 104729) % count * 2 + 1));
+    }
+
+    r.run(prefix + "/lookup_hit", type, count, [&source, &hits] {
+        std::size_t found = 0;
+        for (const auto& key : hits) {
+            found += map_contains(source, key);
+        }
+        do_not_optimise(found);
+    });
+
+    r.run(prefix + "/lookup_miss", type, count, [&source, &misses] {
+        std::size_t found = 0;
+        for (const auto& key : misses) {
+            found += map_contains(source, key);
+        }
+        do_not_optimise(found);
+    });
+}
+
+// The vectorised algorithms against the equivalent std algorithms over the same list.
+template<typename T>
+auto bench_algorithms(runner& r) -> void {
+    constexpr std::size_t count = 100'000;
+    auto type = type_name<T>();
+
+    auto source = collections::list<T>{};
+    for (std::size_t i = 0; i < count; i++) {
+        source.add(static_cast<T>(i % 1'000));
+    }
+    // only the last element matches, so find scans everything
+    source.add(static_cast<T>(-1));
+    auto needle = static_cast<T>(-1);
+
+    r.run("algorithms/find", type, count, [&source, needle] {
+        do_not_optimise(collections::find(source, needle).has_value());
+    });
+
+    r.run("std_algorithms/find", type, count, [&source, needle] {
+        do_not_optimise(std::ranges::find(source, needle) != source.end());
+    });
+
+    r.run("algorithms/count", type, count, [&source] {
+        do_not_optimise(collections::count(source, T{7}));
+    });
+
+    r.run("std_algorithms/count", type, count, [&source] {
+        do_not_optimise(std::ranges::count(source, T{7}));
+    });
+
+    r.run("algorithms/minmax", type, count, [&source] {
+        do_not_optimise(collections::minmax(source));
+    });
+
+    r.run("std_algorithms/minmax", type, count, [&source] {
+        do_not_optimise(std::ranges::minmax(source));
+    });
+
+    r.run("algorithms/sum", type, count, [&source] {
+        do_not_optimise(collections::sum(source));
+    });
+
+    r.run("std_algorithms/sum", type, count, [&source] {
+        do_not_optimise(std::accumulate(source.begin(), source.end(), T{}));
+    });
+}
+
+// Visiting a list of six alternative variants one and two at a time, and copying the list, for `utilities::variant`
+// against `std::variant`.
+template<template<typename...> typename Variant, typename Visit>
+auto bench_variant(runner& r, std::string_view name, Visit visit) -> void {
+    using variant_type = Variant<std::int32_t, float, double, std::int64_t, std::int16_t, char>;
+    constexpr std::size_t count = 100'000;
+
+    auto values = std::vector<variant_type>{};
+    for (std::size_t i = 0; i < count; i++) {
+        switch ((i * 7) % 6) {
+            case 0:
+                values.emplace_back(static_cast<std::int32_t>(i));
+                break;
+            case 1:
+                values.emplace_back(static_cast<float>(i));
+                break;
+            case 2:
+                values.emplace_back(static_cast<double>(i));
+                break;
+            case 3:
+                values.emplace_back(static_cast<std::int64_t>(i));
+                break;
+            case 4:
+                values.emplace_back(static_cast<std::int16_t>(i));
+                break;
+            default:
+                values.emplace_back(static_cast<char>(i));
+                break;
+        }
+    }
+
+    r.run(std::format("{}/visit", name), "variant", count, [&values, &visit] {
+        double sum = 0;
+        for (const auto& value : values) {
+            sum += visit([](auto x) { return static_cast<double>(x); }, value);
+        }
+        do_not_optimise(sum);
+    });
+
+    r.run(std::format("{}/visit_pair", name), "variant", count, [&values, &visit] {
+        double sum = 0;
+        for (std::size_t i = 1; i < values.size(); i++) {
+            sum += visit([](auto x, auto y) { return static_cast<double>(x) - static_cast<double>(y); },
+                values[i - 1], values[i]);
+        }
+        do_not_optimise(sum);
+    });
+
+    r.run(std::format("{}/copy", name), "variant", count, [&values] {
+        auto copy = values;
+        do_not_optimise(copy);
+    });
+}
+
+// Strings of 16 to 23 characters fit inline in `strings::string` but not in libstdc++'s `std::string`, followed by
+// appending and the vectorised searches over a long string against their `std::string` equivalents.
+auto bench_strings(runner& r) -> void {
+    constexpr std::size_t count = 10'000;
+    constexpr std::size_t length = 100'000;
+    constexpr std::string_view word = "twenty_character_key";
+
+    r.run("string/construct_short", "char", count, [word] {
+        for (std::size_t i = 0; i < count; i++) {
+            auto s = strings::string{word};
+            do_not_optimise(s);
+        }
+    });
+
+    r.run("std_string/construct_short", "char", count, [word] {
+        for (std::size_t i = 0; i < count; i++) {
+            auto s = std::string{word};
+            do_not_optimise(s);
+        }
+    });
+
+    r.run("string/add", "char", length, [] {
+        auto s = strings::string{};
+        for (std::size_t i = 0; i < length; i++) {
+            s.add(static_cast<char>('a' + i % 26));
+        }
+        do_not_optimise(s);
+    });
+
+    r.run("std_string/add", "char", length, [] {
+        auto s = std::string{};
+        for (std::size_t i = 0; i < length; i++) {
+            s.push_back(static_cast<char>('a' + i % 26));
+        }
+        do_not_optimise(s);
+    });
+
+    // the needle and the characters searched for only appear at the very end
+    auto source = std::string{};
+    for (std::size_t i = 0; i < length; i++) {
+        source.push_back(static_cast<char>('a' + i % 23));
+    }
+    source += "needle{}";
+    auto string = strings::string{source};
+
+    r.run("string/find", "char", length, [&string] {
+        do_not_optimise(string.find("needle").has_value());
+    });
+
+    r.run("std_string/find", "char", length, [&source] {
+        do_not_optimise(source.find("needle"));
+    });
+
+    r.run("string/find_first_of", "char", length, [&string] {
+        do_not_optimise(string.find_first_of("{}[]").has_value());
+    });
+
+    r.run("std_string/find_first_of", "char", length, [&source] {
+        do_not_optimise(source.find_first_of("{}[]"));
+    });
+}
+
+// Deduplicating repeated keys, and looking interned keys up in a map against looking the strings themselves up.
+auto bench_interner(runner& r) -> void {
+    constexpr std::size_t count = 100'000;
+    constexpr std::size_t distinct = 5'000;
+
+    auto words = std::vector<std::string>{};
+    for (std::size_t i = 0; i < count; i++) {
+        words.push_back(std::format("service.request.tag_{}", i % distinct));
+    }
+
+    r.run("interner/intern", "string", count, [&words] {
+        auto interner = strings::interner{};
+        for (const auto& word : words) {
+            do_not_optimise(interner.intern(word));
+        }
+    });
+
+    r.run("unordered_set/intern", "string", count, [&words] {
+        auto set = std::unordered_set<std::string>{};
+        for (const auto& word : words) {
+            do_not_optimise(*set.insert(word).first);
+        }
+    });
+
+    auto interner = strings::interner{};
+    auto handles = std::vector<strings::interned>{};
+    auto interned_map = collections::hash_map<strings::interned, std::int64_t>{};
+    auto string_map = collections::hash_map<std::string, std::int64_t>{};
+    for (std::size_t i = 0; i < count; i++) {
+        handles.push_back(interner.intern(words[i]));
+        if (i < distinct) {
+            interned_map.insert(handles.back(), static_cast<std::int64_t>(i));
+            string_map.insert(words[i], static_cast<std::int64_t>(i));
+        }
+    }
+
+    r.run("hash_map/interned_lookup", "string", count, [&interned_map, &handles] {
+        std::size_t found = 0;
+        for (auto handle : handles) {
+            found += interned_map.contains(handle);
+        }
+        do_not_optimise(found);
+    });
+
+    r.run("hash_map/string_lookup", "string", count, [&string_map, &words] {
+        std::size_t found = 0;
+        for (const auto& word : words) {
+            found += string_map.contains(word);
+        }
+        do_not_optimise(found);
+    });
+}
+
+// Reading a file that is already in the page cache through a mapping and through a reader against copying it through
+// an ifstream, both whole and a reader buffer at a time, then writing it through a writer against an ofstream.
+auto bench_files(runner& r) -> void {
+    constexpr std::size_t size = 64 * 1024 * 1024;
+    auto path = std::filesystem::temp_directory_path() / "rtl_bench_mapped_file.bin";
+    {
+        auto block = std::vector<char>(1024 * 1024);
+        for (std::size_t i = 0; i < block.size(); i++) {
+            block[i] = static_cast<char>(i % 251);
+        }
+
+        auto file = std::ofstream{path, std::ios::binary};
+        for (std::size_t written = 0; written < size; written += block.size()) {
+            file.write(block.data(), static_cast<std::streamsize>(block.size()));
+        }
+    }
+
+    r.run("mapped_file/read", "byte", size, [&path] {
+        auto file = fs::mapped_file::open(path, {.pattern = fs::access_pattern::sequential});
+        auto bytes = file->view();
+        do_not_optimise(collections::count(bytes, '\0'));
+    });
+
+    r.run("ifstream/read", "byte", size, [&path] {
+        auto buffer = std::vector<char>(size);
+        auto file = std::ifstream{path, std::ios::binary};
+        file.read(buffer.data(), static_cast<std::streamsize>(size));
+        do_not_optimise(collections::count(buffer, '\0'));
+    });
+
+    // the same 1 MiB at a time a reader with the default options hands out
+    r.run("ifstream/read_chunked", "byte", size, [&path] {
+        auto buffer = std::vector<char>(fs::io_options{}.buffer_size);
+        auto file = std::ifstream{path, std::ios::binary};
+        std::size_t zeros = 0;
+        while (file.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || file.gcount() > 0) {
+            zeros += collections::count(std::span{buffer.data(), static_cast<std::size_t>(file.gcount())}, '\0');
+        }
+        do_not_optimise(zeros);
+    });
+
+    r.run("file_reader/read", "byte", size, [&path] {
+        auto file = fs::file_reader::open(path);
+        std::size_t zeros = 0;
+        for (auto chunk = file->next(); !chunk.empty(); chunk = file->next()) {
+            // counted as characters like the ifstream cases, since only arithmetic types take the vector path
+            zeros += collections::count(std::string_view{reinterpret_cast<const char*>(chunk.data()), chunk.size()},
+                '\0');
+        }
+        do_not_optimise(zeros);
+    });
+
+    auto block = std::vector<char>(64 * 1024, 'x');
+    auto write_with = [&](fs::io_backend backend) {
+        return [&path, &block, backend] {
+            auto file = fs::file_writer::open(path, {.backend = backend});
+            for (std::size_t written = 0; written < size; written += block.size()) {
+                file->write(std::string_view{block.data(), block.size()});
+            }
+            do_not_optimise(file->close());
+        };
+    };
+
+    r.run("file_writer/write_io_uring", "byte", size, write_with(fs::io_backend::automatic));
+    r.run("file_writer/write_sync", "byte", size, write_with(fs::io_backend::synchronous));
+
+    r.run("ofstream/write", "byte", size, [&path, &block] {
+        auto file = std::ofstream{path, std::ios::binary};
+        for (std::size_t written = 0; written < size; written += block.size()) {
+            file.write(block.data(), static_cast<std::streamsize>(block.size()));
+        }
+        file.close();
+        do_not_optimise(file.good());
+    });
+
+    std::filesystem::remove(path);
+}
+
+// Building the structural index one block at a time against the dispatched vector classifier and each of its kernels,
+// then parsing a document of 20000 small objects, alone and while summing one field of each.
+auto bench_json(runner& r) -> void {
+    auto text = std::string{"["};
+    for (int i = 0; i < 20000; i++) {
+        text += std::format(R"({{"id": {}, "name": "item \"{}\"", "tags": ["a", "b"], "score": {}.5, "ok": true}},)", i, i, i);
+    }
+    text += "null]";
+
+    auto blocks = text.size() / json::detail::block_size;
+    auto masks = std::vector<json::detail::block_masks>(blocks);
+    r.run("json/classify_scalar", "byte", blocks * json::detail::block_size, [&] {
+        for (std::size_t i = 0; i < blocks; i++) {
+            masks[i] = json::detail::classify_scalar(text.data() + i * json::detail::block_size);
+        }
+        do_not_optimise(masks.back().quote);
+    });
+
+    r.run("json/classify", "byte", blocks * json::detail::block_size, [&] {
+        json::detail::classify(text.data(), blocks, masks.data());
+        do_not_optimise(masks.back().quote);
+    });
+
+#ifdef RTL_X86
+    if (utilities::cpu().sse42) {
+        r.run("json/classify_sse42", "byte", blocks * json::detail::block_size, [&] {
+            json::detail::classify_sse42(text.data(), blocks, masks.data());
+            do_not_optimise(masks.back().quote);
+        });
+    }
+
+    if (utilities::cpu().avx2) {
+        r.run("json/classify_avx2", "byte", blocks * json::detail::block_size, [&] {
+            json::detail::classify_avx2(text.data(), blocks, masks.data());
+            do_not_optimise(masks.back().quote);
+        });
+    }
+#endif
+
+    r.run("json/parse", "byte", text.size(), [&text] {
+        do_not_optimise(json::parse(text).has_value());
+    });
+
+    r.run("json/parse_and_sum", "byte", text.size(), [&text] {
+        auto document = json::parse(text);
+        auto elements = *document->root().as_array();
+        std::int64_t sum = 0;
+        for (auto element : elements) {
+            sum += element["id"].and_then([](json::value id) { return id.get_int64(); }).unwrap_or(0);
+        }
+        do_not_optimise(sum);
+    });
+}
+
+struct bench_record {
+    std::int64_t id;
+    double score;
+    std::string_view name;
+    bool ok;
+};
+} // namespace
+
+template<>
+struct rtl::json::reflection<bench_record> {
+    static constexpr auto fields = std::tuple{
+        json::member{"id", &bench_record::id},
+        json::member{"score", &bench_record::score},
+        json::member{"name", &bench_record::name},
+        json::member{"ok", &bench_record::ok},
+    };
+};
+
+namespace {
+
+// Writing 10000 reflected records into a list and into a string, against formatting the same text with std::format_to.
+auto bench_json_writer(runner& r) -> void {
+    constexpr std::size_t count = 10000;
+    auto records = std::vector<bench_record>{};
+    for (std::size_t i = 0; i < count; i++) {
+        records.push_back({static_cast<std::int64_t>(i), static_cast<double>(i) / 7.0, "a \"quoted\" name", i % 2 == 0});
+    }
+
+    auto buffer = collections::list<char>{};
+    r.run("json/writer", "object", count, [&] {
+        buffer.clear();
+        json::writer{buffer}.value(records);
+        do_not_optimise(buffer.size());
+    });
+
+    auto string = strings::string{};
+    r.run("json/writer_string", "object", count, [&] {
+        string.clear();
+        json::writer{string}.value(records);
+        do_not_optimise(string.size());
+    });
+
+    auto text = std::string{};
+    r.run("json/format", "object", count, [&] {
+        text.clear();
+        text += '[';
+        for (const auto& record : records) {
+            std::format_to(std::back_inserter(text), R"({{"id":{},"score":{},"name":"a \"quoted\" name","ok":{}}},)",
+                record.id, record.score, record.ok);
+        }
+        text.back() = ']';
+        do_not_optimise(text.size());
+    });
+}
+
+// Task overhead: many tiny submitted tasks, and a parallel_for whose body does almost nothing, followed by the parallel
+// algorithms against their serial std equivalents.
+auto bench_thread_pool(runner& r) -> void {
+    constexpr std::size_t tasks = 10'000;
+    constexpr std::size_t indices = 1'000'000;
+
+    concurrency::thread_pool pool;
+    auto handles = collections::list<concurrency::task_handle<std::size_t>>{};
+    handles.reserve(tasks);
+
+    r.run("thread_pool/submit_get", "task", tasks, [&pool, &handles] {
+        for (std::size_t i = 0; i < tasks; i++) {
+            handles.add(pool.submit([i] { return i; }));
+        }
+
+        std::size_t total = 0;
+        for (auto& handle : handles) {
+            total += handle.get();
+        }
+        handles.clear();
+        do_not_optimise(total);
+    });
+
+    auto values = collections::list<std::uint64_t>(indices);
+    r.run("thread_pool/parallel_for", "index", indices, [&pool, &values] {
+        pool.parallel_for(0, indices, [&values](std::size_t i) {
+            values.at_unchecked(i) = i * i;
+        });
+        do_not_optimise(values);
+    });
+
+    r.run("serial/for", "index", indices, [&values] {
+        for (std::size_t i = 0; i < indices; i++) {
+            values.at_unchecked(i) = i * i;
+        }
+        do_not_optimise(values);
+    });
+
+    auto unsorted = collections::list<std::uint64_t>{};
+    for (std::size_t i = 0; i < indices; i++) {
+        unsorted.add(i * 0x9E3779B97F4A7C15u);
+    }
+
+    r.run("parallel/sort", "trivial", indices, [&pool, &unsorted, &values] {
+        values = unsorted;
+        collections::parallel_sort(pool, values);
+        do_not_optimise(values);
+    });
+
+    r.run("serial/sort", "trivial", indices, [&unsorted, &values] {
+        values = unsorted;
+        std::ranges::sort(values);
+        do_not_optimise(values);
+    });
+
+    r.run("parallel/reduce", "trivial", indices, [&pool, &unsorted] {
+        do_not_optimise(collections::parallel_reduce(pool, unsorted, std::uint64_t{}));
+    });
+
+    r.run("serial/accumulate", "trivial", indices, [&unsorted] {
+        do_not_optimise(std::accumulate(unsorted.begin(), unsorted.end(), std::uint64_t{}));
+    });
+}
+
+// One producer thread hands messages to one consumer thread, against a mutex protected std::deque.
+auto bench_spsc_queue(runner& r) -> void {
+    constexpr std::size_t messages = 1'000'000;
+    static constexpr std::size_t batch = 64;
+
+    r.run("spsc_queue/transfer", "message", messages, [] {
+        concurrency::spsc_queue<std::uint64_t> queue{4096};
+        std::thread consumer{[&queue] {
+            std::uint64_t total = 0;
+            for (std::size_t received = 0; received < messages;) {
+                if (auto message = queue.try_pop(); message.has_value()) {
+                    total += message.value();
+                    received++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+            do_not_optimise(total);
+        }};
+
+        for (std::uint64_t i = 0; i < messages;) {
+            if (queue.try_push(i)) {
+                i++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        consumer.join();
+    });
+
+    r.run("spsc_queue/transfer_batched", "message", messages, [] {
+        concurrency::spsc_queue<std::uint64_t> queue{4096};
+        std::thread consumer{[&queue] {
+            std::uint64_t total = 0;
+            std::uint64_t received[batch];
+            for (std::size_t count = 0; count < messages;) {
+                auto popped = queue.pop_n(received, batch);
+                if (popped == 0) {
+                    std::this_thread::yield();
+                }
+                for (std::size_t i = 0; i < popped; i++) {
+                    total += received[i];
+                }
+                count += popped;
+            }
+            do_not_optimise(total);
+        }};
+
+        std::uint64_t sent[batch];
+        for (std::uint64_t i = 0; i < messages;) {
+            auto count = std::min<std::uint64_t>(batch, messages - i);
+            for (std::uint64_t j = 0; j < count; j++) {
+                sent[j] = i + j;
+            }
+            auto pushed = queue.push_n(sent, count);
+            if (pushed == 0) {
+                std::this_thread::yield();
+            }
+            i += pushed;
+        }
+        consumer.join();
+    });
+
+    r.run("mutex_deque/transfer", "message", messages, [] {
+        std::mutex mutex;
+        std::deque<std::uint64_t> queue;
+        std::thread consumer{[&mutex, &queue] {
+            std::uint64_t total = 0;
+            for (std::size_t received = 0; received < messages;) {
+                std::lock_guard lock{mutex};
+                if (!queue.empty()) {
+                    total += queue.front();
+                    queue.pop_front();
+                    received++;
+                }
+            }
+            do_not_optimise(total);
+        }};
+
+        for (std::uint64_t i = 0; i < messages; i++) {
+            std::lock_guard lock{mutex};
+            queue.push_back(i);
+        }
+        consumer.join();
+    });
+}
+
+// Producers and consumers hammering one mpmc_queue, each count going from 1 up to the number of cores in powers of two.
+auto bench_mpmc_queue(runner& r) -> void {
+    constexpr std::size_t messages = 1'000'000;
+    auto cores = static_cast<std::size_t>(std::max(1u, std::thread::hardware_concurrency()));
+
+    auto counts = std::vector<std::size_t>{};
+    for (std::size_t count = 1; count < cores; count *= 2) {
+        counts.push_back(count);
+    }
+    counts.push_back(cores);
+
+    // each of `threads` threads gets an equal share of the messages, the first ones take the remainder
+    auto share = [](std::size_t thread, std::size_t threads) {
+        return messages / threads + (thread < messages % threads ? 1 : 0);
+    };
+
+    for (auto producers : counts) {
+        for (auto consumers : counts) {
+            auto name = "mpmc_queue/p" + std::to_string(producers) + "_c" + std::to_string(consumers);
+            r.run(std::move(name), "message", messages, [producers, consumers, &share] {
+                concurrency::mpmc_queue<std::uint64_t> queue{4096};
+                std::vector<std::thread> threads;
+                for (std::size_t p = 0; p < producers; p++) {
+                    threads.emplace_back([&queue, count = share(p, producers)] {
+                        for (std::uint64_t i = 0; i < count; i++) {
+                            queue.push(i);
+                        }
+                    });
+                }
+
+                for (std::size_t c = 0; c < consumers; c++) {
+                    threads.emplace_back([&queue, count = share(c, consumers)] {
+                        std::uint64_t total = 0;
+                        for (std::size_t i = 0; i < count; i++) {
+                            total += queue.pop();
+                        }
+                        do_not_optimise(total);
+                    });
+                }
+
+                for (auto& thread : threads) {
+                    thread.join();
+                }
+            });
+        }
+    }
+}
+
+auto parse_options(int argc, char** argv) -> options {
+    options opts;
+    for (int i = 1; i < argc; i++) {
+        auto arg = std::string_view{argv[i]};
+        if (arg == "--json") {
+            opts.format = output_format::json;
+        } else if (arg == "--csv") {
+            opts.format = output_format::csv;
+        } else if (arg.starts_with("--filter=")) {
+            opts.filter = arg.substr(std::string_view{"--filter="}.size());
+        } else if (arg == "--quick") {
+            opts.min_time = std::chrono::milliseconds{1};
+            opts.samples = 1;
+        } else {
+            std::println(stderr, "Unknown argument '{}'", arg);
+            std::println(stderr, "Usage: rtl-bench [--csv | --json] [--filter=<substring>] [--quick]");
+            std::exit(1);
+        }
+    }
+    return opts;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    runner r{parse_options(argc, argv)};
+
+    bench_type<std::int64_t>(r);
+    bench_type<std::string>(r);
+    bench_type<move_only>(r);
+
+    bench_map<collections::hash_map<std::int64_t, std::int64_t>>(r, "hash_map");
+    bench_map<std::unordered_map<std::int64_t, std::int64_t>>(r, "unordered_map");
+    bench_map<collections::flat_map<std::int64_t, std::int64_t>>(r, "flat_map");
+    bench_map<collections::btree_map<std::int64_t, std::int64_t>>(r, "btree_map");
+    bench_map<std::map<std::int64_t, std::int64_t>>(r, "map");
+    bench_map<collections::hash_map<std::string, std::int64_t>>(r, "hash_map");
+    bench_map<std::unordered_map<std::string, std::int64_t>>(r, "unordered_map");
+    bench_map<collections::flat_map<std::string, std::int64_t>>(r, "flat_map");
+    bench_map<collections::btree_map<std::string, std::int64_t>>(r, "btree_map");
+    bench_map<std::map<std::string, std::int64_t>>(r, "map");
+
+    bench_algorithms<std::int32_t>(r);
+    bench_algorithms<float>(r);
+    bench_variant<utilities::variant>(r, "variant", [](auto&& f, const auto&... v) {
+        return utilities::visit(f, v...);
+    });
+    bench_variant<std::variant>(r, "std_variant", [](auto&& f, const auto&... v) {
+        return std::visit(f, v...);
+    });
+    bench_strings(r);
+    bench_interner(r);
+    bench_files(r);
+    bench_json(r);
+    bench_json_writer(r);
+
+    bench_thread_pool(r);
+    bench_spsc_queue(r);
+    bench_mpmc_queue(r);
+
+    bench_scratch_buffer(r);
+    bench_allocator_churn<memory::pool_allocator>(r, "pool_allocator");
+    bench_allocator_churn<std::allocator>(r, "std_allocator");
+
+    r.print();
+}
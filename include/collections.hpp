@@ -20,6 +20,15 @@
 #ifndef RTL_COLLECTIONS_HPP
 #define RTL_COLLECTIONS_HPP
 
+#include "collections/algorithms.hpp"
+#include "collections/btree_map.hpp"
+#include "collections/btree_set.hpp"
+#include "collections/flat_map.hpp"
+#include "collections/flat_set.hpp"
+#include "collections/hash_map.hpp"
 #include "collections/list.hpp"
+#include "collections/parallel_algorithms.hpp"
+#include "collections/segmented_list.hpp"
+#include "collections/small_list.hpp"
 
 #endif // #ifndef RTL_COLLECTIONS_HPP
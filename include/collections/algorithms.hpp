@@ -0,0 +1,365 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_ALGORITHMS_HPP
+#define RTL_ALGORITHMS_HPP
+
+#include "utilities/cpu.hpp"
+#include "utilities/option.hpp"
+#include "utilities/reference.hpp"
+#include "utilities/simd.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+// Searches and reductions over the contiguous containers. For arithmetic element types these run vectorised kernels,
+// picking AVX2 or SSE4.2 at runtime based on what the CPU supports, and otherwise fall back to scalar loops.
+
+namespace rtl::collections {
+namespace detail {
+template<typename C>
+concept contiguous_container = requires(C& container) {
+    typename C::value_type;
+    { container.data() } -> std::convertible_to<const typename C::value_type*>;
+    { container.size() } -> std::convertible_to<std::size_t>;
+};
+
+template<typename C>
+using element_reference = utilities::reference<std::remove_pointer_t<decltype(std::declval<C&>().data())>>;
+
+// Integer sums wrap around on overflow, like the vector lanes do.
+template<typename T>
+constexpr auto wrapping_add(T a, T b) noexcept -> T {
+    if constexpr (std::integral<T>) {
+        using unsigned_type = std::make_unsigned_t<T>;
+        return static_cast<T>(static_cast<unsigned_type>(static_cast<unsigned_type>(a) + static_cast<unsigned_type>(b)));
+    } else {
+        return a + b;
+    }
+}
+
+// scalar kernels, used for other types and in constant evaluation
+
+template<typename T>
+constexpr auto find_scalar(const T* data, std::size_t size, const T& value) -> std::size_t {
+    for (std::size_t i = 0; i < size; i++) {
+        if (data[i] == value) {
+            return i;
+        }
+    }
+
+    return size;
+}
+
+template<typename T>
+constexpr auto count_scalar(const T* data, std::size_t size, const T& value) -> std::size_t {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < size; i++) {
+        count += static_cast<std::size_t>(data[i] == value);
+    }
+
+    return count;
+}
+
+// `size` must not be zero.
+template<typename T>
+constexpr auto minmax_scalar(const T* data, std::size_t size) -> std::pair<T, T> {
+    auto min = data[0];
+    auto max = data[0];
+    for (std::size_t i = 1; i < size; i++) {
+        if (data[i] < min) {
+            min = data[i];
+        }
+
+        if (max < data[i]) {
+            max = data[i];
+        }
+    }
+
+    return {min, max};
+}
+
+template<typename T>
+constexpr auto sum_scalar(const T* data, std::size_t size) -> T {
+    auto sum = T{};
+    for (std::size_t i = 0; i < size; i++) {
+        sum = wrapping_add(sum, data[i]);
+    }
+
+    return sum;
+}
+
+// vector kernels, written once over the `utilities::simd` wrappers and inlined into an entry point per instruction set
+
+template<typename Vec, typename T>
+auto find_vector(const T* data, std::size_t size, T value) noexcept -> std::size_t {
+    auto needle = Vec{};
+    needle.fill(value);
+    auto values = Vec{};
+    std::size_t i = 0;
+    for (; i + Vec::lanes <= size; i += Vec::lanes) {
+        values.load(data + i);
+        if (auto mask = values.equal_mask(needle); mask != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(mask)) / sizeof(T);
+        }
+    }
+
+    return i + find_scalar(data + i, size - i, value);
+}
+
+template<typename Vec, typename T>
+auto count_vector(const T* data, std::size_t size, T value) noexcept -> std::size_t {
+    auto needle = Vec{};
+    needle.fill(value);
+    auto values = Vec{};
+    std::size_t matching_bytes = 0;
+    std::size_t i = 0;
+    for (; i + Vec::lanes <= size; i += Vec::lanes) {
+        values.load(data + i);
+        matching_bytes += static_cast<std::size_t>(std::popcount(values.equal_mask(needle)));
+    }
+
+    return matching_bytes / sizeof(T) + count_scalar(data + i, size - i, value);
+}
+
+// `size` must be at least `Vec::lanes`. The last vector may overlap the one before it, which doesn't change the result.
+template<typename Vec, typename T>
+auto minmax_vector(const T* data, std::size_t size) noexcept -> std::pair<T, T> {
+    auto min = Vec{};
+    min.load(data);
+    auto max = min;
+    auto values = Vec{};
+    for (std::size_t i = Vec::lanes; i < size; i += Vec::lanes) {
+        values.load(data + std::min(i, size - Vec::lanes));
+        min.keep_min(values);
+        max.keep_max(values);
+    }
+
+    T min_lanes[Vec::lanes];
+    T max_lanes[Vec::lanes];
+    min.store(min_lanes);
+    max.store(max_lanes);
+    return {minmax_scalar(min_lanes, Vec::lanes).first, minmax_scalar(max_lanes, Vec::lanes).second};
+}
+
+template<typename Vec, typename T>
+auto sum_vector(const T* data, std::size_t size) noexcept -> T {
+    // independent accumulators keep several additions in flight
+    auto a = Vec{};
+    a.fill(T{});
+    auto b = a;
+    auto values = Vec{};
+    std::size_t i = 0;
+    for (; i + 2 * Vec::lanes <= size; i += 2 * Vec::lanes) {
+        values.load(data + i);
+        a.add(values);
+        values.load(data + i + Vec::lanes);
+        b.add(values);
+    }
+
+    T lanes[Vec::lanes];
+    a.add(b);
+    a.store(lanes);
+    return wrapping_add(sum_scalar(lanes, Vec::lanes), sum_scalar(data + i, size - i));
+}
+
+#ifdef RTL_X86
+template<typename T>
+RTL_TARGET("avx2") auto find_avx2(const T* data, std::size_t size, T value) noexcept -> std::size_t {
+    return find_vector<utilities::simd::avx2::vec<T>>(data, size, value);
+}
+
+template<typename T>
+RTL_TARGET("avx2") auto count_avx2(const T* data, std::size_t size, T value) noexcept -> std::size_t {
+    return count_vector<utilities::simd::avx2::vec<T>>(data, size, value);
+}
+
+template<typename T>
+RTL_TARGET("avx2") auto minmax_avx2(const T* data, std::size_t size) noexcept -> std::pair<T, T> {
+    return minmax_vector<utilities::simd::avx2::vec<T>>(data, size);
+}
+
+template<typename T>
+RTL_TARGET("avx2") auto sum_avx2(const T* data, std::size_t size) noexcept -> T {
+    return sum_vector<utilities::simd::avx2::vec<T>>(data, size);
+}
+
+template<typename T>
+RTL_TARGET("sse4.2") auto find_sse42(const T* data, std::size_t size, T value) noexcept -> std::size_t {
+    return find_vector<utilities::simd::sse42::vec<T>>(data, size, value);
+}
+
+template<typename T>
+RTL_TARGET("sse4.2") auto count_sse42(const T* data, std::size_t size, T value) noexcept -> std::size_t {
+    return count_vector<utilities::simd::sse42::vec<T>>(data, size, value);
+}
+
+template<typename T>
+RTL_TARGET("sse4.2") auto minmax_sse42(const T* data, std::size_t size) noexcept -> std::pair<T, T> {
+    return minmax_vector<utilities::simd::sse42::vec<T>>(data, size);
+}
+
+template<typename T>
+RTL_TARGET("sse4.2") auto sum_sse42(const T* data, std::size_t size) noexcept -> T {
+    return sum_vector<utilities::simd::sse42::vec<T>>(data, size);
+}
+#endif
+
+// dispatch
+
+template<typename T>
+constexpr auto find_index(const T* data, std::size_t size, const T& value) -> std::size_t {
+#ifdef RTL_X86
+    if constexpr (utilities::simd::element<T>) {
+        if !consteval {
+            if (utilities::cpu().avx2) {
+                return find_avx2(data, size, value);
+            } else if (utilities::cpu().sse42) {
+                return find_sse42(data, size, value);
+            }
+        }
+    }
+#endif
+    return find_scalar(data, size, value);
+}
+
+template<typename T>
+constexpr auto count(const T* data, std::size_t size, const T& value) -> std::size_t {
+#ifdef RTL_X86
+    if constexpr (utilities::simd::element<T>) {
+        if !consteval {
+            if (utilities::cpu().avx2) {
+                return count_avx2(data, size, value);
+            } else if (utilities::cpu().sse42) {
+                return count_sse42(data, size, value);
+            }
+        }
+    }
+#endif
+    return count_scalar(data, size, value);
+}
+
+// `size` must not be zero.
+template<typename T>
+constexpr auto minmax(const T* data, std::size_t size) -> std::pair<T, T> {
+#ifdef RTL_X86
+    if constexpr (utilities::simd::element<T>) {
+        if !consteval {
+            if (utilities::cpu().avx2 && size >= utilities::simd::avx2::vec<T>::lanes) {
+                return minmax_avx2(data, size);
+            } else if (utilities::cpu().sse42 && size >= utilities::simd::sse42::vec<T>::lanes) {
+                return minmax_sse42(data, size);
+            }
+        }
+    }
+#endif
+    return minmax_scalar(data, size);
+}
+
+template<typename T>
+constexpr auto sum(const T* data, std::size_t size) -> T {
+#ifdef RTL_X86
+    if constexpr (utilities::simd::element<T>) {
+        if !consteval {
+            if (utilities::cpu().avx2) {
+                return sum_avx2(data, size);
+            } else if (utilities::cpu().sse42) {
+                return sum_sse42(data, size);
+            }
+        }
+    }
+#endif
+    return sum_scalar(data, size);
+}
+} // namespace detail
+
+// The first element equal to `value`.
+template<detail::contiguous_container C> requires(std::equality_comparable<typename C::value_type>)
+constexpr auto find(C& container, const typename C::value_type& value)
+    -> utilities::option<detail::element_reference<C>> {
+    auto index = detail::find_index(container.data(), container.size(), value);
+    if (index == container.size()) {
+        return utilities::nullopt;
+    }
+
+    return container.data()[index];
+}
+
+template<detail::contiguous_container C> requires(std::equality_comparable<typename C::value_type>)
+[[nodiscard]] constexpr auto contains(const C& container, const typename C::value_type& value) -> bool {
+    return detail::find_index(container.data(), container.size(), value) != container.size();
+}
+
+// The number of elements equal to `value`.
+template<detail::contiguous_container C> requires(std::equality_comparable<typename C::value_type>)
+[[nodiscard]] constexpr auto count(const C& container, const typename C::value_type& value) -> std::size_t {
+    return detail::count(container.data(), container.size(), value);
+}
+
+// The smallest element, or nothing if the container is empty. The result is unspecified if a floating point container
+// holds NaN.
+template<detail::contiguous_container C>
+requires(std::totally_ordered<typename C::value_type> && std::copy_constructible<typename C::value_type>)
+constexpr auto min(const C& container) -> utilities::flagged_option<typename C::value_type> {
+    if (container.size() == 0) {
+        return utilities::nullopt;
+    }
+
+    return detail::minmax(container.data(), container.size()).first;
+}
+
+// The largest element, or nothing if the container is empty. The result is unspecified if a floating point container
+// holds NaN.
+template<detail::contiguous_container C>
+requires(std::totally_ordered<typename C::value_type> && std::copy_constructible<typename C::value_type>)
+constexpr auto max(const C& container) -> utilities::flagged_option<typename C::value_type> {
+    if (container.size() == 0) {
+        return utilities::nullopt;
+    }
+
+    return detail::minmax(container.data(), container.size()).second;
+}
+
+// The smallest and largest elements, found in a single pass.
+template<detail::contiguous_container C>
+requires(std::totally_ordered<typename C::value_type> && std::copy_constructible<typename C::value_type>)
+constexpr auto minmax(const C& container)
+    -> utilities::option<std::pair<typename C::value_type, typename C::value_type>> {
+    if (container.size() == 0) {
+        return utilities::nullopt;
+    }
+
+    return detail::minmax(container.data(), container.size());
+}
+
+// The sum of the elements, starting from a value-initialised `T`. Integer sums wrap around on overflow, and floating
+// point sums are accumulated in a different order than a sequential loop, so they may round differently.
+template<detail::contiguous_container C>
+requires(std::default_initializable<typename C::value_type>
+         && requires(const typename C::value_type& a) { { a + a } -> std::convertible_to<typename C::value_type>; })
+[[nodiscard]] constexpr auto sum(const C& container) -> typename C::value_type {
+    return detail::sum(container.data(), container.size());
+}
+} // namespace rtl::collections
+
+#endif // #ifndef RTL_ALGORITHMS_HPP
@@ -0,0 +1,966 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_BTREE_MAP_HPP
+#define RTL_BTREE_MAP_HPP
+
+#include "collections/list.hpp"
+#include "collections/sorted_search.hpp"
+#include "memory/relocate.hpp"
+#include "typing/concepts.hpp"
+#include "utilities/assertions.hpp"
+#include "utilities/attributes.hpp"
+#include "utilities/option.hpp"
+#include "utilities/reference.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace rtl::collections {
+namespace detail {
+template<typename K, typename V, std::size_t LeafCapacity, std::size_t InternalCapacity>
+struct btree_nodes {
+    struct internal;
+
+    struct base {
+        internal* parent{};
+        // index of this node in the parent's children
+        std::uint16_t position{};
+        // number of keys
+        std::uint16_t count{};
+        bool is_leaf{};
+    };
+
+    // Leaves hold every entry and are linked to their neighbours for iteration. Keys and values are kept in separate
+    // arrays so a search only reads keys.
+    struct leaf : base {
+        constexpr leaf() noexcept {
+            this->is_leaf = true;
+        }
+
+        constexpr ~leaf() noexcept {
+
+        }
+
+        leaf* prev{};
+        leaf* next{};
+
+        union {
+            K keys[LeafCapacity];
+        };
+
+        union {
+            V values[LeafCapacity];
+        };
+    };
+
+    // Internal nodes hold copies of keys that separate their children, `children[i]` holds the keys that are not less
+    // than `keys[i - 1]` and less than `keys[i]`.
+    struct internal : base {
+        constexpr internal() noexcept {
+
+        }
+
+        constexpr ~internal() noexcept {
+
+        }
+
+        union {
+            K keys[InternalCapacity];
+        };
+
+        base* children[InternalCapacity + 1]{};
+    };
+}; // struct btree_nodes
+} // namespace detail
+
+// An ordered map implemented as a B+ tree. Nodes are sized to a few cache lines so each level of a search is a short
+// branch-free scan of contiguous keys, and all entries live in linked leaves so iteration and range queries walk
+// memory in order. Inserting or removing an entry invalidates iterators into the leaves that were changed.
+template<
+    typename K,
+    typename V,
+    typename Compare = std::less<K>,
+    typing::simple_allocator Allocator = std::allocator<std::pair<K, V>>
+>
+requires(std::strict_weak_order<const Compare&, const K&, const K&> && std::copy_constructible<K>)
+class btree_map {
+private:
+    // four cache lines, large enough that a search spends most of its time within a node and small enough that
+    // shifting entries on insertion stays cheap
+    static constexpr std::size_t s_node_size = 256;
+    static constexpr std::size_t s_leaf_capacity =
+        std::max<std::size_t>(3, (s_node_size - 4 * sizeof(void*)) / (sizeof(K) + sizeof(V)));
+    static constexpr std::size_t s_internal_capacity =
+        std::max<std::size_t>(3, (s_node_size - 3 * sizeof(void*)) / (sizeof(K) + sizeof(void*)));
+
+    using nodes = detail::btree_nodes<K, V, s_leaf_capacity, s_internal_capacity>;
+    using node_base = typename nodes::base;
+    using leaf_node = typename nodes::leaf;
+    using internal_node = typename nodes::internal;
+
+    using leaf_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<leaf_node>;
+    using internal_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<internal_node>;
+    using key_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<K>;
+    using value_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<V>;
+
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    using optional_ref = utilities::option<utilities::reference<V>>;
+    using optional_const_ref = utilities::option<utilities::reference<const V>>;
+
+    // construction
+
+    constexpr btree_map() noexcept(noexcept(Allocator{}) && noexcept(Compare{})) = default;
+
+    explicit constexpr btree_map(const Compare& compare, const Allocator& allocator = Allocator{})
+        : m_compare{compare}
+        , m_allocator{allocator} {
+
+    }
+
+    // Inserts each pair in turn. When a key appears more than once, the first value wins.
+    template<typing::legacy_input_iterator It>
+    constexpr btree_map(It first, It last, const Compare& compare = Compare{}, const Allocator& allocator = Allocator{})
+        requires(std::constructible_from<K, decltype((*first).first)>
+                 && std::constructible_from<V, decltype((*first).second)>)
+        : m_compare{compare}
+        , m_allocator{allocator} {
+        for (auto it = first; it != last; ++it) {
+            insert((*it).first, (*it).second);
+        }
+    }
+
+    // Builds the tree bottom-up in O(n) from pairs whose keys are already sorted and unique.
+    template<typing::legacy_input_iterator It>
+    constexpr btree_map(sorted_unique_t, It first, It last, const Compare& compare = Compare{},
+                        const Allocator& allocator = Allocator{})
+        requires(std::constructible_from<K, decltype((*first).first)>
+                 && std::constructible_from<V, decltype((*first).second)>)
+        : m_compare{compare}
+        , m_allocator{allocator} {
+        bulk_load(first, last);
+    }
+
+    constexpr btree_map(std::initializer_list<std::pair<K, V>> ilist, const Compare& compare = Compare{},
+                        const Allocator& allocator = Allocator{})
+        requires(std::copy_constructible<V>)
+        : btree_map{ilist.begin(), ilist.end(), compare, allocator} {
+
+    }
+
+    constexpr btree_map(const btree_map& other) requires(std::copy_constructible<V>)
+        : m_compare{other.m_compare}
+        , m_allocator{std::allocator_traits<Allocator>::select_on_container_copy_construction(other.m_allocator)} {
+        bulk_load(other.begin(), other.end());
+    }
+
+    constexpr btree_map(btree_map&& other) noexcept
+        : m_root{std::exchange(other.m_root, nullptr)}
+        , m_first{std::exchange(other.m_first, nullptr)}
+        , m_last{std::exchange(other.m_last, nullptr)}
+        , m_size{std::exchange(other.m_size, 0)}
+        , m_compare{std::move(other.m_compare)}
+        , m_allocator{std::move(other.m_allocator)} {
+
+    }
+
+    constexpr ~btree_map() noexcept {
+        clear();
+    }
+
+    constexpr auto operator=(const btree_map& other) -> btree_map& requires(std::copy_constructible<V>) {
+        if (this == &other) {
+            return *this;
+        }
+
+        clear();
+        m_compare = other.m_compare;
+        bulk_load(other.begin(), other.end());
+        return *this;
+    }
+
+    constexpr auto operator=(btree_map&& other) noexcept -> btree_map& {
+        if (this == &other) {
+            return *this;
+        }
+
+        clear();
+        m_root = std::exchange(other.m_root, nullptr);
+        m_first = std::exchange(other.m_first, nullptr);
+        m_last = std::exchange(other.m_last, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_compare = std::move(other.m_compare);
+        m_allocator = std::move(other.m_allocator);
+        return *this;
+    }
+
+    constexpr auto get_allocator() const noexcept(noexcept(allocator_type{m_allocator})) -> allocator_type {
+        return m_allocator;
+    }
+
+    constexpr auto key_comp() const noexcept(noexcept(key_compare{m_compare})) -> key_compare {
+        return m_compare;
+    }
+
+    // access
+
+    constexpr auto operator[](const K& key) const noexcept -> optional_const_ref {
+        return find(key);
+    }
+
+    constexpr auto operator[](const K& key) noexcept -> optional_ref {
+        return find(key);
+    }
+
+    constexpr auto find(const K& key) const noexcept -> optional_const_ref {
+        if (auto [leaf, index] = find_position(key); leaf != nullptr && is_match(leaf, index, key)) {
+            return leaf->values[index];
+        }
+
+        return utilities::nullopt;
+    }
+
+    constexpr auto find(const K& key) noexcept -> optional_ref {
+        if (auto [leaf, index] = find_position(key); leaf != nullptr && is_match(leaf, index, key)) {
+            return leaf->values[index];
+        }
+
+        return utilities::nullopt;
+    }
+
+    [[nodiscard]] constexpr auto contains(const K& key) const noexcept -> bool {
+        return find(key).has_value();
+    }
+
+    // iterators
+
+    template<bool IsConst>
+    class raw_iterator {
+    private:
+        using leaf_pointer = std::conditional_t<IsConst, const leaf_node*, leaf_node*>;
+        using mapped_reference = std::conditional_t<IsConst, const V&, V&>;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = std::pair<const K, V>;
+        using reference = std::pair<const K&, mapped_reference>;
+        using difference_type = std::ptrdiff_t;
+
+        struct pointer {
+            reference entry;
+
+            constexpr auto operator->() const noexcept -> const reference* {
+                return std::addressof(entry);
+            }
+        };
+
+        constexpr raw_iterator() noexcept = default;
+
+        constexpr raw_iterator(leaf_pointer leaf, size_type index) noexcept
+            : m_leaf{leaf}
+            , m_index{index} {
+
+        }
+
+        constexpr operator raw_iterator<true>() const noexcept requires(!IsConst) {
+            return {m_leaf, m_index};
+        }
+
+        constexpr auto operator*() const noexcept -> reference {
+            return {m_leaf->keys[m_index], m_leaf->values[m_index]};
+        }
+
+        constexpr auto operator->() const noexcept -> pointer {
+            return pointer{**this};
+        }
+
+        // the end iterator points one past the last entry of the last leaf
+        constexpr auto operator++() noexcept -> raw_iterator& {
+            if (++m_index == m_leaf->count && m_leaf->next != nullptr) {
+                m_leaf = m_leaf->next;
+                m_index = 0;
+            }
+
+            return *this;
+        }
+
+        constexpr auto operator++(int) noexcept -> raw_iterator {
+            auto temp = *this;
+            ++(*this);
+            return temp;
+        }
+
+        constexpr auto operator--() noexcept -> raw_iterator& {
+            if (m_index == 0) {
+                m_leaf = m_leaf->prev;
+                m_index = m_leaf->count;
+            }
+
+            --m_index;
+            return *this;
+        }
+
+        constexpr auto operator--(int) noexcept -> raw_iterator {
+            auto temp = *this;
+            --(*this);
+            return temp;
+        }
+
+        constexpr friend auto operator==(const raw_iterator& a, const raw_iterator& b) noexcept -> bool {
+            return a.m_leaf == b.m_leaf && a.m_index == b.m_index;
+        }
+
+    private:
+        leaf_pointer m_leaf{};
+        size_type m_index{};
+    }; // class raw_iterator
+
+    using iterator = raw_iterator<false>;
+    using const_iterator = raw_iterator<true>;
+
+    constexpr auto begin() noexcept -> iterator {
+        return {m_first, 0};
+    }
+
+    constexpr auto begin() const noexcept -> const_iterator {
+        return {m_first, 0};
+    }
+
+    constexpr auto cbegin() const noexcept -> const_iterator {
+        return begin();
+    }
+
+    constexpr auto end() noexcept -> iterator {
+        return {m_last, m_last == nullptr ? size_type{0} : size_type{m_last->count}};
+    }
+
+    constexpr auto end() const noexcept -> const_iterator {
+        return {m_last, m_last == nullptr ? size_type{0} : size_type{m_last->count}};
+    }
+
+    constexpr auto cend() const noexcept -> const_iterator {
+        return end();
+    }
+
+    // The first entry whose key is not less than `key`.
+    constexpr auto lower_bound(const K& key) noexcept -> iterator {
+        auto [leaf, index] = normalise(find_position(key));
+        return {leaf, index};
+    }
+
+    constexpr auto lower_bound(const K& key) const noexcept -> const_iterator {
+        auto [leaf, index] = normalise(find_position(key));
+        return {leaf, index};
+    }
+
+    // The first entry whose key is greater than `key`.
+    constexpr auto upper_bound(const K& key) noexcept -> iterator {
+        auto [leaf, index] = normalise(find_upper_position(key));
+        return {leaf, index};
+    }
+
+    constexpr auto upper_bound(const K& key) const noexcept -> const_iterator {
+        auto [leaf, index] = normalise(find_upper_position(key));
+        return {leaf, index};
+    }
+
+    // The entries whose keys are not less than `first` and less than `last`.
+    constexpr auto range(const K& first, const K& last) noexcept -> std::ranges::subrange<iterator> {
+        return {lower_bound(first), lower_bound(last)};
+    }
+
+    constexpr auto range(const K& first, const K& last) const noexcept -> std::ranges::subrange<const_iterator> {
+        return {lower_bound(first), lower_bound(last)};
+    }
+
+    // capacity/size queries
+
+    [[nodiscard]] constexpr auto empty() const noexcept -> bool {
+        return m_size == 0;
+    }
+
+    [[nodiscard]] constexpr auto size() const noexcept -> size_type {
+        return m_size;
+    }
+
+    // modification
+
+    // Inserts `value` under `key` unless the key is already present. Returns whether the entry was inserted.
+    constexpr auto insert(K key, V value) -> bool {
+        auto [leaf, index] = find_position(key);
+        if (leaf != nullptr && is_match(leaf, index, key)) {
+            return false;
+        }
+
+        emplace_at(leaf, index, std::move(key), std::move(value));
+        return true;
+    }
+
+    // Inserts `value` under `key`, replacing the existing value if the key is already present.
+    constexpr auto insert_or_assign(K key, V value) -> V& {
+        auto [leaf, index] = find_position(key);
+        if (leaf != nullptr && is_match(leaf, index, key)) {
+            return leaf->values[index] = std::move(value);
+        }
+
+        auto [new_leaf, new_index] = emplace_at(leaf, index, std::move(key), std::move(value));
+        return new_leaf->values[new_index];
+    }
+
+    // Returns the value under `key`, constructing it from `args` first if the key is not present.
+    template<typename... Args> requires(std::constructible_from<V, Args...>)
+    constexpr auto find_or_insert(K key, Args&&... args) -> V& {
+        auto [leaf, index] = find_position(key);
+        if (leaf != nullptr && is_match(leaf, index, key)) {
+            return leaf->values[index];
+        }
+
+        auto [new_leaf, new_index] = emplace_at(leaf, index, std::move(key), std::forward<Args>(args)...);
+        return new_leaf->values[new_index];
+    }
+
+    // Removes the entry under `key` and returns its value, if there was one.
+    constexpr auto remove(const K& key) -> utilities::flagged_option<V> {
+        auto [leaf, index] = find_position(key);
+        if (leaf == nullptr || !is_match(leaf, index, key)) {
+            return utilities::nullopt;
+        }
+
+        auto value = utilities::flagged_option<V>{std::move(leaf->values[index])};
+        erase_at(leaf, index);
+        return value;
+    }
+
+    constexpr auto clear() noexcept -> void {
+        if (m_root != nullptr) {
+            destroy_subtree(m_root);
+        }
+
+        m_root = nullptr;
+        m_first = nullptr;
+        m_last = nullptr;
+        m_size = 0;
+    }
+
+private:
+    struct position {
+        leaf_node* leaf;
+        size_type index;
+    };
+
+    // lookup
+
+    constexpr auto find_leaf(const K& key) const noexcept -> leaf_node* {
+        auto node = m_root;
+        while (!node->is_leaf) {
+            auto internal = static_cast<internal_node*>(node);
+            node = internal->children[
+                detail::branchless_upper_bound(internal->keys, internal->count, key, m_compare)];
+        }
+
+        return static_cast<leaf_node*>(node);
+    }
+
+    constexpr auto find_position(const K& key) const noexcept -> position {
+        if (m_root == nullptr) {
+            return {nullptr, 0};
+        }
+
+        auto leaf = find_leaf(key);
+        return {leaf, detail::branchless_lower_bound(leaf->keys, leaf->count, key, m_compare)};
+    }
+
+    constexpr auto find_upper_position(const K& key) const noexcept -> position {
+        if (m_root == nullptr) {
+            return {nullptr, 0};
+        }
+
+        auto leaf = find_leaf(key);
+        return {leaf, detail::branchless_upper_bound(leaf->keys, leaf->count, key, m_compare)};
+    }
+
+    // A search can end one past the last key of a leaf, which is the first key of the next leaf.
+    static constexpr auto normalise(position pos) noexcept -> position {
+        if (pos.leaf != nullptr && pos.index == pos.leaf->count && pos.leaf->next != nullptr) {
+            return {pos.leaf->next, 0};
+        }
+
+        return pos;
+    }
+
+    constexpr auto is_match(const leaf_node* leaf, size_type index, const K& key) const noexcept -> bool {
+        return index != leaf->count && !std::invoke(m_compare, key, leaf->keys[index]);
+    }
+
+    // insertion
+
+    template<typename... Args>
+    constexpr auto emplace_at(leaf_node* leaf, size_type index, K&& key, Args&&... args) -> position {
+        if (leaf == nullptr) {
+            leaf = new_leaf();
+            m_root = leaf;
+            m_first = leaf;
+            m_last = leaf;
+        } else if (leaf->count == s_leaf_capacity) {
+            auto right = split_leaf(leaf);
+            if (index > leaf->count) {
+                index -= leaf->count;
+                leaf = right;
+            }
+        }
+
+        auto keys = key_allocator{m_allocator};
+        auto values = value_allocator{m_allocator};
+        memory::relocate_backward(leaf->keys + index, leaf->count - index, leaf->keys + index + 1, keys);
+        memory::relocate_backward(leaf->values + index, leaf->count - index, leaf->values + index + 1, values);
+        std::allocator_traits<key_allocator>::construct(keys, leaf->keys + index, std::move(key));
+        std::allocator_traits<value_allocator>::construct(values, leaf->values + index, std::forward<Args>(args)...);
+        leaf->count++;
+        m_size++;
+        return {leaf, index};
+    }
+
+    // Moves the upper half of a full leaf into a new leaf to its right.
+    constexpr auto split_leaf(leaf_node* leaf) -> leaf_node* {
+        auto right = new_leaf();
+        auto middle = leaf->count / 2u;
+        auto keys = key_allocator{m_allocator};
+        auto values = value_allocator{m_allocator};
+        memory::relocate(leaf->keys + middle, leaf->count - middle, right->keys, keys);
+        memory::relocate(leaf->values + middle, leaf->count - middle, right->values, values);
+        right->count = static_cast<std::uint16_t>(leaf->count - middle);
+        leaf->count = static_cast<std::uint16_t>(middle);
+
+        right->prev = leaf;
+        right->next = leaf->next;
+        if (leaf->next != nullptr) {
+            leaf->next->prev = right;
+        } else {
+            m_last = right;
+        }
+        leaf->next = right;
+
+        insert_into_parent(leaf, K{right->keys[0]}, right);
+        return right;
+    }
+
+    // Adds `right` as the sibling after `left`, separated by `separator`, splitting ancestors as needed.
+    constexpr auto insert_into_parent(node_base* left, K&& separator, node_base* right) -> void {
+        auto keys = key_allocator{m_allocator};
+
+        if (left->parent == nullptr) {
+            auto root = new_internal();
+            std::allocator_traits<key_allocator>::construct(keys, root->keys, std::move(separator));
+            root->children[0] = left;
+            root->children[1] = right;
+            root->count = 1;
+            adopt_children(root, 0);
+            m_root = root;
+            return;
+        }
+
+        auto parent = left->parent;
+        size_type index = left->position;
+        if (parent->count < s_internal_capacity) {
+            insert_into_internal(parent, index, std::move(separator), right);
+            return;
+        }
+
+        // the middle key moves up and the keys and children after it move into a new sibling
+        auto sibling = new_internal();
+        auto middle = s_internal_capacity / 2;
+        memory::relocate(parent->keys + middle + 1, s_internal_capacity - middle - 1, sibling->keys, keys);
+        std::copy(parent->children + middle + 1, parent->children + s_internal_capacity + 1, sibling->children);
+        sibling->count = static_cast<std::uint16_t>(s_internal_capacity - middle - 1);
+        parent->count = static_cast<std::uint16_t>(middle);
+        adopt_children(sibling, 0);
+
+        auto promoted = K{std::move(parent->keys[middle])};
+        std::allocator_traits<key_allocator>::destroy(keys, parent->keys + middle);
+
+        if (index > middle) {
+            insert_into_internal(sibling, index - middle - 1, std::move(separator), right);
+        } else {
+            insert_into_internal(parent, index, std::move(separator), right);
+        }
+
+        insert_into_parent(parent, std::move(promoted), sibling);
+    }
+
+    constexpr auto insert_into_internal(internal_node* node, size_type index, K&& separator, node_base* child)
+        -> void {
+        auto keys = key_allocator{m_allocator};
+        memory::relocate_backward(node->keys + index, node->count - index, node->keys + index + 1, keys);
+        std::allocator_traits<key_allocator>::construct(keys, node->keys + index, std::move(separator));
+        std::copy_backward(node->children + index + 1, node->children + node->count + 1,
+                           node->children + node->count + 2);
+        node->children[index + 1] = child;
+        node->count++;
+        adopt_children(node, index + 1);
+    }
+
+    static constexpr auto adopt_children(internal_node* node, size_type from) noexcept -> void {
+        for (auto i = from; i <= node->count; i++) {
+            node->children[i]->parent = node;
+            node->children[i]->position = static_cast<std::uint16_t>(i);
+        }
+    }
+
+    // removal
+
+    constexpr auto erase_at(leaf_node* leaf, size_type index) -> void {
+        auto keys = key_allocator{m_allocator};
+        auto values = value_allocator{m_allocator};
+        std::allocator_traits<key_allocator>::destroy(keys, leaf->keys + index);
+        std::allocator_traits<value_allocator>::destroy(values, leaf->values + index);
+        memory::relocate(leaf->keys + index + 1, leaf->count - index - 1, leaf->keys + index, keys);
+        memory::relocate(leaf->values + index + 1, leaf->count - index - 1, leaf->values + index, values);
+        leaf->count--;
+        m_size--;
+        rebalance(leaf);
+    }
+
+    // Restores the minimum occupancy of `node` by borrowing from or merging with a sibling, which may in turn leave
+    // the parent under-full.
+    constexpr auto rebalance(node_base* node) -> void {
+        if (node == m_root) {
+            if (node->is_leaf && node->count == 0) {
+                deallocate_leaf(static_cast<leaf_node*>(node));
+                m_root = nullptr;
+                m_first = nullptr;
+                m_last = nullptr;
+            } else if (!node->is_leaf && node->count == 0) {
+                auto root = static_cast<internal_node*>(node);
+                m_root = root->children[0];
+                m_root->parent = nullptr;
+                m_root->position = 0;
+                deallocate_internal(root);
+            }
+
+            return;
+        }
+
+        auto minimum = node->is_leaf ? s_leaf_capacity / 2 : s_internal_capacity / 2;
+        if (node->count >= minimum) {
+            return;
+        }
+
+        auto parent = node->parent;
+        size_type index = node->position;
+        auto left = index > 0 ? parent->children[index - 1] : nullptr;
+        auto right = index < parent->count ? parent->children[index + 1] : nullptr;
+
+        if (left != nullptr && left->count > minimum) {
+            if (node->is_leaf) {
+                borrow_from_left(static_cast<leaf_node*>(node), static_cast<leaf_node*>(left), index);
+            } else {
+                borrow_from_left(static_cast<internal_node*>(node), static_cast<internal_node*>(left), index);
+            }
+        } else if (right != nullptr && right->count > minimum) {
+            if (node->is_leaf) {
+                borrow_from_right(static_cast<leaf_node*>(node), static_cast<leaf_node*>(right), index);
+            } else {
+                borrow_from_right(static_cast<internal_node*>(node), static_cast<internal_node*>(right), index);
+            }
+        } else {
+            auto [into, from, separator] = left != nullptr
+                ? std::tuple{left, node, index - 1}
+                : std::tuple{node, right, index};
+            if (node->is_leaf) {
+                merge(static_cast<leaf_node*>(into), static_cast<leaf_node*>(from), separator);
+            } else {
+                merge(static_cast<internal_node*>(into), static_cast<internal_node*>(from), separator);
+            }
+
+            rebalance(parent);
+        }
+    }
+
+    constexpr auto borrow_from_left(leaf_node* node, leaf_node* left, size_type index) -> void {
+        auto keys = key_allocator{m_allocator};
+        auto values = value_allocator{m_allocator};
+        memory::relocate_backward(node->keys, node->count, node->keys + 1, keys);
+        memory::relocate_backward(node->values, node->count, node->values + 1, values);
+        memory::relocate(left->keys + left->count - 1, 1, node->keys, keys);
+        memory::relocate(left->values + left->count - 1, 1, node->values, values);
+        left->count--;
+        node->count++;
+        node->parent->keys[index - 1] = node->keys[0];
+    }
+
+    constexpr auto borrow_from_right(leaf_node* node, leaf_node* right, size_type index) -> void {
+        auto keys = key_allocator{m_allocator};
+        auto values = value_allocator{m_allocator};
+        memory::relocate(right->keys, 1, node->keys + node->count, keys);
+        memory::relocate(right->values, 1, node->values + node->count, values);
+        memory::relocate(right->keys + 1, right->count - 1u, right->keys, keys);
+        memory::relocate(right->values + 1, right->count - 1u, right->values, values);
+        right->count--;
+        node->count++;
+        node->parent->keys[index] = right->keys[0];
+    }
+
+    // Rotates the last child of `left` through the parent into the front of `node`.
+    constexpr auto borrow_from_left(internal_node* node, internal_node* left, size_type index) -> void {
+        auto keys = key_allocator{m_allocator};
+        auto parent = node->parent;
+        memory::relocate_backward(node->keys, node->count, node->keys + 1, keys);
+        memory::relocate(parent->keys + index - 1, 1, node->keys, keys);
+        memory::relocate(left->keys + left->count - 1, 1, parent->keys + index - 1, keys);
+        std::copy_backward(node->children, node->children + node->count + 1, node->children + node->count + 2);
+        node->children[0] = left->children[left->count];
+        left->count--;
+        node->count++;
+        adopt_children(node, 0);
+    }
+
+    // Rotates the first child of `right` through the parent onto the back of `node`.
+    constexpr auto borrow_from_right(internal_node* node, internal_node* right, size_type index) -> void {
+        auto keys = key_allocator{m_allocator};
+        auto parent = node->parent;
+        memory::relocate(parent->keys + index, 1, node->keys + node->count, keys);
+        memory::relocate(right->keys, 1, parent->keys + index, keys);
+        memory::relocate(right->keys + 1, right->count - 1u, right->keys, keys);
+        node->children[node->count + 1] = right->children[0];
+        std::copy(right->children + 1, right->children + right->count + 1, right->children);
+        right->count--;
+        node->count++;
+        adopt_children(node, node->count);
+        adopt_children(right, 0);
+    }
+
+    // Moves everything in `right` into `left` and removes `right` from the parent.
+    constexpr auto merge(leaf_node* left, leaf_node* right, size_type separator) -> void {
+        auto keys = key_allocator{m_allocator};
+        auto values = value_allocator{m_allocator};
+        memory::relocate(right->keys, right->count, left->keys + left->count, keys);
+        memory::relocate(right->values, right->count, left->values + left->count, values);
+        left->count = static_cast<std::uint16_t>(left->count + right->count);
+        right->count = 0;
+
+        left->next = right->next;
+        if (right->next != nullptr) {
+            right->next->prev = left;
+        } else {
+            m_last = left;
+        }
+
+        remove_from_parent(left->parent, separator);
+        deallocate_leaf(right);
+    }
+
+    // Pulls the separator down between the keys of `left` and `right` and removes `right` from the parent.
+    constexpr auto merge(internal_node* left, internal_node* right, size_type separator) -> void {
+        auto keys = key_allocator{m_allocator};
+        auto parent = left->parent;
+        std::allocator_traits<key_allocator>::construct(keys, left->keys + left->count,
+                                                        std::move(parent->keys[separator]));
+        memory::relocate(right->keys, right->count, left->keys + left->count + 1, keys);
+        std::copy(right->children, right->children + right->count + 1, left->children + left->count + 1);
+
+        size_type first_adopted = left->count + 1u;
+        left->count = static_cast<std::uint16_t>(left->count + right->count + 1);
+        right->count = 0;
+        adopt_children(left, first_adopted);
+
+        remove_from_parent(parent, separator);
+        deallocate_internal(right);
+    }
+
+    // Removes `keys[separator]` and the child to its right.
+    constexpr auto remove_from_parent(internal_node* parent, size_type separator) -> void {
+        auto keys = key_allocator{m_allocator};
+        std::allocator_traits<key_allocator>::destroy(keys, parent->keys + separator);
+        memory::relocate(parent->keys + separator + 1, parent->count - separator - 1, parent->keys + separator, keys);
+        std::copy(parent->children + separator + 2, parent->children + parent->count + 1,
+                  parent->children + separator + 1);
+        parent->count--;
+        adopt_children(parent, separator + 1);
+    }
+
+    // bulk loading
+
+    // Fills leaves left to right, then builds each level of internal nodes from the one below, so every node is
+    // written once. All nodes but the last of a level are full, and the last is evened out with its neighbour.
+    template<typename It>
+    constexpr auto bulk_load(It first, It last) -> void {
+        auto keys = key_allocator{m_allocator};
+        auto values = value_allocator{m_allocator};
+        auto level = list<node_base*>{};
+        [[maybe_unused]] const K* previous = nullptr;
+
+        for (auto it = first; it != last; ++it) {
+            if (m_last == nullptr || m_last->count == s_leaf_capacity) {
+                auto leaf = new_leaf();
+                leaf->prev = m_last;
+                if (m_last != nullptr) {
+                    m_last->next = leaf;
+                } else {
+                    m_first = leaf;
+                }
+
+                m_last = leaf;
+                level.add(leaf);
+            }
+
+            std::allocator_traits<key_allocator>::construct(keys, m_last->keys + m_last->count, (*it).first);
+            RTL_ASSERT(previous == nullptr || std::invoke(m_compare, *previous, m_last->keys[m_last->count]),
+                       "The keys passed with sorted_unique are not sorted and unique");
+            previous = m_last->keys + m_last->count;
+            std::allocator_traits<value_allocator>::construct(values, m_last->values + m_last->count, (*it).second);
+            m_last->count++;
+            m_size++;
+        }
+
+        if (level.empty()) {
+            return;
+        }
+
+        if (auto prev = m_last->prev; prev != nullptr && m_last->count < s_leaf_capacity / 2) {
+            auto moved = (prev->count - m_last->count) / 2u;
+            memory::relocate_backward(m_last->keys, m_last->count, m_last->keys + moved, keys);
+            memory::relocate_backward(m_last->values, m_last->count, m_last->values + moved, values);
+            memory::relocate(prev->keys + prev->count - moved, moved, m_last->keys, keys);
+            memory::relocate(prev->values + prev->count - moved, moved, m_last->values, values);
+            prev->count = static_cast<std::uint16_t>(prev->count - moved);
+            m_last->count = static_cast<std::uint16_t>(m_last->count + moved);
+        }
+
+        while (level.size() > 1) {
+            auto parents = list<node_base*>{};
+            auto parent_count = (level.size() + s_internal_capacity) / (s_internal_capacity + 1);
+            parents.reserve(parent_count);
+
+            size_type child = 0;
+            for (size_type i = 0; i < parent_count; i++) {
+                // spread the children evenly so every node is at least half full
+                auto children = level.size() / parent_count + (i < level.size() % parent_count ? 1 : 0);
+                auto node = new_internal();
+                for (size_type j = 0; j < children; j++) {
+                    auto current = level.at_unchecked(child + j);
+                    node->children[j] = current;
+                    if (j > 0) {
+                        std::allocator_traits<key_allocator>::construct(keys, node->keys + j - 1,
+                                                                        smallest_key(current));
+                        node->count++;
+                    }
+                }
+
+                adopt_children(node, 0);
+                parents.add(node);
+                child += children;
+            }
+
+            level = std::move(parents);
+        }
+
+        m_root = level.at_unchecked(0);
+    }
+
+    static constexpr auto smallest_key(const node_base* node) noexcept -> const K& {
+        while (!node->is_leaf) {
+            node = static_cast<const internal_node*>(node)->children[0];
+        }
+
+        return static_cast<const leaf_node*>(node)->keys[0];
+    }
+
+    // node management
+
+    constexpr auto new_leaf() -> leaf_node* {
+        auto allocator = leaf_allocator{m_allocator};
+        auto leaf = std::allocator_traits<leaf_allocator>::allocate(allocator, 1);
+        std::allocator_traits<leaf_allocator>::construct(allocator, leaf);
+        return leaf;
+    }
+
+    constexpr auto new_internal() -> internal_node* {
+        auto allocator = internal_allocator{m_allocator};
+        auto internal = std::allocator_traits<internal_allocator>::allocate(allocator, 1);
+        std::allocator_traits<internal_allocator>::construct(allocator, internal);
+        return internal;
+    }
+
+    // The caller must have destroyed or moved out the node's keys and values.
+    constexpr auto deallocate_leaf(leaf_node* leaf) noexcept -> void {
+        auto allocator = leaf_allocator{m_allocator};
+        std::allocator_traits<leaf_allocator>::destroy(allocator, leaf);
+        std::allocator_traits<leaf_allocator>::deallocate(allocator, leaf, 1);
+    }
+
+    constexpr auto deallocate_internal(internal_node* internal) noexcept -> void {
+        auto allocator = internal_allocator{m_allocator};
+        std::allocator_traits<internal_allocator>::destroy(allocator, internal);
+        std::allocator_traits<internal_allocator>::deallocate(allocator, internal, 1);
+    }
+
+    constexpr auto destroy_subtree(node_base* node) noexcept -> void {
+        auto keys = key_allocator{m_allocator};
+        if (node->is_leaf) {
+            auto leaf = static_cast<leaf_node*>(node);
+            auto values = value_allocator{m_allocator};
+            for (size_type i = 0; i < leaf->count; i++) {
+                std::allocator_traits<key_allocator>::destroy(keys, leaf->keys + i);
+                std::allocator_traits<value_allocator>::destroy(values, leaf->values + i);
+            }
+
+            deallocate_leaf(leaf);
+            return;
+        }
+
+        auto internal = static_cast<internal_node*>(node);
+        for (size_type i = 0; i <= internal->count; i++) {
+            destroy_subtree(internal->children[i]);
+        }
+
+        for (size_type i = 0; i < internal->count; i++) {
+            std::allocator_traits<key_allocator>::destroy(keys, internal->keys + i);
+        }
+
+        deallocate_internal(internal);
+    }
+
+    node_base* m_root{};
+    leaf_node* m_first{};
+    leaf_node* m_last{};
+    size_type m_size{};
+    RTL_NO_UNIQUE_ADDRESS Compare m_compare{};
+    RTL_NO_UNIQUE_ADDRESS Allocator m_allocator{};
+}; // class btree_map
+} // namespace rtl::collections
+
+#endif // #ifndef RTL_BTREE_MAP_HPP
@@ -0,0 +1,251 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_BTREE_SET_HPP
+#define RTL_BTREE_SET_HPP
+
+#include "collections/btree_map.hpp"
+#include "collections/sorted_search.hpp"
+#include "typing/concepts.hpp"
+#include "utilities/option.hpp"
+#include "utilities/reference.hpp"
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <utility>
+
+namespace rtl::collections {
+namespace detail {
+// The mapped type of the `btree_map` underneath a `btree_set`.
+struct btree_no_value {
+
+};
+} // namespace detail
+
+// An ordered set implemented as a B+ tree, see `btree_map`.
+template<typename K, typename Compare = std::less<K>, typing::simple_allocator Allocator = std::allocator<K>>
+requires(std::strict_weak_order<const Compare&, const K&, const K&> && std::copy_constructible<K>)
+class btree_set {
+private:
+    using map_type = btree_map<K, detail::btree_no_value, Compare, Allocator>;
+
+public:
+    using key_type = K;
+    using value_type = K;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    using optional_const_ref = utilities::option<utilities::reference<const K>>;
+
+    // construction
+
+    constexpr btree_set() = default;
+
+    explicit constexpr btree_set(const Compare& compare, const Allocator& allocator = Allocator{})
+        : m_map{compare, allocator} {
+
+    }
+
+    template<typing::legacy_input_iterator It>
+    constexpr btree_set(It first, It last, const Compare& compare = Compare{}, const Allocator& allocator = Allocator{})
+        requires(std::constructible_from<K, decltype(*first)>)
+        : m_map{compare, allocator} {
+        for (auto it = first; it != last; ++it) {
+            insert(*it);
+        }
+    }
+
+    // Builds the tree bottom-up in O(n) from keys that are already sorted and unique.
+    template<typing::legacy_input_iterator It>
+    constexpr btree_set(sorted_unique_t, It first, It last, const Compare& compare = Compare{},
+                        const Allocator& allocator = Allocator{})
+        requires(std::constructible_from<K, decltype(*first)>)
+        : m_map{sorted_map(first, last, compare, allocator)} {
+
+    }
+
+    constexpr btree_set(std::initializer_list<K> ilist, const Compare& compare = Compare{},
+                        const Allocator& allocator = Allocator{})
+        : btree_set{ilist.begin(), ilist.end(), compare, allocator} {
+
+    }
+
+    constexpr auto get_allocator() const noexcept -> allocator_type {
+        return m_map.get_allocator();
+    }
+
+    constexpr auto key_comp() const noexcept -> key_compare {
+        return m_map.key_comp();
+    }
+
+    // access
+
+    constexpr auto find(const K& key) const noexcept -> optional_const_ref {
+        if (auto it = lower_bound(key); it != end() && !std::invoke(m_map.key_comp(), key, *it)) {
+            return *it;
+        }
+
+        return utilities::nullopt;
+    }
+
+    [[nodiscard]] constexpr auto contains(const K& key) const noexcept -> bool {
+        return m_map.contains(key);
+    }
+
+    // iterators
+
+    class const_iterator {
+    private:
+        using map_iterator = typename map_type::const_iterator;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = K;
+        using reference = const K&;
+        using pointer = const K*;
+        using difference_type = std::ptrdiff_t;
+
+        constexpr const_iterator() noexcept = default;
+
+        constexpr const_iterator(map_iterator it) noexcept : m_it{it} {
+
+        }
+
+        constexpr auto operator*() const noexcept -> reference {
+            return (*m_it).first;
+        }
+
+        constexpr auto operator->() const noexcept -> pointer {
+            return std::addressof((*m_it).first);
+        }
+
+        constexpr auto operator++() noexcept -> const_iterator& {
+            ++m_it;
+            return *this;
+        }
+
+        constexpr auto operator++(int) noexcept -> const_iterator {
+            auto temp = *this;
+            ++(*this);
+            return temp;
+        }
+
+        constexpr auto operator--() noexcept -> const_iterator& {
+            --m_it;
+            return *this;
+        }
+
+        constexpr auto operator--(int) noexcept -> const_iterator {
+            auto temp = *this;
+            --(*this);
+            return temp;
+        }
+
+        constexpr friend auto operator==(const const_iterator& a, const const_iterator& b) noexcept -> bool {
+            return a.m_it == b.m_it;
+        }
+
+    private:
+        map_iterator m_it{};
+    }; // class const_iterator
+
+    using iterator = const_iterator;
+
+    constexpr auto begin() const noexcept -> const_iterator {
+        return m_map.begin();
+    }
+
+    constexpr auto cbegin() const noexcept -> const_iterator {
+        return m_map.cbegin();
+    }
+
+    constexpr auto end() const noexcept -> const_iterator {
+        return m_map.end();
+    }
+
+    constexpr auto cend() const noexcept -> const_iterator {
+        return m_map.cend();
+    }
+
+    // The first key that is not less than `key`.
+    constexpr auto lower_bound(const K& key) const noexcept -> const_iterator {
+        return m_map.lower_bound(key);
+    }
+
+    // The first key that is greater than `key`.
+    constexpr auto upper_bound(const K& key) const noexcept -> const_iterator {
+        return m_map.upper_bound(key);
+    }
+
+    // The keys that are not less than `first` and less than `last`.
+    constexpr auto range(const K& first, const K& last) const noexcept -> std::ranges::subrange<const_iterator> {
+        return {lower_bound(first), lower_bound(last)};
+    }
+
+    // capacity/size queries
+
+    [[nodiscard]] constexpr auto empty() const noexcept -> bool {
+        return m_map.empty();
+    }
+
+    [[nodiscard]] constexpr auto size() const noexcept -> size_type {
+        return m_map.size();
+    }
+
+    // modification
+
+    // Inserts `key` unless an equivalent key is already present. Returns whether the key was inserted.
+    constexpr auto insert(K key) -> bool {
+        return m_map.insert(std::move(key), detail::btree_no_value{});
+    }
+
+    // Removes the key equivalent to `key`. Returns whether there was one.
+    constexpr auto remove(const K& key) -> bool {
+        return m_map.remove(key).has_value();
+    }
+
+    constexpr auto clear() noexcept -> void {
+        m_map.clear();
+    }
+
+private:
+    // Pairs every key with an empty value and builds the map from them bottom-up.
+    template<typename It>
+    static constexpr auto sorted_map(It first, It last, const Compare& compare, const Allocator& allocator)
+        -> map_type {
+        auto entries = std::ranges::subrange{first, last} | std::views::transform([](const auto& key) {
+            return std::pair<const K&, detail::btree_no_value>{key, {}};
+        });
+
+        return map_type{sorted_unique, entries.begin(), entries.end(), compare, allocator};
+    }
+
+    map_type m_map{};
+}; // class btree_set
+} // namespace rtl::collections
+
+#endif // #ifndef RTL_BTREE_SET_HPP
@@ -0,0 +1,409 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_FLAT_MAP_HPP
+#define RTL_FLAT_MAP_HPP
+
+#include "collections/list.hpp"
+#include "collections/sorted_search.hpp"
+#include "typing/concepts.hpp"
+#include "utilities/assertions.hpp"
+#include "utilities/attributes.hpp"
+#include "utilities/option.hpp"
+#include "utilities/reference.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace rtl::collections {
+// A map that keeps its keys sorted in one `list` and the values in another at the same indices. Searching only touches
+// the keys, so lookups are branch-free binary searches over densely packed memory and the values are only read once
+// the key is found. Insertion and removal shift the following entries and are O(n), so this is best suited to tables
+// that are built once, ideally in bulk, and read many times.
+template<
+    typename K,
+    typename V,
+    typename Compare = std::less<K>,
+    typing::simple_allocator KeyAllocator = std::allocator<K>,
+    typing::simple_allocator ValueAllocator = std::allocator<V>
+>
+requires(std::strict_weak_order<const Compare&, const K&, const K&>)
+class flat_map {
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using key_compare = Compare;
+    using key_container_type = list<K, KeyAllocator>;
+    using mapped_container_type = list<V, ValueAllocator>;
+
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    using optional_ref = utilities::option<utilities::reference<V>>;
+    using optional_const_ref = utilities::option<utilities::reference<const V>>;
+
+    // construction
+
+    constexpr flat_map() = default;
+
+    explicit constexpr flat_map(const Compare& compare, const KeyAllocator& key_allocator = KeyAllocator{},
+                                const ValueAllocator& value_allocator = ValueAllocator{})
+        : m_keys{key_allocator}
+        , m_values{value_allocator}
+        , m_compare{compare} {
+
+    }
+
+    // Builds the map from unsorted key/value pairs, sorting and removing duplicates once at the end. When a key
+    // appears more than once, the first value wins.
+    template<typing::legacy_input_iterator It>
+    constexpr flat_map(It first, It last, const Compare& compare = Compare{})
+        requires(std::constructible_from<K, decltype((*first).first)>
+                 && std::constructible_from<V, decltype((*first).second)>)
+        : m_compare{compare} {
+        for (auto it = first; it != last; ++it) {
+            m_keys.add((*it).first);
+            m_values.add((*it).second);
+        }
+
+        sort_and_deduplicate();
+    }
+
+    constexpr flat_map(std::initializer_list<std::pair<K, V>> ilist, const Compare& compare = Compare{})
+        requires(std::constructible_from<K, const K&> && std::constructible_from<V, const V&>)
+        : flat_map{ilist.begin(), ilist.end(), compare} {
+
+    }
+
+    // Builds the map from unsorted keys and the values at the same indices.
+    constexpr flat_map(key_container_type keys, mapped_container_type values, const Compare& compare = Compare{})
+        : m_keys{std::move(keys)}
+        , m_values{std::move(values)}
+        , m_compare{compare} {
+        sort_and_deduplicate();
+    }
+
+    // Adopts `keys` and `values` as they are, the keys must already be sorted and unique.
+    constexpr flat_map(sorted_unique_t, key_container_type keys, mapped_container_type values,
+                       const Compare& compare = Compare{}) noexcept
+        : m_keys{std::move(keys)}
+        , m_values{std::move(values)}
+        , m_compare{compare} {
+        RTL_ASSERT(m_keys.size() == m_values.size(), "There must be as many values as keys");
+        RTL_ASSERT(std::ranges::adjacent_find(m_keys, std::not_fn(m_compare)) == m_keys.end(),
+                   "The keys passed with sorted_unique are not sorted and unique");
+    }
+
+    // access
+
+    constexpr auto operator[](const K& key) const noexcept -> optional_const_ref {
+        return find(key);
+    }
+
+    constexpr auto operator[](const K& key) noexcept -> optional_ref {
+        return find(key);
+    }
+
+    constexpr auto find(const K& key) const noexcept -> optional_const_ref {
+        if (auto index = find_index(key)) {
+            return m_values.at_unchecked(*index);
+        }
+
+        return utilities::nullopt;
+    }
+
+    constexpr auto find(const K& key) noexcept -> optional_ref {
+        if (auto index = find_index(key)) {
+            return m_values.at_unchecked(*index);
+        }
+
+        return utilities::nullopt;
+    }
+
+    [[nodiscard]] constexpr auto contains(const K& key) const noexcept -> bool {
+        return find_index(key).has_value();
+    }
+
+    // The sorted keys.
+    constexpr auto keys() const noexcept -> const key_container_type& {
+        return m_keys;
+    }
+
+    // The values, in the same order as the keys.
+    constexpr auto values() const noexcept -> const mapped_container_type& {
+        return m_values;
+    }
+
+    // iterators
+
+    template<bool IsConst>
+    class raw_iterator {
+    private:
+        using value_pointer = std::conditional_t<IsConst, const V*, V*>;
+        using mapped_reference = std::conditional_t<IsConst, const V&, V&>;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = std::pair<const K, V>;
+        using reference = std::pair<const K&, mapped_reference>;
+        using difference_type = std::ptrdiff_t;
+
+        struct pointer {
+            reference entry;
+
+            constexpr auto operator->() const noexcept -> const reference* {
+                return std::addressof(entry);
+            }
+        };
+
+        constexpr raw_iterator() noexcept = default;
+
+        constexpr raw_iterator(const K* key, value_pointer value) noexcept
+            : m_key{key}
+            , m_value{value} {
+
+        }
+
+        constexpr auto operator*() const noexcept -> reference {
+            return {*m_key, *m_value};
+        }
+
+        constexpr auto operator->() const noexcept -> pointer {
+            return pointer{**this};
+        }
+
+        constexpr auto operator++() noexcept -> raw_iterator& {
+            ++m_key;
+            ++m_value;
+            return *this;
+        }
+
+        constexpr auto operator++(int) noexcept -> raw_iterator {
+            auto temp = *this;
+            ++(*this);
+            return temp;
+        }
+
+        constexpr auto operator--() noexcept -> raw_iterator& {
+            --m_key;
+            --m_value;
+            return *this;
+        }
+
+        constexpr auto operator--(int) noexcept -> raw_iterator {
+            auto temp = *this;
+            --(*this);
+            return temp;
+        }
+
+        constexpr friend auto operator==(const raw_iterator& a, const raw_iterator& b) noexcept -> bool {
+            return a.m_key == b.m_key;
+        }
+
+    private:
+        const K* m_key{};
+        value_pointer m_value{};
+    }; // class raw_iterator
+
+    using iterator = raw_iterator<false>;
+    using const_iterator = raw_iterator<true>;
+
+    constexpr auto begin() noexcept -> iterator {
+        return iterator_at(0);
+    }
+
+    constexpr auto begin() const noexcept -> const_iterator {
+        return iterator_at(0);
+    }
+
+    constexpr auto cbegin() const noexcept -> const_iterator {
+        return begin();
+    }
+
+    constexpr auto end() noexcept -> iterator {
+        return iterator_at(size());
+    }
+
+    constexpr auto end() const noexcept -> const_iterator {
+        return iterator_at(size());
+    }
+
+    constexpr auto cend() const noexcept -> const_iterator {
+        return end();
+    }
+
+    // The first entry whose key is not less than `key`.
+    constexpr auto lower_bound(const K& key) noexcept -> iterator {
+        return iterator_at(lower_bound_index(key));
+    }
+
+    constexpr auto lower_bound(const K& key) const noexcept -> const_iterator {
+        return iterator_at(lower_bound_index(key));
+    }
+
+    // The first entry whose key is greater than `key`.
+    constexpr auto upper_bound(const K& key) noexcept -> iterator {
+        return iterator_at(upper_bound_index(key));
+    }
+
+    constexpr auto upper_bound(const K& key) const noexcept -> const_iterator {
+        return iterator_at(upper_bound_index(key));
+    }
+
+    // capacity/size queries
+
+    [[nodiscard]] constexpr auto empty() const noexcept -> bool {
+        return m_keys.empty();
+    }
+
+    [[nodiscard]] constexpr auto size() const noexcept -> size_type {
+        return m_keys.size();
+    }
+
+    constexpr auto reserve(size_type capacity) -> void {
+        m_keys.reserve(capacity);
+        m_values.reserve(capacity);
+    }
+
+    constexpr auto shrink_to_fit() -> void {
+        m_keys.shrink_to_fit();
+        m_values.shrink_to_fit();
+    }
+
+    // modification
+
+    // Inserts `value` under `key` unless the key is already present. Returns whether the entry was inserted.
+    constexpr auto insert(K key, V value) -> bool {
+        auto index = lower_bound_index(key);
+        if (is_match(index, key)) {
+            return false;
+        }
+
+        m_keys.insert(index, std::move(key));
+        m_values.insert(index, std::move(value));
+        return true;
+    }
+
+    // Inserts `value` under `key`, replacing the existing value if the key is already present.
+    constexpr auto insert_or_assign(K key, V value) -> V& {
+        auto index = lower_bound_index(key);
+        if (is_match(index, key)) {
+            return m_values.at_unchecked(index) = std::move(value);
+        }
+
+        m_keys.insert(index, std::move(key));
+        m_values.insert(index, std::move(value));
+        return m_values.at_unchecked(index);
+    }
+
+    // Returns the value under `key`, constructing it from `args` first if the key is not present.
+    template<typename... Args> requires(std::constructible_from<V, Args...>)
+    constexpr auto find_or_insert(K key, Args&&... args) -> V& {
+        auto index = lower_bound_index(key);
+        if (!is_match(index, key)) {
+            m_keys.insert(index, std::move(key));
+            m_values.insert(index, std::forward<Args>(args)...);
+        }
+
+        return m_values.at_unchecked(index);
+    }
+
+    // Removes the entry under `key` and returns its value, if there was one.
+    constexpr auto remove(const K& key) -> utilities::flagged_option<V> {
+        auto index = lower_bound_index(key);
+        if (!is_match(index, key)) {
+            return utilities::nullopt;
+        }
+
+        m_keys.remove(index);
+        return m_values.remove(index);
+    }
+
+    constexpr auto clear() noexcept -> void {
+        m_keys.clear();
+        m_values.clear();
+    }
+
+private:
+    constexpr auto iterator_at(size_type index) noexcept -> iterator {
+        return {m_keys.data() + index, m_values.data() + index};
+    }
+
+    constexpr auto iterator_at(size_type index) const noexcept -> const_iterator {
+        return {m_keys.data() + index, m_values.data() + index};
+    }
+
+    constexpr auto lower_bound_index(const K& key) const noexcept -> size_type {
+        return detail::branchless_lower_bound(m_keys.data(), m_keys.size(), key, m_compare);
+    }
+
+    constexpr auto upper_bound_index(const K& key) const noexcept -> size_type {
+        return detail::branchless_upper_bound(m_keys.data(), m_keys.size(), key, m_compare);
+    }
+
+    constexpr auto is_match(size_type index, const K& key) const noexcept -> bool {
+        return index != m_keys.size() && !std::invoke(m_compare, key, m_keys.at_unchecked(index));
+    }
+
+    constexpr auto find_index(const K& key) const noexcept -> utilities::option<size_type> {
+        if (auto index = lower_bound_index(key); is_match(index, key)) {
+            return index;
+        }
+
+        return utilities::nullopt;
+    }
+
+    // Sorts the entries as pairs, a stable sort keeps the first of any duplicate keys.
+    constexpr auto sort_and_deduplicate() -> void {
+        RTL_ASSERT(m_keys.size() == m_values.size(), "There must be as many values as keys");
+
+        using entry_allocator = typename std::allocator_traits<KeyAllocator>::template rebind_alloc<std::pair<K, V>>;
+
+        auto entries = list<std::pair<K, V>, entry_allocator>{entry_allocator{m_keys.get_allocator()}};
+        entries.reserve(m_keys.size());
+        for (size_type i = 0; i < m_keys.size(); i++) {
+            entries.add(std::move(m_keys.at_unchecked(i)), std::move(m_values.at_unchecked(i)));
+        }
+
+        std::ranges::stable_sort(entries, m_compare, &std::pair<K, V>::first);
+
+        m_keys.clear();
+        m_values.clear();
+        for (auto& [key, value] : entries) {
+            if (m_keys.empty() || std::invoke(m_compare, m_keys.back_unchecked(), key)) {
+                m_keys.add(std::move(key));
+                m_values.add(std::move(value));
+            }
+        }
+    }
+
+    key_container_type m_keys{};
+    mapped_container_type m_values{};
+    RTL_NO_UNIQUE_ADDRESS Compare m_compare{};
+}; // class flat_map
+} // namespace rtl::collections
+
+#endif // #ifndef RTL_FLAT_MAP_HPP
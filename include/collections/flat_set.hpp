@@ -0,0 +1,222 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_FLAT_SET_HPP
+#define RTL_FLAT_SET_HPP
+
+#include "collections/list.hpp"
+#include "collections/sorted_search.hpp"
+#include "typing/concepts.hpp"
+#include "utilities/assertions.hpp"
+#include "utilities/attributes.hpp"
+#include "utilities/option.hpp"
+#include "utilities/reference.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+
+namespace rtl::collections {
+// A set that keeps its keys sorted in a single `list`. Lookups are branch-free binary searches over contiguous memory,
+// which makes it a good fit for tables that are built once and read many times. Insertion and removal shift the
+// following keys and are O(n).
+template<typename K, typename Compare = std::less<K>, typing::simple_allocator Allocator = std::allocator<K>>
+requires(std::strict_weak_order<const Compare&, const K&, const K&>)
+class flat_set {
+public:
+    using key_type = K;
+    using value_type = K;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+    using container_type = list<K, Allocator>;
+
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    using iterator = typename container_type::const_iterator;
+    using const_iterator = typename container_type::const_iterator;
+
+    using optional_const_ref = utilities::option<utilities::reference<const K>>;
+
+    // construction
+
+    constexpr flat_set() noexcept(noexcept(Allocator{}) && noexcept(Compare{})) = default;
+
+    explicit constexpr flat_set(const Compare& compare, const Allocator& allocator = Allocator{})
+        : m_keys{allocator}
+        , m_compare{compare} {
+
+    }
+
+    // Builds the set from unsorted input, sorting and removing duplicates once at the end.
+    template<typing::legacy_input_iterator It>
+    constexpr flat_set(It first, It last, const Compare& compare = Compare{}, const Allocator& allocator = Allocator{})
+        requires(std::constructible_from<K, decltype(*first)>)
+        : m_keys{first, last, allocator}
+        , m_compare{compare} {
+        sort_and_deduplicate();
+    }
+
+    constexpr flat_set(std::initializer_list<K> ilist, const Compare& compare = Compare{},
+                       const Allocator& allocator = Allocator{})
+        requires(std::constructible_from<K, const K&>)
+        : m_keys{ilist, allocator}
+        , m_compare{compare} {
+        sort_and_deduplicate();
+    }
+
+    explicit constexpr flat_set(container_type keys, const Compare& compare = Compare{})
+        : m_keys{std::move(keys)}
+        , m_compare{compare} {
+        sort_and_deduplicate();
+    }
+
+    // Adopts `keys` as they are, they must already be sorted and unique.
+    constexpr flat_set(sorted_unique_t, container_type keys, const Compare& compare = Compare{}) noexcept
+        : m_keys{std::move(keys)}
+        , m_compare{compare} {
+        RTL_ASSERT(std::ranges::adjacent_find(m_keys, std::not_fn(m_compare)) == m_keys.end(),
+                   "The keys passed with sorted_unique are not sorted and unique");
+    }
+
+    constexpr auto get_allocator() const noexcept(noexcept(allocator_type{m_keys.get_allocator()})) {
+        return m_keys.get_allocator();
+    }
+
+    // access
+
+    constexpr auto find(const K& key) const noexcept -> optional_const_ref {
+        auto index = lower_bound_index(key);
+        if (index != m_keys.size() && !std::invoke(m_compare, key, m_keys.at_unchecked(index))) {
+            return m_keys.at_unchecked(index);
+        }
+
+        return utilities::nullopt;
+    }
+
+    [[nodiscard]] constexpr auto contains(const K& key) const noexcept -> bool {
+        return find(key).has_value();
+    }
+
+    // The first key that is not less than `key`.
+    constexpr auto lower_bound(const K& key) const noexcept -> const_iterator {
+        return m_keys.begin() + static_cast<difference_type>(lower_bound_index(key));
+    }
+
+    // The first key that is greater than `key`.
+    constexpr auto upper_bound(const K& key) const noexcept -> const_iterator {
+        return m_keys.begin() + static_cast<difference_type>(
+            detail::branchless_upper_bound(m_keys.data(), m_keys.size(), key, m_compare));
+    }
+
+    // The sorted keys.
+    constexpr auto keys() const noexcept -> const container_type& {
+        return m_keys;
+    }
+
+    // iterators
+
+    constexpr auto begin() const noexcept -> const_iterator {
+        return m_keys.begin();
+    }
+
+    constexpr auto cbegin() const noexcept -> const_iterator {
+        return m_keys.cbegin();
+    }
+
+    constexpr auto end() const noexcept -> const_iterator {
+        return m_keys.end();
+    }
+
+    constexpr auto cend() const noexcept -> const_iterator {
+        return m_keys.cend();
+    }
+
+    // capacity/size queries
+
+    [[nodiscard]] constexpr auto empty() const noexcept -> bool {
+        return m_keys.empty();
+    }
+
+    [[nodiscard]] constexpr auto size() const noexcept -> size_type {
+        return m_keys.size();
+    }
+
+    [[nodiscard]] constexpr auto capacity() const noexcept -> size_type {
+        return m_keys.capacity();
+    }
+
+    constexpr auto reserve(size_type capacity) -> void {
+        m_keys.reserve(capacity);
+    }
+
+    constexpr auto shrink_to_fit() -> void {
+        m_keys.shrink_to_fit();
+    }
+
+    // modification
+
+    // Inserts `key` unless an equivalent key is already present. Returns whether the key was inserted.
+    constexpr auto insert(K key) -> bool {
+        auto index = lower_bound_index(key);
+        if (index != m_keys.size() && !std::invoke(m_compare, key, m_keys.at_unchecked(index))) {
+            return false;
+        }
+
+        m_keys.insert(index, std::move(key));
+        return true;
+    }
+
+    // Removes the key equivalent to `key`. Returns whether there was one.
+    constexpr auto remove(const K& key) -> bool {
+        auto index = lower_bound_index(key);
+        if (index == m_keys.size() || std::invoke(m_compare, key, m_keys.at_unchecked(index))) {
+            return false;
+        }
+
+        m_keys.remove(index);
+        return true;
+    }
+
+    constexpr auto clear() noexcept -> void {
+        m_keys.clear();
+    }
+
+private:
+    constexpr auto lower_bound_index(const K& key) const noexcept -> size_type {
+        return detail::branchless_lower_bound(m_keys.data(), m_keys.size(), key, m_compare);
+    }
+
+    constexpr auto sort_and_deduplicate() -> void {
+        std::ranges::sort(m_keys, m_compare);
+        // the keys are sorted, so neighbours are equivalent exactly when the first is not less than the second
+        auto duplicates = std::ranges::unique(m_keys, std::not_fn(m_compare));
+        m_keys.truncate(m_keys.size() - duplicates.size());
+    }
+
+    container_type m_keys{};
+    RTL_NO_UNIQUE_ADDRESS Compare m_compare{};
+}; // class flat_set
+} // namespace rtl::collections
+
+#endif // #ifndef RTL_FLAT_SET_HPP
@@ -0,0 +1,34 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_GROWTH_HPP
+#define RTL_GROWTH_HPP
+
+#include <algorithm>
+#include <cstddef>
+
+namespace rtl::collections::detail {
+// The capacity a contiguous container grows to when `required` elements no longer fit in `capacity`. Doubling keeps
+// appending amortised constant time, shared by the containers so they all grow the same way.
+constexpr auto grown_capacity(std::size_t capacity, std::size_t required) noexcept -> std::size_t {
+    return std::max(capacity == 0 ? 1 : capacity * 2, required);
+}
+} // namespace rtl::collections::detail
+
+#endif // #ifndef RTL_GROWTH_HPP
@@ -0,0 +1,632 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_HASH_MAP_HPP
+#define RTL_HASH_MAP_HPP
+
+#include "memory/relocate.hpp"
+#include "typing/concepts.hpp"
+#include "utilities/attributes.hpp"
+#include "utilities/option.hpp"
+#include "utilities/reference.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RTL_HASH_MAP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace rtl::collections {
+namespace detail {
+// Each slot has a control byte. Full slots store the low 7 bits of the hash, so the top bit tells empty and deleted
+// slots apart from full ones and a whole group of control bytes can be matched against a hash at once.
+using control_byte = std::int8_t;
+
+inline constexpr control_byte control_empty = -128;
+inline constexpr control_byte control_deleted = -2;
+
+// A group of control bytes that is probed as a unit. Matches are returned as a bitmask with bit `i` set when the
+// byte at index `i` matched.
+struct control_group {
+    static constexpr std::size_t width = 16;
+
+#ifdef RTL_HASH_MAP_SSE2
+    explicit control_group(const control_byte* bytes) noexcept
+        : m_bytes{_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes))} {
+
+    }
+
+    [[nodiscard]] auto match(control_byte h2) const noexcept -> std::uint32_t {
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(m_bytes, _mm_set1_epi8(h2))));
+    }
+
+    [[nodiscard]] auto match_empty() const noexcept -> std::uint32_t {
+        return match(control_empty);
+    }
+
+    // Empty and deleted are the only negative values other than -1, which is never stored.
+    [[nodiscard]] auto match_empty_or_deleted() const noexcept -> std::uint32_t {
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), m_bytes)));
+    }
+
+private:
+    __m128i m_bytes;
+#else
+    explicit control_group(const control_byte* bytes) noexcept {
+        std::memcpy(m_bytes, bytes, width);
+    }
+
+    [[nodiscard]] auto match(control_byte h2) const noexcept -> std::uint32_t {
+        std::uint32_t mask = 0;
+        for (std::size_t i = 0; i < width; i++) {
+            mask |= static_cast<std::uint32_t>(m_bytes[i] == h2) << i;
+        }
+
+        return mask;
+    }
+
+    [[nodiscard]] auto match_empty() const noexcept -> std::uint32_t {
+        return match(control_empty);
+    }
+
+    [[nodiscard]] auto match_empty_or_deleted() const noexcept -> std::uint32_t {
+        std::uint32_t mask = 0;
+        for (std::size_t i = 0; i < width; i++) {
+            mask |= static_cast<std::uint32_t>(m_bytes[i] < -1) << i;
+        }
+
+        return mask;
+    }
+
+private:
+    control_byte m_bytes[width];
+#endif
+}; // struct control_group
+
+// Spreads the entropy of the hash over all of its bits, `std::hash` is the identity for integers on most platforms.
+constexpr auto mix_hash(std::uint64_t hash) noexcept -> std::uint64_t {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+} // namespace detail
+
+// An open addressing hash map in the style of Swiss tables. Entries live in one flat array next to an array of control
+// bytes, and lookups compare a group of 16 control bytes against the hash with a single SIMD comparison when SSE2 is
+// available. The maximum load factor is 7/8.
+//
+// There is deliberately no AVX2 path. One SSE2 comparison already covers a whole group, and most lookups finish in the
+// first group, so a wider group would not save a probe. Dispatching to it at runtime would also prevent the probe loop
+// from being inlined, which costs more than the wider comparison could save.
+template<
+    typename K,
+    typename V,
+    typename Hash = std::hash<K>,
+    typename Eq = std::equal_to<K>,
+    typing::simple_allocator Allocator = std::allocator<std::pair<K, V>>
+>
+requires(std::invocable<const Hash&, const K&> && std::predicate<const Eq&, const K&, const K&>)
+class hash_map {
+private:
+    using slot_type = std::pair<K, V>;
+    using slot_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<slot_type>;
+    using slot_traits = std::allocator_traits<slot_allocator>;
+    using control_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<detail::control_byte>;
+    using control_traits = std::allocator_traits<control_allocator>;
+
+    static constexpr std::size_t s_group_width = detail::control_group::width;
+
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using hasher = Hash;
+    using key_equal = Eq;
+    using allocator_type = Allocator;
+
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    using optional_ref = utilities::option<utilities::reference<V>>;
+    using optional_const_ref = utilities::option<utilities::reference<const V>>;
+
+    // construction
+
+    constexpr hash_map() noexcept(noexcept(Allocator{})) = default;
+
+    explicit hash_map(const Allocator& allocator) noexcept(noexcept(Allocator{allocator}))
+        : m_allocator{allocator} {
+
+    }
+
+    explicit hash_map(size_type capacity, const Hash& hash = Hash{}, const Eq& eq = Eq{},
+                      const Allocator& allocator = Allocator{})
+        : m_hash{hash}
+        , m_eq{eq}
+        , m_allocator{allocator} {
+        reserve(capacity);
+    }
+
+    hash_map(const hash_map& other)
+        requires(std::is_copy_constructible_v<K> && std::is_copy_constructible_v<V>)
+        : m_hash{other.m_hash}
+        , m_eq{other.m_eq}
+        , m_allocator{std::allocator_traits<Allocator>::select_on_container_copy_construction(other.m_allocator)} {
+        reserve(other.m_size);
+        for (auto [key, value] : other) {
+            insert(key, value);
+        }
+    }
+
+    hash_map(hash_map&& other) noexcept
+        : m_control{std::exchange(other.m_control, nullptr)}
+        , m_slots{std::exchange(other.m_slots, nullptr)}
+        , m_capacity{std::exchange(other.m_capacity, 0)}
+        , m_size{std::exchange(other.m_size, 0)}
+        , m_growth_left{std::exchange(other.m_growth_left, 0)}
+        , m_hash{std::move(other.m_hash)}
+        , m_eq{std::move(other.m_eq)}
+        , m_allocator{std::move(other.m_allocator)} {
+
+    }
+
+    ~hash_map() noexcept {
+        destroy();
+    }
+
+    auto operator=(const hash_map& other) -> hash_map&
+        requires(std::is_copy_constructible_v<K> && std::is_copy_constructible_v<V>) {
+        if (this == &other) {
+            return *this;
+        }
+
+        clear();
+        reserve(other.m_size);
+        for (auto [key, value] : other) {
+            insert(key, value);
+        }
+
+        return *this;
+    }
+
+    auto operator=(hash_map&& other) noexcept -> hash_map& {
+        if (this == &other) {
+            return *this;
+        }
+
+        destroy();
+        m_control = std::exchange(other.m_control, nullptr);
+        m_slots = std::exchange(other.m_slots, nullptr);
+        m_capacity = std::exchange(other.m_capacity, 0);
+        m_size = std::exchange(other.m_size, 0);
+        m_growth_left = std::exchange(other.m_growth_left, 0);
+        m_hash = std::move(other.m_hash);
+        m_eq = std::move(other.m_eq);
+        m_allocator = std::move(other.m_allocator);
+        return *this;
+    }
+
+    auto get_allocator() const noexcept(noexcept(allocator_type{m_allocator})) -> allocator_type {
+        return allocator_type{m_allocator};
+    }
+
+    // access
+
+    auto operator[](const K& key) const noexcept -> optional_const_ref {
+        return find(key);
+    }
+
+    auto operator[](const K& key) noexcept -> optional_ref {
+        return find(key);
+    }
+
+    auto find(const K& key) const noexcept -> optional_const_ref {
+        if (auto index = find_index(key, hash_of(key))) {
+            return m_slots[*index].second;
+        }
+
+        return utilities::nullopt;
+    }
+
+    auto find(const K& key) noexcept -> optional_ref {
+        if (auto index = find_index(key, hash_of(key))) {
+            return m_slots[*index].second;
+        }
+
+        return utilities::nullopt;
+    }
+
+    [[nodiscard]] auto contains(const K& key) const noexcept -> bool {
+        return find_index(key, hash_of(key)).has_value();
+    }
+
+    // iterators
+
+    template<bool IsConst>
+    class raw_iterator {
+    private:
+        using slot_pointer = std::conditional_t<IsConst, const slot_type*, slot_type*>;
+        using mapped_reference = std::conditional_t<IsConst, const V&, V&>;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<const K, V>;
+        using reference = std::pair<const K&, mapped_reference>;
+        using difference_type = std::ptrdiff_t;
+
+        struct pointer {
+            reference entry;
+
+            constexpr auto operator->() const noexcept -> const reference* {
+                return std::addressof(entry);
+            }
+        };
+
+        constexpr raw_iterator() noexcept = default;
+
+        constexpr raw_iterator(const detail::control_byte* control, slot_pointer slot,
+                               const detail::control_byte* end) noexcept
+            : m_control{control}
+            , m_slot{slot}
+            , m_end{end} {
+            skip_empty();
+        }
+
+        constexpr auto operator*() const noexcept -> reference {
+            return {m_slot->first, m_slot->second};
+        }
+
+        constexpr auto operator->() const noexcept -> pointer {
+            return pointer{**this};
+        }
+
+        constexpr auto operator++() noexcept -> raw_iterator& {
+            ++m_control;
+            ++m_slot;
+            skip_empty();
+            return *this;
+        }
+
+        constexpr auto operator++(int) noexcept -> raw_iterator {
+            auto temp = *this;
+            ++(*this);
+            return temp;
+        }
+
+        constexpr friend auto operator==(const raw_iterator& a, const raw_iterator& b) noexcept -> bool {
+            return a.m_control == b.m_control;
+        }
+
+    private:
+        constexpr auto skip_empty() noexcept -> void {
+            while (m_control != m_end && *m_control < 0) {
+                ++m_control;
+                ++m_slot;
+            }
+        }
+
+        const detail::control_byte* m_control{};
+        slot_pointer m_slot{};
+        const detail::control_byte* m_end{};
+    }; // class raw_iterator
+
+    using iterator = raw_iterator<false>;
+    using const_iterator = raw_iterator<true>;
+
+    auto begin() noexcept -> iterator {
+        return {m_control, m_slots, m_control + m_capacity};
+    }
+
+    auto begin() const noexcept -> const_iterator {
+        return {m_control, m_slots, m_control + m_capacity};
+    }
+
+    auto cbegin() const noexcept -> const_iterator {
+        return begin();
+    }
+
+    auto end() noexcept -> iterator {
+        return {m_control + m_capacity, m_slots + m_capacity, m_control + m_capacity};
+    }
+
+    auto end() const noexcept -> const_iterator {
+        return {m_control + m_capacity, m_slots + m_capacity, m_control + m_capacity};
+    }
+
+    auto cend() const noexcept -> const_iterator {
+        return end();
+    }
+
+    // capacity/size queries
+
+    [[nodiscard]] auto empty() const noexcept -> bool {
+        return m_size == 0;
+    }
+
+    [[nodiscard]] auto size() const noexcept -> size_type {
+        return m_size;
+    }
+
+    // The number of slots, of which at most 7/8 are used before the map grows.
+    [[nodiscard]] auto capacity() const noexcept -> size_type {
+        return m_capacity;
+    }
+
+    // Makes room for at least `count` entries without growing.
+    auto reserve(size_type count) -> void {
+        auto capacity = capacity_for(count);
+        if (capacity > m_capacity) {
+            rehash(capacity);
+        }
+    }
+
+    // modification
+
+    // Inserts `value` under `key` unless the key is already present. Returns whether the entry was inserted.
+    auto insert(K key, V value) -> bool {
+        auto hash = hash_of(key);
+        if (find_index(key, hash)) {
+            return false;
+        }
+
+        emplace_new(hash, std::move(key), std::move(value));
+        return true;
+    }
+
+    // Inserts `value` under `key`, replacing the existing value if the key is already present.
+    auto insert_or_assign(K key, V value) -> V& {
+        auto hash = hash_of(key);
+        if (auto index = find_index(key, hash)) {
+            m_slots[*index].second = std::move(value);
+            return m_slots[*index].second;
+        }
+
+        auto index = emplace_new(hash, std::move(key), std::move(value));
+        return m_slots[index].second;
+    }
+
+    // Returns the value under `key`, constructing it from `args` first if the key is not present.
+    template<typename... Args> requires(std::constructible_from<V, Args...>)
+    auto find_or_insert(K key, Args&&... args) -> V& {
+        auto hash = hash_of(key);
+        if (auto index = find_index(key, hash)) {
+            return m_slots[*index].second;
+        }
+
+        auto index = emplace_new(hash, std::move(key), std::forward<Args>(args)...);
+        return m_slots[index].second;
+    }
+
+    // Removes the entry under `key` and returns its value, if there was one.
+    auto remove(const K& key) -> utilities::flagged_option<V> {
+        auto index = find_index(key, hash_of(key));
+        if (!index) {
+            return utilities::nullopt;
+        }
+
+        auto value = utilities::flagged_option<V>{std::move(m_slots[*index].second)};
+        erase_at(*index);
+        return value;
+    }
+
+    auto clear() noexcept -> void {
+        if (m_capacity == 0) {
+            return;
+        }
+
+        destroy_slots();
+        std::memset(m_control, detail::control_empty, m_capacity);
+        m_size = 0;
+        m_growth_left = max_load(m_capacity);
+    }
+
+private:
+    static constexpr auto max_load(size_type capacity) noexcept -> size_type {
+        return capacity - capacity / 8;
+    }
+
+    static constexpr auto capacity_for(size_type count) noexcept -> size_type {
+        if (count == 0) {
+            return 0;
+        }
+
+        auto capacity = std::bit_ceil(std::max(count + count / 7 + 1, s_group_width));
+        return max_load(capacity) < count ? capacity * 2 : capacity;
+    }
+
+    auto hash_of(const K& key) const noexcept -> std::uint64_t {
+        return detail::mix_hash(static_cast<std::uint64_t>(std::invoke(m_hash, key)));
+    }
+
+    static constexpr auto h1(std::uint64_t hash) noexcept -> size_type {
+        return static_cast<size_type>(hash >> 7);
+    }
+
+    static constexpr auto h2(std::uint64_t hash) noexcept -> detail::control_byte {
+        return static_cast<detail::control_byte>(hash & 0x7f);
+    }
+
+    // Groups are probed quadratically, every group is visited once because the group count is a power of two.
+    auto find_index(const K& key, std::uint64_t hash) const noexcept -> utilities::option<size_type> {
+        if (m_capacity == 0) {
+            return utilities::nullopt;
+        }
+
+        auto group_mask = m_capacity / s_group_width - 1;
+        auto group = h1(hash) & group_mask;
+
+        for (size_type step = 1;; step++) {
+            auto base = group * s_group_width;
+            auto control = detail::control_group{m_control + base};
+
+            for (auto matches = control.match(h2(hash)); matches != 0; matches &= matches - 1) {
+                auto index = base + static_cast<size_type>(std::countr_zero(matches));
+                if (std::invoke(m_eq, m_slots[index].first, key)) {
+                    return index;
+                }
+            }
+
+            if (control.match_empty() != 0 || step > group_mask) {
+                return utilities::nullopt;
+            }
+
+            group = (group + step) & group_mask;
+        }
+    }
+
+    // Returns the first empty or deleted slot on the probe sequence for `hash`.
+    auto find_insert_index(std::uint64_t hash) const noexcept -> size_type {
+        auto group_mask = m_capacity / s_group_width - 1;
+        auto group = h1(hash) & group_mask;
+
+        for (size_type step = 1;; step++) {
+            auto base = group * s_group_width;
+            if (auto free = detail::control_group{m_control + base}.match_empty_or_deleted()) {
+                return base + static_cast<size_type>(std::countr_zero(free));
+            }
+
+            group = (group + step) & group_mask;
+        }
+    }
+
+    template<typename... Args>
+    auto emplace_new(std::uint64_t hash, K&& key, Args&&... args) -> size_type {
+        auto index = find_insert_index_for_growth(hash);
+        slot_traits::construct(m_allocator, m_slots + index, std::piecewise_construct,
+                               std::forward_as_tuple(std::move(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+        m_control[index] = h2(hash);
+        m_size++;
+        return index;
+    }
+
+    auto find_insert_index_for_growth(std::uint64_t hash) -> size_type {
+        auto index = m_capacity == 0 ? 0 : find_insert_index(hash);
+        if (m_capacity != 0 && m_control[index] == detail::control_deleted) {
+            return index;
+        }
+
+        if (m_growth_left == 0) {
+            // if deleted slots make up a large part of the table, rehashing in place is enough to reclaim them
+            auto capacity = m_size < max_load(m_capacity) / 2 ? m_capacity : capacity_for(m_size + 1);
+            rehash(std::max(capacity, s_group_width));
+            index = find_insert_index(hash);
+        }
+
+        m_growth_left--;
+        return index;
+    }
+
+    auto erase_at(size_type index) noexcept -> void {
+        slot_traits::destroy(m_allocator, m_slots + index);
+        m_size--;
+
+        // a probe sequence only continues past a group that was full, so if this group still has an empty slot no
+        // sequence can pass through it and the slot can be reused as empty rather than leaving a tombstone
+        auto base = index / s_group_width * s_group_width;
+        if (detail::control_group{m_control + base}.match_empty() != 0) {
+            m_control[index] = detail::control_empty;
+            m_growth_left++;
+        } else {
+            m_control[index] = detail::control_deleted;
+        }
+    }
+
+    auto rehash(size_type capacity) -> void {
+        auto control_alloc = control_allocator{m_allocator};
+        auto control = control_traits::allocate(control_alloc, capacity);
+        std::memset(control, detail::control_empty, capacity);
+
+        auto slots = slot_traits::allocate(m_allocator, capacity);
+
+        auto old_control = m_control;
+        auto old_slots = m_slots;
+        auto old_capacity = m_capacity;
+
+        m_control = control;
+        m_slots = slots;
+        m_capacity = capacity;
+        m_growth_left = max_load(capacity) - m_size;
+
+        for (size_type i = 0; i < old_capacity; i++) {
+            if (old_control[i] >= 0) {
+                auto index = find_insert_index(hash_of(old_slots[i].first));
+                memory::relocate(old_slots + i, 1, m_slots + index, m_allocator);
+                m_control[index] = old_control[i];
+            }
+        }
+
+        deallocate(old_control, old_slots, old_capacity);
+    }
+
+    auto destroy_slots() noexcept -> void {
+        if constexpr (!std::is_trivially_destructible_v<slot_type>) {
+            for (size_type i = 0; i < m_capacity; i++) {
+                if (m_control[i] >= 0) {
+                    slot_traits::destroy(m_allocator, m_slots + i);
+                }
+            }
+        }
+    }
+
+    auto deallocate(detail::control_byte* control, slot_type* slots, size_type capacity) noexcept -> void {
+        if (capacity == 0) {
+            return;
+        }
+
+        auto control_alloc = control_allocator{m_allocator};
+        control_traits::deallocate(control_alloc, control, capacity);
+        slot_traits::deallocate(m_allocator, slots, capacity);
+    }
+
+    auto destroy() noexcept -> void {
+        destroy_slots();
+        deallocate(m_control, m_slots, m_capacity);
+        m_control = nullptr;
+        m_slots = nullptr;
+        m_capacity = 0;
+        m_size = 0;
+        m_growth_left = 0;
+    }
+
+    detail::control_byte* m_control{};
+    slot_type* m_slots{};
+    size_type m_capacity{};
+    size_type m_size{};
+    size_type m_growth_left{};
+    RTL_NO_UNIQUE_ADDRESS Hash m_hash{};
+    RTL_NO_UNIQUE_ADDRESS Eq m_eq{};
+    slot_allocator m_allocator{};
+}; // class hash_map
+} // namespace rtl::collections
+
+#endif // #ifndef RTL_HASH_MAP_HPP
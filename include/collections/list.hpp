@@ -20,8 +20,12 @@
 #ifndef RTL_LIST_HPP
 #define RTL_LIST_HPP
 
+#include "collections/growth.hpp"
+#include "collections/raw_iterator.hpp"
+#include "memory/relocate.hpp"
 #include "typing/concepts.hpp"
 #include "utilities/assertions.hpp"
+#include "utilities/attributes.hpp"
 #include "utilities/option.hpp"
 #include "utilities/reference.hpp"
 
@@ -33,9 +37,39 @@
 #include <iterator>
 #include <memory>
 #include <type_traits>
+#include <utility>
 
 namespace rtl::collections {
-template<typename T, typing::simple_allocator Allocator = std::allocator<T>>
+namespace detail {
+// Uninitialised room for the first `N` elements of a list, which is empty when `N` is zero.
+template<typename T, std::size_t N>
+union inline_storage {
+    constexpr inline_storage() noexcept {
+
+    }
+
+    constexpr ~inline_storage() noexcept {
+
+    }
+
+    constexpr auto data() noexcept -> T* {
+        return values;
+    }
+
+    T values[N];
+};
+
+template<typename T>
+union inline_storage<T, 0> {
+    constexpr auto data() noexcept -> T* {
+        return nullptr;
+    }
+};
+} // namespace detail
+
+// A contiguous growable array. When `N` is non-zero the first `N` elements are stored inline and memory is only
+// allocated from `Allocator` once the list grows beyond that, see `small_list`.
+template<typename T, typing::simple_allocator Allocator = std::allocator<T>, std::size_t N = 0>
 class list {
 private:
     static constexpr bool s_is_default_constructible = std::is_default_constructible_v<T>;
@@ -62,6 +96,8 @@ public:
     using optional_ref = utilities::option<utilities::reference<T>>;
     using optional_const_ref = utilities::option<utilities::reference<const T>>;
 
+    static constexpr size_type inline_capacity = N;
+
     // construction
 
     constexpr list() noexcept(noexcept(Allocator{})) = default;
@@ -102,8 +138,8 @@ public:
 
     constexpr list(std::initializer_list<T> ilist, const Allocator& allocator = Allocator{})
         noexcept(noexcept(Allocator{allocator})
-                 && std::is_nothrow_constructible_v<T, typename decltype(ilist)::reference>)
-        requires(std::constructible_from<T, typename decltype(ilist)::reference>)
+                 && std::is_nothrow_constructible_v<T, const T&>)
+        requires(std::constructible_from<T, const T&>)
         : m_allocator{allocator} {
         reserve(ilist.size());
         for (auto& el : ilist) {
@@ -111,6 +147,55 @@ public:
         }
     }
 
+    constexpr list(const list& other) noexcept(s_is_nothrow_copy_constructible) requires(s_is_copy_constructible)
+        : m_allocator{allocator_traits::select_on_container_copy_construction(other.m_allocator)} {
+        reserve(other.m_size);
+        for (const auto& el : other) {
+            add(el);
+        }
+    }
+
+    // Moving a list with inline elements relocates them, so it can only throw if that can.
+    constexpr list(list&& other) noexcept(N == 0 || s_is_nothrow_move_constructible)
+        : m_allocator{std::move(other.m_allocator)} {
+        take(std::move(other));
+    }
+
+    constexpr ~list() noexcept {
+        clear();
+        deallocate();
+    }
+
+    constexpr auto operator=(const list& other) noexcept(s_is_nothrow_copy_constructible)
+        -> list& requires(s_is_copy_constructible) {
+        if (this == &other) {
+            return *this;
+        }
+
+        clear();
+        reserve(other.m_size);
+        for (const auto& el : other) {
+            add(el);
+        }
+
+        return *this;
+    }
+
+    constexpr auto operator=(list&& other) noexcept(N == 0 || s_is_nothrow_move_constructible) -> list& {
+        if (this == &other) {
+            return *this;
+        }
+
+        clear();
+        deallocate();
+
+        m_array = m_storage.data();
+        m_capacity = N;
+        m_allocator = std::move(other.m_allocator);
+        take(std::move(other));
+        return *this;
+    }
+
     constexpr auto get_allocator() const noexcept(noexcept(allocator_type{m_allocator})) {
         return m_allocator;
     }
@@ -200,114 +285,17 @@ public:
         return at_unchecked(m_size - 1);
     }
 
-    // iterators
-    template<typename Ty>
-    class raw_iterator {
-    public:
-        using iterator_category = std::forward_iterator_tag;
-        using value_type = Ty;
-        using pointer = value_type*;
-        using reference = value_type&;
-        using difference_type = difference_type;
-
-        constexpr raw_iterator() noexcept = default;
-        constexpr raw_iterator(pointer p) noexcept : m_pointer{p} {
-
-        }
-
-        constexpr raw_iterator(const raw_iterator&) noexcept = default;
-
-        constexpr auto operator*() const noexcept -> reference {
-            return *m_pointer;
-        }
-
-        constexpr auto operator->() const noexcept -> pointer {
-            return m_pointer;
-        }
-
-        constexpr auto operator++() noexcept -> raw_iterator& {
-            ++m_pointer;
-            return *this;
-        }
-
-        constexpr auto operator++(int) noexcept -> raw_iterator {
-            auto temp = *this;
-            ++(*this);
-            return temp;
-        }
-
-        constexpr auto operator--() noexcept -> raw_iterator& {
-            --m_pointer;
-            return *this;
-        }
-
-        constexpr auto operator--(int) noexcept -> raw_iterator {
-            auto temp = *this;
-            --(*this);
-            return temp;
-        }
-
-        constexpr auto operator+=(difference_type n) noexcept -> raw_iterator& {
-            m_pointer += n;
-            return *this;
-        }
-
-        constexpr friend auto operator+(const raw_iterator& it, difference_type n) noexcept -> raw_iterator {
-            return it.m_pointer + n;
-        }
-
-        constexpr friend auto operator+(difference_type n, const raw_iterator& it) noexcept -> raw_iterator {
-            return n + it.m_pointer;
-        }
-
-        constexpr auto operator-=(difference_type n) noexcept -> raw_iterator& {
-            m_pointer -= n;
-            return *this;
-        }
-
-        constexpr friend auto operator-(const raw_iterator& it, difference_type n) noexcept -> raw_iterator {
-            return it.m_pointer - n;
-        }
-
-        constexpr friend auto operator-(difference_type n, const raw_iterator& it) noexcept -> raw_iterator {
-            return n - it.m_pointer;
-        }
-
-        constexpr friend auto operator-(const raw_iterator& a, const raw_iterator& b) noexcept -> difference_type {
-            return a.m_pointer - b.m_pointer;
-        }
-
-        constexpr auto operator[](difference_type n) const noexcept -> Ty& {
-            return *(*this + n);
-        }
-
-        constexpr friend auto operator<(const raw_iterator& a, const raw_iterator& b) noexcept -> bool {
-            return b - a > 0;
-        }
-
-        constexpr friend auto operator>(const raw_iterator& a, const raw_iterator& b) noexcept -> bool {
-            return b < a;
-        }
-
-        constexpr friend auto operator<=(const raw_iterator& a, const raw_iterator& b) noexcept -> bool {
-            return !(a < b);
-        }
-
-        constexpr friend auto operator>=(const raw_iterator& a, const raw_iterator& b) noexcept -> bool {
-            return !(a > b);
-        }
-
-        constexpr friend auto operator==(const raw_iterator& a, const raw_iterator& b) noexcept -> bool {
-            return a.m_pointer == b.m_pointer;
-        }
+    constexpr auto data() const noexcept -> const T* {
+        return m_array;
+    }
 
-        constexpr friend auto operator!=(const raw_iterator& a, const raw_iterator& b) noexcept -> bool {
-            return a.m_pointer != b.m_pointer;
-        }
+    constexpr auto data() noexcept -> T* {
+        return m_array;
+    }
 
-    private:
-        pointer m_pointer{nullptr};
-    }; // class raw_iterator
+    // iterators
+    template<typename Ty>
+    using raw_iterator = detail::raw_iterator<Ty>;
 
     using iterator = raw_iterator<value_type>;
     using const_iterator = raw_iterator<const value_type>;
@@ -365,43 +353,31 @@ public:
         return m_capacity;
     }
 
+    // Whether the elements currently live in the inline buffer rather than in memory from the allocator.
+    [[nodiscard]] constexpr auto is_inline() const noexcept -> bool {
+        if constexpr (N == 0) {
+            return false;
+        } else {
+            return m_array == m_storage.values;
+        }
+    }
+
     constexpr auto reserve(size_type capacity) noexcept(s_is_nothrow_move_constructible)
         -> void requires(s_is_move_constructible) {
         if (capacity <= m_capacity) {
             return;
         }
 
-        std::println("Reserving {}", capacity);
-        auto array = m_allocator.allocate(capacity);
-
-        for (size_type i = 0; i < m_size; i++) {
-            auto& element = m_array[i];
-            allocator_traits::construct(m_allocator, array + i, std::move(element));
-            allocator_traits::destroy(m_allocator, m_array + i);
-        }
-
-        m_allocator.deallocate(m_array, m_capacity);
-        m_array = array;
-        m_capacity = capacity;
+        reallocate(capacity);
     }
 
     constexpr auto shrink_to_fit() noexcept(s_is_nothrow_move_constructible)
         -> void requires(s_is_move_constructible) {
-        if (m_size == m_capacity) {
+        if (is_inline() || m_size == m_capacity) {
             return;
         }
 
-        auto array = m_allocator.allocate(m_size);
-
-        for (size_type i = 0; i < m_size; i++) {
-            auto& element = m_array[i];
-            allocator_traits::construct(m_allocator, array + i, std::move(element));
-            allocator_traits::destroy(m_allocator, m_array + i);
-        }
-
-        m_allocator.deallocate(m_array, m_capacity);
-        m_array = array;
-        m_capacity = m_size;
+        reallocate(std::max(m_size, N));
     }
 
     // modification
@@ -432,16 +408,11 @@ public:
     constexpr auto insert(size_type index, const T& value)
         noexcept(s_is_nothrow_copy_constructible && s_is_nothrow_move_constructible)
         -> optional_ref requires(s_is_copy_constructible && s_is_move_constructible) {
-        if (index >= m_size) {
+        if (index > m_size) {
             return utilities::nullopt;
         }
 
-        grow_if_needed();
-
-        for (size_type i = m_size; i > index; i--) {
-            allocator_traits::construct(m_allocator, m_array + i, std::move(m_array[i - 1]));
-        }
-        
+        open_gap(index);
         allocator_traits::construct(m_allocator, m_array + index, value);
         m_size++;
         return at_unchecked(index);
@@ -449,16 +420,11 @@ public:
 
     constexpr auto insert(size_type index, T&& value) noexcept(s_is_nothrow_move_constructible)
         -> optional_ref requires(s_is_move_constructible) {
-        if (index >= m_size) {
+        if (index > m_size) {
             return utilities::nullopt;
         }
 
-        grow_if_needed();
-
-        for (size_type i = m_size; i > index; i--) {
-            allocator_traits::construct(m_allocator, m_array + i, std::move(m_array[i - 1]));
-        }
-        
+        open_gap(index);
         allocator_traits::construct(m_allocator, m_array + index, std::move(value));
         m_size++;
         return at_unchecked(index);
@@ -468,27 +434,46 @@ public:
     constexpr auto insert(size_type index, Args&&...  args)
         noexcept(s_is_nothrow_move_constructible && std::is_nothrow_constructible_v<T, Args...>)
         -> optional_ref requires(s_is_move_constructible) {
-        if (index >= m_size) {
+        if (index > m_size) {
             return utilities::nullopt;
         }
 
-        grow_if_needed();
-
-        for (size_type i = m_size; i > index; i--) {
-            allocator_traits::construct(m_allocator, m_array + i, std::move(m_array[i - 1]));
-        }
-        
+        open_gap(index);
         allocator_traits::construct(m_allocator, m_array + index, std::forward<Args>(args)...);
         m_size++;
         return at_unchecked(index);
     }
 
     constexpr auto pop() noexcept(s_is_nothrow_move_constructible) -> T requires(s_is_move_constructible) {
-        auto value = std::move(back());
-        resize(m_size - 1);
+        auto value = std::move(back_unchecked());
+        m_size--;
+        allocator_traits::destroy(m_allocator, m_array + m_size);
+        return value;
+    }
+
+    // Removes the element at `index` and returns it, shifting the following elements down.
+    constexpr auto remove(size_type index) noexcept(s_is_nothrow_move_constructible)
+        -> utilities::flagged_option<T> requires(s_is_move_constructible) {
+        if (index >= m_size) {
+            return utilities::nullopt;
+        }
+
+        auto value = utilities::flagged_option<T>{std::move(m_array[index])};
+        allocator_traits::destroy(m_allocator, m_array + index);
+        memory::relocate(m_array + index + 1, m_size - index - 1, m_array + index, m_allocator);
+        m_size--;
         return value;
     }
 
+    // Destroys the elements from `size` onwards, does nothing if the list is not longer than `size`.
+    constexpr auto truncate(size_type size) noexcept -> void {
+        for (auto i = size; i < m_size; i++) {
+            allocator_traits::destroy(m_allocator, m_array + i);
+        }
+
+        m_size = std::min(m_size, size);
+    }
+
     constexpr auto resize(size_type size)
         noexcept(s_is_nothrow_default_constructible && s_is_nothrow_move_constructible)
         -> void requires(s_is_default_constructible) {
@@ -498,14 +483,27 @@ public:
             }
         } else if (size > m_size) {
             grow_if_needed(size - m_size);
+            // through a local, since stores of a character type could alias `m_array` and force a reload every time
+            auto array = m_array;
             for (auto i = m_size; i < size; i++) {
-                allocator_traits::construct(m_allocator, m_array + i, T{});
+                allocator_traits::construct(m_allocator, array + i, T{});
             }
         }
 
         m_size = size;
     }
 
+    // Like `resize`, but new elements are default-initialised, which leaves them uninitialised for the caller to
+    // overwrite.
+    constexpr auto resize_for_overwrite(size_type size) noexcept(s_is_nothrow_move_constructible)
+        -> void requires(std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>) {
+        if (size > m_size) {
+            grow_if_needed(size - m_size);
+        }
+
+        m_size = size;
+    }
+
     constexpr auto resize(size_type size, const T& value) noexcept(s_is_nothrow_copy_constructible)
         -> void requires(s_is_copy_constructible) {
         if (size < m_size) {
@@ -533,14 +531,59 @@ public:
 private:
     constexpr auto grow_if_needed(size_type increase = 1) noexcept(noexcept(reserve(0)))
         -> void requires(s_is_move_constructible) {
-        if (empty() || m_size == m_capacity || m_capacity - m_size < increase) {
-            reserve(std::max(m_capacity == 0 ? 1 : m_capacity * 2, m_size + increase));
+        if (m_capacity - m_size < increase) {
+            reserve(detail::grown_capacity(m_capacity, m_size + increase));
         }
     }
 
-    T* m_array{};
+    // Moves the elements into a buffer of `capacity` elements, which is the inline buffer if they fit in it.
+    constexpr auto reallocate(size_type capacity) noexcept(s_is_nothrow_move_constructible)
+        -> void requires(s_is_move_constructible) {
+        auto array = N != 0 && capacity <= N ? m_storage.data() : m_allocator.allocate(capacity);
+        if (array == m_array) {
+            return;
+        }
+
+        memory::relocate(m_array, m_size, array, m_allocator);
+        deallocate();
+
+        m_array = array;
+        m_capacity = std::max(capacity, N);
+    }
+
+    // Returns the buffer to the allocator unless it is the inline one, leaving `m_array` dangling.
+    constexpr auto deallocate() noexcept -> void {
+        if (m_array != nullptr && !is_inline()) {
+            m_allocator.deallocate(m_array, m_capacity);
+        }
+    }
+
+    // Takes the elements of `other`, which is left empty and inline. Expects this list to be empty and inline.
+    constexpr auto take(list&& other) noexcept(N == 0 || s_is_nothrow_move_constructible) -> void {
+        if constexpr (N != 0) {
+            if (other.is_inline()) {
+                memory::relocate(other.m_array, other.m_size, m_array, m_allocator);
+                m_size = std::exchange(other.m_size, 0);
+                return;
+            }
+        }
+
+        m_array = std::exchange(other.m_array, other.m_storage.data());
+        m_size = std::exchange(other.m_size, 0);
+        m_capacity = std::exchange(other.m_capacity, N);
+    }
+
+    // Shifts the elements from `index` onwards up by one, leaving `m_array + index` uninitialised.
+    constexpr auto open_gap(size_type index) noexcept(s_is_nothrow_move_constructible)
+        -> void requires(s_is_move_constructible) {
+        grow_if_needed();
+        memory::relocate_backward(m_array + index, m_size - index, m_array + index + 1, m_allocator);
+    }
+
+    RTL_NO_UNIQUE_ADDRESS detail::inline_storage<T, N> m_storage;
+    T* m_array{m_storage.data()};
     size_type m_size{};
-    size_type m_capacity{};
+    size_type m_capacity{N};
     allocator_type m_allocator{};
 }; // class list
 
@@ -551,4 +594,11 @@ template<
 list(It, It, Alloc = Alloc{}) -> list<typename std::iterator_traits<It>::value_type, Alloc>;
 } // namespace rtl::collections
 
+// A list with inline elements points into itself, so only one without them can be moved by copying its bytes.
+template<typename T, typename Allocator, std::size_t N>
+struct rtl::typing::is_trivially_relocatable<rtl::collections::list<T, Allocator, N>>
+    : std::bool_constant<N == 0 && rtl::typing::is_trivially_relocatable_v<Allocator>> {
+
+};
+
 #endif // #ifndef RTL_LIST_HPP
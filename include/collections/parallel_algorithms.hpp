@@ -0,0 +1,163 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_PARALLEL_ALGORITHMS_HPP
+#define RTL_PARALLEL_ALGORITHMS_HPP
+
+#include "collections/algorithms.hpp"
+#include "collections/list.hpp"
+#include "concurrency/thread_pool.hpp"
+#include "utilities/assertions.hpp"
+#include "utilities/option.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <format>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+// Parallel versions of the common algorithms over contiguous containers. The elements are split into chunks of
+// `grain_size` elements which run as tasks on a `concurrency::thread_pool`. A `grain_size` of zero picks one from the
+// size of the container and the number of threads in the pool. The chunks only depend on the container size and the
+// grain size, and partial results are always combined in the same order, so with the same grain size, or with the
+// default one and the same thread count, the results are the same on every run.
+
+namespace rtl::collections {
+namespace detail {
+class chunking {
+public:
+    static constexpr std::size_t minimum_default_grain_size = 1024;
+
+    chunking(std::size_t size, std::size_t grain_size, const concurrency::thread_pool& pool) noexcept
+        : m_size{size}
+        , m_grain_size{grain_size != 0 ? grain_size
+              : std::max(minimum_default_grain_size, size / (pool.thread_count() * 4))} {
+
+    }
+
+    [[nodiscard]] auto count() const noexcept -> std::size_t {
+        return m_size == 0 ? 0 : (m_size - 1) / m_grain_size + 1;
+    }
+
+    [[nodiscard]] auto begin(std::size_t chunk) const noexcept -> std::size_t {
+        return chunk * m_grain_size;
+    }
+
+    [[nodiscard]] auto end(std::size_t chunk) const noexcept -> std::size_t {
+        return std::min(begin(chunk) + m_grain_size, m_size);
+    }
+
+private:
+    std::size_t m_size;
+    std::size_t m_grain_size;
+}; // class chunking
+} // namespace detail
+
+// Calls `function` on every element.
+template<detail::contiguous_container C, typename F>
+requires(std::invocable<F&, decltype(*std::declval<C&>().data())>)
+auto parallel_for_each(concurrency::thread_pool& pool, C& container, F function, std::size_t grain_size = 0) -> void {
+    auto data = container.data();
+    auto chunks = detail::chunking{container.size(), grain_size, pool};
+    pool.parallel_for(0, chunks.count(), [&](std::size_t chunk) {
+        for (auto i = chunks.begin(chunk); i < chunks.end(chunk); i++) {
+            std::invoke(function, data[i]);
+        }
+    }, 1);
+}
+
+// Assigns `function(source[i])` to `destination[i]` for every element of `source`. `destination` must be at least as
+// large as `source`, and may be the same container.
+template<detail::contiguous_container S, detail::contiguous_container D, typename F>
+requires(std::is_assignable_v<typename D::value_type&,
+                              std::invoke_result_t<F&, const typename S::value_type&>>)
+auto parallel_transform(concurrency::thread_pool& pool, const S& source, D& destination, F function,
+    std::size_t grain_size = 0) -> void {
+    RTL_ASSERT(destination.size() >= source.size(), std::format(
+        "The destination has {} elements but the source has {}", destination.size(), source.size()));
+
+    auto input = source.data();
+    auto output = destination.data();
+    auto chunks = detail::chunking{source.size(), grain_size, pool};
+    pool.parallel_for(0, chunks.count(), [&](std::size_t chunk) {
+        for (auto i = chunks.begin(chunk); i < chunks.end(chunk); i++) {
+            output[i] = std::invoke(function, input[i]);
+        }
+    }, 1);
+}
+
+// Folds the elements into `initial` with `operation`. Each chunk is folded left to right from its first element, then
+// the chunk results are folded into `initial` in order, so the result matches a serial fold whenever `operation` is
+// associative. Floating point results depend on the chunks, but not on how the chunks were scheduled.
+template<detail::contiguous_container C, typename T, typename Operation = std::plus<>>
+requires(std::move_constructible<T>
+         && std::is_assignable_v<T&, std::invoke_result_t<Operation&, T, const typename C::value_type&>>
+         && std::is_assignable_v<T&, std::invoke_result_t<Operation&, T, T>>
+         && std::constructible_from<T, const typename C::value_type&>)
+auto parallel_reduce(concurrency::thread_pool& pool, const C& container, T initial, Operation operation = {},
+    std::size_t grain_size = 0) -> T {
+    auto data = container.data();
+    auto chunks = detail::chunking{container.size(), grain_size, pool};
+    auto partials = list<utilities::flagged_option<T>>(chunks.count());
+    pool.parallel_for(0, chunks.count(), [&](std::size_t chunk) {
+        auto i = chunks.begin(chunk);
+        auto partial = T(data[i]);
+        for (i++; i < chunks.end(chunk); i++) {
+            partial = std::invoke(operation, std::move(partial), data[i]);
+        }
+        partials.at_unchecked(chunk) = std::move(partial);
+    }, 1);
+
+    for (auto& partial : partials) {
+        initial = std::invoke(operation, std::move(initial), partial.unwrap());
+    }
+
+    return initial;
+}
+
+// Sorts the elements, keeping equal elements in their original order. Each chunk is stable sorted, then neighbouring
+// runs are merged in rounds, with the merges of a round running in parallel. The last round is a single merge over the
+// whole container.
+template<detail::contiguous_container C, typename Compare = std::ranges::less>
+requires(std::sortable<decltype(std::declval<C&>().data()), Compare>)
+auto parallel_sort(concurrency::thread_pool& pool, C& container, Compare compare = {}, std::size_t grain_size = 0)
+    -> void {
+    auto data = container.data();
+    auto chunks = detail::chunking{container.size(), grain_size, pool};
+    pool.parallel_for(0, chunks.count(), [&](std::size_t chunk) {
+        std::stable_sort(data + chunks.begin(chunk), data + chunks.end(chunk), std::ref(compare));
+    }, 1);
+
+    // runs of `width` chunks are sorted, merge them pairwise into runs of twice the width
+    for (std::size_t width = 1; width < chunks.count(); width *= 2) {
+        auto merges = (chunks.count() - width - 1) / (2 * width) + 1;
+        pool.parallel_for(0, merges, [&](std::size_t merge) {
+            auto first = merge * 2 * width;
+            auto middle = first + width;
+            auto last = std::min(middle + width, chunks.count());
+            std::inplace_merge(data + chunks.begin(first), data + chunks.begin(middle), data + chunks.end(last - 1),
+                std::ref(compare));
+        }, 1);
+    }
+}
+} // namespace rtl::collections
+
+#endif // #ifndef RTL_PARALLEL_ALGORITHMS_HPP
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_RAW_ITERATOR_HPP
+#define RTL_RAW_ITERATOR_HPP
+
+#include <cstddef>
+#include <iterator>
+
+namespace rtl::collections::detail {
+// Random access iterator over a contiguous array, shared by the contiguous containers.
+template<typename Ty>
+class raw_iterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = Ty;
+    using pointer = value_type*;
+    using reference = value_type&;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr raw_iterator() noexcept = default;
+    constexpr raw_iterator(pointer p) noexcept : m_pointer{p} {
+
+    }
+
+    constexpr raw_iterator(const raw_iterator&) noexcept = default;
+
+    constexpr auto operator*() const noexcept -> reference {
+        return *m_pointer;
+    }
+
+    constexpr auto operator->() const noexcept -> pointer {
+        return m_pointer;
+    }
+
+    constexpr auto operator++() noexcept -> raw_iterator& {
+        ++m_pointer;
+        return *this;
+    }
+
+    constexpr auto operator++(int) noexcept -> raw_iterator {
+        auto temp = *this;
+        ++(*this);
+        return temp;
+    }
+
+    constexpr auto operator--() noexcept -> raw_iterator& {
+        --m_pointer;
+        return *this;
+    }
+
+    constexpr auto operator--(int) noexcept -> raw_iterator {
+        auto temp = *this;
+        --(*this);
+        return temp;
+    }
+
+    constexpr auto operator+=(difference_type n) noexcept -> raw_iterator& {
+        m_pointer += n;
+        return *this;
+    }
+
+    constexpr friend auto operator+(const raw_iterator& it, difference_type n) noexcept -> raw_iterator {
+        return it.m_pointer + n;
+    }
+
+    constexpr friend auto operator+(difference_type n, const raw_iterator& it) noexcept -> raw_iterator {
+        return n + it.m_pointer;
+    }
+
+    constexpr auto operator-=(difference_type n) noexcept -> raw_iterator& {
+        m_pointer -= n;
+        return *this;
+    }
+
+    constexpr friend auto operator-(const raw_iterator& it, difference_type n) noexcept -> raw_iterator {
+        return it.m_pointer - n;
+    }
+
+    constexpr friend auto operator-(const raw_iterator& a, const raw_iterator& b) noexcept -> difference_type {
+        return a.m_pointer - b.m_pointer;
+    }
+
+    constexpr auto operator[](difference_type n) const noexcept -> Ty& {
+        return *(*this + n);
+    }
+
+    constexpr friend auto operator<(const raw_iterator& a, const raw_iterator& b) noexcept -> bool {
+        return b - a > 0;
+    }
+
+    constexpr friend auto operator>(const raw_iterator& a, const raw_iterator& b) noexcept -> bool {
+        return b < a;
+    }
+
+    constexpr friend auto operator<=(const raw_iterator& a, const raw_iterator& b) noexcept -> bool {
+        return !(b < a);
+    }
+
+    constexpr friend auto operator>=(const raw_iterator& a, const raw_iterator& b) noexcept -> bool {
+        return !(a < b);
+    }
+
+    constexpr friend auto operator==(const raw_iterator& a, const raw_iterator& b) noexcept -> bool {
+        return a.m_pointer == b.m_pointer;
+    }
+
+    constexpr friend auto operator!=(const raw_iterator& a, const raw_iterator& b) noexcept -> bool {
+        return a.m_pointer != b.m_pointer;
+    }
+
+private:
+    pointer m_pointer{nullptr};
+}; // class raw_iterator
+} // namespace rtl::collections::detail
+
+#endif // #ifndef RTL_RAW_ITERATOR_HPP
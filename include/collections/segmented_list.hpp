@@ -0,0 +1,612 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_SEGMENTED_LIST_HPP
+#define RTL_SEGMENTED_LIST_HPP
+
+#include "typing/concepts.hpp"
+#include "utilities/attributes.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace rtl::collections {
+namespace detail {
+// A slot holds either an element or, while it is a hole, the index of the next hole in its segment.
+template<typename T>
+union segment_slot {
+    constexpr segment_slot() noexcept {
+
+    }
+
+    constexpr ~segment_slot() noexcept {
+
+    }
+
+    T value;
+    std::uint32_t next_free;
+};
+
+template<typename T>
+struct segment {
+    static constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+    static constexpr std::uint32_t no_free_slot = std::numeric_limits<std::uint32_t>::max();
+    static constexpr std::size_t word_bits = 64;
+
+    segment_slot<T>* slots;
+    // one bit per slot, set while the slot holds an element
+    std::uint64_t* occupied;
+    std::size_t capacity;
+    std::size_t size;
+    // slots from here on have never held an element
+    std::size_t high_water;
+    std::uint32_t free_head;
+    segment* previous;
+    segment* next;
+    segment* previous_with_free;
+    segment* next_with_free;
+
+    [[nodiscard]] constexpr auto word_count() const noexcept -> std::size_t {
+        return (capacity + word_bits - 1) / word_bits;
+    }
+
+    constexpr auto mark(std::size_t index, bool is_occupied) noexcept -> void {
+        auto bit = std::uint64_t{1} << (index % word_bits);
+        if (is_occupied) {
+            occupied[index / word_bits] |= bit;
+        } else {
+            occupied[index / word_bits] &= ~bit;
+        }
+    }
+
+    // The first element at or after `from`, or `high_water` if there isn't one. Holes are skipped a word at a time.
+    [[nodiscard]] constexpr auto next_occupied(std::size_t from) const noexcept -> std::size_t {
+        if (from >= high_water) {
+            return high_water;
+        }
+
+        auto word = from / word_bits;
+        auto bits = occupied[word] & (~std::uint64_t{0} << (from % word_bits));
+        while (bits == 0) {
+            word++;
+            if (word * word_bits >= high_water) {
+                return high_water;
+            }
+
+            bits = occupied[word];
+        }
+
+        return word * word_bits + static_cast<std::size_t>(std::countr_zero(bits));
+    }
+
+    // The last element before `before`, or `none` if there isn't one.
+    [[nodiscard]] constexpr auto previous_occupied(std::size_t before) const noexcept -> std::size_t {
+        if (before == 0) {
+            return none;
+        }
+
+        auto last = before - 1;
+        auto word = last / word_bits;
+        auto bits = occupied[word] & (~std::uint64_t{0} >> (word_bits - 1 - last % word_bits));
+        while (bits == 0) {
+            if (word == 0) {
+                return none;
+            }
+
+            bits = occupied[--word];
+        }
+
+        return word * word_bits + word_bits - 1 - static_cast<std::size_t>(std::countl_zero(bits));
+    }
+};
+} // namespace detail
+
+// A container whose elements never move once added, so pointers and references to them stay valid until the element
+// itself is removed. Elements live in segments that double in size up to `max_segment_capacity` and are never
+// reallocated. Removing an element leaves a hole which the next `add` reuses, every segment tracks its holes in a free
+// list and a bitmap, and iteration skips runs of holes a word of the bitmap at a time. Segments that become empty are
+// freed, except for the last one. The order of iteration is the order of the slots, not the order of insertion.
+//
+// Adding and removing elements only invalidates iterators to removed elements and `end()`.
+template<typename T, typing::simple_allocator Allocator = std::allocator<T>>
+class segmented_list {
+private:
+    static constexpr bool s_is_copy_constructible = std::is_copy_constructible_v<T>;
+    static constexpr bool s_is_nothrow_copy_constructible = std::is_nothrow_copy_constructible_v<T>;
+
+    using segment_type = detail::segment<T>;
+    using slot_type = detail::segment_slot<T>;
+    using segment_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<segment_type>;
+    using slot_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<slot_type>;
+    using word_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<std::uint64_t>;
+
+public:
+    using allocator_type = Allocator;
+    using allocator_traits = std::allocator_traits<allocator_type>;
+
+    using value_type = T;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    static constexpr size_type min_segment_capacity = 8;
+    // segments top out at about a megabyte
+    static constexpr size_type max_segment_capacity = std::clamp<size_type>(
+        (size_type{1} << 20) / sizeof(slot_type), min_segment_capacity, std::numeric_limits<std::uint32_t>::max());
+
+    // construction
+
+    constexpr segmented_list() noexcept(noexcept(Allocator{})) = default;
+
+    explicit constexpr segmented_list(const Allocator& allocator) noexcept(noexcept(Allocator{allocator}))
+        : m_allocator{allocator} {
+
+    }
+
+    constexpr segmented_list(std::initializer_list<T> ilist, const Allocator& allocator = Allocator{})
+        requires(s_is_copy_constructible)
+        : m_allocator{allocator} {
+        for (const auto& value : ilist) {
+            add(value);
+        }
+    }
+
+    constexpr segmented_list(const segmented_list& other) requires(s_is_copy_constructible)
+        : m_allocator{allocator_traits::select_on_container_copy_construction(other.m_allocator)} {
+        for (const auto& value : other) {
+            add(value);
+        }
+    }
+
+    constexpr segmented_list(segmented_list&& other) noexcept
+        : m_first{std::exchange(other.m_first, nullptr)}
+        , m_last{std::exchange(other.m_last, nullptr)}
+        , m_first_with_free{std::exchange(other.m_first_with_free, nullptr)}
+        , m_size{std::exchange(other.m_size, 0)}
+        , m_capacity{std::exchange(other.m_capacity, 0)}
+        , m_allocator{std::move(other.m_allocator)} {
+
+    }
+
+    constexpr ~segmented_list() noexcept {
+        clear();
+    }
+
+    constexpr auto operator=(const segmented_list& other) -> segmented_list& requires(s_is_copy_constructible) {
+        if (this == &other) {
+            return *this;
+        }
+
+        clear();
+        for (const auto& value : other) {
+            add(value);
+        }
+
+        return *this;
+    }
+
+    constexpr auto operator=(segmented_list&& other) noexcept -> segmented_list& {
+        if (this == &other) {
+            return *this;
+        }
+
+        clear();
+        m_first = std::exchange(other.m_first, nullptr);
+        m_last = std::exchange(other.m_last, nullptr);
+        m_first_with_free = std::exchange(other.m_first_with_free, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_capacity = std::exchange(other.m_capacity, 0);
+        m_allocator = std::move(other.m_allocator);
+        return *this;
+    }
+
+    constexpr auto get_allocator() const noexcept(noexcept(allocator_type{m_allocator})) {
+        return m_allocator;
+    }
+
+    // iterators
+
+    template<bool IsConst>
+    class raw_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+        using difference_type = std::ptrdiff_t;
+
+        constexpr raw_iterator() noexcept = default;
+
+        constexpr raw_iterator(segment_type* segment, size_type index) noexcept {
+            seek(segment, index);
+        }
+
+        constexpr operator raw_iterator<true>() const noexcept requires(!IsConst) {
+            return {m_segment, m_index};
+        }
+
+        constexpr auto operator*() const noexcept -> reference {
+            return m_segment->slots[m_index].value;
+        }
+
+        constexpr auto operator->() const noexcept -> pointer {
+            return std::addressof(m_segment->slots[m_index].value);
+        }
+
+        constexpr auto operator++() noexcept -> raw_iterator& {
+            // Within a word the next element comes from the cached bits, so stepping doesn't wait on a load. The bits
+            // are masked with the current word to leave out elements removed since they were cached.
+            m_bits &= m_bits - 1;
+            m_bits &= m_segment->occupied[m_word];
+            if (m_bits != 0) {
+                m_index = m_word * segment_type::word_bits + static_cast<size_type>(std::countr_zero(m_bits));
+                return *this;
+            }
+
+            auto index = m_segment->next_occupied((m_word + 1) * segment_type::word_bits);
+            if (index == m_segment->high_water && m_segment->next != nullptr) {
+                // only the last segment can be empty, so the next one has an element unless it is the end
+                seek(m_segment->next, m_segment->next->next_occupied(0));
+            } else {
+                seek(m_segment, index);
+            }
+
+            return *this;
+        }
+
+        constexpr auto operator++(int) noexcept -> raw_iterator {
+            auto temp = *this;
+            ++(*this);
+            return temp;
+        }
+
+        constexpr auto operator--() noexcept -> raw_iterator& {
+            if (auto index = m_segment->previous_occupied(m_index); index != segment_type::none) {
+                seek(m_segment, index);
+            } else {
+                seek(m_segment->previous, m_segment->previous->previous_occupied(m_segment->previous->high_water));
+            }
+
+            return *this;
+        }
+
+        constexpr auto operator--(int) noexcept -> raw_iterator {
+            auto temp = *this;
+            --(*this);
+            return temp;
+        }
+
+        constexpr friend auto operator==(const raw_iterator& a, const raw_iterator& b) noexcept -> bool {
+            return a.m_segment == b.m_segment && a.m_index == b.m_index;
+        }
+
+    private:
+        friend class segmented_list;
+
+        constexpr auto seek(segment_type* segment, size_type index) noexcept -> void {
+            m_segment = segment;
+            m_index = index;
+            m_word = index / segment_type::word_bits;
+            m_bits = segment != nullptr && index < segment->high_water
+                ? segment->occupied[m_word] & (~std::uint64_t{0} << (index % segment_type::word_bits))
+                : 0;
+        }
+
+        segment_type* m_segment{};
+        size_type m_index{};
+        size_type m_word{};
+        // the elements from `m_index` to the end of its word
+        std::uint64_t m_bits{};
+    }; // class raw_iterator
+
+    using iterator = raw_iterator<false>;
+    using const_iterator = raw_iterator<true>;
+
+    static_assert(std::bidirectional_iterator<iterator>);
+    static_assert(std::bidirectional_iterator<const_iterator>);
+
+    constexpr auto begin() noexcept -> iterator {
+        if (m_first == nullptr) {
+            return end();
+        }
+
+        return {m_first, m_first->next_occupied(0)};
+    }
+
+    constexpr auto begin() const noexcept -> const_iterator {
+        if (m_first == nullptr) {
+            return end();
+        }
+
+        return {m_first, m_first->next_occupied(0)};
+    }
+
+    constexpr auto cbegin() const noexcept -> const_iterator {
+        return begin();
+    }
+
+    constexpr auto end() noexcept -> iterator {
+        return {m_last, m_last == nullptr ? 0 : m_last->high_water};
+    }
+
+    constexpr auto end() const noexcept -> const_iterator {
+        return {m_last, m_last == nullptr ? 0 : m_last->high_water};
+    }
+
+    constexpr auto cend() const noexcept -> const_iterator {
+        return end();
+    }
+
+    // The iterator to an element of this list, found in time linear in the number of segments.
+    constexpr auto iterator_to(const T& value) const noexcept -> const_iterator {
+        auto slot = reinterpret_cast<const slot_type*>(std::addressof(value));
+        for (auto segment = m_first; segment != nullptr; segment = segment->next) {
+            if (std::less_equal<>{}(segment->slots, slot) && std::less<>{}(slot, segment->slots + segment->capacity)) {
+                return {segment, static_cast<size_type>(slot - segment->slots)};
+            }
+        }
+
+        return end();
+    }
+
+    constexpr auto iterator_to(T& value) noexcept -> iterator {
+        auto position = std::as_const(*this).iterator_to(value);
+        return {position.m_segment, position.m_index};
+    }
+
+    // capacity/size queries
+
+    [[nodiscard]] constexpr auto empty() const noexcept -> bool {
+        return m_size == 0;
+    }
+
+    [[nodiscard]] constexpr auto size() const noexcept -> size_type {
+        return m_size;
+    }
+
+    [[nodiscard]] constexpr auto capacity() const noexcept -> size_type {
+        return m_capacity;
+    }
+
+    // modification
+
+    // Constructs an element in a free slot, reusing a hole if there is one.
+    template<typename... Args> requires(std::constructible_from<T, Args...>)
+    constexpr auto add(Args&&... args) -> iterator {
+        auto [segment, index] = claim_slot();
+        if constexpr (std::is_nothrow_constructible_v<T, Args...>) {
+            allocator_traits::construct(m_allocator, std::addressof(segment->slots[index].value),
+                std::forward<Args>(args)...);
+        } else {
+            try {
+                allocator_traits::construct(m_allocator, std::addressof(segment->slots[index].value),
+                    std::forward<Args>(args)...);
+            } catch (...) {
+                free_slot(segment, index);
+                throw;
+            }
+        }
+
+        segment->mark(index, true);
+        segment->size++;
+        m_size++;
+        return {segment, index};
+    }
+
+    // Destroys the element at `position` and returns the iterator to the element after it.
+    constexpr auto remove(const_iterator position) noexcept -> iterator {
+        auto segment = position.m_segment;
+        auto index = position.m_index;
+        auto next = iterator{segment, index};
+        ++next;
+        auto next_in_segment = next.m_segment == segment;
+
+        allocator_traits::destroy(m_allocator, std::addressof(segment->slots[index].value));
+        segment->mark(index, false);
+        segment->size--;
+        m_size--;
+        free_slot(segment, index);
+
+        // if that was the last element of the last segment, the segment has been reset and the end has moved
+        return next_in_segment && segment->size == 0 ? end() : next;
+    }
+
+    constexpr auto clear() noexcept -> void {
+        while (m_first != nullptr) {
+            auto segment = m_first;
+            for (auto i = segment->next_occupied(0); i < segment->high_water; i = segment->next_occupied(i + 1)) {
+                allocator_traits::destroy(m_allocator, std::addressof(segment->slots[i].value));
+            }
+
+            m_first = segment->next;
+            deallocate_segment(segment);
+        }
+
+        m_last = nullptr;
+        m_first_with_free = nullptr;
+        m_size = 0;
+        m_capacity = 0;
+    }
+
+private:
+    // Picks the slot for a new element: a hole if there is one, then the unused tail of the last segment, then a new
+    // segment.
+    constexpr auto claim_slot() -> std::pair<segment_type*, size_type> {
+        if (auto segment = m_first_with_free; segment != nullptr) {
+            auto index = segment->free_head;
+            segment->free_head = segment->slots[index].next_free;
+            if (segment->free_head == segment_type::no_free_slot) {
+                unlink_with_free(segment);
+            }
+
+            return {segment, index};
+        }
+
+        if (m_last == nullptr || m_last->high_water == m_last->capacity) {
+            append_segment();
+        }
+
+        return {m_last, m_last->high_water++};
+    }
+
+    // Turns the slot at `index`, which must not hold an element, into a hole. A segment left without elements is freed
+    // unless it is the last one, which is reset instead.
+    constexpr auto free_slot(segment_type* segment, size_type index) noexcept -> void {
+        if (segment->size == 0) {
+            if (segment->free_head != segment_type::no_free_slot) {
+                unlink_with_free(segment);
+            }
+
+            if (segment == m_last) {
+                segment->free_head = segment_type::no_free_slot;
+                segment->high_water = 0;
+                return;
+            }
+
+            unlink(segment);
+            deallocate_segment(segment);
+            return;
+        }
+
+        segment->slots[index].next_free = segment->free_head;
+        if (segment->free_head == segment_type::no_free_slot) {
+            segment->previous_with_free = nullptr;
+            segment->next_with_free = m_first_with_free;
+            if (m_first_with_free != nullptr) {
+                m_first_with_free->previous_with_free = segment;
+            }
+
+            m_first_with_free = segment;
+        }
+
+        segment->free_head = static_cast<std::uint32_t>(index);
+    }
+
+    constexpr auto append_segment() -> void {
+        auto capacity = m_last == nullptr ? min_segment_capacity : std::min(m_last->capacity * 2, max_segment_capacity);
+
+        auto segments = segment_allocator{m_allocator};
+        auto slots = slot_allocator{m_allocator};
+        auto words = word_allocator{m_allocator};
+
+        auto segment = std::allocator_traits<segment_allocator>::allocate(segments, 1);
+        auto word_count = (capacity + segment_type::word_bits - 1) / segment_type::word_bits;
+        try {
+            std::construct_at(segment, segment_type{
+                .slots = std::allocator_traits<slot_allocator>::allocate(slots, capacity),
+                .occupied = nullptr,
+                .capacity = capacity,
+                .size = 0,
+                .high_water = 0,
+                .free_head = segment_type::no_free_slot,
+                .previous = m_last,
+                .next = nullptr,
+                .previous_with_free = nullptr,
+                .next_with_free = nullptr,
+            });
+
+            try {
+                segment->occupied = std::allocator_traits<word_allocator>::allocate(words, word_count);
+            } catch (...) {
+                std::allocator_traits<slot_allocator>::deallocate(slots, segment->slots, capacity);
+                throw;
+            }
+        } catch (...) {
+            std::allocator_traits<segment_allocator>::deallocate(segments, segment, 1);
+            throw;
+        }
+
+        std::fill_n(segment->occupied, word_count, std::uint64_t{0});
+        if (m_last != nullptr) {
+            m_last->next = segment;
+        } else {
+            m_first = segment;
+        }
+
+        m_last = segment;
+        m_capacity += capacity;
+    }
+
+    constexpr auto unlink(segment_type* segment) noexcept -> void {
+        if (segment->previous != nullptr) {
+            segment->previous->next = segment->next;
+        } else {
+            m_first = segment->next;
+        }
+
+        if (segment->next != nullptr) {
+            segment->next->previous = segment->previous;
+        } else {
+            m_last = segment->previous;
+        }
+    }
+
+    constexpr auto unlink_with_free(segment_type* segment) noexcept -> void {
+        if (segment->previous_with_free != nullptr) {
+            segment->previous_with_free->next_with_free = segment->next_with_free;
+        } else {
+            m_first_with_free = segment->next_with_free;
+        }
+
+        if (segment->next_with_free != nullptr) {
+            segment->next_with_free->previous_with_free = segment->previous_with_free;
+        }
+    }
+
+    // The caller must have destroyed the segment's elements and unlinked it.
+    constexpr auto deallocate_segment(segment_type* segment) noexcept -> void {
+        auto segments = segment_allocator{m_allocator};
+        auto slots = slot_allocator{m_allocator};
+        auto words = word_allocator{m_allocator};
+
+        m_capacity -= segment->capacity;
+        std::allocator_traits<word_allocator>::deallocate(words, segment->occupied, segment->word_count());
+        std::allocator_traits<slot_allocator>::deallocate(slots, segment->slots, segment->capacity);
+        std::destroy_at(segment);
+        std::allocator_traits<segment_allocator>::deallocate(segments, segment, 1);
+    }
+
+    segment_type* m_first{};
+    segment_type* m_last{};
+    segment_type* m_first_with_free{};
+    size_type m_size{};
+    size_type m_capacity{};
+    RTL_NO_UNIQUE_ADDRESS allocator_type m_allocator{};
+}; // class segmented_list
+} // namespace rtl::collections
+
+template<typename T, typename Allocator>
+struct rtl::typing::is_trivially_relocatable<rtl::collections::segmented_list<T, Allocator>>
+    : rtl::typing::is_trivially_relocatable<Allocator> {
+
+};
+
+#endif // #ifndef RTL_SEGMENTED_LIST_HPP
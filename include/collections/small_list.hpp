@@ -0,0 +1,35 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_SMALL_LIST_HPP
+#define RTL_SMALL_LIST_HPP
+
+#include "collections/list.hpp"
+#include "typing/concepts.hpp"
+
+#include <cstddef>
+#include <memory>
+
+namespace rtl::collections {
+// A list that stores up to `N` elements inline and only allocates from `Allocator` once it grows beyond that.
+template<typename T, std::size_t N, typing::simple_allocator Allocator = std::allocator<T>> requires(N > 0)
+using small_list = list<T, Allocator, N>;
+} // namespace rtl::collections
+
+#endif // #ifndef RTL_SMALL_LIST_HPP
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_SORTED_SEARCH_HPP
+#define RTL_SORTED_SEARCH_HPP
+
+#include <cstddef>
+#include <functional>
+
+namespace rtl::collections {
+// Tag for constructing a sorted container from input that is already sorted and free of duplicates.
+struct sorted_unique_t {
+    explicit sorted_unique_t() = default;
+};
+
+inline constexpr sorted_unique_t sorted_unique{};
+
+namespace detail {
+// Binary searches that halve the range unconditionally and select the next base with a conditional move rather than
+// a branch, so the loop runs the same number of iterations for every key and never mispredicts.
+template<typename T, typename U, typename Compare>
+constexpr auto branchless_lower_bound(const T* first, std::size_t count, const U& key, const Compare& compare)
+    noexcept(noexcept(std::invoke(compare, *first, key))) -> std::size_t {
+    if (count == 0) {
+        return 0;
+    }
+
+    auto base = first;
+    while (count > 1) {
+        auto half = count / 2;
+        base = std::invoke(compare, base[half], key) ? base + half : base;
+        count -= half;
+    }
+
+    return static_cast<std::size_t>(base - first) + static_cast<std::size_t>(std::invoke(compare, *base, key));
+}
+
+template<typename T, typename U, typename Compare>
+constexpr auto branchless_upper_bound(const T* first, std::size_t count, const U& key, const Compare& compare)
+    noexcept(noexcept(std::invoke(compare, key, *first))) -> std::size_t {
+    if (count == 0) {
+        return 0;
+    }
+
+    auto base = first;
+    while (count > 1) {
+        auto half = count / 2;
+        base = std::invoke(compare, key, base[half]) ? base : base + half;
+        count -= half;
+    }
+
+    return static_cast<std::size_t>(base - first) + static_cast<std::size_t>(!std::invoke(compare, key, *base));
+}
+} // namespace detail
+} // namespace rtl::collections
+
+#endif // #ifndef RTL_SORTED_SEARCH_HPP
@@ -0,0 +1,169 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_CHASE_LEV_DEQUE_HPP
+#define RTL_CHASE_LEV_DEQUE_HPP
+
+#include "collections/list.hpp"
+#include "memory/unique_ptr.hpp"
+#include "utilities/cpu.hpp"
+#include "utilities/option.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace rtl::concurrency {
+namespace detail {
+// The circular array behind a `chase_lev_deque`. Indices grow without bound and are masked into the array.
+template<typename T>
+class deque_ring {
+public:
+    explicit deque_ring(std::int64_t capacity) : m_mask{capacity - 1}, m_slots{new std::atomic<T>[
+        static_cast<std::size_t>(capacity)]} {
+
+    }
+
+    deque_ring(const deque_ring&) = delete;
+    auto operator=(const deque_ring&) -> deque_ring& = delete;
+
+    ~deque_ring() noexcept {
+        delete[] m_slots;
+    }
+
+    [[nodiscard]] auto capacity() const noexcept -> std::int64_t {
+        return m_mask + 1;
+    }
+
+    auto get(std::int64_t index) const noexcept -> T {
+        return m_slots[index & m_mask].load(std::memory_order_relaxed);
+    }
+
+    auto put(std::int64_t index, T value) noexcept -> void {
+        m_slots[index & m_mask].store(value, std::memory_order_relaxed);
+    }
+
+private:
+    std::int64_t m_mask;
+    std::atomic<T>* m_slots;
+}; // class deque_ring
+} // namespace detail
+
+// The work-stealing deque of Chase and Lev, with the memory orderings of Lê et al., "Correct and Efficient
+// Work-Stealing for Weak Memory Models". One owner thread pushes and pops at the bottom, any thread may steal from the
+// top. The deque grows when it is full. Thieves may still be reading a replaced array, so old arrays are kept until
+// the deque is destroyed, which costs at most as much memory as the current array.
+template<typename T> requires(std::is_trivially_copyable_v<T>)
+class chase_lev_deque {
+public:
+    static constexpr std::int64_t initial_capacity = 256;
+
+    chase_lev_deque() : m_ring{new detail::deque_ring<T>(initial_capacity)} {
+        m_rings.add(memory::unique_ptr<detail::deque_ring<T>>{m_ring.load(std::memory_order_relaxed)});
+    }
+
+    chase_lev_deque(const chase_lev_deque&) = delete;
+    auto operator=(const chase_lev_deque&) -> chase_lev_deque& = delete;
+
+    // Owner only.
+    auto push(T value) -> void {
+        auto bottom = m_bottom.load(std::memory_order_relaxed);
+        auto top = m_top.load(std::memory_order_acquire);
+        auto ring = m_ring.load(std::memory_order_relaxed);
+        if (bottom - top > ring->capacity() - 1) {
+            ring = grow(ring, top, bottom);
+        }
+
+        ring->put(bottom, value);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    // Owner only, takes the most recently pushed value.
+    auto pop() noexcept -> utilities::flagged_option<T> {
+        auto bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        auto ring = m_ring.load(std::memory_order_relaxed);
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto top = m_top.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return utilities::nullopt;
+        }
+
+        auto value = ring->get(bottom);
+        if (top == bottom) {
+            // the last value, which a thief may be taking at the same time
+            auto won = m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                std::memory_order_relaxed);
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            if (!won) {
+                return utilities::nullopt;
+            }
+        }
+
+        return value;
+    }
+
+    // Any thread, takes the least recently pushed value. Returns nothing if the deque is empty or another thread took
+    // the value first.
+    auto steal() noexcept -> utilities::flagged_option<T> {
+        auto top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto bottom = m_bottom.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return utilities::nullopt;
+        }
+
+        auto value = m_ring.load(std::memory_order_acquire)->get(top);
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return utilities::nullopt;
+        }
+
+        return value;
+    }
+
+    // Only a snapshot when other threads are using the deque.
+    [[nodiscard]] auto empty() const noexcept -> bool {
+        return m_top.load(std::memory_order_relaxed) >= m_bottom.load(std::memory_order_relaxed);
+    }
+
+private:
+    auto grow(detail::deque_ring<T>* ring, std::int64_t top, std::int64_t bottom) -> detail::deque_ring<T>* {
+        auto bigger = new detail::deque_ring<T>(ring->capacity() * 2);
+        m_rings.add(memory::unique_ptr<detail::deque_ring<T>>{bigger});
+        for (auto i = top; i < bottom; i++) {
+            bigger->put(i, ring->get(i));
+        }
+
+        m_ring.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+    // the owner writes the bottom and thieves write the top, so they are kept on separate cache lines
+    alignas(utilities::cache_line_size) std::atomic<std::int64_t> m_top{0};
+    alignas(utilities::cache_line_size) std::atomic<std::int64_t> m_bottom{0};
+    std::atomic<detail::deque_ring<T>*> m_ring;
+    collections::list<memory::unique_ptr<detail::deque_ring<T>>> m_rings;
+}; // class chase_lev_deque
+} // namespace rtl::concurrency
+
+#endif // #ifndef RTL_CHASE_LEV_DEQUE_HPP
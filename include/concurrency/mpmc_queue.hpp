@@ -0,0 +1,242 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_MPMC_QUEUE_HPP
+#define RTL_MPMC_QUEUE_HPP
+
+#include "typing/concepts.hpp"
+#include "utilities/attributes.hpp"
+#include "utilities/cpu.hpp"
+#include "utilities/option.hpp"
+
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace rtl::concurrency {
+namespace detail {
+template<typename T>
+struct mpmc_slot {
+    // `position` when the slot is free for the producer at `position`, `position + 1` once that producer has filled
+    // it, and `position + capacity` once the consumer has emptied it for the next lap.
+    std::atomic<std::size_t> sequence;
+    alignas(T) std::byte storage[sizeof(T)];
+
+    auto value() noexcept -> T* {
+        return std::launder(reinterpret_cast<T*>(storage));
+    }
+};
+} // namespace detail
+
+// Dmitry Vyukov's bounded multi-producer, multi-consumer queue. Every slot carries a sequence number saying whose turn
+// it is, so producers and consumers only contend on their own index and never take a lock. The capacity is rounded up
+// to a power of two.
+//
+// The `try_` functions give up when the queue is full or empty. `push` and `pop` take a ticket and sleep on their slot's
+// sequence number with `std::atomic::wait` until it is their turn, so they never spin.
+template<typename T, typing::simple_allocator Allocator = std::allocator<T>>
+requires(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_destructible_v<T>)
+class mpmc_queue {
+private:
+    using slot_type = detail::mpmc_slot<T>;
+    using slot_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<slot_type>;
+
+public:
+    using allocator_type = Allocator;
+    using value_type = T;
+    using size_type = std::size_t;
+
+    explicit mpmc_queue(size_type capacity, const Allocator& allocator = Allocator{})
+        : m_capacity{std::bit_ceil(std::max<size_type>(capacity, 1))}
+        , m_allocator{allocator} {
+        m_slots = m_allocator.allocate(m_capacity);
+        for (size_type i = 0; i < m_capacity; i++) {
+            std::construct_at(&m_slots[i].sequence, i);
+        }
+    }
+
+    mpmc_queue(const mpmc_queue&) = delete;
+    auto operator=(const mpmc_queue&) -> mpmc_queue& = delete;
+
+    ~mpmc_queue() noexcept {
+        auto head = m_head.load(std::memory_order_relaxed);
+        auto tail = m_tail.load(std::memory_order_relaxed);
+        for (; head != tail; head++) {
+            std::destroy_at(slot(head).value());
+        }
+
+        for (size_type i = 0; i < m_capacity; i++) {
+            std::destroy_at(&m_slots[i].sequence);
+        }
+
+        m_allocator.deallocate(m_slots, m_capacity);
+    }
+
+    [[nodiscard]] auto capacity() const noexcept -> size_type {
+        return m_capacity;
+    }
+
+    // Only a snapshot. Blocked `push` and `pop` calls count as already done.
+    [[nodiscard]] auto size() const noexcept -> size_type {
+        auto head = m_head.load(std::memory_order_relaxed);
+        auto tail = m_tail.load(std::memory_order_relaxed);
+        return tail > head ? std::min(tail - head, m_capacity) : 0;
+    }
+
+    [[nodiscard]] auto empty() const noexcept -> bool {
+        return size() == 0;
+    }
+
+    // producers
+
+    // Constructs an element at the back from `args`, returns false if the queue is full.
+    template<typename... Args> requires(std::constructible_from<T, Args...>)
+    auto try_emplace(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>) -> bool {
+        if constexpr (!std::is_nothrow_constructible_v<T, Args...>) {
+            // a claimed slot must be filled, so anything that can throw happens before claiming one
+            return try_emplace(T(std::forward<Args>(args)...));
+        }
+
+        auto position = m_tail.load(std::memory_order_relaxed);
+        while (true) {
+            auto& target = slot(position);
+            auto difference = static_cast<std::ptrdiff_t>(target.sequence.load(std::memory_order_acquire) - position);
+            if (difference == 0) {
+                if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    fill(target, position, std::forward<Args>(args)...);
+                    return true;
+                }
+            } else if (difference < 0) {
+                // the slot still holds the value from the previous lap
+                return false;
+            } else {
+                position = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Returns false if the queue is full, in which case `value` is not moved from.
+    auto try_push(T&& value) noexcept -> bool {
+        return try_emplace(std::move(value));
+    }
+
+    auto try_push(const T& value) noexcept(std::is_nothrow_copy_constructible_v<T>) -> bool
+        requires(std::copy_constructible<T>) {
+        return try_emplace(value);
+    }
+
+    // Constructs an element at the back from `args`, waiting for space if the queue is full.
+    template<typename... Args> requires(std::constructible_from<T, Args...>)
+    auto emplace(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>) -> void {
+        if constexpr (!std::is_nothrow_constructible_v<T, Args...>) {
+            return emplace(T(std::forward<Args>(args)...));
+        }
+
+        auto position = m_tail.fetch_add(1, std::memory_order_relaxed);
+        auto& target = slot(position);
+        wait_for(target, position);
+        fill(target, position, std::forward<Args>(args)...);
+    }
+
+    auto push(T&& value) noexcept -> void {
+        emplace(std::move(value));
+    }
+
+    auto push(const T& value) noexcept(std::is_nothrow_copy_constructible_v<T>) -> void
+        requires(std::copy_constructible<T>) {
+        emplace(value);
+    }
+
+    // consumers
+
+    // Removes and returns the front element, or nothing if the queue is empty. The option is flagged, so a null
+    // element is still returned as a value.
+    auto try_pop() noexcept -> utilities::flagged_option<T> {
+        auto position = m_head.load(std::memory_order_relaxed);
+        while (true) {
+            auto& source = slot(position);
+            auto difference = static_cast<std::ptrdiff_t>(
+                source.sequence.load(std::memory_order_acquire) - (position + 1));
+            if (difference == 0) {
+                if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    return utilities::flagged_option<T>{empty_slot(source, position)};
+                }
+            } else if (difference < 0) {
+                // the producer for this position hasn't finished yet
+                return utilities::nullopt;
+            } else {
+                position = m_head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Removes and returns the front element, waiting for one if the queue is empty.
+    auto pop() noexcept -> T {
+        auto position = m_head.fetch_add(1, std::memory_order_relaxed);
+        auto& source = slot(position);
+        wait_for(source, position + 1);
+        return empty_slot(source, position);
+    }
+
+private:
+    auto slot(size_type position) const noexcept -> slot_type& {
+        return m_slots[position & (m_capacity - 1)];
+    }
+
+    static auto wait_for(slot_type& target, size_type sequence) noexcept -> void {
+        while (true) {
+            auto current = target.sequence.load(std::memory_order_acquire);
+            if (current == sequence) {
+                return;
+            }
+
+            target.sequence.wait(current, std::memory_order_acquire);
+        }
+    }
+
+    template<typename... Args>
+    static auto fill(slot_type& target, size_type position, Args&&... args) noexcept -> void {
+        std::construct_at(reinterpret_cast<T*>(target.storage), std::forward<Args>(args)...);
+        target.sequence.store(position + 1, std::memory_order_release);
+        target.sequence.notify_all();
+    }
+
+    auto empty_slot(slot_type& source, size_type position) noexcept -> T {
+        auto value = T(std::move(*source.value()));
+        std::destroy_at(source.value());
+        source.sequence.store(position + m_capacity, std::memory_order_release);
+        source.sequence.notify_all();
+        return value;
+    }
+
+    alignas(utilities::cache_line_size) std::atomic<size_type> m_tail{0};
+    alignas(utilities::cache_line_size) std::atomic<size_type> m_head{0};
+    alignas(utilities::cache_line_size) slot_type* m_slots{};
+    size_type m_capacity;
+    RTL_NO_UNIQUE_ADDRESS slot_allocator m_allocator;
+}; // class mpmc_queue
+} // namespace rtl::concurrency
+
+#endif // #ifndef RTL_MPMC_QUEUE_HPP
@@ -0,0 +1,200 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_SPSC_QUEUE_HPP
+#define RTL_SPSC_QUEUE_HPP
+
+#include "typing/concepts.hpp"
+#include "utilities/attributes.hpp"
+#include "utilities/cpu.hpp"
+#include "utilities/option.hpp"
+
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace rtl::concurrency {
+// A bounded, lock-free queue between exactly one producer thread and one consumer thread. The capacity is rounded up
+// to a power of two. Each side keeps a cached copy of the other side's index and only reloads it when the cached value
+// says the queue is full or empty. The two sides' data is on separate cache lines, so they only share one in that
+// case. The batch functions publish their index once for the whole batch.
+template<typename T, typing::simple_allocator Allocator = std::allocator<T>>
+class spsc_queue {
+public:
+    using allocator_type = Allocator;
+    using allocator_traits = std::allocator_traits<allocator_type>;
+    using value_type = T;
+    using size_type = std::size_t;
+
+    explicit spsc_queue(size_type capacity, const Allocator& allocator = Allocator{})
+        : m_capacity{std::bit_ceil(std::max<size_type>(capacity, 1))}
+        , m_allocator{allocator} {
+        m_slots = m_allocator.allocate(m_capacity);
+    }
+
+    spsc_queue(const spsc_queue&) = delete;
+    auto operator=(const spsc_queue&) -> spsc_queue& = delete;
+
+    ~spsc_queue() noexcept {
+        auto head = m_consumer.head.load(std::memory_order_relaxed);
+        auto tail = m_producer.tail.load(std::memory_order_relaxed);
+        for (; head != tail; head++) {
+            allocator_traits::destroy(m_allocator, slot(head));
+        }
+
+        m_allocator.deallocate(m_slots, m_capacity);
+    }
+
+    [[nodiscard]] auto capacity() const noexcept -> size_type {
+        return m_capacity;
+    }
+
+    // Only a snapshot when called from a thread other than the producer or consumer.
+    [[nodiscard]] auto size() const noexcept -> size_type {
+        return m_producer.tail.load(std::memory_order_acquire) - m_consumer.head.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] auto empty() const noexcept -> bool {
+        return size() == 0;
+    }
+
+    // producer
+
+    // Constructs an element at the back from `args`, returns false if the queue is full.
+    template<typename... Args> requires(std::constructible_from<T, Args...>)
+    auto try_emplace(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>) -> bool {
+        auto tail = m_producer.tail.load(std::memory_order_relaxed);
+        if (free_slots(tail, 1) == 0) {
+            return false;
+        }
+
+        allocator_traits::construct(m_allocator, slot(tail), std::forward<Args>(args)...);
+        m_producer.tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false if the queue is full, in which case `value` is left alone.
+    auto try_push(const T& value) noexcept(std::is_nothrow_copy_constructible_v<T>) -> bool
+        requires(std::copy_constructible<T>) {
+        return try_emplace(value);
+    }
+
+    // Returns false if the queue is full, in which case `value` is not moved from.
+    auto try_push(T&& value) noexcept(std::is_nothrow_move_constructible_v<T>) -> bool
+        requires(std::move_constructible<T>) {
+        return try_emplace(std::move(value));
+    }
+
+    // Pushes as many of the `count` values from `first` as fit and returns how many that was.
+    template<std::input_iterator It> requires(std::constructible_from<T, std::iter_reference_t<It>>)
+    auto push_n(It first, size_type count) noexcept(std::is_nothrow_constructible_v<T, std::iter_reference_t<It>>)
+        -> size_type {
+        auto tail = m_producer.tail.load(std::memory_order_relaxed);
+        count = std::min(count, free_slots(tail, count));
+        for (size_type i = 0; i < count; i++, ++first) {
+            allocator_traits::construct(m_allocator, slot(tail + i), *first);
+        }
+
+        m_producer.tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // consumer
+
+    // Removes and returns the front element, or nothing if the queue is empty. The option is flagged, so a null
+    // element is still returned as a value.
+    auto try_pop() noexcept(std::is_nothrow_move_constructible_v<T>) -> utilities::flagged_option<T>
+        requires(std::move_constructible<T>) {
+        auto head = m_consumer.head.load(std::memory_order_relaxed);
+        if (used_slots(head, 1) == 0) {
+            return utilities::nullopt;
+        }
+
+        auto value = utilities::flagged_option<T>{std::move(*slot(head))};
+        allocator_traits::destroy(m_allocator, slot(head));
+        m_consumer.head.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+    // Moves up to `count` elements from the front to `out` and returns how many that was.
+    template<std::output_iterator<T&&> It>
+    auto pop_n(It out, size_type count) noexcept(std::is_nothrow_move_constructible_v<T>) -> size_type {
+        auto head = m_consumer.head.load(std::memory_order_relaxed);
+        count = std::min(count, used_slots(head, count));
+        for (size_type i = 0; i < count; i++) {
+            *out = std::move(*slot(head + i));
+            ++out;
+            allocator_traits::destroy(m_allocator, slot(head + i));
+        }
+
+        m_consumer.head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+private:
+    auto slot(size_type index) const noexcept -> T* {
+        return m_slots + (index & (m_capacity - 1));
+    }
+
+    // Producer only, reloads the consumer's index when the cached one says there are fewer than `wanted` free slots.
+    auto free_slots(size_type tail, size_type wanted) noexcept -> size_type {
+        auto free = m_capacity - (tail - m_producer.cached_head);
+        if (free < wanted) {
+            m_producer.cached_head = m_consumer.head.load(std::memory_order_acquire);
+            free = m_capacity - (tail - m_producer.cached_head);
+        }
+
+        return free;
+    }
+
+    // Consumer only, reloads the producer's index when the cached one says there are fewer than `wanted` elements.
+    auto used_slots(size_type head, size_type wanted) noexcept -> size_type {
+        auto used = m_consumer.cached_tail - head;
+        if (used < wanted) {
+            m_consumer.cached_tail = m_producer.tail.load(std::memory_order_acquire);
+            used = m_consumer.cached_tail - head;
+        }
+
+        return used;
+    }
+
+    struct alignas(utilities::cache_line_size) producer_data {
+        std::atomic<size_type> tail{0};
+        size_type cached_head{0};
+    };
+
+    struct alignas(utilities::cache_line_size) consumer_data {
+        std::atomic<size_type> head{0};
+        size_type cached_tail{0};
+    };
+
+    producer_data m_producer;
+    consumer_data m_consumer;
+    T* m_slots{};
+    size_type m_capacity;
+    RTL_NO_UNIQUE_ADDRESS allocator_type m_allocator;
+}; // class spsc_queue
+} // namespace rtl::concurrency
+
+#endif // #ifndef RTL_SPSC_QUEUE_HPP
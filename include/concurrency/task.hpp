@@ -0,0 +1,144 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_TASK_HPP
+#define RTL_TASK_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace rtl::concurrency {
+// A move-only, type-erased `void()` callable. Callables of up to `inline_size` bytes that can be moved without throwing
+// are stored in the task itself, so creating a task from them doesn't allocate. Larger callables are moved to the heap.
+class task {
+public:
+    static constexpr std::size_t inline_size = 48;
+    static constexpr std::size_t inline_alignment = alignof(std::max_align_t);
+
+    constexpr task() noexcept = default;
+
+    template<typename F>
+    requires(!std::same_as<std::remove_cvref_t<F>, task> && std::invocable<std::decay_t<F>&>)
+    task(F&& function) : m_operations{&s_operations<std::decay_t<F>>} {
+        using callable = std::decay_t<F>;
+        if constexpr (s_is_inline<callable>) {
+            std::construct_at(reinterpret_cast<callable*>(m_storage), std::forward<F>(function));
+        } else {
+            std::construct_at(reinterpret_cast<callable**>(m_storage), new callable(std::forward<F>(function)));
+        }
+    }
+
+    task(const task&) = delete;
+
+    task(task&& other) noexcept : m_operations{std::exchange(other.m_operations, nullptr)} {
+        if (m_operations != nullptr) {
+            m_operations->relocate(other.m_storage, m_storage);
+        }
+    }
+
+    ~task() noexcept {
+        reset();
+    }
+
+    auto operator=(const task&) -> task& = delete;
+
+    auto operator=(task&& other) noexcept -> task& {
+        if (this == &other) {
+            return *this;
+        }
+
+        reset();
+        m_operations = std::exchange(other.m_operations, nullptr);
+        if (m_operations != nullptr) {
+            m_operations->relocate(other.m_storage, m_storage);
+        }
+
+        return *this;
+    }
+
+    auto operator()() -> void {
+        m_operations->invoke(m_storage);
+    }
+
+    [[nodiscard]] explicit operator bool() const noexcept {
+        return m_operations != nullptr;
+    }
+
+    auto reset() noexcept -> void {
+        if (m_operations != nullptr) {
+            m_operations->destroy(m_storage);
+            m_operations = nullptr;
+        }
+    }
+
+private:
+    struct operations {
+        void (*invoke)(std::byte* storage);
+        // Moves the callable from `source` to `destination` and destroys what is left in `source`.
+        void (*relocate)(std::byte* source, std::byte* destination) noexcept;
+        void (*destroy)(std::byte* storage) noexcept;
+    };
+
+    template<typename F>
+    static constexpr bool s_is_inline = sizeof(F) <= inline_size && alignof(F) <= inline_alignment
+        && std::is_nothrow_move_constructible_v<F>;
+
+    template<typename F>
+    static auto get(std::byte* storage) noexcept -> F& {
+        if constexpr (s_is_inline<F>) {
+            return *std::launder(reinterpret_cast<F*>(storage));
+        } else {
+            return **std::launder(reinterpret_cast<F**>(storage));
+        }
+    }
+
+    template<typename F>
+    static constexpr operations s_operations{
+        [](std::byte* storage) {
+            std::invoke(get<F>(storage));
+        },
+        [](std::byte* source, std::byte* destination) noexcept {
+            if constexpr (s_is_inline<F>) {
+                auto& callable = get<F>(source);
+                std::construct_at(reinterpret_cast<F*>(destination), std::move(callable));
+                std::destroy_at(&callable);
+            } else {
+                std::construct_at(reinterpret_cast<F**>(destination), &get<F>(source));
+            }
+        },
+        [](std::byte* storage) noexcept {
+            if constexpr (s_is_inline<F>) {
+                std::destroy_at(&get<F>(storage));
+            } else {
+                delete &get<F>(storage);
+            }
+        },
+    };
+
+    alignas(inline_alignment) std::byte m_storage[inline_size];
+    const operations* m_operations{};
+}; // class task
+} // namespace rtl::concurrency
+
+#endif // #ifndef RTL_TASK_HPP
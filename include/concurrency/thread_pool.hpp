@@ -0,0 +1,525 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_THREAD_POOL_HPP
+#define RTL_THREAD_POOL_HPP
+
+#include "collections/list.hpp"
+#include "concurrency/chase_lev_deque.hpp"
+#include "concurrency/task.hpp"
+#include "memory/pool_allocator.hpp"
+#include "memory/unique_ptr.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace rtl::concurrency {
+class thread_pool;
+
+namespace detail {
+struct no_result {
+
+};
+
+// What a submitted task shares with its `task_handle`, freed by whichever of the two lets go of it last.
+template<typename R>
+class task_state {
+public:
+    static auto create() -> task_state* {
+        auto allocator = memory::pool_allocator<task_state>{};
+        return std::construct_at(allocator.allocate(1));
+    }
+
+    template<typename F>
+    auto run(F& function) noexcept -> void {
+        try {
+            if constexpr (std::is_void_v<R>) {
+                std::invoke(function);
+            } else {
+                m_result = std::invoke(function);
+            }
+        } catch (...) {
+            m_error = std::current_exception();
+        }
+
+        m_ready.store(true, std::memory_order_release);
+        m_ready.notify_all();
+    }
+
+    [[nodiscard]] auto ready() const noexcept -> bool {
+        return m_ready.load(std::memory_order_acquire);
+    }
+
+    auto wait_until_ready() const noexcept -> void {
+        m_ready.wait(false, std::memory_order_acquire);
+    }
+
+    auto take() -> R {
+        if (m_error != nullptr) {
+            std::rethrow_exception(std::exchange(m_error, nullptr));
+        }
+
+        if constexpr (!std::is_void_v<R>) {
+            return m_result.unwrap();
+        }
+    }
+
+    auto release() noexcept -> void {
+        if (m_references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            auto allocator = memory::pool_allocator<task_state>{};
+            std::destroy_at(this);
+            allocator.deallocate(this, 1);
+        }
+    }
+
+private:
+    std::atomic<bool> m_ready{false};
+    std::atomic<std::uint32_t> m_references{2};
+    // flagged, so a task that returns a null pointer still has a result
+    utilities::flagged_option<std::conditional_t<std::is_void_v<R>, no_result, R>> m_result;
+    std::exception_ptr m_error;
+}; // class task_state
+} // namespace detail
+
+// A handle to the result of a task given to `thread_pool::submit`. Dropping the handle doesn't cancel the task. The
+// pool must outlive any call to `wait` or `get`.
+template<typename R>
+class [[nodiscard]] task_handle {
+public:
+    task_handle(const task_handle&) = delete;
+
+    task_handle(task_handle&& other) noexcept
+        : m_pool{other.m_pool}
+        , m_state{std::exchange(other.m_state, nullptr)} {
+
+    }
+
+    ~task_handle() noexcept {
+        if (m_state != nullptr) {
+            m_state->release();
+        }
+    }
+
+    auto operator=(const task_handle&) -> task_handle& = delete;
+
+    auto operator=(task_handle&& other) noexcept -> task_handle& {
+        if (this == &other) {
+            return *this;
+        }
+
+        if (m_state != nullptr) {
+            m_state->release();
+        }
+
+        m_pool = other.m_pool;
+        m_state = std::exchange(other.m_state, nullptr);
+        return *this;
+    }
+
+    [[nodiscard]] auto ready() const noexcept -> bool {
+        return m_state->ready();
+    }
+
+    // Runs other queued tasks on the calling thread until the task has finished, so waiting from inside a task doesn't
+    // tie up a worker.
+    auto wait() -> void;
+
+    // Waits for the task and returns its result, or rethrows what it threw. May only be called once.
+    auto get() -> R {
+        wait();
+        return m_state->take();
+    }
+
+private:
+    friend class thread_pool;
+
+    task_handle(thread_pool* pool, detail::task_state<R>* state) noexcept : m_pool{pool}, m_state{state} {
+
+    }
+
+    thread_pool* m_pool;
+    detail::task_state<R>* m_state;
+}; // class task_handle
+
+// A fixed set of worker threads, each with its own `chase_lev_deque` of tasks. Tasks submitted by a worker go to the
+// bottom of its own deque and are run newest first, idle workers steal the oldest tasks from the others, and tasks
+// submitted from other threads go through a shared queue. Tasks are pooled `task` objects, so submitting doesn't touch
+// the global heap once the pools are warm.
+//
+// Destroying the pool runs every task that has been submitted and joins the workers.
+class thread_pool {
+public:
+    explicit thread_pool(std::size_t thread_count = default_thread_count()) {
+        thread_count = std::max<std::size_t>(thread_count, 1);
+        m_workers.reserve(thread_count);
+        for (std::size_t i = 0; i < thread_count; i++) {
+            m_workers.add(memory::make_unique<chase_lev_deque<task*>>());
+        }
+
+        m_threads.reserve(thread_count);
+        try {
+            for (std::size_t i = 0; i < thread_count; i++) {
+                m_threads.add(std::thread{[this, i] { work(i); }});
+            }
+        } catch (...) {
+            // the threads that did start would terminate the program if they were destroyed while joinable
+            stop();
+            throw;
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    auto operator=(const thread_pool&) -> thread_pool& = delete;
+
+    ~thread_pool() noexcept {
+        stop();
+    }
+
+    [[nodiscard]] static auto default_thread_count() noexcept -> std::size_t {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    [[nodiscard]] auto thread_count() const noexcept -> std::size_t {
+        return m_threads.size();
+    }
+
+    // Queues `function` to run on a worker and returns a handle to its result.
+    template<typename F> requires(std::invocable<std::decay_t<F>&>)
+    auto submit(F&& function) -> task_handle<std::invoke_result_t<std::decay_t<F>&>> {
+        using result_type = std::invoke_result_t<std::decay_t<F>&>;
+
+        auto state = detail::task_state<result_type>::create();
+        task* queued = nullptr;
+        try {
+            queued = make_task([state, function = std::forward<F>(function)]() mutable {
+                state->run(function);
+                state->release();
+            });
+        } catch (...) {
+            state->release();
+            state->release();
+            throw;
+        }
+
+        try {
+            push(queued);
+        } catch (...) {
+            discard(queued);
+            state->release();
+            state->release();
+            throw;
+        }
+
+        wake(false);
+        return task_handle<result_type>{this, state};
+    }
+
+    // Calls `body(i)` for every `i` in [`first`, `last`), in chunks of `grain_size` indices spread over the workers,
+    // and returns once every call has finished. The calling thread works through chunks as well. A `grain_size` of
+    // zero picks one that gives each worker a few chunks. If `body` throws, the remaining chunks are skipped and the
+    // first exception is rethrown.
+    template<typename F> requires(std::invocable<F&, std::size_t>)
+    auto parallel_for(std::size_t first, std::size_t last, F&& body, std::size_t grain_size = 0) -> void {
+        if (first >= last) {
+            return;
+        }
+
+        auto count = last - first;
+        if (grain_size == 0) {
+            grain_size = std::max<std::size_t>(1, count / (thread_count() * 4));
+        }
+
+        auto chunk_count = (count - 1) / grain_size + 1;
+        if (chunk_count == 1) {
+            for (auto i = first; i < last; i++) {
+                std::invoke(body, i);
+            }
+
+            return;
+        }
+
+        struct shared_state {
+            std::atomic<std::size_t> next_chunk{0};
+            std::atomic<std::size_t> running_helpers{0};
+            std::atomic<bool> failed{false};
+            std::exception_ptr error;
+        } shared;
+
+        auto run_chunks = [&]() noexcept {
+            for (auto chunk = shared.next_chunk.fetch_add(1, std::memory_order_relaxed); chunk < chunk_count;
+                 chunk = shared.next_chunk.fetch_add(1, std::memory_order_relaxed)) {
+                if (shared.failed.load(std::memory_order_relaxed)) {
+                    break;
+                }
+
+                auto begin = first + chunk * grain_size;
+                auto end = std::min(begin + grain_size, last);
+                try {
+                    for (auto i = begin; i < end; i++) {
+                        std::invoke(body, i);
+                    }
+                } catch (...) {
+                    if (!shared.failed.exchange(true, std::memory_order_relaxed)) {
+                        shared.error = std::current_exception();
+                    }
+                }
+            }
+        };
+
+        // Helpers take chunks from the shared counter until none are left, so a helper that starts late finishes
+        // straight away. They refer to this stack frame, so each one is counted once it is queued, and if queueing
+        // one fails the ones already queued are waited for before the exception leaves.
+        auto helpers = std::min(chunk_count - 1, thread_count());
+        try {
+            for (std::size_t i = 0; i < helpers; i++) {
+                auto helper = make_task([&shared, &run_chunks] {
+                    run_chunks();
+                    shared.running_helpers.fetch_sub(1, std::memory_order_release);
+                });
+
+                shared.running_helpers.fetch_add(1, std::memory_order_relaxed);
+                try {
+                    push(helper);
+                } catch (...) {
+                    shared.running_helpers.fetch_sub(1, std::memory_order_relaxed);
+                    discard(helper);
+                    throw;
+                }
+            }
+        } catch (...) {
+            shared.failed.store(true, std::memory_order_relaxed);
+            wake(true);
+            wait_for_helpers(shared.running_helpers);
+            throw;
+        }
+
+        wake(true);
+        run_chunks();
+        wait_for_helpers(shared.running_helpers);
+
+        if (shared.error != nullptr) {
+            std::rethrow_exception(shared.error);
+        }
+    }
+
+    // Runs one queued task on the calling thread, if any thread can find one. Used to make progress while waiting.
+    auto try_run_pending_task() -> bool {
+        if (auto pending = find_task(); pending != nullptr) {
+            run(pending);
+            return true;
+        }
+
+        return false;
+    }
+
+private:
+    struct worker_context {
+        thread_pool* pool{};
+        std::size_t index{};
+        std::uint32_t random{};
+    };
+
+    static auto current() noexcept -> worker_context& {
+        thread_local worker_context context;
+        return context;
+    }
+
+    template<typename F>
+    static auto make_task(F&& function) -> task* {
+        auto allocator = memory::pool_allocator<task>{};
+        auto pointer = allocator.allocate(1);
+        try {
+            return std::construct_at(pointer, std::forward<F>(function));
+        } catch (...) {
+            allocator.deallocate(pointer, 1);
+            throw;
+        }
+    }
+
+    static auto run(task* pending) noexcept -> void {
+        (*pending)();
+        discard(pending);
+    }
+
+    // Frees a task from `make_task` without running it.
+    static auto discard(task* pending) noexcept -> void {
+        auto allocator = memory::pool_allocator<task>{};
+        std::destroy_at(pending);
+        allocator.deallocate(pending, 1);
+    }
+
+    // Runs queued tasks on the calling thread until `running` drops to zero.
+    auto wait_for_helpers(const std::atomic<std::size_t>& running) -> void {
+        while (running.load(std::memory_order_acquire) != 0) {
+            if (!try_run_pending_task()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // Lets the workers finish every queued task and joins them.
+    auto stop() noexcept -> void {
+        m_stopping.store(true, std::memory_order_release);
+        m_epoch.fetch_add(1, std::memory_order_seq_cst);
+        m_epoch.notify_all();
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    auto push(task* pending) -> void {
+        if (auto& context = current(); context.pool == this) {
+            m_workers.at_unchecked(context.index).get()->push(pending);
+            return;
+        }
+
+        std::lock_guard lock{m_injected_mutex};
+        m_injected.add(pending);
+        m_injected_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Wakes sleeping workers after tasks were pushed. Workers register as sleeping before their last look for work, so
+    // either they see the new epoch and look again, or this sees them and notifies them.
+    auto wake(bool all) noexcept -> void {
+        m_epoch.fetch_add(1, std::memory_order_seq_cst);
+        if (m_sleeping.load(std::memory_order_seq_cst) == 0) {
+            return;
+        }
+
+        if (all) {
+            m_epoch.notify_all();
+        } else {
+            m_epoch.notify_one();
+        }
+    }
+
+    auto find_task() -> task* {
+        auto& context = current();
+        auto is_worker = context.pool == this;
+        if (is_worker) {
+            if (auto pending = m_workers.at_unchecked(context.index).get()->pop(); pending.has_value()) {
+                return pending.value();
+            }
+        }
+
+        if (auto pending = take_injected(); pending != nullptr) {
+            return pending;
+        }
+
+        // start stealing from a random worker, so idle workers don't all go after the same one
+        context.random ^= context.random << 13;
+        context.random ^= context.random >> 17;
+        context.random ^= context.random << 5;
+        auto count = m_workers.size();
+        auto start = context.random % count;
+        for (std::size_t i = 0; i < count; i++) {
+            auto victim = (start + i) % count;
+            if (is_worker && victim == context.index) {
+                continue;
+            }
+
+            if (auto pending = m_workers.at_unchecked(victim).get()->steal(); pending.has_value()) {
+                return pending.value();
+            }
+        }
+
+        return nullptr;
+    }
+
+    auto take_injected() -> task* {
+        if (m_injected_count.load(std::memory_order_relaxed) == 0) {
+            return nullptr;
+        }
+
+        std::lock_guard lock{m_injected_mutex};
+        if (m_injected_head == m_injected.size()) {
+            return nullptr;
+        }
+
+        auto pending = m_injected.at_unchecked(m_injected_head++);
+        if (m_injected_head == m_injected.size()) {
+            m_injected.clear();
+            m_injected_head = 0;
+        }
+
+        m_injected_count.fetch_sub(1, std::memory_order_relaxed);
+        return pending;
+    }
+
+    auto work(std::size_t index) -> void {
+        current() = worker_context{this, index, static_cast<std::uint32_t>(index * 2654435761u) | 1};
+
+        while (true) {
+            if (auto pending = find_task(); pending != nullptr) {
+                run(pending);
+                continue;
+            }
+
+            m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+            auto epoch = m_epoch.load(std::memory_order_seq_cst);
+            if (auto pending = find_task(); pending != nullptr) {
+                m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+                run(pending);
+                continue;
+            }
+
+            if (m_stopping.load(std::memory_order_acquire)) {
+                m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+                break;
+            }
+
+            m_epoch.wait(epoch, std::memory_order_seq_cst);
+            m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    collections::list<memory::unique_ptr<chase_lev_deque<task*>>> m_workers;
+    collections::list<std::thread> m_threads;
+
+    std::mutex m_injected_mutex;
+    collections::list<task*> m_injected;
+    std::size_t m_injected_head{};
+    std::atomic<std::size_t> m_injected_count{0};
+
+    std::atomic<bool> m_stopping{false};
+    std::atomic<std::uint32_t> m_epoch{0};
+    std::atomic<std::uint32_t> m_sleeping{0};
+}; // class thread_pool
+
+template<typename R>
+auto task_handle<R>::wait() -> void {
+    while (!m_state->ready()) {
+        if (!m_pool->try_run_pending_task()) {
+            m_state->wait_until_ready();
+        }
+    }
+}
+} // namespace rtl::concurrency
+
+#endif // #ifndef RTL_THREAD_POOL_HPP
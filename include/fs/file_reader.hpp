@@ -0,0 +1,255 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_FILE_READER_HPP
+#define RTL_FILE_READER_HPP
+
+#include "collections/list.hpp"
+#include "fs/io_queue.hpp"
+#include "fs/platform.hpp"
+#include "utilities/result.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <span>
+#include <system_error>
+#include <utility>
+
+#ifdef RTL_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace rtl::fs {
+// Reads a file from start to end, keeping every buffer but the one the caller is looking at busy with reads further
+// ahead. `next` hands out whole buffers without copying and `read` copies into the caller's memory, a reader should
+// only use one of them.
+//
+// Only POSIX systems are supported for now, elsewhere `open` always fails with `std::errc::not_supported`.
+class file_reader {
+public:
+    file_reader() noexcept = default;
+
+    file_reader(const file_reader&) = delete;
+
+    file_reader(file_reader&& other) noexcept
+        : m_fd{std::exchange(other.m_fd, -1)}
+#ifdef RTL_POSIX
+        , m_queue{std::move(other.m_queue)}
+#endif
+        , m_buffers{std::move(other.m_buffers)}
+        , m_in_flight{std::move(other.m_in_flight)}
+        , m_slot{other.m_slot}
+        , m_holding{std::exchange(other.m_holding, false)}
+        , m_reached_end{std::exchange(other.m_reached_end, true)}
+        , m_next_offset{other.m_next_offset}
+        , m_chunk{std::exchange(other.m_chunk, {})}
+        , m_error{other.m_error} {
+
+    }
+
+    ~file_reader() noexcept {
+        close();
+    }
+
+    auto operator=(const file_reader&) -> file_reader& = delete;
+
+    auto operator=(file_reader&& other) noexcept -> file_reader& {
+        if (this == &other) {
+            return *this;
+        }
+
+        close();
+        m_fd = std::exchange(other.m_fd, -1);
+#ifdef RTL_POSIX
+        m_queue = std::move(other.m_queue);
+#endif
+        m_buffers = std::move(other.m_buffers);
+        m_in_flight = std::move(other.m_in_flight);
+        m_slot = other.m_slot;
+        m_holding = std::exchange(other.m_holding, false);
+        m_reached_end = std::exchange(other.m_reached_end, true);
+        m_next_offset = other.m_next_offset;
+        m_chunk = std::exchange(other.m_chunk, {});
+        m_error = other.m_error;
+        return *this;
+    }
+
+    // Opens the file at `path` and starts reading it, or returns the reason it couldn't.
+    static auto open(const std::filesystem::path& path, const io_options& options = {})
+        -> utilities::result<file_reader, std::error_code> {
+#ifdef RTL_POSIX
+        auto flags = O_RDONLY | O_CLOEXEC;
+#ifdef O_DIRECT
+        if (options.direct) {
+            flags |= O_DIRECT;
+        }
+#endif
+        auto fd = ::open(path.c_str(), flags);
+        if (fd < 0) {
+            return utilities::failure{detail::errno_error()};
+        }
+
+        auto reader = file_reader{};
+        reader.m_fd = fd;
+        auto error = reader.m_queue.setup(fd, std::max<std::size_t>(options.buffer_count, 1), options.backend);
+        if (error) {
+            return utilities::failure{error};
+        }
+
+        auto buffer_size = (std::max<std::size_t>(options.buffer_size, 1) + direct_alignment - 1)
+            & ~(direct_alignment - 1);
+        auto buffer_count = std::max<std::size_t>(options.buffer_count, 1);
+        reader.m_buffers = detail::io_buffers{buffer_size, buffer_count};
+        reader.m_in_flight = collections::list<bool>(buffer_count, false);
+        reader.m_reached_end = false;
+        for (std::size_t i = 0; i < buffer_count; i++) {
+            reader.refill(i);
+        }
+
+        return reader;
+#else
+        (void)path;
+        (void)options;
+        return utilities::failure{std::make_error_code(std::errc::not_supported)};
+#endif
+    }
+
+    // The next part of the file, which stays valid until the next call. Empty at the end of the file or after an
+    // error.
+    auto next() -> std::span<const std::byte> {
+#ifdef RTL_POSIX
+        if (m_holding) {
+            // the caller is done with the buffer, so it can read further ahead
+            m_holding = false;
+            refill(m_slot);
+            m_slot = (m_slot + 1) % m_in_flight.size();
+        }
+
+        if (m_error || m_in_flight.empty() || !m_in_flight.data()[m_slot]) {
+            return {};
+        }
+
+        auto result = m_queue.wait(m_slot);
+        m_in_flight.data()[m_slot] = false;
+        if (result < 0) {
+            m_error = {static_cast<int>(-result), std::system_category()};
+            return {};
+        } else if (static_cast<std::size_t>(result) < m_buffers.buffer_size()) {
+            m_reached_end = true;
+        }
+
+        if (result == 0) {
+            return {};
+        }
+
+        m_holding = true;
+        return {m_buffers[m_slot], static_cast<std::size_t>(result)};
+#else
+        return {};
+#endif
+    }
+
+    // Copies up to `destination.size()` bytes from the file, returns how many were copied. Fewer are only copied at
+    // the end of the file or after an error.
+    auto read(std::span<std::byte> destination) -> std::size_t {
+        std::size_t copied = 0;
+        while (copied < destination.size()) {
+            if (m_chunk.empty()) {
+                m_chunk = next();
+                if (m_chunk.empty()) {
+                    break;
+                }
+            }
+
+            auto count = std::min(m_chunk.size(), destination.size() - copied);
+            std::memcpy(destination.data() + copied, m_chunk.data(), count);
+            m_chunk = m_chunk.subspan(count);
+            copied += count;
+        }
+
+        return copied;
+    }
+
+    // The first error reading hit, reading stops there.
+    [[nodiscard]] auto error() const noexcept -> std::error_code {
+        return m_error;
+    }
+
+    [[nodiscard]] auto uses_io_uring() const noexcept -> bool {
+#ifdef RTL_POSIX
+        return m_queue.uses_io_uring();
+#else
+        return false;
+#endif
+    }
+
+    [[nodiscard]] auto is_open() const noexcept -> bool {
+        return m_fd >= 0;
+    }
+
+    // Waits for the reads still in flight and closes the file.
+    auto close() noexcept -> void {
+#ifdef RTL_POSIX
+        if (m_fd >= 0) {
+            m_queue.drain();
+            ::close(m_fd);
+            m_fd = -1;
+        }
+#endif
+    }
+
+private:
+    // Starts reading the next buffer's worth of the file into `slot`, unless the end has been seen already.
+    auto refill(std::size_t slot) noexcept -> void {
+#ifdef RTL_POSIX
+        if (m_reached_end || m_error) {
+            return;
+        }
+
+        m_queue.submit(slot, detail::io_queue::operation::read, m_buffers[slot], m_buffers.buffer_size(),
+            m_next_offset);
+        m_in_flight.data()[slot] = true;
+        m_next_offset += m_buffers.buffer_size();
+#else
+        (void)slot;
+#endif
+    }
+
+    int m_fd{-1};
+#ifdef RTL_POSIX
+    detail::io_queue m_queue;
+#endif
+    detail::io_buffers m_buffers;
+    collections::list<bool> m_in_flight;
+    std::size_t m_slot{};
+    // whether the caller has been given the buffer in `m_slot`
+    bool m_holding{};
+    bool m_reached_end{true};
+    std::uint64_t m_next_offset{};
+    // what `read` hasn't copied yet of the last buffer
+    std::span<const std::byte> m_chunk{};
+    std::error_code m_error{};
+}; // class file_reader
+} // namespace rtl::fs
+
+#endif // #ifndef RTL_FILE_READER_HPP
@@ -0,0 +1,280 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_FILE_WRITER_HPP
+#define RTL_FILE_WRITER_HPP
+
+#include "fs/io_queue.hpp"
+#include "fs/platform.hpp"
+#include "utilities/result.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#ifdef RTL_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace rtl::fs {
+// Writes a file from start to end. Bytes are gathered into the current buffer, and full buffers are written in the
+// background while the next one fills, so the caller only waits when every buffer is still being written.
+//
+// With `O_DIRECT` only whole multiples of `direct_alignment` can be written, so `flush` keeps the rest of the current
+// buffer back and `close` writes it through the page cache.
+//
+// Only POSIX systems are supported for now, elsewhere `open` always fails with `std::errc::not_supported`.
+class file_writer {
+public:
+    file_writer() noexcept = default;
+
+    file_writer(const file_writer&) = delete;
+
+    file_writer(file_writer&& other) noexcept
+        : m_fd{std::exchange(other.m_fd, -1)}
+#ifdef RTL_POSIX
+        , m_queue{std::move(other.m_queue)}
+#endif
+        , m_buffers{std::move(other.m_buffers)}
+        , m_buffer_count{std::exchange(other.m_buffer_count, 0)}
+        , m_slot{other.m_slot}
+        , m_filled{std::exchange(other.m_filled, 0)}
+        , m_offset{other.m_offset}
+        , m_direct{other.m_direct}
+        , m_error{other.m_error} {
+
+    }
+
+    ~file_writer() noexcept {
+        close();
+    }
+
+    auto operator=(const file_writer&) -> file_writer& = delete;
+
+    auto operator=(file_writer&& other) noexcept -> file_writer& {
+        if (this == &other) {
+            return *this;
+        }
+
+        close();
+        m_fd = std::exchange(other.m_fd, -1);
+#ifdef RTL_POSIX
+        m_queue = std::move(other.m_queue);
+#endif
+        m_buffers = std::move(other.m_buffers);
+        m_buffer_count = std::exchange(other.m_buffer_count, 0);
+        m_slot = other.m_slot;
+        m_filled = std::exchange(other.m_filled, 0);
+        m_offset = other.m_offset;
+        m_direct = other.m_direct;
+        m_error = other.m_error;
+        return *this;
+    }
+
+    // Creates the file at `path`, or truncates it if it exists, or returns the reason it couldn't.
+    static auto open(const std::filesystem::path& path, const io_options& options = {})
+        -> utilities::result<file_writer, std::error_code> {
+#ifdef RTL_POSIX
+        auto flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+        auto direct = false;
+#ifdef O_DIRECT
+        if (options.direct) {
+            flags |= O_DIRECT;
+            direct = true;
+        }
+#endif
+        auto fd = ::open(path.c_str(), flags, 0644);
+        if (fd < 0) {
+            return utilities::failure{detail::errno_error()};
+        }
+
+        auto writer = file_writer{};
+        writer.m_fd = fd;
+        writer.m_direct = direct;
+        writer.m_buffer_count = std::max<std::size_t>(options.buffer_count, 1);
+        if (auto error = writer.m_queue.setup(fd, writer.m_buffer_count, options.backend); error) {
+            return utilities::failure{error};
+        }
+
+        auto buffer_size = (std::max<std::size_t>(options.buffer_size, 1) + direct_alignment - 1)
+            & ~(direct_alignment - 1);
+        writer.m_buffers = detail::io_buffers{buffer_size, writer.m_buffer_count};
+        return writer;
+#else
+        (void)path;
+        (void)options;
+        return utilities::failure{std::make_error_code(std::errc::not_supported)};
+#endif
+    }
+
+    // Returns false once any write has failed, see `error`.
+    auto write(std::span<const std::byte> bytes) -> bool {
+        while (!bytes.empty() && !m_error) {
+            auto count = std::min(bytes.size(), m_buffers.buffer_size() - m_filled);
+            std::memcpy(m_buffers[m_slot] + m_filled, bytes.data(), count);
+            m_filled += count;
+            bytes = bytes.subspan(count);
+
+            if (m_filled == m_buffers.buffer_size()) {
+                submit_buffer(m_filled);
+            }
+        }
+
+        return !m_error;
+    }
+
+    auto write(std::string_view chars) -> bool {
+        return write(std::as_bytes(std::span{chars}));
+    }
+
+    // Writes out everything written so far, apart from what `O_DIRECT` has to keep back, and waits for it.
+    auto flush() -> bool {
+#ifdef RTL_POSIX
+        auto length = m_direct ? m_filled & ~(direct_alignment - 1) : m_filled;
+        if (length != 0 && !m_error) {
+            auto kept = m_filled - length;
+            auto previous = m_slot;
+            submit_buffer(length);
+            // the rest moves to the start of the new current buffer, which is the same one when there's only one
+            std::memmove(m_buffers[m_slot], m_buffers[previous] + length, kept);
+            m_filled = kept;
+        }
+
+        for (std::size_t i = 0; i < m_buffer_count; i++) {
+            wait_for(i);
+        }
+#endif
+        return !m_error;
+    }
+
+    // Flushes and closes the file, returns false if anything failed to be written.
+    auto close() -> bool {
+#ifdef RTL_POSIX
+        if (m_fd < 0) {
+            return !m_error;
+        }
+
+        flush();
+        if (m_filled != 0 && !m_error) {
+            write_tail();
+        }
+
+        if (::close(m_fd) != 0 && !m_error) {
+            m_error = detail::errno_error();
+        }
+
+        m_fd = -1;
+#endif
+        return !m_error;
+    }
+
+    // Flushes and waits for the data to reach the device.
+    auto sync() -> bool {
+#ifdef RTL_POSIX
+        if (flush() && m_fd >= 0 && ::fsync(m_fd) != 0) {
+            m_error = detail::errno_error();
+        }
+#endif
+        return !m_error;
+    }
+
+    // The first error writing hit, nothing more is written after it.
+    [[nodiscard]] auto error() const noexcept -> std::error_code {
+        return m_error;
+    }
+
+    [[nodiscard]] auto uses_io_uring() const noexcept -> bool {
+#ifdef RTL_POSIX
+        return m_queue.uses_io_uring();
+#else
+        return false;
+#endif
+    }
+
+    [[nodiscard]] auto is_open() const noexcept -> bool {
+        return m_fd >= 0;
+    }
+
+private:
+    // Starts writing the first `length` bytes of the current buffer and moves on to the next buffer, waiting for it if
+    // it's still being written.
+    auto submit_buffer(std::size_t length) -> void {
+#ifdef RTL_POSIX
+        m_queue.submit(m_slot, detail::io_queue::operation::write, m_buffers[m_slot], length, m_offset);
+        m_offset += length;
+        m_slot = (m_slot + 1) % m_buffer_count;
+        m_filled = 0;
+        wait_for(m_slot);
+#else
+        (void)length;
+#endif
+    }
+
+    auto wait_for(std::size_t slot) -> void {
+#ifdef RTL_POSIX
+        if (!m_queue.pending(slot)) {
+            return;
+        }
+
+        if (auto result = m_queue.wait(slot); result < 0 && !m_error) {
+            m_error = {static_cast<int>(-result), std::system_category()};
+        }
+#else
+        (void)slot;
+#endif
+    }
+
+    // Writes what `O_DIRECT` kept back, after turning it off since the length isn't aligned.
+    auto write_tail() -> void {
+#ifdef RTL_POSIX
+#ifdef O_DIRECT
+        if (m_direct) {
+            ::fcntl(m_fd, F_SETFL, ::fcntl(m_fd, F_GETFL) & ~O_DIRECT);
+        }
+#endif
+        submit_buffer(m_filled);
+        for (std::size_t i = 0; i < m_buffer_count; i++) {
+            wait_for(i);
+        }
+#endif
+    }
+
+    int m_fd{-1};
+#ifdef RTL_POSIX
+    detail::io_queue m_queue;
+#endif
+    detail::io_buffers m_buffers;
+    std::size_t m_buffer_count{};
+    std::size_t m_slot{};
+    // bytes gathered in the current buffer
+    std::size_t m_filled{};
+    std::uint64_t m_offset{};
+    bool m_direct{};
+    std::error_code m_error{};
+}; // class file_writer
+} // namespace rtl::fs
+
+#endif // #ifndef RTL_FILE_WRITER_HPP
@@ -0,0 +1,463 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_IO_QUEUE_HPP
+#define RTL_IO_QUEUE_HPP
+
+#include "collections/list.hpp"
+#include "fs/platform.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <system_error>
+#include <utility>
+
+#ifdef RTL_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef RTL_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace rtl::fs {
+// Buffers, offsets and lengths of `O_DIRECT` transfers have to be multiples of the logical block size of the device,
+// which this covers on every common device.
+inline constexpr std::size_t direct_alignment = 4096;
+
+enum class io_backend {
+    // io_uring where the kernel allows it, otherwise synchronous calls
+    automatic,
+    io_uring,
+    synchronous,
+};
+
+struct io_options {
+    // The size of each buffer, rounded up to a multiple of `direct_alignment`.
+    std::size_t buffer_size{1024 * 1024};
+    // The number of buffers, so at most this many transfers are in flight while the caller fills or drains another.
+    // Two is double buffering.
+    std::size_t buffer_count{2};
+    // Bypasses the page cache with `O_DIRECT` where the platform has it.
+    bool direct{false};
+    io_backend backend{io_backend::automatic};
+};
+
+namespace detail {
+inline auto errno_error() noexcept -> std::error_code {
+    return {errno, std::system_category()};
+}
+
+// Buffers for every slot of an `io_queue` in one allocation, aligned for `O_DIRECT`.
+class io_buffers {
+public:
+    io_buffers() noexcept = default;
+
+    io_buffers(std::size_t buffer_size, std::size_t buffer_count)
+        : m_data{static_cast<std::byte*>(::operator new(buffer_size * buffer_count, std::align_val_t{direct_alignment}))}
+        , m_buffer_size{buffer_size} {
+
+    }
+
+    io_buffers(const io_buffers&) = delete;
+
+    io_buffers(io_buffers&& other) noexcept
+        : m_data{std::exchange(other.m_data, nullptr)}
+        , m_buffer_size{std::exchange(other.m_buffer_size, 0)} {
+
+    }
+
+    ~io_buffers() noexcept {
+        if (m_data != nullptr) {
+            ::operator delete(m_data, std::align_val_t{direct_alignment});
+        }
+    }
+
+    auto operator=(const io_buffers&) -> io_buffers& = delete;
+
+    auto operator=(io_buffers&& other) noexcept -> io_buffers& {
+        std::swap(m_data, other.m_data);
+        std::swap(m_buffer_size, other.m_buffer_size);
+        return *this;
+    }
+
+    auto operator[](std::size_t index) const noexcept -> std::byte* {
+        return m_data + index * m_buffer_size;
+    }
+
+    [[nodiscard]] auto buffer_size() const noexcept -> std::size_t {
+        return m_buffer_size;
+    }
+
+private:
+    std::byte* m_data{};
+    std::size_t m_buffer_size{};
+}; // class io_buffers
+
+#ifdef RTL_IO_URING
+// A minimal io_uring instance driven through the raw system calls. Only one thread submits and reaps, so the ring
+// indices this side owns are accessed plainly and only the ones the kernel writes need acquire and release.
+class io_ring {
+public:
+    io_ring() noexcept = default;
+
+    io_ring(const io_ring&) = delete;
+
+    io_ring(io_ring&& other) noexcept {
+        swap(other);
+    }
+
+    ~io_ring() noexcept {
+        if (m_fd < 0) {
+            return;
+        }
+
+        ::munmap(m_sqes, m_sqes_size);
+        if (m_cq_ring != m_sq_ring) {
+            ::munmap(m_cq_ring, m_cq_size);
+        }
+        ::munmap(m_sq_ring, m_sq_size);
+        ::close(m_fd);
+    }
+
+    auto operator=(const io_ring&) -> io_ring& = delete;
+
+    auto operator=(io_ring&& other) noexcept -> io_ring& {
+        swap(other);
+        return *this;
+    }
+
+    // Fails when the kernel doesn't have io_uring or it has been disabled, as it often is in containers.
+    auto setup(std::uint32_t entries) noexcept -> bool {
+        auto params = io_uring_params{};
+        auto fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) {
+            return false;
+        }
+
+        m_fd = fd;
+        m_sq_size = params.sq_off.array + params.sq_entries * sizeof(std::uint32_t);
+        m_cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        auto single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            m_sq_size = m_cq_size = std::max(m_sq_size, m_cq_size);
+        }
+
+        m_sq_ring = map(m_sq_size, IORING_OFF_SQ_RING);
+        m_cq_ring = single_mmap ? m_sq_ring : map(m_cq_size, IORING_OFF_CQ_RING);
+        m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        m_sqes = static_cast<io_uring_sqe*>(map(m_sqes_size, IORING_OFF_SQES));
+        if (m_sq_ring == MAP_FAILED || m_cq_ring == MAP_FAILED || m_sqes == MAP_FAILED) {
+            // unmap whatever did succeed
+            m_sq_ring = m_sq_ring == MAP_FAILED ? nullptr : m_sq_ring;
+            m_cq_ring = m_cq_ring == MAP_FAILED ? nullptr : m_cq_ring;
+            m_sqes = m_sqes == MAP_FAILED ? nullptr : m_sqes;
+            *this = io_ring{};
+            return false;
+        }
+
+        auto sq = static_cast<std::byte*>(m_sq_ring);
+        auto cq = static_cast<std::byte*>(m_cq_ring);
+        m_sq_head = reinterpret_cast<std::uint32_t*>(sq + params.sq_off.head);
+        m_sq_tail = reinterpret_cast<std::uint32_t*>(sq + params.sq_off.tail);
+        m_sq_mask = *reinterpret_cast<std::uint32_t*>(sq + params.sq_off.ring_mask);
+        m_sq_array = reinterpret_cast<std::uint32_t*>(sq + params.sq_off.array);
+        m_cq_head = reinterpret_cast<std::uint32_t*>(cq + params.cq_off.head);
+        m_cq_tail = reinterpret_cast<std::uint32_t*>(cq + params.cq_off.tail);
+        m_cq_mask = *reinterpret_cast<std::uint32_t*>(cq + params.cq_off.ring_mask);
+        m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    [[nodiscard]] auto active() const noexcept -> bool {
+        return m_fd >= 0;
+    }
+
+    // The longest transfer one entry asks for, a multiple of `direct_alignment` whose byte count fits the result of a
+    // completion. Longer transfers come back short and the caller transfers the rest.
+    static constexpr std::size_t max_length = static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())
+        & ~(direct_alignment - 1);
+
+    // Queues one transfer of up to `max_length` bytes and passes it to the kernel. On failure the entry is taken back
+    // off the ring, so no completion will arrive for it. The caller must never have more operations in flight than the
+    // ring has entries.
+    auto submit(std::uint8_t opcode, int fd, void* buffer, std::size_t length, std::uint64_t offset,
+                std::uint64_t user_data) noexcept -> int {
+        auto tail = *m_sq_tail;
+        auto index = tail & m_sq_mask;
+        auto& sqe = m_sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = opcode;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<std::uint64_t>(buffer);
+        sqe.len = static_cast<std::uint32_t>(std::min(length, max_length));
+        sqe.off = offset;
+        sqe.user_data = user_data;
+        m_sq_array[index] = index;
+        std::atomic_ref{*m_sq_tail}.store(tail + 1, std::memory_order_release);
+
+        while (true) {
+            auto submitted = ::syscall(__NR_io_uring_enter, m_fd, 1, 0, 0, nullptr, 0);
+            if (submitted >= 0) {
+                return 0;
+            } else if (errno != EINTR && errno != EAGAIN) {
+                break;
+            }
+        }
+
+        // the kernel doesn't normally take entries when enter fails, but if it did the completion is on the way
+        auto error = errno;
+        if (std::atomic_ref{*m_sq_head}.load(std::memory_order_acquire) != tail) {
+            return 0;
+        }
+
+        std::atomic_ref{*m_sq_tail}.store(tail, std::memory_order_release);
+        return -error;
+    }
+
+    // Waits for at least one completion and passes every available one to `on_completion(user_data, result)`.
+    template<typename F>
+    auto reap(F&& on_completion) noexcept -> int {
+        auto head = *m_cq_head;
+        while (head == std::atomic_ref{*m_cq_tail}.load(std::memory_order_acquire)) {
+            auto result = ::syscall(__NR_io_uring_enter, m_fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (result < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                return -errno;
+            }
+        }
+
+        auto tail = std::atomic_ref{*m_cq_tail}.load(std::memory_order_acquire);
+        for (; head != tail; head++) {
+            const auto& cqe = m_cqes[head & m_cq_mask];
+            on_completion(cqe.user_data, cqe.res);
+        }
+
+        std::atomic_ref{*m_cq_head}.store(head, std::memory_order_release);
+        return 0;
+    }
+
+private:
+    auto map(std::size_t size, std::uint64_t offset) const noexcept -> void* {
+        return ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd,
+            static_cast<off_t>(offset));
+    }
+
+    auto swap(io_ring& other) noexcept -> void {
+        std::swap(m_fd, other.m_fd);
+        std::swap(m_sq_ring, other.m_sq_ring);
+        std::swap(m_cq_ring, other.m_cq_ring);
+        std::swap(m_sqes, other.m_sqes);
+        std::swap(m_sq_size, other.m_sq_size);
+        std::swap(m_cq_size, other.m_cq_size);
+        std::swap(m_sqes_size, other.m_sqes_size);
+        std::swap(m_sq_head, other.m_sq_head);
+        std::swap(m_sq_tail, other.m_sq_tail);
+        std::swap(m_sq_array, other.m_sq_array);
+        std::swap(m_sq_mask, other.m_sq_mask);
+        std::swap(m_cq_head, other.m_cq_head);
+        std::swap(m_cq_tail, other.m_cq_tail);
+        std::swap(m_cq_mask, other.m_cq_mask);
+        std::swap(m_cqes, other.m_cqes);
+    }
+
+    int m_fd{-1};
+    void* m_sq_ring{};
+    void* m_cq_ring{};
+    io_uring_sqe* m_sqes{};
+    std::size_t m_sq_size{};
+    std::size_t m_cq_size{};
+    std::size_t m_sqes_size{};
+    std::uint32_t* m_sq_head{};
+    std::uint32_t* m_sq_tail{};
+    std::uint32_t* m_sq_array{};
+    std::uint32_t m_sq_mask{};
+    std::uint32_t* m_cq_head{};
+    std::uint32_t* m_cq_tail{};
+    std::uint32_t m_cq_mask{};
+    io_uring_cqe* m_cqes{};
+}; // class io_ring
+#endif
+
+#ifdef RTL_POSIX
+// Reads and writes of whole buffers at explicit offsets, one per slot, with at most one transfer in flight per slot.
+// With io_uring the transfers run in the background until `wait`, otherwise `submit` performs them straight away with
+// `pread`/`pwrite`. Either way a transfer is complete when `wait` returns: short transfers are finished synchronously,
+// so only the end of the file or an error leave a read short.
+class io_queue {
+public:
+    enum class operation : std::uint8_t {
+        read,
+        write,
+    };
+
+    io_queue() noexcept = default;
+
+    // Fails with `std::errc::not_supported` if `io_backend::io_uring` is asked for and can't be set up.
+    auto setup(int fd, std::size_t slot_count, io_backend backend) -> std::error_code {
+        m_fd = fd;
+        m_slots = collections::list<slot>(slot_count);
+#ifdef RTL_IO_URING
+        if (backend != io_backend::synchronous
+                && m_ring.setup(static_cast<std::uint32_t>(std::bit_ceil(slot_count)))) {
+            return {};
+        }
+#endif
+        if (backend == io_backend::io_uring) {
+            return std::make_error_code(std::errc::not_supported);
+        }
+
+        return {};
+    }
+
+    [[nodiscard]] auto uses_io_uring() const noexcept -> bool {
+#ifdef RTL_IO_URING
+        return m_ring.active() && !m_ring_failed;
+#else
+        return false;
+#endif
+    }
+
+    // `buffer` must stay valid until the slot has been waited for. Transfers the ring won't take, and the part of a
+    // transfer past `io_ring::max_length`, are done synchronously.
+    auto submit(std::size_t index, operation op, std::byte* buffer, std::size_t length, std::uint64_t offset) noexcept
+        -> void {
+        auto& slot = m_slots.data()[index];
+        slot = {buffer, length, offset, 0, op, true};
+#ifdef RTL_IO_URING
+        if (uses_io_uring()) {
+            auto opcode = op == operation::read ? IORING_OP_READ : IORING_OP_WRITE;
+            if (m_ring.submit(static_cast<std::uint8_t>(opcode), m_fd, buffer, length, offset, index) < 0) {
+                // the entry was taken back off the ring, so the kernel won't touch the buffer
+                complete(slot, 0);
+            }
+
+            return;
+        }
+#endif
+        complete(slot, 0);
+    }
+
+    // The number of bytes transferred, or the negated error number.
+    auto wait(std::size_t index) noexcept -> std::int64_t {
+        auto& slot = m_slots.data()[index];
+#ifdef RTL_IO_URING
+        while (slot.pending) {
+            auto result = m_ring.reap([this](std::uint64_t user_data, std::int32_t result) {
+                complete(m_slots.data()[user_data], result);
+            });
+
+            if (result < 0) {
+                fail_pending(result);
+            }
+        }
+#endif
+        return slot.result;
+    }
+
+    [[nodiscard]] auto pending(std::size_t index) const noexcept -> bool {
+        return m_slots.data()[index].pending;
+    }
+
+    // Waits for every slot, for before the buffers or the file go away.
+    auto drain() noexcept -> void {
+        for (std::size_t i = 0; i < m_slots.size(); i++) {
+            wait(i);
+        }
+    }
+
+private:
+    struct slot {
+        std::byte* buffer;
+        std::size_t length;
+        std::uint64_t offset;
+        std::int64_t result;
+        operation op;
+        bool pending;
+    };
+
+    // Records the result of the asynchronous part of a transfer, `done` bytes, and transfers the rest synchronously.
+    // Kernels that have io_uring but not its read and write operations land here too.
+    auto complete(slot& slot, std::int64_t done) noexcept -> void {
+        if (done == -EINVAL || done == -EOPNOTSUPP) {
+            done = 0;
+        }
+
+        while (done >= 0 && static_cast<std::size_t>(done) < slot.length) {
+            auto buffer = slot.buffer + done;
+            auto length = slot.length - static_cast<std::size_t>(done);
+            auto offset = static_cast<off_t>(slot.offset + static_cast<std::uint64_t>(done));
+            auto transferred = slot.op == operation::read
+                ? ::pread(m_fd, buffer, length, offset)
+                : ::pwrite(m_fd, buffer, length, offset);
+
+            if (transferred < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                done = -errno;
+            } else if (transferred == 0) {
+                // the end of the file, reads only
+                break;
+            } else {
+                done += transferred;
+            }
+        }
+
+        slot.result = done;
+        slot.pending = false;
+    }
+
+#ifdef RTL_IO_URING
+    // The transfers in flight can't be reaped, and the kernel may still finish them, so rather than transferring their
+    // bytes a second time every pending slot fails with `error`. The ring isn't used again.
+    auto fail_pending(std::int64_t error) noexcept -> void {
+        for (auto& slot : m_slots) {
+            if (slot.pending) {
+                slot.result = error;
+                slot.pending = false;
+            }
+        }
+
+        m_ring_failed = true;
+    }
+#endif
+
+    int m_fd{-1};
+    collections::list<slot> m_slots;
+#ifdef RTL_IO_URING
+    io_ring m_ring;
+    bool m_ring_failed{false};
+#endif
+}; // class io_queue
+#endif
+} // namespace detail
+} // namespace rtl::fs
+
+#endif // #ifndef RTL_IO_QUEUE_HPP
@@ -0,0 +1,246 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_MAPPED_FILE_HPP
+#define RTL_MAPPED_FILE_HPP
+
+#include "fs/platform.hpp"
+#include "utilities/result.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#ifdef RTL_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rtl::fs {
+// How a mapping is going to be read, passed on to the kernel to tune read-ahead.
+enum class access_pattern {
+    normal,
+    sequential,
+    random,
+};
+
+struct map_options {
+    access_pattern pattern{access_pattern::normal};
+    // Starts reading the whole file in the background straight away.
+    bool will_need{false};
+    // Reads the whole file in before `open` returns, so touching a page never faults. Linux only.
+    bool populate{false};
+    // Asks for the mapping to be backed by transparent huge pages, which cuts TLB misses on large files. Linux only,
+    // and only honoured for files when the kernel supports huge pages in the page cache.
+    bool huge_pages{false};
+};
+
+// A read-only view of a whole file mapped into memory, which is unmapped when the `mapped_file` is destroyed. Like
+// `memory::unique_ptr` it is move-only, and a moved from or default constructed `mapped_file` is empty. Empty files
+// are never mapped and give an empty span.
+//
+// Only POSIX systems are supported for now, elsewhere `open` always fails with `std::errc::not_supported`.
+class mapped_file {
+public:
+    mapped_file() noexcept = default;
+
+    mapped_file(const mapped_file&) = delete;
+
+    mapped_file(mapped_file&& other) noexcept
+        : m_data{std::exchange(other.m_data, nullptr)}
+        , m_size{std::exchange(other.m_size, 0)} {
+
+    }
+
+    ~mapped_file() noexcept {
+        unmap();
+    }
+
+    auto operator=(const mapped_file&) -> mapped_file& = delete;
+
+    auto operator=(mapped_file&& other) noexcept -> mapped_file& {
+        if (this == &other) {
+            return *this;
+        }
+
+        unmap();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        return *this;
+    }
+
+    // Maps the file at `path`, or returns the reason it couldn't be.
+    static auto open(const std::filesystem::path& path, const map_options& options = {})
+        -> utilities::result<mapped_file, std::error_code> {
+#ifdef RTL_POSIX
+        auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return utilities::failure{last_error()};
+        }
+
+        // the mapping keeps the file open by itself
+        auto file = map(fd, options);
+        ::close(fd);
+        return file;
+#else
+        (void)path;
+        (void)options;
+        return utilities::failure{std::make_error_code(std::errc::not_supported)};
+#endif
+    }
+
+    // access
+
+    [[nodiscard]] auto bytes() const noexcept -> std::span<const std::byte> {
+        return {m_data, m_size};
+    }
+
+    [[nodiscard]] auto data() const noexcept -> const std::byte* {
+        return m_data;
+    }
+
+    // The contents as characters, for text formats.
+    [[nodiscard]] auto view() const noexcept -> std::string_view {
+        return {reinterpret_cast<const char*>(m_data), m_size};
+    }
+
+    [[nodiscard]] auto size() const noexcept -> std::size_t {
+        return m_size;
+    }
+
+    [[nodiscard]] auto empty() const noexcept -> bool {
+        return m_size == 0;
+    }
+
+    // hints, which the kernel is free to ignore, so failures are only reported and never fatal
+
+    auto advise(access_pattern pattern) const noexcept -> bool {
+#ifdef RTL_POSIX
+        auto advice = pattern == access_pattern::sequential ? MADV_SEQUENTIAL
+            : pattern == access_pattern::random ? MADV_RANDOM
+            : MADV_NORMAL;
+        return advise_range(0, m_size, advice);
+#else
+        (void)pattern;
+        return false;
+#endif
+    }
+
+    // Starts reading `length` bytes from `offset` in the background, clamped to the end of the file.
+    auto prefetch(std::size_t offset, std::size_t length) const noexcept -> bool {
+#ifdef RTL_POSIX
+        return advise_range(offset, length, MADV_WILLNEED);
+#else
+        (void)offset;
+        (void)length;
+        return false;
+#endif
+    }
+
+private:
+    mapped_file(const std::byte* data, std::size_t size) noexcept : m_data{data}, m_size{size} {
+
+    }
+
+#ifdef RTL_POSIX
+    static auto last_error() noexcept -> std::error_code {
+        return {errno, std::system_category()};
+    }
+
+    static auto map(int fd, const map_options& options) -> utilities::result<mapped_file, std::error_code> {
+        struct stat status{};
+        if (::fstat(fd, &status) != 0) {
+            return utilities::failure{last_error()};
+        } else if (!S_ISREG(status.st_mode)) {
+            return utilities::failure{std::make_error_code(S_ISDIR(status.st_mode) ? std::errc::is_a_directory
+                                                                                   : std::errc::invalid_argument)};
+        } else if (static_cast<std::make_unsigned_t<off_t>>(status.st_size) > std::numeric_limits<std::size_t>::max()) {
+            return utilities::failure{std::make_error_code(std::errc::file_too_large)};
+        }
+
+        auto size = static_cast<std::size_t>(status.st_size);
+        if (size == 0) {
+            return mapped_file{};
+        }
+
+        auto flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+        if (options.populate) {
+            flags |= MAP_POPULATE;
+        }
+#endif
+
+        auto address = ::mmap(nullptr, size, PROT_READ, flags, fd, 0);
+        if (address == MAP_FAILED) {
+            return utilities::failure{last_error()};
+        }
+
+        auto file = mapped_file{static_cast<const std::byte*>(address), size};
+#ifdef MADV_HUGEPAGE
+        if (options.huge_pages) {
+            file.advise_range(0, size, MADV_HUGEPAGE);
+        }
+#endif
+        if (options.pattern != access_pattern::normal) {
+            file.advise(options.pattern);
+        }
+
+        if (options.will_need) {
+            file.prefetch(0, size);
+        }
+
+        return file;
+    }
+
+    auto advise_range(std::size_t offset, std::size_t length, int advice) const noexcept -> bool {
+        if (offset >= m_size) {
+            return false;
+        }
+
+        // madvise wants a page aligned start
+        auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        auto start = offset - offset % page_size;
+        length = std::min(length, m_size - offset) + (offset - start);
+        return ::madvise(const_cast<std::byte*>(m_data) + start, length, advice) == 0;
+    }
+#endif
+
+    auto unmap() noexcept -> void {
+#ifdef RTL_POSIX
+        if (m_data != nullptr) {
+            ::munmap(const_cast<std::byte*>(m_data), m_size);
+        }
+#endif
+    }
+
+    const std::byte* m_data{};
+    std::size_t m_size{};
+}; // class mapped_file
+} // namespace rtl::fs
+
+#endif // #ifndef RTL_MAPPED_FILE_HPP
@@ -0,0 +1,658 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_JSON_DOCUMENT_HPP
+#define RTL_JSON_DOCUMENT_HPP
+
+#include "collections/list.hpp"
+#include "fs/mapped_file.hpp"
+#include "json/structural_index.hpp"
+#include "strings/search.hpp"
+#include "strings/string.hpp"
+#include "utilities/option.hpp"
+#include "utilities/result.hpp"
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+namespace rtl::json {
+enum class parse_error {
+    none,
+    empty,
+    // the index only addresses the first 4 GiB
+    too_large,
+    unclosed_string,
+    unbalanced_brackets,
+    trailing_content,
+};
+
+enum class value_type {
+    object,
+    array,
+    string,
+    number,
+    boolean,
+    null,
+    invalid,
+};
+
+class document;
+class object;
+class array;
+
+namespace detail {
+inline auto append_utf8(std::uint32_t code_point, strings::string& output) -> void {
+    if (code_point < 0x80) {
+        output.add(static_cast<char>(code_point));
+    } else if (code_point < 0x800) {
+        output.add(static_cast<char>(0xC0 | (code_point >> 6)));
+        output.add(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else if (code_point < 0x10000) {
+        output.add(static_cast<char>(0xE0 | (code_point >> 12)));
+        output.add(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        output.add(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else {
+        output.add(static_cast<char>(0xF0 | (code_point >> 18)));
+        output.add(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        output.add(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        output.add(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+}
+
+// Reads the four hex digits of a `\u` escape starting at `chars[index]`.
+inline auto read_hex4(std::string_view chars, std::size_t index) noexcept -> utilities::option<std::uint32_t> {
+    if (chars.size() - index < 4) {
+        return utilities::nullopt;
+    }
+
+    std::uint32_t value = 0;
+    auto [end, error] = std::from_chars(chars.data() + index, chars.data() + index + 4, value, 16);
+    if (error != std::errc{} || end != chars.data() + index + 4) {
+        return utilities::nullopt;
+    }
+
+    return value;
+}
+
+// Appends the characters of the body of a string with its escapes decoded, returns false on an invalid escape.
+inline auto decode_string(std::string_view raw, strings::string& output) -> bool {
+    output.reserve(output.size() + raw.size());
+    std::size_t i = 0;
+    while (i < raw.size()) {
+        auto backslash = i + strings::detail::find_char(raw.data() + i, raw.size() - i, '\\');
+        output.append(raw.substr(i, backslash - i));
+        if (backslash == raw.size() || backslash + 1 == raw.size()) {
+            return backslash == raw.size();
+        }
+
+        i = backslash + 2;
+        switch (raw[backslash + 1]) {
+            case '"':
+                output.add('"');
+                break;
+            case '\\':
+                output.add('\\');
+                break;
+            case '/':
+                output.add('/');
+                break;
+            case 'b':
+                output.add('\b');
+                break;
+            case 'f':
+                output.add('\f');
+                break;
+            case 'n':
+                output.add('\n');
+                break;
+            case 'r':
+                output.add('\r');
+                break;
+            case 't':
+                output.add('\t');
+                break;
+            case 'u': {
+                auto code_point = read_hex4(raw, i);
+                if (!code_point) {
+                    return false;
+                }
+
+                i += 4;
+                if (*code_point >= 0xD800 && *code_point < 0xDC00) {
+                    // a high surrogate has to be followed by an escaped low one
+                    auto low = raw.substr(i).starts_with("\\u") ? read_hex4(raw, i + 2) : utilities::nullopt;
+                    if (!low || *low < 0xDC00 || *low >= 0xE000) {
+                        return false;
+                    }
+
+                    i += 6;
+                    *code_point = 0x10000 + ((*code_point - 0xD800) << 10) + (*low - 0xDC00);
+                } else if (*code_point >= 0xDC00 && *code_point < 0xE000) {
+                    return false;
+                }
+
+                append_utf8(*code_point, output);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+} // namespace detail
+
+// A value somewhere in a `document`, which is only looked at when asked for. Lookups that find the document isn't
+// valid JSON where they look return nothing, but the rest of the document is never checked. A value refers to its
+// document, which must outlive it and not be moved.
+class value {
+public:
+    [[nodiscard]] auto type() const noexcept -> value_type;
+
+    // The text of the value as it appears in the input. Strings include their quotes.
+    [[nodiscard]] auto raw() const noexcept -> std::string_view;
+
+    // objects and arrays
+
+    auto as_object() const noexcept -> utilities::option<object>;
+    auto as_array() const noexcept -> utilities::option<array>;
+
+    // The member `key` of an object, keys are compared as they appear in the input, without decoding escapes.
+    auto operator[](std::string_view key) const noexcept -> utilities::option<value>;
+
+    // The element at `index` of an array.
+    auto at(std::size_t index) const noexcept -> utilities::option<value>;
+
+    // scalars
+
+    // The body of a string as it appears in the input, with its escapes still encoded.
+    auto get_string() const noexcept -> utilities::option<std::string_view> {
+        if (type() != value_type::string) {
+            return utilities::nullopt;
+        }
+
+        auto text = raw();
+        return text.substr(1, text.size() - 2);
+    }
+
+    // The body of a string with its escapes decoded.
+    auto decode_string() const -> utilities::option<strings::string> {
+        auto output = strings::string{};
+        if (!decode_string(output)) {
+            return utilities::nullopt;
+        }
+
+        return output;
+    }
+
+    // Appends the body of a string with its escapes decoded to `output`, so a buffer can be reused. Returns false if
+    // the value isn't a string or has an invalid escape.
+    auto decode_string(strings::string& output) const -> bool {
+        auto body = get_string();
+        return body && detail::decode_string(*body, output);
+    }
+
+    auto get_int64() const noexcept -> utilities::option<std::int64_t> {
+        return parse_number<std::int64_t>();
+    }
+
+    auto get_uint64() const noexcept -> utilities::option<std::uint64_t> {
+        return parse_number<std::uint64_t>();
+    }
+
+    auto get_double() const noexcept -> utilities::option<double> {
+        return parse_number<double>();
+    }
+
+    auto get_bool() const noexcept -> utilities::option<bool> {
+        auto text = raw();
+        if (text == "true") {
+            return true;
+        } else if (text == "false") {
+            return false;
+        }
+
+        return utilities::nullopt;
+    }
+
+    [[nodiscard]] auto is_null() const noexcept -> bool {
+        return raw() == "null";
+    }
+
+private:
+    friend class document;
+    friend class object;
+    friend class array;
+
+    value(const document* document, std::uint32_t token) noexcept : m_document{document}, m_token{token} {
+
+    }
+
+    template<typename T>
+    auto parse_number() const noexcept -> utilities::option<T> {
+        if (type() != value_type::number) {
+            return utilities::nullopt;
+        }
+
+        auto text = raw();
+        auto result = T{};
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), result);
+        if (error != std::errc{} || end != text.data() + text.size()) {
+            return utilities::nullopt;
+        }
+
+        return result;
+    }
+
+    const document* m_document;
+    std::uint32_t m_token;
+}; // class value
+
+// A member of an object, the key is as it appears in the input, without its quotes and with its escapes encoded.
+struct field {
+    std::string_view key;
+    json::value value;
+};
+
+// A parsed JSON input: the input itself and the offsets of its structural characters, with the matching closing
+// bracket of every opening one. Values are read from the input when they're asked for, so the input must outlive the
+// document.
+class document {
+public:
+    document(const document&) = delete;
+    document(document&&) noexcept = default;
+    auto operator=(const document&) -> document& = delete;
+    auto operator=(document&&) noexcept -> document& = default;
+
+    static auto parse(std::string_view input) -> utilities::result<document, parse_error> {
+        if (input.size() >= std::numeric_limits<std::uint32_t>::max()) {
+            return utilities::failure{parse_error::too_large};
+        }
+
+        auto result = document{input};
+        if (!detail::build_structural_index(input, result.m_offsets)) {
+            return utilities::failure{parse_error::unclosed_string};
+        } else if (result.m_offsets.empty()) {
+            return utilities::failure{parse_error::empty};
+        } else if (auto error = result.match_brackets(); error != parse_error::none) {
+            return utilities::failure{error};
+        } else if (result.after(0) != result.token_count()) {
+            return utilities::failure{parse_error::trailing_content};
+        }
+
+        return result;
+    }
+
+    // The file must stay mapped for as long as the document is used.
+    static auto parse(const fs::mapped_file& file) -> utilities::result<document, parse_error> {
+        return parse(file.view());
+    }
+
+    auto root() const noexcept -> value {
+        return {this, 0};
+    }
+
+    auto input() const noexcept -> std::string_view {
+        return m_input;
+    }
+
+private:
+    friend class value;
+    friend class object;
+    friend class array;
+
+    explicit document(std::string_view input) noexcept : m_input{input} {
+
+    }
+
+    auto token_count() const noexcept -> std::uint32_t {
+        return static_cast<std::uint32_t>(m_offsets.size());
+    }
+
+    auto char_at(std::uint32_t token) const noexcept -> char {
+        return m_input[m_offsets.data()[token]];
+    }
+
+    // The matching closing bracket of the object or array at `token`.
+    auto close_of(std::uint32_t token) const noexcept -> std::uint32_t {
+        return m_matching.data()[token];
+    }
+
+    // The token after the value starting at `token`.
+    auto after(std::uint32_t token) const noexcept -> std::uint32_t {
+        switch (char_at(token)) {
+            case '{':
+            case '[':
+                return close_of(token) + 1;
+            case '"':
+                return token + 2;
+            default:
+                return token + 1;
+        }
+    }
+
+    auto match_brackets() -> parse_error {
+        m_matching = collections::list<std::uint32_t>(m_offsets.size(), 0);
+        auto open = collections::list<std::uint32_t>{};
+        for (std::uint32_t token = 0; token < token_count(); token++) {
+            auto c = char_at(token);
+            if (c == '{' || c == '[') {
+                open.add(token);
+            } else if (c == '}' || c == ']') {
+                if (open.empty() || char_at(open.back_unchecked()) != (c == '}' ? '{' : '[')) {
+                    return parse_error::unbalanced_brackets;
+                }
+
+                m_matching.data()[open.pop()] = token;
+            }
+        }
+
+        return open.empty() ? parse_error::none : parse_error::unbalanced_brackets;
+    }
+
+    std::string_view m_input;
+    collections::list<std::uint32_t> m_offsets;
+    collections::list<std::uint32_t> m_matching;
+}; // class document
+
+class object {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = field;
+        using reference = field;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() noexcept = default;
+
+        auto operator*() const noexcept -> field {
+            auto key = m_document->m_offsets.data()[m_token] + 1;
+            auto key_end = m_document->m_offsets.data()[m_token + 1];
+            return {m_document->m_input.substr(key, key_end - key), value{m_document, m_token + 3}};
+        }
+
+        auto operator++() noexcept -> iterator& {
+            auto next = m_document->after(m_token + 3);
+            m_token = next < m_close && m_document->char_at(next) == ',' ? checked(next + 1) : m_close;
+            return *this;
+        }
+
+        auto operator++(int) noexcept -> iterator {
+            auto temp = *this;
+            ++(*this);
+            return temp;
+        }
+
+        friend auto operator==(const iterator& a, const iterator& b) noexcept -> bool {
+            return a.m_token == b.m_token;
+        }
+
+    private:
+        friend class object;
+
+        iterator(const document* document, std::uint32_t token, std::uint32_t close) noexcept
+            : m_document{document}
+            , m_token{token}
+            , m_close{close} {
+            m_token = checked(token);
+        }
+
+        // `token` if a member starts there, which is a key, a colon and a value, otherwise the end
+        auto checked(std::uint32_t token) const noexcept -> std::uint32_t {
+            auto valid = token + 3 < m_close
+                && m_document->char_at(token) == '"'
+                && m_document->char_at(token + 2) == ':';
+            return valid ? token : m_close;
+        }
+
+        const document* m_document{};
+        std::uint32_t m_token{};
+        std::uint32_t m_close{};
+    }; // class iterator
+
+    auto begin() const noexcept -> iterator {
+        return {m_document, m_token + 1, m_document->close_of(m_token)};
+    }
+
+    auto end() const noexcept -> iterator {
+        auto close = m_document->close_of(m_token);
+        return {m_document, close, close};
+    }
+
+    // Compares keys as they appear in the input, without decoding escapes. With duplicate keys the first one wins.
+    auto find(std::string_view key) const noexcept -> utilities::option<value> {
+        for (auto member : *this) {
+            if (member.key == key) {
+                return member.value;
+            }
+        }
+
+        return utilities::nullopt;
+    }
+
+    auto operator[](std::string_view key) const noexcept -> utilities::option<value> {
+        return find(key);
+    }
+
+    // Walks the whole object.
+    [[nodiscard]] auto size() const noexcept -> std::size_t {
+        return static_cast<std::size_t>(std::distance(begin(), end()));
+    }
+
+    [[nodiscard]] auto empty() const noexcept -> bool {
+        return begin() == end();
+    }
+
+private:
+    friend class value;
+
+    object(const document* document, std::uint32_t token) noexcept : m_document{document}, m_token{token} {
+
+    }
+
+    const document* m_document;
+    std::uint32_t m_token;
+}; // class object
+
+class array {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = json::value;
+        using reference = json::value;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() noexcept = default;
+
+        auto operator*() const noexcept -> json::value {
+            return {m_document, m_token};
+        }
+
+        auto operator++() noexcept -> iterator& {
+            auto next = m_document->after(m_token);
+            auto has_next = next < m_close && m_document->char_at(next) == ',' && next + 1 < m_close;
+            m_token = has_next ? next + 1 : m_close;
+            return *this;
+        }
+
+        auto operator++(int) noexcept -> iterator {
+            auto temp = *this;
+            ++(*this);
+            return temp;
+        }
+
+        friend auto operator==(const iterator& a, const iterator& b) noexcept -> bool {
+            return a.m_token == b.m_token;
+        }
+
+    private:
+        friend class array;
+
+        iterator(const document* document, std::uint32_t token, std::uint32_t close) noexcept
+            : m_document{document}
+            , m_token{token}
+            , m_close{close} {
+
+        }
+
+        const document* m_document{};
+        std::uint32_t m_token{};
+        std::uint32_t m_close{};
+    }; // class iterator
+
+    auto begin() const noexcept -> iterator {
+        return {m_document, m_token + 1, m_document->close_of(m_token)};
+    }
+
+    auto end() const noexcept -> iterator {
+        auto close = m_document->close_of(m_token);
+        return {m_document, close, close};
+    }
+
+    // Walks the array up to `index`.
+    auto at(std::size_t index) const noexcept -> utilities::option<value> {
+        for (auto element : *this) {
+            if (index-- == 0) {
+                return element;
+            }
+        }
+
+        return utilities::nullopt;
+    }
+
+    // Walks the whole array.
+    [[nodiscard]] auto size() const noexcept -> std::size_t {
+        return static_cast<std::size_t>(std::distance(begin(), end()));
+    }
+
+    [[nodiscard]] auto empty() const noexcept -> bool {
+        return begin() == end();
+    }
+
+private:
+    friend class value;
+
+    array(const document* document, std::uint32_t token) noexcept : m_document{document}, m_token{token} {
+
+    }
+
+    const document* m_document;
+    std::uint32_t m_token;
+}; // class array
+
+inline auto value::type() const noexcept -> value_type {
+    switch (m_document->char_at(m_token)) {
+        case '{':
+            return value_type::object;
+        case '[':
+            return value_type::array;
+        case '"':
+            return value_type::string;
+        case 't':
+        case 'f':
+            return value_type::boolean;
+        case 'n':
+            return value_type::null;
+        case '-':
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9':
+            return value_type::number;
+        default:
+            return value_type::invalid;
+    }
+}
+
+inline auto value::raw() const noexcept -> std::string_view {
+    const auto& offsets = m_document->m_offsets;
+    auto start = offsets.data()[m_token];
+    auto next = m_document->after(m_token);
+    std::size_t end = 0;
+    switch (m_document->char_at(m_token)) {
+        case '{':
+        case '[':
+        case '"':
+            // up to and including the closing bracket or quote
+            end = offsets.data()[next - 1] + 1;
+            break;
+        default: {
+            // up to the next structural character, less the whitespace before it
+            end = next < offsets.size() ? offsets.data()[next] : m_document->m_input.size();
+            auto text = m_document->m_input.substr(start, end - start);
+            return text.substr(0, text.find_last_not_of(" \t\n\r") + 1);
+        }
+    }
+
+    return m_document->m_input.substr(start, end - start);
+}
+
+inline auto value::as_object() const noexcept -> utilities::option<object> {
+    if (type() != value_type::object) {
+        return utilities::nullopt;
+    }
+
+    return object{m_document, m_token};
+}
+
+inline auto value::as_array() const noexcept -> utilities::option<array> {
+    if (type() != value_type::array) {
+        return utilities::nullopt;
+    }
+
+    return array{m_document, m_token};
+}
+
+inline auto value::operator[](std::string_view key) const noexcept -> utilities::option<value> {
+    return as_object().and_then([key](const object& object) {
+        return object.find(key);
+    });
+}
+
+inline auto value::at(std::size_t index) const noexcept -> utilities::option<value> {
+    return as_array().and_then([index](const array& array) {
+        return array.at(index);
+    });
+}
+
+inline auto parse(std::string_view input) -> utilities::result<document, parse_error> {
+    return document::parse(input);
+}
+
+inline auto parse(const fs::mapped_file& file) -> utilities::result<document, parse_error> {
+    return document::parse(file);
+}
+} // namespace rtl::json
+
+#endif // #ifndef RTL_JSON_DOCUMENT_HPP
@@ -0,0 +1,250 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_STRUCTURAL_INDEX_HPP
+#define RTL_STRUCTURAL_INDEX_HPP
+
+#include "collections/list.hpp"
+#include "utilities/cpu.hpp"
+#include "utilities/simd.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+// The first stage of the JSON parser: finding the offsets of every structural character of the input, 64 bytes at a
+// time. The bytes are classified with vector comparisons, picking AVX2 or SSE4.2 at runtime, and everything after that
+// works on 64 bit masks with one bit per byte.
+
+namespace rtl::json::detail {
+inline constexpr std::size_t block_size = 64;
+
+// One bit per byte of a block for each class of character.
+struct block_masks {
+    std::uint64_t quote;
+    std::uint64_t backslash;
+    // {}[]:,
+    std::uint64_t operators;
+    std::uint64_t whitespace;
+};
+
+constexpr auto classify_scalar(const char* block) noexcept -> block_masks {
+    auto masks = block_masks{};
+    for (std::size_t i = 0; i < block_size; i++) {
+        auto bit = std::uint64_t{1} << i;
+        switch (block[i]) {
+            case '"':
+                masks.quote |= bit;
+                break;
+            case '\\':
+                masks.backslash |= bit;
+                break;
+            case '{':
+            case '}':
+            case '[':
+            case ']':
+            case ':':
+            case ',':
+                masks.operators |= bit;
+                break;
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+                masks.whitespace |= bit;
+                break;
+            default:
+                break;
+        }
+    }
+
+    return masks;
+}
+
+template<typename Vec>
+auto classify_vector(const char* data, std::size_t block_count, block_masks* masks) noexcept -> void {
+    auto quote = Vec{};
+    quote.fill('"');
+    auto backslash = Vec{};
+    backslash.fill('\\');
+
+    constexpr char operator_chars[] = {'{', '}', '[', ']', ':', ','};
+    constexpr char whitespace_chars[] = {' ', '\t', '\n', '\r'};
+    Vec operators[std::size(operator_chars)];
+    Vec whitespace[std::size(whitespace_chars)];
+    for (std::size_t i = 0; i < std::size(operator_chars); i++) {
+        operators[i].fill(operator_chars[i]);
+    }
+    for (std::size_t i = 0; i < std::size(whitespace_chars); i++) {
+        whitespace[i].fill(whitespace_chars[i]);
+    }
+
+    auto bytes = Vec{};
+    for (std::size_t block = 0; block < block_count; block++) {
+        auto result = block_masks{};
+        for (std::size_t offset = 0; offset < block_size; offset += Vec::lanes) {
+            bytes.load(data + block * block_size + offset);
+            result.quote |= std::uint64_t{bytes.equal_mask(quote)} << offset;
+            result.backslash |= std::uint64_t{bytes.equal_mask(backslash)} << offset;
+
+            std::uint32_t mask = 0;
+            for (const auto& op : operators) {
+                mask |= bytes.equal_mask(op);
+            }
+            result.operators |= std::uint64_t{mask} << offset;
+
+            mask = 0;
+            for (const auto& space : whitespace) {
+                mask |= bytes.equal_mask(space);
+            }
+            result.whitespace |= std::uint64_t{mask} << offset;
+        }
+
+        masks[block] = result;
+    }
+}
+
+#ifdef RTL_X86
+RTL_TARGET("avx2") inline auto classify_avx2(const char* data, std::size_t block_count, block_masks* masks) noexcept
+    -> void {
+    classify_vector<utilities::simd::avx2::vec<char>>(data, block_count, masks);
+}
+
+RTL_TARGET("sse4.2") inline auto classify_sse42(const char* data, std::size_t block_count, block_masks* masks) noexcept
+    -> void {
+    classify_vector<utilities::simd::sse42::vec<char>>(data, block_count, masks);
+}
+#endif
+
+// Classifies `block_count` whole blocks starting at `data`.
+inline auto classify(const char* data, std::size_t block_count, block_masks* masks) noexcept -> void {
+#ifdef RTL_X86
+    if (utilities::cpu().avx2) {
+        return classify_avx2(data, block_count, masks);
+    } else if (utilities::cpu().sse42) {
+        return classify_sse42(data, block_count, masks);
+    }
+#endif
+    for (std::size_t block = 0; block < block_count; block++) {
+        masks[block] = classify_scalar(data + block * block_size);
+    }
+}
+
+// Sets every bit from each set bit up to, but not including, the next one.
+constexpr auto prefix_xor(std::uint64_t bits) noexcept -> std::uint64_t {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+// Turns the character classes of consecutive blocks into the offsets of the structural characters: operators outside
+// of strings, every quote that isn't escaped, and the first character of every other value. The state carried between
+// blocks is whether the last one ended in an escape, inside a string, or on a separator.
+class structural_scanner {
+public:
+    auto scan(const block_masks& masks, std::uint32_t base, collections::list<std::uint32_t>& offsets) -> void {
+        auto escaped = find_escaped(masks.backslash);
+        auto quotes = masks.quote & ~escaped;
+
+        // the opening quote of a string up to the character before its closing quote
+        auto inside = prefix_xor(quotes) ^ m_inside;
+        m_inside = static_cast<std::uint64_t>(static_cast<std::int64_t>(inside) >> 63);
+
+        auto operators = masks.operators & ~inside;
+        auto separators = operators | (masks.whitespace & ~inside) | quotes;
+        auto scalars = ~(separators | inside);
+        auto follows_separator = (separators << 1) | m_separator;
+        m_separator = separators >> 63;
+
+        auto structurals = operators | quotes | (scalars & follows_separator);
+
+        // grown once per block rather than checked per offset
+        auto size = offsets.size();
+        offsets.resize(size + static_cast<std::size_t>(std::popcount(structurals)));
+        auto out = offsets.data() + size;
+        while (structurals != 0) {
+            *out++ = base + static_cast<std::uint32_t>(std::countr_zero(structurals));
+            structurals &= structurals - 1;
+        }
+    }
+
+    // Whether the input ended in the middle of a string.
+    [[nodiscard]] auto inside_string() const noexcept -> bool {
+        return m_inside != 0;
+    }
+
+private:
+    // The characters escaped by a backslash, counting runs of backslashes across blocks.
+    auto find_escaped(std::uint64_t backslash) noexcept -> std::uint64_t {
+        constexpr std::uint64_t even_bits = 0x5555'5555'5555'5555;
+
+        backslash &= ~m_escaped;
+        auto follows_escape = (backslash << 1) | m_escaped;
+        // a run of backslashes escapes the character after it when its length is odd, which is when the run starts
+        // and ends on bits of different parity
+        auto odd_starts = backslash & ~even_bits & ~follows_escape;
+        auto sum = odd_starts + backslash;
+        m_escaped = sum < odd_starts ? 1 : 0;
+        auto invert = sum << 1;
+        return (even_bits ^ invert) & follows_escape;
+    }
+
+    std::uint64_t m_escaped{};
+    std::uint64_t m_inside{};
+    // starts as though the input follows a separator, so a value at the very start counts
+    std::uint64_t m_separator{1};
+}; // class structural_scanner
+
+// Appends the offsets of the structural characters of `input` to `offsets`, returns false if a string is never
+// closed.
+inline auto build_structural_index(std::string_view input, collections::list<std::uint32_t>& offsets) -> bool {
+    constexpr std::size_t batch = 64;
+    block_masks masks[batch];
+
+    auto scanner = structural_scanner{};
+    auto whole_blocks = input.size() / block_size;
+    for (std::size_t first = 0; first < whole_blocks; first += batch) {
+        auto count = std::min(batch, whole_blocks - first);
+        classify(input.data() + first * block_size, count, masks);
+        for (std::size_t i = 0; i < count; i++) {
+            scanner.scan(masks[i], static_cast<std::uint32_t>((first + i) * block_size), offsets);
+        }
+    }
+
+    if (auto rest = input.size() % block_size; rest != 0) {
+        // padded with whitespace, which adds nothing to the index
+        char last[block_size];
+        std::memset(last, ' ', block_size);
+        std::memcpy(last, input.data() + whole_blocks * block_size, rest);
+        classify(last, 1, masks);
+        scanner.scan(masks[0], static_cast<std::uint32_t>(whole_blocks * block_size), offsets);
+    }
+
+    return !scanner.inside_string();
+}
+} // namespace rtl::json::detail
+
+#endif // #ifndef RTL_STRUCTURAL_INDEX_HPP
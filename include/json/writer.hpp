@@ -0,0 +1,411 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_JSON_WRITER_HPP
+#define RTL_JSON_WRITER_HPP
+
+#include "fs/file_writer.hpp"
+#include "json/document.hpp"
+#include "utilities/cpu.hpp"
+#include "utilities/option.hpp"
+#include "utilities/simd.hpp"
+
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ranges>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+namespace rtl::json {
+// Describes the members of a user type so a `writer` can write it as an object. Specialise it with a `fields` tuple
+// of `json::member`s:
+//
+//     template<>
+//     struct rtl::json::reflection<point> {
+//         static constexpr auto fields = std::tuple{rtl::json::member{"x", &point::x}, rtl::json::member{"y", &point::y}};
+//     };
+template<typename T>
+struct reflection;
+
+template<typename Class, typename T>
+struct member {
+    std::string_view name;
+    T Class::* pointer;
+};
+
+template<typename T>
+concept reflectable = requires {
+    std::tuple_size<std::remove_cvref_t<decltype(reflection<T>::fields)>>::value;
+};
+
+// The buffers a `writer` can append to, `collections::list<char>` and `strings::string`.
+template<typename B>
+concept output_buffer = requires(B& buffer, std::size_t size) {
+    { buffer.data() } -> std::same_as<char*>;
+    { buffer.size() } -> std::convertible_to<std::size_t>;
+    buffer.resize_for_overwrite(size);
+    buffer.clear();
+};
+
+namespace detail {
+// Whether `c` has to be escaped inside a string.
+constexpr auto needs_escape(char c) noexcept -> bool {
+    return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+// Eight characters at a time in a general purpose register. A lane's high bit is set when it's below 0x20 or equal to a
+// quote or backslash, borrows between lanes can only set bits above the first of those, so the lowest one is exact.
+inline auto find_escape_scalar(const char* data, std::size_t size) noexcept -> std::size_t {
+    constexpr std::uint64_t ones = 0x0101'0101'0101'0101;
+    constexpr std::uint64_t high_bits = 0x8080'8080'8080'8080;
+
+    std::size_t i = 0;
+    if constexpr (std::endian::native == std::endian::little) {
+        for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t)) {
+            std::uint64_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+            auto control = word - ones * 0x20;
+            auto quotes = (word ^ (ones * '"')) - ones;
+            auto backslashes = (word ^ (ones * '\\')) - ones;
+            if (auto mask = (control | quotes | backslashes) & ~word & high_bits; mask != 0) {
+                return i + static_cast<std::size_t>(std::countr_zero(mask)) / 8;
+            }
+        }
+    }
+
+    for (; i < size; i++) {
+        if (needs_escape(data[i])) {
+            return i;
+        }
+    }
+
+    return size;
+}
+
+template<typename Vec>
+auto find_escape_vector(const char* data, std::size_t size) noexcept -> std::size_t {
+    auto quote = Vec{};
+    quote.fill('"');
+    auto backslash = Vec{};
+    backslash.fill('\\');
+    auto control = Vec{};
+    control.fill(0x1F);
+
+    auto bytes = Vec{};
+    auto low = Vec{};
+    std::size_t i = 0;
+    for (; i + Vec::lanes <= size; i += Vec::lanes) {
+        bytes.load(reinterpret_cast<const unsigned char*>(data + i));
+        // a byte is a control character when clamping it to 0x1F leaves it unchanged
+        low = bytes;
+        low.keep_min(control);
+        auto mask = bytes.equal_mask(quote) | bytes.equal_mask(backslash) | low.equal_mask(bytes);
+        if (mask != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+    }
+
+    return i + find_escape_scalar(data + i, size - i);
+}
+
+#ifdef RTL_X86
+RTL_TARGET("avx2") inline auto find_escape_avx2(const char* data, std::size_t size) noexcept -> std::size_t {
+    return find_escape_vector<utilities::simd::avx2::vec<unsigned char>>(data, size);
+}
+
+RTL_TARGET("sse4.2") inline auto find_escape_sse42(const char* data, std::size_t size) noexcept -> std::size_t {
+    return find_escape_vector<utilities::simd::sse42::vec<unsigned char>>(data, size);
+}
+#endif
+
+// The index of the first character of `data` that has to be escaped, or `size` if there isn't one.
+inline auto find_escape(const char* data, std::size_t size) noexcept -> std::size_t {
+#ifdef RTL_X86
+    if (utilities::cpu().avx2) {
+        return find_escape_avx2(data, size);
+    } else if (utilities::cpu().sse42) {
+        return find_escape_sse42(data, size);
+    }
+#endif
+    return find_escape_scalar(data, size);
+}
+
+template<typename T>
+struct is_option : std::false_type {
+
+};
+
+template<typename T, typename Layout>
+struct is_option<utilities::option<T, Layout>> : std::true_type {
+
+};
+} // namespace detail
+
+// Writes JSON straight into the end of a buffer, one value at a time, adding the commas and colons in between. Nothing
+// checks that the calls make a valid document, the caller has to open and close every object and array and give
+// every member of an object a key.
+//
+// Given a `fs::file_writer`, the buffer is handed to it and cleared whenever it grows past `flush_size`, and once more
+// by `flush`.
+template<output_buffer Buffer>
+class writer {
+public:
+    static constexpr std::size_t default_flush_size = 64 * 1024;
+
+    explicit writer(Buffer& buffer) noexcept : m_buffer{&buffer} {
+
+    }
+
+    writer(Buffer& buffer, fs::file_writer& file, std::size_t flush_size = default_flush_size) noexcept
+        : m_buffer{&buffer}
+        , m_file{&file}
+        , m_flush_size{flush_size} {
+
+    }
+
+    // structure
+
+    auto begin_object() -> writer& {
+        separate();
+        put('{');
+        m_separate = false;
+        return *this;
+    }
+
+    auto end_object() -> writer& {
+        put('}');
+        m_separate = true;
+        return flush_if_full();
+    }
+
+    auto begin_array() -> writer& {
+        separate();
+        put('[');
+        m_separate = false;
+        return *this;
+    }
+
+    auto end_array() -> writer& {
+        put(']');
+        m_separate = true;
+        return flush_if_full();
+    }
+
+    auto key(std::string_view name) -> writer& {
+        separate();
+        write_string(name);
+        put(':');
+        m_separate = false;
+        return *this;
+    }
+
+    // values
+
+    auto null() -> writer& {
+        return raw("null");
+    }
+
+    // Writes text that is already JSON as the next value.
+    auto raw(std::string_view json) -> writer& {
+        separate();
+        append(json);
+        m_separate = true;
+        return flush_if_full();
+    }
+
+    // Writes strings, numbers, booleans, `nullptr`, values from a `document`, options (as null when empty), ranges (as
+    // arrays) and types with a `reflection` (as objects). Non-finite floating point numbers have no JSON representation
+    // and are written as null.
+    template<typename T>
+    auto value(const T& value) -> writer& {
+        if constexpr (std::same_as<T, bool>) {
+            return raw(value ? "true" : "false");
+        } else if constexpr (std::same_as<T, std::nullptr_t>) {
+            return null();
+        } else if constexpr (std::same_as<T, json::value>) {
+            // copied as it appears in its document
+            return raw(value.raw());
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            separate();
+            write_string(value);
+            m_separate = true;
+            return flush_if_full();
+        } else if constexpr (std::integral<T>) {
+            char chars[24];
+            auto [end, error] = std::to_chars(chars, chars + sizeof(chars), value);
+            return raw({chars, static_cast<std::size_t>(end - chars)});
+        } else if constexpr (std::floating_point<T>) {
+            if (!std::isfinite(value)) {
+                return null();
+            }
+
+            // the shortest representation that reads back as the same value
+            char chars[32];
+            auto [end, error] = std::to_chars(chars, chars + sizeof(chars), value);
+            return raw({chars, static_cast<std::size_t>(end - chars)});
+        } else if constexpr (detail::is_option<T>::value) {
+            return value.has_value() ? this->value(*value) : null();
+        } else if constexpr (reflectable<T>) {
+            begin_object();
+            std::apply([this, &value](const auto&... members) {
+                (member(members.name, value.*members.pointer), ...);
+            }, reflection<T>::fields);
+            return end_object();
+        } else if constexpr (std::ranges::input_range<const T>) {
+            begin_array();
+            for (const auto& element : value) {
+                this->value(element);
+            }
+            return end_array();
+        } else {
+            static_assert(!sizeof(T), "json::writer doesn't know how to write this type, specialise json::reflection");
+        }
+    }
+
+    auto value(const char* chars) -> writer& {
+        return value(std::string_view{chars});
+    }
+
+    // A key followed by its value.
+    template<typename T>
+    auto member(std::string_view name, const T& value) -> writer& {
+        key(name);
+        return this->value(value);
+    }
+
+    // output
+
+    // Hands everything written so far to the file, if there is one. Returns false if the file has failed, flushes made
+    // as the buffer fills report failures through the file's `error`.
+    auto flush() -> bool {
+        if (m_file == nullptr) {
+            return true;
+        }
+
+        auto written = m_file->write(std::string_view{m_buffer->data(), m_buffer->size()});
+        m_buffer->clear();
+        return written;
+    }
+
+    auto buffer() const noexcept -> const Buffer& {
+        return *m_buffer;
+    }
+
+private:
+    auto separate() -> void {
+        if (m_separate) {
+            put(',');
+        }
+    }
+
+    auto extend(std::size_t count) -> char* {
+        auto size = static_cast<std::size_t>(m_buffer->size());
+        m_buffer->resize_for_overwrite(size + count);
+        return m_buffer->data() + size;
+    }
+
+    auto put(char c) -> void {
+        *extend(1) = c;
+    }
+
+    auto append(std::string_view chars) -> void {
+        if (!chars.empty()) {
+            std::memcpy(extend(chars.size()), chars.data(), chars.size());
+        }
+    }
+
+    auto write_string(std::string_view chars) -> void {
+        constexpr char hex_digits[] = "0123456789abcdef";
+
+        // room for the string if nothing needs escaping, each escape makes room for the rest of itself
+        auto offset = static_cast<std::size_t>(m_buffer->size());
+        extend(chars.size() + 2);
+        m_buffer->data()[offset++] = '"';
+        while (true) {
+            auto run = detail::find_escape(chars.data(), chars.size());
+            if (run != 0) {
+                std::memcpy(m_buffer->data() + offset, chars.data(), run);
+                offset += run;
+            }
+
+            if (run == chars.size()) {
+                break;
+            }
+
+            auto c = chars[run];
+            char escape[] = {'\\', 'u', '0', '0', hex_digits[(c >> 4) & 0xF], hex_digits[c & 0xF]};
+            std::size_t length = 2;
+            switch (c) {
+                case '"':
+                    escape[1] = '"';
+                    break;
+                case '\\':
+                    escape[1] = '\\';
+                    break;
+                case '\b':
+                    escape[1] = 'b';
+                    break;
+                case '\f':
+                    escape[1] = 'f';
+                    break;
+                case '\n':
+                    escape[1] = 'n';
+                    break;
+                case '\r':
+                    escape[1] = 'r';
+                    break;
+                case '\t':
+                    escape[1] = 't';
+                    break;
+                default:
+                    length = sizeof(escape);
+                    break;
+            }
+
+            extend(length - 1);
+            std::memcpy(m_buffer->data() + offset, escape, length);
+            offset += length;
+            chars.remove_prefix(run + 1);
+        }
+        m_buffer->data()[offset] = '"';
+    }
+
+    auto flush_if_full() -> writer& {
+        if (m_file != nullptr && static_cast<std::size_t>(m_buffer->size()) >= m_flush_size) {
+            flush();
+        }
+
+        return *this;
+    }
+
+    Buffer* m_buffer;
+    fs::file_writer* m_file{};
+    std::size_t m_flush_size{default_flush_size};
+    // whether a comma goes before the next key or value
+    bool m_separate{};
+}; // class writer
+} // namespace rtl::json
+
+#endif // #ifndef RTL_JSON_WRITER_HPP
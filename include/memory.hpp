@@ -20,6 +20,12 @@
 #ifndef RTL_MEMORY_HPP
 #define RTL_MEMORY_HPP
 
+#include "memory/arena.hpp"
+#include "memory/intrusive_ptr.hpp"
+#include "memory/pool_allocator.hpp"
+#include "memory/ref_count.hpp"
+#include "memory/relocate.hpp"
+#include "memory/shared_ptr.hpp"
 #include "memory/unique_ptr.hpp"
 
 #endif // #ifndef RTL_MEMORY_HPP
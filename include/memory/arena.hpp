@@ -0,0 +1,247 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_ARENA_HPP
+#define RTL_ARENA_HPP
+
+#include "utilities/assertions.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <span>
+#include <utility>
+
+namespace rtl::memory {
+// A monotonic bump allocator. Memory is handed out from an optional caller-supplied buffer and then from chunks
+// obtained from the global allocator. Individual allocations are never freed. `reset` makes all of the memory
+// available again in constant time, keeping the chunks for reuse, and `release` returns the chunks.
+class arena {
+public:
+    static constexpr std::size_t default_chunk_size = 64 * 1024;
+
+    arena() noexcept = default;
+
+    explicit arena(std::size_t chunk_size) noexcept
+        : m_chunk_size{chunk_size} {
+
+    }
+
+    explicit arena(std::span<std::byte> initial_buffer, std::size_t chunk_size = default_chunk_size) noexcept
+        : m_cursor{initial_buffer.data()}
+        , m_end{initial_buffer.data() + initial_buffer.size()}
+        , m_initial_buffer{initial_buffer}
+        , m_chunk_size{chunk_size} {
+
+    }
+
+    arena(const arena&) = delete;
+
+    arena(arena&& other) noexcept
+        : m_cursor{std::exchange(other.m_cursor, nullptr)}
+        , m_end{std::exchange(other.m_end, nullptr)}
+        , m_chunks{std::exchange(other.m_chunks, nullptr)}
+        , m_current{std::exchange(other.m_current, nullptr)}
+        , m_initial_buffer{std::exchange(other.m_initial_buffer, {})}
+        , m_chunk_size{other.m_chunk_size} {
+
+    }
+
+    ~arena() noexcept {
+        release();
+    }
+
+    auto operator=(const arena&) -> arena& = delete;
+
+    auto operator=(arena&& other) noexcept -> arena& {
+        if (this == &other) {
+            return *this;
+        }
+
+        release();
+        m_cursor = std::exchange(other.m_cursor, nullptr);
+        m_end = std::exchange(other.m_end, nullptr);
+        m_chunks = std::exchange(other.m_chunks, nullptr);
+        m_current = std::exchange(other.m_current, nullptr);
+        m_initial_buffer = std::exchange(other.m_initial_buffer, {});
+        m_chunk_size = other.m_chunk_size;
+        return *this;
+    }
+
+    [[nodiscard]] auto allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) -> void* {
+        RTL_ASSERT(std::has_single_bit(alignment), "Alignment must be a power of two");
+
+        if (auto memory = bump(size, alignment)) {
+            return memory;
+        }
+
+        return allocate_slow(size, alignment);
+    }
+
+    // Makes all memory handed out so far available again. Memory from the initial buffer is used first again, then the
+    // chunks that were already allocated, in order.
+    auto reset() noexcept -> void {
+        if (!m_initial_buffer.empty() || m_chunks == nullptr) {
+            m_cursor = m_initial_buffer.data();
+            m_end = m_initial_buffer.data() + m_initial_buffer.size();
+            m_current = nullptr;
+        } else {
+            enter(m_chunks);
+        }
+    }
+
+    // Resets the arena and returns all of its chunks to the global allocator.
+    auto release() noexcept -> void {
+        auto chunk = m_chunks;
+        while (chunk != nullptr) {
+            auto next = chunk->next;
+            ::operator delete(static_cast<void*>(chunk), chunk->size);
+            chunk = next;
+        }
+
+        m_chunks = nullptr;
+        reset();
+    }
+
+    // The total number of bytes owned by the arena, including the initial buffer.
+    [[nodiscard]] auto capacity() const noexcept -> std::size_t {
+        auto total = m_initial_buffer.size();
+        for (auto chunk = m_chunks; chunk != nullptr; chunk = chunk->next) {
+            total += chunk->size - sizeof(chunk_header);
+        }
+
+        return total;
+    }
+
+private:
+    struct alignas(std::max_align_t) chunk_header {
+        chunk_header* next;
+        std::size_t size;
+    };
+
+    auto bump(std::size_t size, std::size_t alignment) noexcept -> void* {
+        auto cursor = reinterpret_cast<std::uintptr_t>(m_cursor);
+        auto aligned = (cursor + alignment - 1) & ~(alignment - 1);
+        auto end = reinterpret_cast<std::uintptr_t>(m_end);
+
+        if (m_cursor == nullptr || aligned > end || end - aligned < size) {
+            return nullptr;
+        }
+
+        m_cursor += (aligned - cursor) + size;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    auto allocate_slow(std::size_t size, std::size_t alignment) -> void* {
+        // chunks kept from before the last reset are reused before allocating new ones
+        auto next = m_current == nullptr ? m_chunks : m_current->next;
+        while (next != nullptr) {
+            enter(next);
+            if (auto memory = bump(size, alignment)) {
+                return memory;
+            }
+
+            next = next->next;
+        }
+
+        if (size > std::numeric_limits<std::size_t>::max() - sizeof(chunk_header) - alignment) {
+            throw std::bad_alloc{};
+        }
+
+        auto chunk_size = sizeof(chunk_header) + std::max(m_chunk_size, size + alignment);
+        auto chunk = static_cast<chunk_header*>(::operator new(chunk_size));
+        chunk->size = chunk_size;
+
+        if (m_current == nullptr) {
+            chunk->next = m_chunks;
+            m_chunks = chunk;
+        } else {
+            chunk->next = m_current->next;
+            m_current->next = chunk;
+        }
+
+        enter(chunk);
+        return bump(size, alignment);
+    }
+
+    auto enter(chunk_header* chunk) noexcept -> void {
+        m_current = chunk;
+        m_cursor = reinterpret_cast<std::byte*>(chunk + 1);
+        m_end = reinterpret_cast<std::byte*>(chunk) + chunk->size;
+    }
+
+    std::byte* m_cursor{};
+    std::byte* m_end{};
+    chunk_header* m_chunks{};
+    chunk_header* m_current{};
+    std::span<std::byte> m_initial_buffer{};
+    std::size_t m_chunk_size{default_chunk_size};
+}; // class arena
+
+// Adapts an `arena` to the allocator interface. Deallocation does nothing, the memory is reclaimed when the arena is
+// reset or released, so the arena must outlive everything allocated from it.
+template<typename T>
+class arena_allocator {
+public:
+    using value_type = T;
+
+    explicit arena_allocator(arena& arena) noexcept
+        : m_arena{&arena} {
+
+    }
+
+    template<typename U>
+    arena_allocator(const arena_allocator<U>& other) noexcept
+        : m_arena{&other.get_arena()} {
+
+    }
+
+    [[nodiscard]] auto allocate(std::size_t n) -> T* {
+        if (n > max_size()) {
+            throw std::bad_array_new_length{};
+        }
+
+        return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    auto deallocate(T*, std::size_t) noexcept -> void {
+
+    }
+
+    [[nodiscard]] constexpr auto max_size() const noexcept -> std::size_t {
+        return std::numeric_limits<std::size_t>::max() / sizeof(T);
+    }
+
+    [[nodiscard]] auto get_arena() const noexcept -> arena& {
+        return *m_arena;
+    }
+
+    friend auto operator==(const arena_allocator& a, const arena_allocator& b) noexcept -> bool {
+        return a.m_arena == b.m_arena;
+    }
+
+private:
+    arena* m_arena;
+}; // class arena_allocator
+} // namespace rtl::memory
+
+#endif // #ifndef RTL_ARENA_HPP
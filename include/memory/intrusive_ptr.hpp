@@ -0,0 +1,239 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_INTRUSIVE_PTR_HPP
+#define RTL_INTRUSIVE_PTR_HPP
+
+#include "memory/ref_count.hpp"
+#include "typing/concepts.hpp"
+#include "utilities/niche.hpp"
+
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace rtl::memory {
+// Base for objects that carry their own reference count for `intrusive_ptr`. The object deletes itself when its last
+// reference is released, so it must have been created with `new`. Copying an object doesn't copy its references.
+template<typename Derived, count_policy Policy = atomic_count>
+class intrusive_counted {
+public:
+    auto retain() const noexcept -> void {
+        m_count.increment();
+    }
+
+    auto release() const noexcept -> void {
+        if (m_count.decrement()) {
+            delete static_cast<const Derived*>(this);
+        }
+    }
+
+    [[nodiscard]] auto use_count() const noexcept -> std::size_t {
+        return m_count.load();
+    }
+
+protected:
+    constexpr intrusive_counted() noexcept
+        : m_count{0} {
+
+    }
+
+    constexpr intrusive_counted(const intrusive_counted&) noexcept
+        : m_count{0} {
+
+    }
+
+    constexpr auto operator=(const intrusive_counted&) noexcept -> intrusive_counted& {
+        return *this;
+    }
+
+    ~intrusive_counted() = default;
+
+private:
+    mutable Policy m_count;
+}; // class intrusive_counted
+
+// How `intrusive_ptr` takes and drops references to a `T`. By default it calls the object's own `retain` and `release`
+// members, as provided by `intrusive_counted`. Specialise this for types that count their references some other way.
+template<typename T>
+struct intrusive_traits {
+    static auto retain(T* pointer) noexcept -> void {
+        pointer->retain();
+    }
+
+    static auto release(T* pointer) noexcept -> void {
+        pointer->release();
+    }
+};
+
+// A shared pointer to an object that embeds its own reference count. It is the size of a raw pointer and, unlike
+// `shared_ptr`, can be recreated from a raw pointer to the object at any point without a separate control block.
+template<typename T>
+class intrusive_ptr {
+private:
+    using traits = intrusive_traits<T>;
+
+public:
+    using element_type = T;
+
+    // construction
+
+    constexpr intrusive_ptr() noexcept = default;
+
+    constexpr intrusive_ptr(std::nullptr_t) noexcept {
+
+    }
+
+    // Takes a new reference to `pointer`, or adopts one the caller already holds if `retain` is false.
+    explicit intrusive_ptr(T* pointer, bool retain = true) noexcept
+        : m_pointer{pointer} {
+        if (m_pointer != nullptr && retain) {
+            traits::retain(m_pointer);
+        }
+    }
+
+    intrusive_ptr(const intrusive_ptr& other) noexcept
+        : intrusive_ptr{other.m_pointer} {
+
+    }
+
+    template<typename U> requires(std::convertible_to<U*, T*>)
+    intrusive_ptr(const intrusive_ptr<U>& other) noexcept
+        : intrusive_ptr{other.m_pointer} {
+
+    }
+
+    constexpr intrusive_ptr(intrusive_ptr&& other) noexcept
+        : m_pointer{std::exchange(other.m_pointer, nullptr)} {
+
+    }
+
+    template<typename U> requires(std::convertible_to<U*, T*>)
+    constexpr intrusive_ptr(intrusive_ptr<U>&& other) noexcept
+        : m_pointer{std::exchange(other.m_pointer, nullptr)} {
+
+    }
+
+    ~intrusive_ptr() noexcept {
+        if (m_pointer != nullptr) {
+            traits::release(m_pointer);
+        }
+    }
+
+    auto operator=(const intrusive_ptr& other) noexcept -> intrusive_ptr& {
+        intrusive_ptr{other}.swap(*this);
+        return *this;
+    }
+
+    auto operator=(intrusive_ptr&& other) noexcept -> intrusive_ptr& {
+        intrusive_ptr{std::move(other)}.swap(*this);
+        return *this;
+    }
+
+    // access
+
+    auto get() const noexcept -> const T* {
+        return m_pointer;
+    }
+
+    auto get() noexcept -> T* {
+        return m_pointer;
+    }
+
+    auto operator*() const noexcept -> const T& {
+        return *m_pointer;
+    }
+
+    auto operator*() noexcept -> T& {
+        return *m_pointer;
+    }
+
+    auto operator->() const noexcept -> const T* {
+        return m_pointer;
+    }
+
+    auto operator->() noexcept -> T* {
+        return m_pointer;
+    }
+
+    explicit operator bool() const noexcept {
+        return m_pointer != nullptr;
+    }
+
+    // modification
+
+    // Gives up the reference without releasing it, the caller becomes responsible for it.
+    [[nodiscard]] auto detach() noexcept -> T* {
+        return std::exchange(m_pointer, nullptr);
+    }
+
+    auto reset() noexcept -> void {
+        intrusive_ptr{}.swap(*this);
+    }
+
+    auto reset(T* pointer, bool retain = true) noexcept -> void {
+        intrusive_ptr{pointer, retain}.swap(*this);
+    }
+
+    auto swap(intrusive_ptr& other) noexcept -> void {
+        std::swap(m_pointer, other.m_pointer);
+    }
+
+    // comparison
+
+    template<typename U>
+    friend auto operator==(const intrusive_ptr& a, const intrusive_ptr<U>& b) noexcept -> bool {
+        return a.get() == b.get();
+    }
+
+    friend auto operator==(const intrusive_ptr& a, std::nullptr_t) noexcept -> bool {
+        return a.get() == nullptr;
+    }
+
+private:
+    template<typename U>
+    friend class intrusive_ptr;
+
+    T* m_pointer{};
+}; // class intrusive_ptr
+
+template<typename T, typename... Args> requires(std::is_constructible_v<T, Args...>)
+auto make_intrusive(Args&&... args) -> intrusive_ptr<T> {
+    return intrusive_ptr<T>{new T(std::forward<Args>(args)...)};
+}
+} // namespace rtl::memory
+
+template<typename T>
+struct rtl::utilities::niche_traits<rtl::memory::intrusive_ptr<T>> {
+    static constexpr auto empty() noexcept -> rtl::memory::intrusive_ptr<T> {
+        return rtl::memory::intrusive_ptr<T>{};
+    }
+
+    static constexpr auto is_empty(const rtl::memory::intrusive_ptr<T>& value) noexcept -> bool {
+        return value.get() == nullptr;
+    }
+};
+
+template<typename T>
+struct rtl::typing::is_trivially_relocatable<rtl::memory::intrusive_ptr<T>> : std::true_type {
+
+};
+
+#endif // #ifndef RTL_INTRUSIVE_PTR_HPP
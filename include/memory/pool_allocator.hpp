@@ -0,0 +1,248 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_POOL_ALLOCATOR_HPP
+#define RTL_POOL_ALLOCATOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <new>
+
+namespace rtl::memory {
+namespace detail {
+struct free_block {
+    free_block* next;
+};
+
+// The shared free list for one block size. Blocks are carved from slabs which are kept for the lifetime of the
+// process, so the pool is never destroyed and thread caches can return blocks to it at any point during shutdown.
+template<std::size_t BlockSize, std::size_t Alignment>
+class block_pool {
+public:
+    static constexpr std::size_t slab_size = std::max<std::size_t>(64 * 1024, BlockSize * 64);
+
+    static auto instance() -> block_pool& {
+        static auto* pool = new block_pool{};
+        return *pool;
+    }
+
+    // Pops up to `count` blocks into a list headed by `head` and returns how many were taken.
+    auto take(free_block*& head, std::size_t count) -> std::size_t {
+        std::lock_guard lock{m_mutex};
+
+        std::size_t taken = 0;
+        while (taken < count && m_free != nullptr) {
+            auto block = m_free;
+            m_free = block->next;
+            block->next = head;
+            head = block;
+            taken++;
+        }
+
+        while (taken < count) {
+            if (m_slab_cursor == m_slab_end) {
+                m_slab_cursor = static_cast<std::byte*>(::operator new(slab_size, std::align_val_t{Alignment}));
+                m_slab_end = m_slab_cursor + slab_size / BlockSize * BlockSize;
+            }
+
+            auto block = reinterpret_cast<free_block*>(m_slab_cursor);
+            m_slab_cursor += BlockSize;
+            block->next = head;
+            head = block;
+            taken++;
+        }
+
+        return taken;
+    }
+
+    // Pushes the list from `head` to `tail` back onto the shared free list.
+    auto give(free_block* head, free_block* tail) noexcept -> void {
+        std::lock_guard lock{m_mutex};
+        tail->next = m_free;
+        m_free = head;
+    }
+
+private:
+    block_pool() noexcept = default;
+
+    std::mutex m_mutex;
+    free_block* m_free{};
+    std::byte* m_slab_cursor{};
+    std::byte* m_slab_end{};
+}; // class block_pool
+
+// A per-thread free list in front of a `block_pool`, so that most allocations and deallocations touch no shared state.
+// Blocks move between the two in batches, and whatever the cache holds when its thread exits goes back to the pool.
+// Once a thread's cache has been destroyed, for example while static objects are destroyed after the main thread's
+// thread locals, its blocks go straight to and from the pool instead.
+template<std::size_t BlockSize, std::size_t Alignment>
+class thread_cache {
+public:
+    static constexpr std::size_t batch_size = 32;
+    static constexpr std::size_t high_water_mark = batch_size * 4;
+
+    // Returns the calling thread's cache, or null if it has already been destroyed.
+    static auto local() noexcept -> thread_cache* {
+        // trivially destructible, so it can still be read after the cache itself is gone
+        thread_local bool destroyed = false;
+        if (destroyed) {
+            return nullptr;
+        }
+
+        thread_local thread_cache cache{destroyed};
+        return &cache;
+    }
+
+    [[nodiscard]] static auto allocate_block() -> void* {
+        if (auto cache = local()) {
+            return cache->allocate();
+        }
+
+        free_block* block = nullptr;
+        block_pool<BlockSize, Alignment>::instance().take(block, 1);
+        return block;
+    }
+
+    static auto deallocate_block(void* pointer) noexcept -> void {
+        if (auto cache = local()) {
+            cache->deallocate(pointer);
+            return;
+        }
+
+        auto block = static_cast<free_block*>(pointer);
+        block_pool<BlockSize, Alignment>::instance().give(block, block);
+    }
+
+    thread_cache(const thread_cache&) = delete;
+    auto operator=(const thread_cache&) -> thread_cache& = delete;
+
+    ~thread_cache() noexcept {
+        m_destroyed = true;
+        if (m_head != nullptr) {
+            auto tail = m_head;
+            while (tail->next != nullptr) {
+                tail = tail->next;
+            }
+
+            block_pool<BlockSize, Alignment>::instance().give(m_head, tail);
+        }
+    }
+
+    [[nodiscard]] auto allocate() -> void* {
+        if (m_head == nullptr) {
+            m_count += block_pool<BlockSize, Alignment>::instance().take(m_head, batch_size);
+        }
+
+        auto block = m_head;
+        m_head = block->next;
+        m_count--;
+        return block;
+    }
+
+    auto deallocate(void* pointer) noexcept -> void {
+        auto block = static_cast<free_block*>(pointer);
+        block->next = m_head;
+        m_head = block;
+        m_count++;
+
+        if (m_count > high_water_mark) {
+            release_batch();
+        }
+    }
+
+private:
+    explicit thread_cache(bool& destroyed) noexcept
+        : m_destroyed{destroyed} {
+
+    }
+
+    auto release_batch() noexcept -> void {
+        auto head = m_head;
+        auto tail = m_head;
+        for (std::size_t i = 1; i < batch_size; i++) {
+            tail = tail->next;
+        }
+
+        m_head = tail->next;
+        m_count -= batch_size;
+        block_pool<BlockSize, Alignment>::instance().give(head, tail);
+    }
+
+    free_block* m_head{};
+    std::size_t m_count{};
+    bool& m_destroyed;
+}; // class thread_cache
+} // namespace detail
+
+// Serves single-object allocations from fixed-size blocks. Every `pool_allocator` whose `T` has the same block size
+// and alignment shares one pool, and each thread keeps a cache of free blocks in front of it. Allocations of more than
+// one object go straight to the global allocator.
+template<typename T>
+class pool_allocator {
+private:
+    static constexpr std::size_t s_alignment = std::max(alignof(T), alignof(detail::free_block));
+    static constexpr std::size_t s_block_size = (std::max(sizeof(T), sizeof(detail::free_block)) + s_alignment - 1)
+        / s_alignment * s_alignment;
+
+    using cache = detail::thread_cache<s_block_size, s_alignment>;
+
+public:
+    using value_type = T;
+
+    constexpr pool_allocator() noexcept = default;
+
+    template<typename U>
+    constexpr pool_allocator(const pool_allocator<U>&) noexcept {
+
+    }
+
+    [[nodiscard]] auto allocate(std::size_t n) -> T* {
+        if (n == 1) {
+            return static_cast<T*>(cache::allocate_block());
+        }
+
+        if (n > max_size()) {
+            throw std::bad_array_new_length{};
+        }
+
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{alignof(T)}));
+    }
+
+    auto deallocate(T* pointer, std::size_t n) noexcept -> void {
+        if (n == 1) {
+            cache::deallocate_block(pointer);
+            return;
+        }
+
+        ::operator delete(pointer, n * sizeof(T), std::align_val_t{alignof(T)});
+    }
+
+    [[nodiscard]] constexpr auto max_size() const noexcept -> std::size_t {
+        return std::numeric_limits<std::size_t>::max() / sizeof(T);
+    }
+
+    friend constexpr auto operator==(const pool_allocator&, const pool_allocator&) noexcept -> bool {
+        return true;
+    }
+}; // class pool_allocator
+} // namespace rtl::memory
+
+#endif // #ifndef RTL_POOL_ALLOCATOR_HPP
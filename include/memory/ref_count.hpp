@@ -0,0 +1,110 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_REF_COUNT_HPP
+#define RTL_REF_COUNT_HPP
+
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+
+namespace rtl::memory {
+// Reference count policy for `shared_ptr`, `weak_ptr` and `intrusive_ptr` whose objects are shared between threads.
+class atomic_count {
+public:
+    explicit constexpr atomic_count(std::uint32_t count) noexcept
+        : m_count{count} {
+
+    }
+
+    auto increment() noexcept -> void {
+        m_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Increments the count unless it is already zero, returns whether it did.
+    auto increment_if_nonzero() noexcept -> bool {
+        auto count = m_count.load(std::memory_order_relaxed);
+        while (count != 0) {
+            if (m_count.compare_exchange_weak(count, count + 1, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Decrements the count and returns whether it reached zero. Every write made through earlier references happens
+    // before a true return, so the caller can then destroy the object.
+    auto decrement() noexcept -> bool {
+        return m_count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+    auto load() const noexcept -> std::uint32_t {
+        return m_count.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<std::uint32_t> m_count;
+}; // class atomic_count
+
+// Reference count policy for objects that never leave the thread that created them, the counts are plain integers so
+// copying and dropping a reference costs no locked instructions.
+class local_count {
+public:
+    explicit constexpr local_count(std::uint32_t count) noexcept
+        : m_count{count} {
+
+    }
+
+    constexpr auto increment() noexcept -> void {
+        m_count++;
+    }
+
+    constexpr auto increment_if_nonzero() noexcept -> bool {
+        if (m_count == 0) {
+            return false;
+        }
+
+        m_count++;
+        return true;
+    }
+
+    constexpr auto decrement() noexcept -> bool {
+        return --m_count == 0;
+    }
+
+    constexpr auto load() const noexcept -> std::uint32_t {
+        return m_count;
+    }
+
+private:
+    std::uint32_t m_count;
+}; // class local_count
+
+template<typename Policy>
+concept count_policy = requires(Policy policy, const Policy& const_policy) {
+    Policy{std::uint32_t{}};
+    { policy.increment() };
+    { policy.increment_if_nonzero() } -> std::same_as<bool>;
+    { policy.decrement() } -> std::same_as<bool>;
+    { const_policy.load() } -> std::same_as<std::uint32_t>;
+};
+} // namespace rtl::memory
+
+#endif // #ifndef RTL_REF_COUNT_HPP
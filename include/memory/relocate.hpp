@@ -0,0 +1,74 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_RELOCATE_HPP
+#define RTL_RELOCATE_HPP
+
+#include "typing/concepts.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace rtl::memory {
+// Moves `count` objects starting at `source` into the uninitialised storage at `destination` and destroys the
+// originals. The ranges may only overlap if `destination` comes before `source`.
+template<typename T, typename Allocator>
+constexpr auto relocate(T* source, std::size_t count, T* destination, Allocator& allocator)
+    noexcept(std::is_nothrow_move_constructible_v<T>) -> void {
+    if constexpr (typing::trivially_relocatable<T>) {
+        if !consteval {
+            if (count != 0) {
+                std::memmove(static_cast<void*>(destination), static_cast<const void*>(source), count * sizeof(T));
+            }
+            return;
+        }
+    }
+
+    using allocator_traits = std::allocator_traits<Allocator>;
+    for (std::size_t i = 0; i < count; i++) {
+        allocator_traits::construct(allocator, destination + i, std::move(source[i]));
+        allocator_traits::destroy(allocator, source + i);
+    }
+}
+
+// Like `relocate`, but moves the last object first so the ranges may overlap if `destination` comes after `source`.
+template<typename T, typename Allocator>
+constexpr auto relocate_backward(T* source, std::size_t count, T* destination, Allocator& allocator)
+    noexcept(std::is_nothrow_move_constructible_v<T>) -> void {
+    if constexpr (typing::trivially_relocatable<T>) {
+        if !consteval {
+            if (count != 0) {
+                std::memmove(static_cast<void*>(destination), static_cast<const void*>(source), count * sizeof(T));
+            }
+            return;
+        }
+    }
+
+    using allocator_traits = std::allocator_traits<Allocator>;
+    for (std::size_t i = count; i > 0; i--) {
+        allocator_traits::construct(allocator, destination + i - 1, std::move(source[i - 1]));
+        allocator_traits::destroy(allocator, source + i - 1);
+    }
+}
+} // namespace rtl::memory
+
+#endif // #ifndef RTL_RELOCATE_HPP
@@ -0,0 +1,520 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_SHARED_PTR_HPP
+#define RTL_SHARED_PTR_HPP
+
+#include "memory/ref_count.hpp"
+#include "memory/unique_ptr.hpp"
+#include "typing/concepts.hpp"
+#include "utilities/attributes.hpp"
+#include "utilities/niche.hpp"
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace rtl::memory {
+namespace detail {
+// The counts shared by the `shared_ptr`s and `weak_ptr`s of one object. The weak count holds one extra reference on
+// behalf of all the shared pointers, so the block outlives the object while there are weak pointers left to see that
+// it expired.
+template<count_policy Policy>
+class control_block {
+public:
+    control_block(const control_block&) = delete;
+    auto operator=(const control_block&) -> control_block& = delete;
+
+    auto retain() noexcept -> void {
+        m_shared.increment();
+    }
+
+    auto retain_weak() noexcept -> void {
+        m_weak.increment();
+    }
+
+    // Takes a shared reference unless the object has already been destroyed, for `weak_ptr::lock`.
+    auto try_retain() noexcept -> bool {
+        return m_shared.increment_if_nonzero();
+    }
+
+    auto release() noexcept -> void {
+        if (m_shared.decrement()) {
+            destroy();
+            release_weak();
+        }
+    }
+
+    auto release_weak() noexcept -> void {
+        if (m_weak.decrement()) {
+            deallocate();
+        }
+    }
+
+    auto use_count() const noexcept -> std::uint32_t {
+        return m_shared.load();
+    }
+
+protected:
+    control_block() noexcept
+        : m_shared{1}
+        , m_weak{1} {
+
+    }
+
+    ~control_block() = default;
+
+    // Destroys the object when the last shared reference is released.
+    virtual auto destroy() noexcept -> void = 0;
+
+    // Destroys the block and returns its memory when the last reference of either kind is released.
+    virtual auto deallocate() noexcept -> void = 0;
+
+private:
+    Policy m_shared;
+    Policy m_weak;
+}; // class control_block
+
+// Control block for an object that was allocated separately, which is deleted through `Deleter`.
+template<typename T, typename Deleter, typename Allocator, count_policy Policy>
+class pointer_control_block final : public control_block<Policy> {
+public:
+    using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<pointer_control_block>;
+    using allocator_traits = std::allocator_traits<allocator_type>;
+
+    pointer_control_block(T* pointer, Deleter deleter, const allocator_type& allocator) noexcept
+        : m_pointer{pointer}
+        , m_deleter{std::move(deleter)}
+        , m_allocator{allocator} {
+
+    }
+
+private:
+    auto destroy() noexcept -> void override {
+        m_deleter(m_pointer);
+    }
+
+    auto deallocate() noexcept -> void override {
+        auto allocator = m_allocator;
+        std::destroy_at(this);
+        allocator_traits::deallocate(allocator, this, 1);
+    }
+
+    T* m_pointer;
+    RTL_NO_UNIQUE_ADDRESS Deleter m_deleter;
+    RTL_NO_UNIQUE_ADDRESS allocator_type m_allocator;
+}; // class pointer_control_block
+
+// Control block created by `make_shared` and `allocate_shared`, which holds the object itself so both come from a
+// single allocation.
+template<typename T, typename Allocator, count_policy Policy>
+class inplace_control_block final : public control_block<Policy> {
+public:
+    using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<inplace_control_block>;
+    using allocator_traits = std::allocator_traits<allocator_type>;
+    using value_allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+    using value_allocator_traits = std::allocator_traits<value_allocator_type>;
+
+    template<typename... Args>
+    explicit inplace_control_block(const allocator_type& allocator, Args&&... args)
+        : m_allocator{allocator} {
+        auto value_allocator = value_allocator_type{m_allocator};
+        value_allocator_traits::construct(value_allocator, get(), std::forward<Args>(args)...);
+    }
+
+    ~inplace_control_block() {
+
+    }
+
+    auto get() noexcept -> T* {
+        return std::addressof(m_value);
+    }
+
+private:
+    auto destroy() noexcept -> void override {
+        auto value_allocator = value_allocator_type{m_allocator};
+        value_allocator_traits::destroy(value_allocator, get());
+    }
+
+    auto deallocate() noexcept -> void override {
+        auto allocator = m_allocator;
+        std::destroy_at(this);
+        allocator_traits::deallocate(allocator, this, 1);
+    }
+
+    RTL_NO_UNIQUE_ADDRESS allocator_type m_allocator;
+
+    union {
+        T m_value;
+    };
+}; // class inplace_control_block
+
+struct adopt_control_block {
+
+};
+} // namespace detail
+
+template<typename T, count_policy Policy = atomic_count>
+class weak_ptr;
+
+// A pointer that shares ownership of its object with the other `shared_ptr`s it was copied from, the object is
+// destroyed when the last of them is. `Policy` is how the references are counted: `atomic_count` for objects that are
+// shared between threads, or `local_count` for objects that stay on one thread, which makes copying and dropping a
+// pointer a plain increment and decrement.
+template<typename T, count_policy Policy = atomic_count>
+class shared_ptr {
+public:
+    using element_type = T;
+    using weak_type = weak_ptr<T, Policy>;
+
+    // construction
+
+    constexpr shared_ptr() noexcept = default;
+
+    constexpr shared_ptr(std::nullptr_t) noexcept {
+
+    }
+
+    template<typename U> requires(std::convertible_to<U*, T*>)
+    explicit shared_ptr(U* pointer)
+        : shared_ptr{pointer, std::default_delete<U>{}} {
+
+    }
+
+    // Takes ownership of `pointer`, which is deleted by `deleter`. The control block is allocated separately from
+    // `allocator`, if that fails `pointer` is deleted before the exception propagates.
+    template<typename U, typename Deleter, typing::simple_allocator Allocator = std::allocator<U>>
+    requires(std::convertible_to<U*, T*> && std::invocable<Deleter&, U*> && std::move_constructible<Deleter>)
+    shared_ptr(U* pointer, Deleter deleter, const Allocator& allocator = Allocator{})
+        : m_pointer{pointer} {
+        try {
+            m_control = allocate_control<Deleter>(pointer, std::move(deleter), allocator);
+        } catch (...) {
+            deleter(pointer);
+            throw;
+        }
+    }
+
+    // Takes ownership of what `other` owns. If allocating the control block throws, `other` still owns it.
+    template<typename U, typename Deleter> requires(std::convertible_to<U*, T*>)
+    shared_ptr(unique_ptr<U, Deleter>&& other)
+        : shared_ptr{} {
+        if (other.get() != nullptr) {
+            m_control = allocate_control<Deleter>(other.get(), std::move(other.get_deleter()), std::allocator<U>{});
+            m_pointer = other.release();
+        }
+    }
+
+    // Shares ownership with `other` but points at `pointer`, usually a member of the object `other` owns.
+    template<typename U>
+    shared_ptr(const shared_ptr<U, Policy>& other, T* pointer) noexcept
+        : m_pointer{pointer}
+        , m_control{other.m_control} {
+        if (m_control != nullptr) {
+            m_control->retain();
+        }
+    }
+
+    shared_ptr(const shared_ptr& other) noexcept
+        : m_pointer{other.m_pointer}
+        , m_control{other.m_control} {
+        if (m_control != nullptr) {
+            m_control->retain();
+        }
+    }
+
+    template<typename U> requires(std::convertible_to<U*, T*>)
+    shared_ptr(const shared_ptr<U, Policy>& other) noexcept
+        : m_pointer{other.m_pointer}
+        , m_control{other.m_control} {
+        if (m_control != nullptr) {
+            m_control->retain();
+        }
+    }
+
+    shared_ptr(shared_ptr&& other) noexcept
+        : m_pointer{std::exchange(other.m_pointer, nullptr)}
+        , m_control{std::exchange(other.m_control, nullptr)} {
+
+    }
+
+    template<typename U> requires(std::convertible_to<U*, T*>)
+    shared_ptr(shared_ptr<U, Policy>&& other) noexcept
+        : m_pointer{std::exchange(other.m_pointer, nullptr)}
+        , m_control{std::exchange(other.m_control, nullptr)} {
+
+    }
+
+    ~shared_ptr() noexcept {
+        if (m_control != nullptr) {
+            m_control->release();
+        }
+    }
+
+    auto operator=(const shared_ptr& other) noexcept -> shared_ptr& {
+        shared_ptr{other}.swap(*this);
+        return *this;
+    }
+
+    auto operator=(shared_ptr&& other) noexcept -> shared_ptr& {
+        shared_ptr{std::move(other)}.swap(*this);
+        return *this;
+    }
+
+    // access
+
+    auto get() const noexcept -> const T* {
+        return m_pointer;
+    }
+
+    auto get() noexcept -> T* {
+        return m_pointer;
+    }
+
+    auto operator*() const noexcept -> const T& requires(!std::is_void_v<T>) {
+        return *m_pointer;
+    }
+
+    auto operator*() noexcept -> T& requires(!std::is_void_v<T>) {
+        return *m_pointer;
+    }
+
+    auto operator->() const noexcept -> const T* {
+        return m_pointer;
+    }
+
+    auto operator->() noexcept -> T* {
+        return m_pointer;
+    }
+
+    explicit operator bool() const noexcept {
+        return m_pointer != nullptr;
+    }
+
+    // The number of `shared_ptr`s sharing the object, or zero if this is empty. With `atomic_count` the value may be
+    // stale by the time it is returned.
+    [[nodiscard]] auto use_count() const noexcept -> std::size_t {
+        return m_control != nullptr ? m_control->use_count() : 0;
+    }
+
+    // modification
+
+    auto reset() noexcept -> void {
+        shared_ptr{}.swap(*this);
+    }
+
+    template<typename U> requires(std::convertible_to<U*, T*>)
+    auto reset(U* pointer) -> void {
+        shared_ptr{pointer}.swap(*this);
+    }
+
+    auto swap(shared_ptr& other) noexcept -> void {
+        std::swap(m_pointer, other.m_pointer);
+        std::swap(m_control, other.m_control);
+    }
+
+    // comparison
+
+    template<typename U>
+    friend auto operator==(const shared_ptr& a, const shared_ptr<U, Policy>& b) noexcept -> bool {
+        return a.get() == b.get();
+    }
+
+    friend auto operator==(const shared_ptr& a, std::nullptr_t) noexcept -> bool {
+        return a.get() == nullptr;
+    }
+
+private:
+    template<typename U, count_policy P>
+    friend class shared_ptr;
+
+    template<typename U, count_policy P>
+    friend class weak_ptr;
+
+    friend struct utilities::niche_traits<shared_ptr>;
+
+    template<typename U, count_policy P, typing::simple_allocator Allocator, typename... Args>
+    requires(std::is_constructible_v<U, Args...>)
+    friend auto allocate_shared(const Allocator& allocator, Args&&... args) -> shared_ptr<U, P>;
+
+    // A control block that deletes `pointer` through `deleter`. Nothing is deleted if this throws.
+    template<typename Deleter, typename U, typename Allocator>
+    static auto allocate_control(U* pointer, Deleter&& deleter, const Allocator& allocator)
+        -> detail::control_block<Policy>* {
+        using block_type = detail::pointer_control_block<U, Deleter, Allocator, Policy>;
+        using block_allocator = typename block_type::allocator_type;
+        using block_traits = typename block_type::allocator_traits;
+
+        auto rebound = block_allocator{allocator};
+        auto block = block_traits::allocate(rebound, 1);
+        try {
+            return std::construct_at(block, pointer, std::forward<Deleter>(deleter), rebound);
+        } catch (...) {
+            block_traits::deallocate(rebound, block, 1);
+            throw;
+        }
+    }
+
+    // Takes over a reference that the caller already holds on `control`.
+    shared_ptr(detail::adopt_control_block, T* pointer, detail::control_block<Policy>* control) noexcept
+        : m_pointer{pointer}
+        , m_control{control} {
+
+    }
+
+    T* m_pointer{};
+    detail::control_block<Policy>* m_control{};
+}; // class shared_ptr
+
+// Observes an object owned by `shared_ptr`s without keeping it alive. `lock` gives a `shared_ptr` to the object, or an
+// empty one if it has already been destroyed.
+template<typename T, count_policy Policy>
+class weak_ptr {
+public:
+    using element_type = T;
+
+    // construction
+
+    constexpr weak_ptr() noexcept = default;
+
+    template<typename U> requires(std::convertible_to<U*, T*>)
+    weak_ptr(const shared_ptr<U, Policy>& other) noexcept
+        : m_pointer{other.m_pointer}
+        , m_control{other.m_control} {
+        if (m_control != nullptr) {
+            m_control->retain_weak();
+        }
+    }
+
+    weak_ptr(const weak_ptr& other) noexcept
+        : m_pointer{other.m_pointer}
+        , m_control{other.m_control} {
+        if (m_control != nullptr) {
+            m_control->retain_weak();
+        }
+    }
+
+    weak_ptr(weak_ptr&& other) noexcept
+        : m_pointer{std::exchange(other.m_pointer, nullptr)}
+        , m_control{std::exchange(other.m_control, nullptr)} {
+
+    }
+
+    ~weak_ptr() noexcept {
+        if (m_control != nullptr) {
+            m_control->release_weak();
+        }
+    }
+
+    auto operator=(const weak_ptr& other) noexcept -> weak_ptr& {
+        weak_ptr{other}.swap(*this);
+        return *this;
+    }
+
+    auto operator=(weak_ptr&& other) noexcept -> weak_ptr& {
+        weak_ptr{std::move(other)}.swap(*this);
+        return *this;
+    }
+
+    // access
+
+    [[nodiscard]] auto lock() const noexcept -> shared_ptr<T, Policy> {
+        if (m_control != nullptr && m_control->try_retain()) {
+            return shared_ptr<T, Policy>{detail::adopt_control_block{}, m_pointer, m_control};
+        }
+
+        return nullptr;
+    }
+
+    [[nodiscard]] auto expired() const noexcept -> bool {
+        return use_count() == 0;
+    }
+
+    [[nodiscard]] auto use_count() const noexcept -> std::size_t {
+        return m_control != nullptr ? m_control->use_count() : 0;
+    }
+
+    // modification
+
+    auto reset() noexcept -> void {
+        weak_ptr{}.swap(*this);
+    }
+
+    auto swap(weak_ptr& other) noexcept -> void {
+        std::swap(m_pointer, other.m_pointer);
+        std::swap(m_control, other.m_control);
+    }
+
+private:
+    T* m_pointer{};
+    detail::control_block<Policy>* m_control{};
+}; // class weak_ptr
+
+// Creates the object and its control block in one allocation from `allocator`, which is rebound to the block type.
+template<typename T, count_policy Policy = atomic_count, typing::simple_allocator Allocator, typename... Args>
+requires(std::is_constructible_v<T, Args...>)
+auto allocate_shared(const Allocator& allocator, Args&&... args) -> shared_ptr<T, Policy> {
+    using block_type = detail::inplace_control_block<T, Allocator, Policy>;
+    using block_allocator = typename block_type::allocator_type;
+    using block_traits = typename block_type::allocator_traits;
+
+    auto rebound = block_allocator{allocator};
+    auto block = block_traits::allocate(rebound, 1);
+    try {
+        std::construct_at(block, rebound, std::forward<Args>(args)...);
+    } catch (...) {
+        block_traits::deallocate(rebound, block, 1);
+        throw;
+    }
+
+    return shared_ptr<T, Policy>{detail::adopt_control_block{}, block->get(), block};
+}
+
+template<typename T, count_policy Policy = atomic_count, typename... Args> requires(std::is_constructible_v<T, Args...>)
+auto make_shared(Args&&... args) -> shared_ptr<T, Policy> {
+    return allocate_shared<T, Policy>(std::allocator<T>{}, std::forward<Args>(args)...);
+}
+} // namespace rtl::memory
+
+template<typename T, typename Policy>
+struct rtl::utilities::niche_traits<rtl::memory::shared_ptr<T, Policy>> {
+    static auto empty() noexcept -> rtl::memory::shared_ptr<T, Policy> {
+        return rtl::memory::shared_ptr<T, Policy>{};
+    }
+
+    // an aliasing pointer can be null while it owns something, so this checks for a control block instead
+    static auto is_empty(const rtl::memory::shared_ptr<T, Policy>& value) noexcept -> bool {
+        return value.m_control == nullptr;
+    }
+};
+
+template<typename T, typename Policy>
+struct rtl::typing::is_trivially_relocatable<rtl::memory::shared_ptr<T, Policy>> : std::true_type {
+
+};
+
+template<typename T, typename Policy>
+struct rtl::typing::is_trivially_relocatable<rtl::memory::weak_ptr<T, Policy>> : std::true_type {
+
+};
+
+#endif // #ifndef RTL_SHARED_PTR_HPP
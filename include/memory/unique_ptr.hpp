@@ -20,73 +20,137 @@
 #ifndef RTL_UNIQUE_PTR_HPP
 #define RTL_UNIQUE_PTR_HPP
 
+#include "typing/concepts.hpp"
+#include "utilities/attributes.hpp"
+#include "utilities/niche.hpp"
+
 #include <concepts>
+#include <cstddef>
 #include <memory>
+#include <new>
 #include <type_traits>
 #include <utility>
 
 namespace rtl::memory {
 namespace detail {
-template<typename T>
+// Stores a single member of a `compressed_pair`. Empty types are inherited from instead so they take up no space.
+// `Index` keeps the two bases distinct when both members have the same type.
+template<typename T, std::size_t Index, bool = std::is_empty_v<T> && !std::is_final_v<T>>
 class compressed_pair_element {
 public:
-    compressed_pair_element() noexcept(std::is_nothrow_default_constructible_v<T>)
+    constexpr compressed_pair_element() noexcept(std::is_nothrow_default_constructible_v<T>)
         requires(std::is_default_constructible_v<T>) = default;
 
-    compressed_pair_element(T&& value) noexcept(noexcept(std::is_nothrow_move_constructible_v<T>))
+    constexpr compressed_pair_element(T value) noexcept(std::is_nothrow_move_constructible_v<T>)
         : m_value{std::move(value)} {
 
     }
 
-    auto get() noexcept -> T& {
+    constexpr auto get() noexcept -> T& {
+        return m_value;
+    }
+
+    constexpr auto get() const noexcept -> const T& {
         return m_value;
     }
 
 private:
-    T m_value;
+    T m_value{};
+};
+
+template<typename T, std::size_t Index>
+class compressed_pair_element<T, Index, true> : private T {
+public:
+    constexpr compressed_pair_element() noexcept(std::is_nothrow_default_constructible_v<T>)
+        requires(std::is_default_constructible_v<T>) = default;
+
+    constexpr compressed_pair_element(T value) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : T{std::move(value)} {
+
+    }
+
+    constexpr auto get() noexcept -> T& {
+        return *this;
+    }
+
+    constexpr auto get() const noexcept -> const T& {
+        return *this;
+    }
 };
 
-template<typename T1, typename T2> requires(std::is_empty_v<T2>)
-class compressed_pair : private compressed_pair_element<T1>, private compressed_pair_element<T2> {
+// A pair that takes up no space for a member of an empty type, such as a stateless deleter or allocator. Members of
+// any other type are stored as usual.
+template<typename T1, typename T2>
+class compressed_pair : private compressed_pair_element<T1, 0>, private compressed_pair_element<T2, 1> {
+private:
+    using first_element = compressed_pair_element<T1, 0>;
+    using second_element = compressed_pair_element<T2, 1>;
+
 public:
-    compressed_pair()
+    constexpr compressed_pair()
         noexcept(std::is_nothrow_default_constructible_v<T1> && std::is_nothrow_default_constructible_v<T2>)
         requires(std::is_default_constructible_v<T1> && std::is_default_constructible_v<T2>) = default;
 
-    compressed_pair(T1&& first, T2&& second)
+    constexpr compressed_pair(T1 first, T2 second)
         noexcept(std::is_nothrow_move_constructible_v<T1> && std::is_nothrow_move_constructible_v<T2>)
-        : compressed_pair_element<T1>{std::move(first)}
-        , compressed_pair_element<T2>{std::move(second)} {
+        : first_element{std::move(first)}
+        , second_element{std::move(second)} {
+
+    }
+
+    constexpr auto first() noexcept -> T1& {
+        return first_element::get();
+    }
 
+    constexpr auto first() const noexcept -> const T1& {
+        return first_element::get();
     }
 
-    auto first() noexcept -> T1& {
-        return compressed_pair_element<T1>::get();
+    constexpr auto second() noexcept -> T2& {
+        return second_element::get();
     }
 
-    auto second() noexcept {
-        return compressed_pair_element<T2>::get();
+    constexpr auto second() const noexcept -> const T2& {
+        return second_element::get();
     }
 };
 } // namespace detail
 
-template<typename T, typename Deleter = std::default_delete<T>> requires(requires(Deleter deleter, T* pointer) {
+// A callable that `unique_ptr<T>` can destroy its object with, or its array with for `unique_ptr<T[]>`.
+template<typename Deleter, typename T>
+concept deleter_for = std::is_object_v<Deleter> && requires(Deleter& deleter, std::remove_extent_t<T>* pointer) {
     { deleter(pointer) } -> std::same_as<void>;
-} && std::is_default_constructible_v<Deleter> && std::is_empty_v<Deleter>)
+};
+
+// Owns an object and destroys it with `Deleter` when it goes out of scope. A deleter with no state takes up no space,
+// so the pointer is the size of a raw one, while a stateful deleter is stored alongside the pointer.
+template<typename T, typename Deleter = std::default_delete<T>> requires(deleter_for<Deleter, T>)
 class unique_ptr {
 private:
     static constexpr bool s_deleter_nothrow_default_constructible = std::is_nothrow_default_constructible_v<Deleter>;
     static constexpr bool s_deleter_nothrow_move_constructible = std::is_nothrow_move_constructible_v<Deleter>;
 
 public:
-    constexpr unique_ptr() noexcept(s_deleter_nothrow_default_constructible) = default;
+    using element_type = T;
+    using deleter_type = Deleter;
+
+    constexpr unique_ptr() noexcept(s_deleter_nothrow_default_constructible)
+        requires(std::is_default_constructible_v<Deleter>) = default;
 
     constexpr unique_ptr(std::nullptr_t) noexcept(s_deleter_nothrow_default_constructible)
+        requires(std::is_default_constructible_v<Deleter>)
         : m_pair{nullptr, Deleter{}} {
 
     }
 
-    constexpr unique_ptr(T* pointer) noexcept(s_deleter_nothrow_default_constructible) : m_pair{pointer, Deleter{}} {
+    constexpr unique_ptr(T* pointer) noexcept(s_deleter_nothrow_default_constructible)
+        requires(std::is_default_constructible_v<Deleter>)
+        : m_pair{pointer, Deleter{}} {
+
+    }
+
+    constexpr unique_ptr(T* pointer, Deleter deleter) noexcept(s_deleter_nothrow_move_constructible)
+        : m_pair{pointer, std::move(deleter)} {
 
     }
 
@@ -101,6 +165,17 @@ public:
         reset();
     }
 
+    constexpr auto operator=(unique_ptr&& other) noexcept(std::is_nothrow_move_assignable_v<Deleter>) -> unique_ptr& {
+        if (this != &other) {
+            reset(other.release());
+            get_deleter() = std::move(other.get_deleter());
+        }
+
+        return *this;
+    }
+
+    constexpr auto operator=(const unique_ptr&) -> unique_ptr& = delete;
+
     constexpr auto get() const noexcept -> const T* {
         return m_pair.first();
     }
@@ -121,23 +196,316 @@ public:
         return std::exchange(m_pair.first(), nullptr);
     }
 
-    constexpr auto reset() noexcept -> void {
-        m_pair.second()(release());
+    constexpr auto reset(T* pointer = nullptr) noexcept -> void {
+        if (auto old = std::exchange(m_pair.first(), pointer); old != nullptr) {
+            m_pair.second()(old);
+        }
     }
 
-    constexpr auto swap(unique_ptr& other) noexcept -> void {
-        std::swap(get(), other.get());
+    constexpr auto swap(unique_ptr& other) noexcept(std::is_nothrow_swappable_v<Deleter>) -> void {
+        using std::swap;
+        swap(m_pair.first(), other.m_pair.first());
+        swap(m_pair.second(), other.m_pair.second());
     }
 
 private:
-    detail::compressed_pair<T, Deleter> m_pair;
+    detail::compressed_pair<T*, Deleter> m_pair;
 }; // class unique_ptr
 
-template<typename T, typename... Args> requires(std::is_constructible_v<T, Args...>)
+// Owns an array, which is destroyed as a whole by `Deleter`. The pointer doesn't know the length, so a deleter that
+// needs it, like `allocator_delete<T[]>`, carries it.
+template<typename T, typename Deleter> requires(deleter_for<Deleter, T[]>)
+class unique_ptr<T[], Deleter> {
+private:
+    static constexpr bool s_deleter_nothrow_default_constructible = std::is_nothrow_default_constructible_v<Deleter>;
+    static constexpr bool s_deleter_nothrow_move_constructible = std::is_nothrow_move_constructible_v<Deleter>;
+
+public:
+    using element_type = T;
+    using deleter_type = Deleter;
+
+    constexpr unique_ptr() noexcept(s_deleter_nothrow_default_constructible)
+        requires(std::is_default_constructible_v<Deleter>) = default;
+
+    constexpr unique_ptr(std::nullptr_t) noexcept(s_deleter_nothrow_default_constructible)
+        requires(std::is_default_constructible_v<Deleter>)
+        : m_pair{nullptr, Deleter{}} {
+
+    }
+
+    constexpr unique_ptr(T* pointer) noexcept(s_deleter_nothrow_default_constructible)
+        requires(std::is_default_constructible_v<Deleter>)
+        : m_pair{pointer, Deleter{}} {
+
+    }
+
+    constexpr unique_ptr(T* pointer, Deleter deleter) noexcept(s_deleter_nothrow_move_constructible)
+        : m_pair{pointer, std::move(deleter)} {
+
+    }
+
+    constexpr unique_ptr(unique_ptr&& other) noexcept(s_deleter_nothrow_move_constructible)
+        : m_pair{other.get(), std::move(other.get_deleter())} {
+        other.m_pair.first() = nullptr;
+    }
+
+    constexpr unique_ptr(const unique_ptr&) = delete;
+
+    constexpr ~unique_ptr() {
+        reset();
+    }
+
+    constexpr auto operator=(unique_ptr&& other) noexcept(std::is_nothrow_move_assignable_v<Deleter>) -> unique_ptr& {
+        if (this != &other) {
+            reset(other.release());
+            get_deleter() = std::move(other.get_deleter());
+        }
+
+        return *this;
+    }
+
+    constexpr auto operator=(const unique_ptr&) -> unique_ptr& = delete;
+
+    // Unchecked, the pointer doesn't know how many elements there are.
+    constexpr auto operator[](std::size_t index) const noexcept -> const T& {
+        return m_pair.first()[index];
+    }
+
+    constexpr auto operator[](std::size_t index) noexcept -> T& {
+        return m_pair.first()[index];
+    }
+
+    constexpr auto get() const noexcept -> const T* {
+        return m_pair.first();
+    }
+
+    constexpr auto get() noexcept -> T* {
+        return m_pair.first();
+    }
+
+    constexpr auto get_deleter() noexcept -> Deleter& {
+        return m_pair.second();
+    }
+
+    constexpr auto get_deleter() const noexcept -> const Deleter& {
+        return m_pair.second();
+    }
+
+    constexpr auto release() noexcept -> T* {
+        return std::exchange(m_pair.first(), nullptr);
+    }
+
+    // The deleter is kept, so if it carries the length, it must suit `pointer` too.
+    constexpr auto reset(T* pointer = nullptr) noexcept -> void {
+        if (auto old = std::exchange(m_pair.first(), pointer); old != nullptr) {
+            m_pair.second()(old);
+        }
+    }
+
+    constexpr auto swap(unique_ptr& other) noexcept(std::is_nothrow_swappable_v<Deleter>) -> void {
+        using std::swap;
+        swap(m_pair.first(), other.m_pair.first());
+        swap(m_pair.second(), other.m_pair.second());
+    }
+
+private:
+    detail::compressed_pair<T*, Deleter> m_pair;
+}; // class unique_ptr<T[]>
+
+template<typename T, typename... Args> requires(!std::is_array_v<T> && std::is_constructible_v<T, Args...>)
 constexpr inline auto make_unique(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>)
     -> unique_ptr<T> {
     return unique_ptr{new T{std::forward<Args>(args)...}};
 }
+
+// Creates an array of `count` value-initialised elements.
+template<typename T> requires(std::is_unbounded_array_v<T>)
+constexpr inline auto make_unique(std::size_t count) -> unique_ptr<T> {
+    return unique_ptr<T>{new std::remove_extent_t<T>[count]{}};
+}
+
+// Like `make_unique`, but the object is default-initialised, so a trivial type is left uninitialised for the caller
+// to overwrite.
+template<typename T> requires(!std::is_array_v<T> && std::is_default_constructible_v<T>)
+constexpr inline auto make_unique_for_overwrite() -> unique_ptr<T> {
+    return unique_ptr<T>{new T};
+}
+
+template<typename T> requires(std::is_unbounded_array_v<T>)
+constexpr inline auto make_unique_for_overwrite(std::size_t count) -> unique_ptr<T> {
+    return unique_ptr<T>{new std::remove_extent_t<T>[count]};
+}
+
+// Deleter for objects created by `allocate_unique`, destroys the object and returns its memory to a copy of the
+// allocator it came from. A stateless allocator takes up no space.
+template<typename T, typing::simple_allocator Allocator>
+class allocator_delete {
+public:
+    using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+    using allocator_traits = std::allocator_traits<allocator_type>;
+
+    constexpr allocator_delete() noexcept(std::is_nothrow_default_constructible_v<allocator_type>)
+        requires(std::is_default_constructible_v<allocator_type>) = default;
+
+    explicit constexpr allocator_delete(const allocator_type& allocator) noexcept
+        : m_allocator{allocator} {
+
+    }
+
+    constexpr auto operator()(T* pointer) noexcept -> void {
+        if (pointer != nullptr) {
+            allocator_traits::destroy(m_allocator, pointer);
+            allocator_traits::deallocate(m_allocator, pointer, 1);
+        }
+    }
+
+private:
+    RTL_NO_UNIQUE_ADDRESS allocator_type m_allocator{};
+}; // class allocator_delete
+
+// Deleter for arrays created by `allocate_unique`, which also carries their length since the allocator needs it back.
+template<typename T, typing::simple_allocator Allocator>
+class allocator_delete<T[], Allocator> {
+public:
+    using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+    using allocator_traits = std::allocator_traits<allocator_type>;
+
+    constexpr allocator_delete() noexcept(std::is_nothrow_default_constructible_v<allocator_type>)
+        requires(std::is_default_constructible_v<allocator_type>) = default;
+
+    constexpr allocator_delete(const allocator_type& allocator, std::size_t count) noexcept
+        : m_allocator{allocator}
+        , m_count{count} {
+
+    }
+
+    constexpr auto operator()(T* pointer) noexcept -> void {
+        if (pointer != nullptr) {
+            for (auto i = m_count; i > 0; i--) {
+                allocator_traits::destroy(m_allocator, pointer + i - 1);
+            }
+
+            allocator_traits::deallocate(m_allocator, pointer, m_count);
+        }
+    }
+
+    [[nodiscard]] constexpr auto size() const noexcept -> std::size_t {
+        return m_count;
+    }
+
+private:
+    RTL_NO_UNIQUE_ADDRESS allocator_type m_allocator{};
+    std::size_t m_count{};
+}; // class allocator_delete<T[]>
+
+namespace detail {
+// Allocates `count` elements from `allocator` and creates them with `construct`, destroying those already created
+// and freeing the memory if one of them throws.
+template<typename Allocator, typename Construct>
+constexpr auto allocate_array(Allocator& allocator, std::size_t count, Construct construct)
+    -> typename std::allocator_traits<Allocator>::value_type* {
+    using allocator_traits = std::allocator_traits<Allocator>;
+
+    auto pointer = allocator_traits::allocate(allocator, count);
+    std::size_t created = 0;
+    try {
+        for (; created < count; created++) {
+            construct(pointer + created);
+        }
+    } catch (...) {
+        for (; created > 0; created--) {
+            allocator_traits::destroy(allocator, pointer + created - 1);
+        }
+
+        allocator_traits::deallocate(allocator, pointer, count);
+        throw;
+    }
+
+    return pointer;
+}
+
+template<typename Allocator, typename Construct>
+constexpr auto allocate_object(Allocator& allocator, Construct construct)
+    -> typename std::allocator_traits<Allocator>::value_type* {
+    return allocate_array(allocator, 1, construct);
+}
+} // namespace detail
+
+template<typename T, typing::simple_allocator Allocator, typename... Args>
+requires(!std::is_array_v<T> && std::is_constructible_v<T, Args...>)
+constexpr inline auto allocate_unique(const Allocator& allocator, Args&&... args)
+    -> unique_ptr<T, allocator_delete<T, Allocator>> {
+    using deleter = allocator_delete<T, Allocator>;
+
+    auto rebound = typename deleter::allocator_type{allocator};
+    auto pointer = detail::allocate_object(rebound, [&](T* object) {
+        deleter::allocator_traits::construct(rebound, object, std::forward<Args>(args)...);
+    });
+
+    return unique_ptr<T, deleter>{pointer, deleter{rebound}};
+}
+
+// Creates an array of `count` value-initialised elements from `allocator`.
+template<typename T, typing::simple_allocator Allocator> requires(std::is_unbounded_array_v<T>)
+constexpr inline auto allocate_unique(const Allocator& allocator, std::size_t count)
+    -> unique_ptr<T, allocator_delete<T, Allocator>> {
+    using deleter = allocator_delete<T, Allocator>;
+
+    auto rebound = typename deleter::allocator_type{allocator};
+    auto pointer = detail::allocate_array(rebound, count, [&](std::remove_extent_t<T>* element) {
+        deleter::allocator_traits::construct(rebound, element);
+    });
+
+    return unique_ptr<T, deleter>{pointer, deleter{rebound, count}};
+}
+
+// Like `allocate_unique`, but the object is default-initialised rather than going through the allocator's
+// `construct`, so a trivial type is left uninitialised. This is the way to get a large scratch buffer from an arena
+// without paying to zero it.
+template<typename T, typing::simple_allocator Allocator>
+requires(!std::is_array_v<T> && std::is_default_constructible_v<T>)
+constexpr inline auto allocate_unique_for_overwrite(const Allocator& allocator)
+    -> unique_ptr<T, allocator_delete<T, Allocator>> {
+    using deleter = allocator_delete<T, Allocator>;
+
+    auto rebound = typename deleter::allocator_type{allocator};
+    auto pointer = detail::allocate_object(rebound, [](T* object) {
+        ::new (static_cast<void*>(object)) T;
+    });
+
+    return unique_ptr<T, deleter>{pointer, deleter{rebound}};
+}
+
+template<typename T, typing::simple_allocator Allocator> requires(std::is_unbounded_array_v<T>)
+constexpr inline auto allocate_unique_for_overwrite(const Allocator& allocator, std::size_t count)
+    -> unique_ptr<T, allocator_delete<T, Allocator>> {
+    using deleter = allocator_delete<T, Allocator>;
+    using element_type = std::remove_extent_t<T>;
+
+    auto rebound = typename deleter::allocator_type{allocator};
+    auto pointer = detail::allocate_array(rebound, count, [](element_type* element) {
+        ::new (static_cast<void*>(element)) element_type;
+    });
+
+    return unique_ptr<T, deleter>{pointer, deleter{rebound, count}};
+}
 } // namespace rtl::memory
 
+template<typename T, typename Deleter> requires(std::is_default_constructible_v<Deleter>)
+struct rtl::utilities::niche_traits<rtl::memory::unique_ptr<T, Deleter>> {
+    static constexpr auto empty() noexcept -> rtl::memory::unique_ptr<T, Deleter> {
+        return rtl::memory::unique_ptr<T, Deleter>{};
+    }
+
+    static constexpr auto is_empty(const rtl::memory::unique_ptr<T, Deleter>& value) noexcept -> bool {
+        return value.get() == nullptr;
+    }
+};
+
+template<typename T, typename Deleter>
+struct rtl::typing::is_trivially_relocatable<rtl::memory::unique_ptr<T, Deleter>>
+    : rtl::typing::is_trivially_relocatable<Deleter> {
+
+};
+
 #endif // #ifndef RTL_UNIQUE_PTR_HPP
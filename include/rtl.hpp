@@ -21,7 +21,11 @@
 #define RTL_HPP
 
 #include "collections.hpp"
+#include "concurrency.hpp"
+#include "fs.hpp"
+#include "json.hpp"
 #include "memory.hpp"
+#include "strings.hpp"
 #include "typing.hpp"
 #include "utilities.hpp"
 
@@ -0,0 +1,430 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_INTERNER_HPP
+#define RTL_INTERNER_HPP
+
+#include "collections/list.hpp"
+#include "memory/arena.hpp"
+#include "memory/unique_ptr.hpp"
+#include "utilities/assertions.hpp"
+#include "utilities/cpu.hpp"
+#include "utilities/niche.hpp"
+#include "utilities/option.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+namespace rtl::strings {
+// A handle to a string owned by an `interner` or a `concurrent_interner`. Interning the same characters in the same
+// interner always produces the same handle, so handles compare and hash as the 32 bit integers they are without
+// touching the characters. Ordering is by the interner's internal numbering, not by the characters.
+//
+// A default constructed handle refers to no string, and is the niche an `option<interned>` uses.
+class interned {
+public:
+    static constexpr std::uint32_t empty_id = std::numeric_limits<std::uint32_t>::max();
+
+    constexpr interned() noexcept = default;
+
+    [[nodiscard]] constexpr auto id() const noexcept -> std::uint32_t {
+        return m_id;
+    }
+
+    friend constexpr auto operator==(interned, interned) noexcept -> bool = default;
+    friend constexpr auto operator<=>(interned, interned) noexcept -> std::strong_ordering = default;
+
+private:
+    friend class interner;
+    friend class concurrent_interner;
+
+    explicit constexpr interned(std::uint32_t id) noexcept : m_id{id} {
+
+    }
+
+    std::uint32_t m_id{empty_id};
+}; // class interned
+} // namespace rtl::strings
+
+// declared before `option<interned>` is first used below
+template<>
+struct rtl::utilities::niche_traits<rtl::strings::interned> {
+    static constexpr auto empty() noexcept -> rtl::strings::interned {
+        return rtl::strings::interned{};
+    }
+
+    static constexpr auto is_empty(const rtl::strings::interned& value) noexcept -> bool {
+        return value.id() == rtl::strings::interned::empty_id;
+    }
+};
+
+namespace rtl::strings {
+namespace detail {
+struct interned_entry {
+    const char* data;
+    std::uint32_t size;
+    std::uint32_t hash;
+};
+
+inline auto hash_chars(std::string_view chars) noexcept -> std::uint32_t {
+    auto hash = static_cast<std::uint64_t>(std::hash<std::string_view>{}(chars));
+    return static_cast<std::uint32_t>(hash ^ (hash >> 32));
+}
+
+// The characters and the lookup table behind an interner. Characters are copied into arena chunks back to back, each
+// followed by a null terminator, and never move. The entries describing them live in blocks that double in size and
+// never move either, so an entry can be read without synchronising with threads that add others. The table is open
+// addressed with linear probing and keeps each entry's hash next to its index, so probing and rehashing never touch
+// the characters of entries that don't match.
+class intern_table {
+public:
+    explicit intern_table(std::uint32_t max_size = interned::empty_id, std::size_t chunk_size = s_chunk_size) noexcept
+        : m_arena{chunk_size}
+        , m_max_size{max_size} {
+
+    }
+
+    intern_table(const intern_table&) = delete;
+
+    intern_table(intern_table&& other) noexcept
+        : m_arena{std::move(other.m_arena)}
+        , m_slots{std::move(other.m_slots)}
+        , m_size{std::exchange(other.m_size, 0)}
+        , m_max_size{other.m_max_size} {
+        std::ranges::copy(other.m_blocks, m_blocks);
+        std::ranges::fill(other.m_blocks, nullptr);
+    }
+
+    auto operator=(const intern_table&) -> intern_table& = delete;
+
+    auto operator=(intern_table&& other) noexcept -> intern_table& {
+        if (this == &other) {
+            return *this;
+        }
+
+        m_arena = std::move(other.m_arena);
+        m_slots = std::move(other.m_slots);
+        m_size = std::exchange(other.m_size, 0);
+        m_max_size = other.m_max_size;
+        std::ranges::copy(other.m_blocks, m_blocks);
+        std::ranges::fill(other.m_blocks, nullptr);
+        return *this;
+    }
+
+    // The index of `chars`, which is added if it isn't in the table yet.
+    auto intern(std::string_view chars, std::uint32_t hash) -> std::uint32_t {
+        if ((std::size_t{m_size} + 1) * 4 > m_slots.size() * 3) {
+            rehash(m_slots.empty() ? s_min_slots : m_slots.size() * 2);
+        }
+
+        auto mask = m_slots.size() - 1;
+        for (auto i = hash & mask;; i = (i + 1) & mask) {
+            auto& slot = m_slots.data()[i];
+            if (slot.index == 0) {
+                slot = {hash, add(chars, hash) + 1};
+                return slot.index - 1;
+            } else if (slot.hash == hash && matches(slot.index - 1, chars)) {
+                return slot.index - 1;
+            }
+        }
+    }
+
+    auto find(std::string_view chars, std::uint32_t hash) const noexcept -> utilities::option<std::uint32_t> {
+        if (m_slots.empty()) {
+            return utilities::nullopt;
+        }
+
+        auto mask = m_slots.size() - 1;
+        for (auto i = hash & mask;; i = (i + 1) & mask) {
+            const auto& slot = m_slots.data()[i];
+            if (slot.index == 0) {
+                return utilities::nullopt;
+            } else if (slot.hash == hash && matches(slot.index - 1, chars)) {
+                return slot.index - 1;
+            }
+        }
+    }
+
+    // `index` must have been returned by `intern`.
+    auto entry(std::uint32_t index) const noexcept -> const interned_entry& {
+        auto [block, offset] = locate(index);
+        return m_blocks[block][offset];
+    }
+
+    [[nodiscard]] auto size() const noexcept -> std::uint32_t {
+        return m_size;
+    }
+
+    // The bytes held for the characters, the entries and the table.
+    [[nodiscard]] auto memory_usage() const noexcept -> std::size_t {
+        return m_arena.capacity() + m_slots.capacity() * sizeof(table_slot);
+    }
+
+private:
+    struct table_slot {
+        std::uint32_t hash;
+        // the index of the entry plus one, zero for an empty slot
+        std::uint32_t index;
+    };
+
+    static constexpr std::size_t s_chunk_size = 64 * 1024;
+    static constexpr std::size_t s_min_slots = 16;
+    static constexpr std::size_t s_first_block_shift = 6;
+    // enough blocks for every 32 bit index
+    static constexpr std::size_t s_block_count = 32 - s_first_block_shift + 1;
+
+    static constexpr auto locate(std::uint32_t index) noexcept -> std::pair<std::size_t, std::size_t> {
+        auto position = std::uint64_t{index} + (std::uint64_t{1} << s_first_block_shift);
+        auto block = static_cast<std::size_t>(std::bit_width(position)) - 1 - s_first_block_shift;
+        auto offset = static_cast<std::size_t>(position - (std::uint64_t{1} << (block + s_first_block_shift)));
+        return {block, offset};
+    }
+
+    auto matches(std::uint32_t index, std::string_view chars) const noexcept -> bool {
+        const auto& entry = this->entry(index);
+        return std::string_view{entry.data, entry.size} == chars;
+    }
+
+    auto add(std::string_view chars, std::uint32_t hash) -> std::uint32_t {
+        RTL_ASSERT(m_size < m_max_size, std::format("The interner is full with {} strings", m_size));
+        RTL_ASSERT(chars.size() <= std::numeric_limits<std::uint32_t>::max(),
+            std::format("Strings of {} characters are too long to intern", chars.size()));
+
+        auto index = m_size;
+        auto [block, offset] = locate(index);
+        if (m_blocks[block] == nullptr) {
+            auto block_size = std::size_t{1} << (block + s_first_block_shift);
+            m_blocks[block] = static_cast<interned_entry*>(
+                m_arena.allocate(block_size * sizeof(interned_entry), alignof(interned_entry)));
+        }
+
+        auto data = static_cast<char*>(m_arena.allocate(chars.size() + 1, 1));
+        if (!chars.empty()) {
+            std::memcpy(data, chars.data(), chars.size());
+        }
+        data[chars.size()] = '\0';
+
+        std::construct_at(m_blocks[block] + offset,
+            interned_entry{data, static_cast<std::uint32_t>(chars.size()), hash});
+        m_size++;
+        return index;
+    }
+
+    auto rehash(std::size_t slot_count) -> void {
+        auto slots = collections::list<table_slot>(slot_count);
+        auto mask = slot_count - 1;
+        for (const auto& old : m_slots) {
+            if (old.index == 0) {
+                continue;
+            }
+
+            auto i = old.hash & mask;
+            while (slots.data()[i].index != 0) {
+                i = (i + 1) & mask;
+            }
+
+            slots.data()[i] = old;
+        }
+
+        m_slots = std::move(slots);
+    }
+
+    memory::arena m_arena;
+    interned_entry* m_blocks[s_block_count]{};
+    collections::list<table_slot> m_slots;
+    std::uint32_t m_size{};
+    std::uint32_t m_max_size;
+}; // class intern_table
+} // namespace detail
+
+// Deduplicates strings, handing out an `interned` handle for each distinct string. The characters are stored back to
+// back in arena chunks and stay at the same address until the interner is destroyed, so the views returned by `view`
+// remain valid for as long as the interner does. Strings are never removed.
+class interner {
+public:
+    static constexpr std::size_t default_chunk_size = memory::arena::default_chunk_size;
+
+    interner() noexcept = default;
+
+    explicit interner(std::size_t chunk_size) noexcept : m_table{interned::empty_id, chunk_size} {
+
+    }
+
+    auto intern(std::string_view chars) -> interned {
+        return interned{m_table.intern(chars, detail::hash_chars(chars))};
+    }
+
+    // The handle for `chars` if it has been interned, without interning it otherwise.
+    auto find(std::string_view chars) const noexcept -> utilities::option<interned> {
+        return m_table.find(chars, detail::hash_chars(chars)).map([](std::uint32_t id) {
+            return interned{id};
+        });
+    }
+
+    // The characters of `handle`, which must have come from this interner. They are followed by a null terminator.
+    auto view(interned handle) const noexcept -> std::string_view {
+        RTL_ASSERT(handle.id() < m_table.size(),
+            std::format("The handle {} did not come from this interner", handle.id()));
+        const auto& entry = m_table.entry(handle.id());
+        return {entry.data, entry.size};
+    }
+
+    // The hash of the characters of `handle`, computed when it was interned.
+    auto hash(interned handle) const noexcept -> std::uint32_t {
+        return m_table.entry(handle.id()).hash;
+    }
+
+    // The number of distinct strings.
+    [[nodiscard]] auto size() const noexcept -> std::size_t {
+        return m_table.size();
+    }
+
+    [[nodiscard]] auto empty() const noexcept -> bool {
+        return size() == 0;
+    }
+
+    [[nodiscard]] auto memory_usage() const noexcept -> std::size_t {
+        return m_table.memory_usage();
+    }
+
+private:
+    detail::intern_table m_table;
+}; // class interner
+
+// An `interner` that can be used from any number of threads at once. Strings are spread over shards by their hash,
+// each with its own lock, so threads interning different strings rarely contend. Looking up the characters of a
+// handle doesn't lock at all.
+//
+// A handle keeps the shard in its low bits, so every extra bit of shards halves the number of strings one shard holds.
+class concurrent_interner {
+public:
+    static constexpr std::size_t max_shard_count = 256;
+
+    // The shard count is rounded up to a power of two.
+    explicit concurrent_interner(std::size_t shard_count = default_shard_count(),
+                                 std::size_t chunk_size = interner::default_chunk_size)
+        : m_shard_bits{static_cast<std::uint32_t>(std::countr_zero(
+            std::bit_ceil(std::clamp<std::size_t>(shard_count, 1, max_shard_count))))} {
+        auto count = std::size_t{1} << m_shard_bits;
+        // the largest index still has to fit beside the shard bits without becoming the empty id
+        auto max_size = static_cast<std::uint32_t>(interned::empty_id >> m_shard_bits);
+        m_shards.reserve(count);
+        for (std::size_t i = 0; i < count; i++) {
+            m_shards.add(memory::make_unique<shard>(max_size, chunk_size));
+        }
+    }
+
+    concurrent_interner(const concurrent_interner&) = delete;
+    auto operator=(const concurrent_interner&) -> concurrent_interner& = delete;
+
+    static auto default_shard_count() noexcept -> std::size_t {
+        return std::max<std::size_t>(1, std::thread::hardware_concurrency()) * 4;
+    }
+
+    auto intern(std::string_view chars) -> interned {
+        auto hash = detail::hash_chars(chars);
+        auto index = shard_index(hash);
+        auto& shard = *m_shards.data()[index].get();
+        auto lock = std::lock_guard{shard.mutex};
+        return interned{(shard.table.intern(chars, hash) << m_shard_bits) | index};
+    }
+
+    auto find(std::string_view chars) const -> utilities::option<interned> {
+        auto hash = detail::hash_chars(chars);
+        auto index = shard_index(hash);
+        auto& shard = *m_shards.data()[index].get();
+        auto lock = std::lock_guard{shard.mutex};
+        return shard.table.find(chars, hash).map([this, index](std::uint32_t local) {
+            return interned{(local << m_shard_bits) | index};
+        });
+    }
+
+    // The characters of `handle`, which must have come from this interner. The handle must have reached this thread
+    // through something that synchronises with the thread that interned it, as handing over any other value would.
+    auto view(interned handle) const noexcept -> std::string_view {
+        const auto& entry = locate(handle);
+        return {entry.data, entry.size};
+    }
+
+    auto hash(interned handle) const noexcept -> std::uint32_t {
+        return locate(handle).hash;
+    }
+
+    // The number of distinct strings, which may already be out of date when other threads are interning.
+    [[nodiscard]] auto size() const -> std::size_t {
+        std::size_t size = 0;
+        for (const auto& shard : m_shards) {
+            auto lock = std::lock_guard{shard.get()->mutex};
+            size += shard.get()->table.size();
+        }
+
+        return size;
+    }
+
+    [[nodiscard]] auto shard_count() const noexcept -> std::size_t {
+        return m_shards.size();
+    }
+
+private:
+    struct alignas(utilities::cache_line_size) shard {
+        shard(std::uint32_t max_size, std::size_t chunk_size) noexcept : table{max_size, chunk_size} {
+
+        }
+
+        mutable std::mutex mutex;
+        detail::intern_table table;
+    };
+
+    // the top bits, the table uses the bottom bits to pick a slot
+    auto shard_index(std::uint32_t hash) const noexcept -> std::uint32_t {
+        return m_shard_bits == 0 ? 0 : hash >> (32 - m_shard_bits);
+    }
+
+    auto locate(interned handle) const noexcept -> const detail::interned_entry& {
+        RTL_ASSERT(handle.id() != interned::empty_id, "The handle does not refer to a string");
+        auto index = handle.id() & ((std::uint32_t{1} << m_shard_bits) - 1);
+        return m_shards.data()[index].get()->table.entry(handle.id() >> m_shard_bits);
+    }
+
+    collections::list<memory::unique_ptr<shard>> m_shards;
+    std::uint32_t m_shard_bits;
+}; // class concurrent_interner
+} // namespace rtl::strings
+
+// The id is already unique per interner, hash maps spread its bits themselves.
+template<>
+struct std::hash<rtl::strings::interned> {
+    auto operator()(rtl::strings::interned handle) const noexcept -> std::size_t {
+        return handle.id();
+    }
+};
+
+#endif // #ifndef RTL_INTERNER_HPP
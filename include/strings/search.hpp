@@ -0,0 +1,195 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_STRING_SEARCH_HPP
+#define RTL_STRING_SEARCH_HPP
+
+#include "collections/algorithms.hpp"
+#include "utilities/cpu.hpp"
+#include "utilities/simd.hpp"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Search kernels for `strings::basic_string`. Like the collection algorithms they pick AVX2 or SSE4.2 at runtime and
+// otherwise fall back to scalar loops. Every kernel returns `size` when nothing is found.
+
+namespace rtl::strings::detail {
+// a set of characters for `find_first_of` small enough to compare against one vector per character
+inline constexpr std::size_t max_vector_set_size = 16;
+
+// scalar kernels, used without vector support and in constant evaluation
+
+constexpr auto find_substring_scalar(const char* data, std::size_t size, const char* needle, std::size_t needle_size)
+    -> std::size_t {
+    auto index = std::string_view{data, size}.find(std::string_view{needle, needle_size});
+    return index == std::string_view::npos ? size : index;
+}
+
+constexpr auto find_first_of_scalar(const char* data, std::size_t size, const char* set, std::size_t set_size)
+    -> std::size_t {
+    bool in_set[256]{};
+    for (std::size_t i = 0; i < set_size; i++) {
+        in_set[static_cast<unsigned char>(set[i])] = true;
+    }
+
+    for (std::size_t i = 0; i < size; i++) {
+        if (in_set[static_cast<unsigned char>(data[i])]) {
+            return i;
+        }
+    }
+
+    return size;
+}
+
+// vector kernels
+
+// `needle_size` must be at least two. Candidates are the positions where both the first and the last characters of
+// the needle match, which rules out almost every position a whole vector at a time, and only they are compared fully.
+template<typename Vec>
+auto find_substring_vector(const char* data, std::size_t size, const char* needle, std::size_t needle_size) noexcept
+    -> std::size_t {
+    auto first = Vec{};
+    first.fill(needle[0]);
+    auto last = Vec{};
+    last.fill(needle[needle_size - 1]);
+
+    auto block_first = Vec{};
+    auto block_last = Vec{};
+    std::size_t i = 0;
+    for (; i + needle_size - 1 + Vec::lanes <= size; i += Vec::lanes) {
+        block_first.load(data + i);
+        block_last.load(data + i + needle_size - 1);
+        auto mask = block_first.equal_mask(first) & block_last.equal_mask(last);
+        while (mask != 0) {
+            auto candidate = i + static_cast<std::size_t>(std::countr_zero(mask));
+            if (std::string_view{data + candidate + 1, needle_size - 2}
+                    == std::string_view{needle + 1, needle_size - 2}) {
+                return candidate;
+            }
+
+            mask &= mask - 1;
+        }
+    }
+
+    return i + find_substring_scalar(data + i, size - i, needle, needle_size);
+}
+
+// `set_size` must be between one and `max_vector_set_size`.
+template<typename Vec>
+auto find_first_of_vector(const char* data, std::size_t size, const char* set, std::size_t set_size) noexcept
+    -> std::size_t {
+    Vec needles[max_vector_set_size];
+    for (std::size_t j = 0; j < set_size; j++) {
+        needles[j].fill(set[j]);
+    }
+
+    auto block = Vec{};
+    std::size_t i = 0;
+    for (; i + Vec::lanes <= size; i += Vec::lanes) {
+        block.load(data + i);
+        std::uint32_t mask = 0;
+        for (std::size_t j = 0; j < set_size; j++) {
+            mask |= block.equal_mask(needles[j]);
+        }
+
+        if (mask != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+    }
+
+    return i + find_first_of_scalar(data + i, size - i, set, set_size);
+}
+
+#ifdef RTL_X86
+RTL_TARGET("avx2") inline auto find_substring_avx2(
+    const char* data, std::size_t size, const char* needle, std::size_t needle_size) noexcept -> std::size_t {
+    return find_substring_vector<utilities::simd::avx2::vec<char>>(data, size, needle, needle_size);
+}
+
+RTL_TARGET("avx2") inline auto find_first_of_avx2(
+    const char* data, std::size_t size, const char* set, std::size_t set_size) noexcept -> std::size_t {
+    return find_first_of_vector<utilities::simd::avx2::vec<char>>(data, size, set, set_size);
+}
+
+RTL_TARGET("sse4.2") inline auto find_substring_sse42(
+    const char* data, std::size_t size, const char* needle, std::size_t needle_size) noexcept -> std::size_t {
+    return find_substring_vector<utilities::simd::sse42::vec<char>>(data, size, needle, needle_size);
+}
+
+RTL_TARGET("sse4.2") inline auto find_first_of_sse42(
+    const char* data, std::size_t size, const char* set, std::size_t set_size) noexcept -> std::size_t {
+    return find_first_of_vector<utilities::simd::sse42::vec<char>>(data, size, set, set_size);
+}
+#endif
+
+// dispatch
+
+constexpr auto find_char(const char* data, std::size_t size, char c) -> std::size_t {
+    return collections::detail::find_index(data, size, c);
+}
+
+constexpr auto find_substring(const char* data, std::size_t size, const char* needle, std::size_t needle_size)
+    -> std::size_t {
+    if (needle_size == 0) {
+        return 0;
+    } else if (needle_size > size) {
+        return size;
+    } else if (needle_size == 1) {
+        return find_char(data, size, needle[0]);
+    }
+
+#ifdef RTL_X86
+    if !consteval {
+        if (utilities::cpu().avx2) {
+            return find_substring_avx2(data, size, needle, needle_size);
+        } else if (utilities::cpu().sse42) {
+            return find_substring_sse42(data, size, needle, needle_size);
+        }
+    }
+#endif
+    return find_substring_scalar(data, size, needle, needle_size);
+}
+
+constexpr auto find_first_of(const char* data, std::size_t size, const char* set, std::size_t set_size)
+    -> std::size_t {
+    if (set_size == 0) {
+        return size;
+    } else if (set_size == 1) {
+        return find_char(data, size, set[0]);
+    }
+
+#ifdef RTL_X86
+    if !consteval {
+        if (set_size <= max_vector_set_size) {
+            if (utilities::cpu().avx2) {
+                return find_first_of_avx2(data, size, set, set_size);
+            } else if (utilities::cpu().sse42) {
+                return find_first_of_sse42(data, size, set, set_size);
+            }
+        }
+    }
+#endif
+    return find_first_of_scalar(data, size, set, set_size);
+}
+} // namespace rtl::strings::detail
+
+#endif // #ifndef RTL_STRING_SEARCH_HPP
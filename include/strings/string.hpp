@@ -0,0 +1,670 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_STRING_HPP
+#define RTL_STRING_HPP
+
+#include "collections/growth.hpp"
+#include "collections/raw_iterator.hpp"
+#include "strings/search.hpp"
+#include "typing/concepts.hpp"
+#include "utilities/assertions.hpp"
+#include "utilities/attributes.hpp"
+#include "utilities/option.hpp"
+#include "utilities/reference.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <format>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace rtl::strings {
+// A null terminated string of bytes. Strings of up to `inline_capacity` characters, 23 on 64 bit platforms, are stored
+// inside the object itself, which is the size of three pointers, and only longer strings allocate.
+//
+// The last byte of the object tells the two apart: an inline string keeps `inline_capacity - size` there, which is
+// zero and doubles as the null terminator when the buffer is full, and a heap string keeps the high bit of its
+// capacity there.
+template<typing::simple_allocator Allocator = std::allocator<char>>
+class basic_string {
+private:
+    using char_traits = std::char_traits<char>;
+
+    struct heap_representation {
+        char* data;
+        std::size_t size;
+        std::size_t capacity;
+    };
+
+    static constexpr std::size_t s_representation_size = sizeof(heap_representation);
+
+    union representation {
+        heap_representation heap;
+        char chars[s_representation_size];
+    };
+
+public:
+    using allocator_type = typename std::allocator_traits<Allocator>::template rebind_alloc<char>;
+    using allocator_traits = std::allocator_traits<allocator_type>;
+
+    using value_type = char;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = value_type*;
+    using const_pointer = const value_type*;
+
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    using optional_ref = utilities::option<utilities::reference<char>>;
+    using optional_const_ref = utilities::option<utilities::reference<const char>>;
+
+    static constexpr size_type inline_capacity = s_representation_size - 1;
+
+    // construction
+
+    basic_string() noexcept(noexcept(allocator_type{})) : basic_string{allocator_type{}} {
+
+    }
+
+    explicit basic_string(const allocator_type& allocator) noexcept(noexcept(allocator_type{allocator}))
+        : m_allocator{allocator} {
+        set_inline_size(0);
+    }
+
+    basic_string(const char* chars, const allocator_type& allocator = allocator_type{})
+        : basic_string{std::string_view{chars}, allocator} {
+
+    }
+
+    explicit basic_string(std::string_view chars, const allocator_type& allocator = allocator_type{})
+        : basic_string{allocator} {
+        append(chars);
+    }
+
+    basic_string(size_type count, char c, const allocator_type& allocator = allocator_type{})
+        : basic_string{allocator} {
+        resize(count, c);
+    }
+
+    basic_string(const basic_string& other)
+        : basic_string{other.view(), allocator_traits::select_on_container_copy_construction(other.m_allocator)} {
+
+    }
+
+    basic_string(basic_string&& other) noexcept
+        : m_representation{other.m_representation}
+        , m_allocator{std::move(other.m_allocator)} {
+        other.set_inline_size(0);
+    }
+
+    ~basic_string() noexcept {
+        deallocate();
+    }
+
+    auto operator=(const basic_string& other) -> basic_string& {
+        if (this == &other) {
+            return *this;
+        }
+
+        return assign(other.view());
+    }
+
+    auto operator=(basic_string&& other) noexcept -> basic_string& {
+        if (this == &other) {
+            return *this;
+        }
+
+        deallocate();
+        m_representation = other.m_representation;
+        m_allocator = std::move(other.m_allocator);
+        other.set_inline_size(0);
+        return *this;
+    }
+
+    auto operator=(std::string_view chars) -> basic_string& {
+        return assign(chars);
+    }
+
+    auto get_allocator() const noexcept(noexcept(allocator_type{m_allocator})) {
+        return m_allocator;
+    }
+
+    // access
+
+    auto operator[](size_type index) const noexcept -> optional_const_ref {
+        return at(index);
+    }
+
+    auto operator[](size_type index) noexcept -> optional_ref {
+        return at(index);
+    }
+
+    auto at(size_type index) const noexcept -> optional_const_ref {
+        if (index < size()) {
+            return data()[index];
+        }
+
+        return utilities::nullopt;
+    }
+
+    auto at(size_type index) noexcept -> optional_ref {
+        if (index < size()) {
+            return data()[index];
+        }
+
+        return utilities::nullopt;
+    }
+
+    auto at_unchecked(size_type index) const noexcept -> const char& {
+        RTL_ASSERT(index < size(),
+                std::format("Index out of range: the index is {} but the size is {}", index, size()));
+        return data()[index];
+    }
+
+    auto at_unchecked(size_type index) noexcept -> char& {
+        RTL_ASSERT(index < size(),
+                std::format("Index out of range: the index is {} but the size is {}", index, size()));
+        return data()[index];
+    }
+
+    auto front() const noexcept -> optional_const_ref {
+        return at(0);
+    }
+
+    auto front() noexcept -> optional_ref {
+        return at(0);
+    }
+
+    auto back() const noexcept -> optional_const_ref {
+        if (empty()) {
+            return utilities::nullopt;
+        }
+
+        return at(size() - 1);
+    }
+
+    auto back() noexcept -> optional_ref {
+        if (empty()) {
+            return utilities::nullopt;
+        }
+
+        return at(size() - 1);
+    }
+
+    // Never null, the characters are always followed by a null terminator.
+    auto data() const noexcept -> const char* {
+        return is_inline() ? m_representation.chars : m_representation.heap.data;
+    }
+
+    auto data() noexcept -> char* {
+        return is_inline() ? m_representation.chars : m_representation.heap.data;
+    }
+
+    auto c_str() const noexcept -> const char* {
+        return data();
+    }
+
+    auto view() const noexcept -> std::string_view {
+        return {data(), size()};
+    }
+
+    operator std::string_view() const noexcept {
+        return view();
+    }
+
+    // iterators
+
+    using iterator = collections::detail::raw_iterator<char>;
+    using const_iterator = collections::detail::raw_iterator<const char>;
+
+    static_assert(typing::legacy_random_access_iterator<iterator>);
+    static_assert(typing::legacy_random_access_iterator<const_iterator>);
+
+    auto begin() noexcept -> iterator {
+        return data();
+    }
+
+    auto begin() const noexcept -> const_iterator {
+        return data();
+    }
+
+    auto cbegin() const noexcept -> const_iterator {
+        return data();
+    }
+
+    auto end() noexcept -> iterator {
+        return data() + size();
+    }
+
+    auto end() const noexcept -> const_iterator {
+        return data() + size();
+    }
+
+    auto cend() const noexcept -> const_iterator {
+        return data() + size();
+    }
+
+    // capacity/size queries
+
+    [[nodiscard]] auto empty() const noexcept -> bool {
+        return size() == 0;
+    }
+
+    [[nodiscard]] auto size() const noexcept -> size_type {
+        return is_inline() ? inline_capacity - last_byte() : m_representation.heap.size;
+    }
+
+    [[nodiscard]] auto capacity() const noexcept -> size_type {
+        return is_inline() ? inline_capacity : decode_capacity(m_representation.heap.capacity);
+    }
+
+    // Whether the characters are stored inside the object.
+    [[nodiscard]] auto is_inline() const noexcept -> bool {
+        return (last_byte() & s_heap_flag) == 0;
+    }
+
+    auto reserve(size_type capacity) -> void {
+        if (capacity <= this->capacity()) {
+            return;
+        }
+
+        reallocate(capacity);
+    }
+
+    // Moves the characters back inside the object if they fit.
+    auto shrink_to_fit() -> void {
+        if (is_inline() || size() == capacity()) {
+            return;
+        }
+
+        reallocate(size());
+    }
+
+    // search
+
+    // The index of the first `c` at or after `from`.
+    auto find(char c, size_type from = 0) const noexcept -> utilities::option<size_type> {
+        auto size = this->size();
+        if (from >= size) {
+            return utilities::nullopt;
+        }
+
+        return found(from + detail::find_char(data() + from, size - from, c), size);
+    }
+
+    // The index of the first occurrence of `chars` at or after `from`. An empty `chars` is found at `from`.
+    auto find(std::string_view chars, size_type from = 0) const noexcept -> utilities::option<size_type> {
+        auto size = this->size();
+        if (from > size) {
+            return utilities::nullopt;
+        } else if (chars.empty()) {
+            return from;
+        }
+
+        return found(from + detail::find_substring(data() + from, size - from, chars.data(), chars.size()), size);
+    }
+
+    // The index of the first character at or after `from` that is any of `chars`.
+    auto find_first_of(std::string_view chars, size_type from = 0) const noexcept -> utilities::option<size_type> {
+        auto size = this->size();
+        if (from >= size) {
+            return utilities::nullopt;
+        }
+
+        return found(from + detail::find_first_of(data() + from, size - from, chars.data(), chars.size()), size);
+    }
+
+    [[nodiscard]] auto contains(char c) const noexcept -> bool {
+        return find(c).has_value();
+    }
+
+    [[nodiscard]] auto contains(std::string_view chars) const noexcept -> bool {
+        return find(chars).has_value();
+    }
+
+    [[nodiscard]] auto starts_with(std::string_view chars) const noexcept -> bool {
+        return view().starts_with(chars);
+    }
+
+    [[nodiscard]] auto ends_with(std::string_view chars) const noexcept -> bool {
+        return view().ends_with(chars);
+    }
+
+    // modification
+
+    auto assign(std::string_view chars) -> basic_string& {
+        replace(0, size(), chars);
+        return *this;
+    }
+
+    auto add(char c) -> void {
+        auto size = this->size();
+        grow_if_needed(1);
+        data()[size] = c;
+        set_size(size + 1);
+    }
+
+    auto append(std::string_view chars) -> basic_string& {
+        replace(size(), 0, chars);
+        return *this;
+    }
+
+    auto operator+=(char c) -> basic_string& {
+        add(c);
+        return *this;
+    }
+
+    auto operator+=(std::string_view chars) -> basic_string& {
+        return append(chars);
+    }
+
+    // Inserts `chars` before `index`, returns false and does nothing if `index` is past the end.
+    auto insert(size_type index, std::string_view chars) -> bool {
+        if (index > size()) {
+            return false;
+        }
+
+        replace(index, 0, chars);
+        return true;
+    }
+
+    // Removes up to `count` characters starting at `index`, returns false and does nothing if `index` is past the end.
+    auto remove(size_type index, size_type count = 1) noexcept -> bool {
+        auto size = this->size();
+        if (index > size) {
+            return false;
+        }
+
+        count = std::min(count, size - index);
+        auto data = this->data();
+        char_traits::move(data + index, data + index + count, size - index - count);
+        set_size(size - count);
+        return true;
+    }
+
+    auto pop() noexcept -> char {
+        auto size = this->size();
+        RTL_ASSERT(size != 0, "Tried to pop from an empty string");
+        auto c = data()[size - 1];
+        set_size(size - 1);
+        return c;
+    }
+
+    // Removes the characters from `size` onwards, does nothing if the string is not longer than `size`.
+    auto truncate(size_type size) noexcept -> void {
+        if (size < this->size()) {
+            set_size(size);
+        }
+    }
+
+    auto resize(size_type size, char c = '\0') -> void {
+        auto old_size = this->size();
+        if (size > old_size) {
+            grow_if_needed(size - old_size);
+            char_traits::assign(data() + old_size, size - old_size, c);
+        }
+
+        set_size(size);
+    }
+
+    // Like `resize`, but leaves any new characters uninitialised for the caller to overwrite.
+    auto resize_for_overwrite(size_type size) -> void {
+        if (auto old_size = this->size(); size > old_size) {
+            grow_if_needed(size - old_size);
+        }
+
+        set_size(size);
+    }
+
+    auto clear() noexcept -> void {
+        set_size(0);
+    }
+
+    // comparison, strings compare with each other through their conversion to `std::string_view`
+
+    friend auto operator==(const basic_string& a, std::string_view b) noexcept -> bool {
+        return a.view() == b;
+    }
+
+    friend auto operator<=>(const basic_string& a, std::string_view b) noexcept -> std::strong_ordering {
+        return a.view() <=> b;
+    }
+
+    friend auto operator+(const basic_string& a, std::string_view b) -> basic_string {
+        auto result = basic_string{a.m_allocator};
+        result.reserve(a.size() + b.size());
+        result.append(a.view());
+        result.append(b);
+        return result;
+    }
+
+private:
+    static constexpr unsigned char s_heap_flag = 0x80;
+
+    // Puts `s_heap_flag` in the last byte of the representation, whichever end of the capacity that is.
+    static constexpr auto encode_capacity(size_type capacity) noexcept -> size_type {
+        if constexpr (std::endian::native == std::endian::little) {
+            return capacity | (size_type{s_heap_flag} << (8 * (sizeof(size_type) - 1)));
+        } else {
+            return (capacity << 8) | s_heap_flag;
+        }
+    }
+
+    static constexpr auto decode_capacity(size_type capacity) noexcept -> size_type {
+        if constexpr (std::endian::native == std::endian::little) {
+            return capacity & ~(size_type{s_heap_flag} << (8 * (sizeof(size_type) - 1)));
+        } else {
+            return capacity >> 8;
+        }
+    }
+
+    static auto found(size_type index, size_type size) noexcept -> utilities::option<size_type> {
+        if (index == size) {
+            return utilities::nullopt;
+        }
+
+        return index;
+    }
+
+    auto last_byte() const noexcept -> unsigned char {
+        // reading the object representation through unsigned char is allowed whichever member is active
+        return reinterpret_cast<const unsigned char*>(&m_representation)[inline_capacity];
+    }
+
+    auto set_inline_size(size_type size) noexcept -> void {
+        m_representation.chars[size] = '\0';
+        m_representation.chars[inline_capacity] = static_cast<char>(inline_capacity - size);
+    }
+
+    // `size` must not be more than the capacity.
+    auto set_size(size_type size) noexcept -> void {
+        if (is_inline()) {
+            if (size > inline_capacity) {
+                // tells the optimiser, which can't follow the representation, that the inline buffer isn't overrun
+                std::unreachable();
+            }
+
+            set_inline_size(size);
+        } else {
+            m_representation.heap.size = size;
+            m_representation.heap.data[size] = '\0';
+        }
+    }
+
+    auto deallocate() noexcept -> void {
+        if (!is_inline()) {
+            auto& heap = m_representation.heap;
+            allocator_traits::deallocate(m_allocator, heap.data, decode_capacity(heap.capacity) + 1);
+        }
+    }
+
+    auto grow_if_needed(size_type increase) -> void {
+        auto size = this->size();
+        auto capacity = this->capacity();
+        if (capacity - size < increase) {
+            reallocate(collections::detail::grown_capacity(capacity, size + increase));
+        }
+    }
+
+    // Moves the characters to a buffer of `capacity` characters, which is the inline buffer if they fit in it.
+    auto reallocate(size_type capacity) -> void {
+        auto size = this->size();
+        if (capacity <= inline_capacity) {
+            if (!is_inline()) {
+                auto heap = m_representation.heap;
+                char_traits::copy(m_representation.chars, heap.data, size);
+                allocator_traits::deallocate(m_allocator, heap.data, decode_capacity(heap.capacity) + 1);
+                set_inline_size(size);
+            }
+
+            return;
+        }
+
+        auto buffer = allocator_traits::allocate(m_allocator, capacity + 1);
+        char_traits::copy(buffer, data(), size + 1);
+        deallocate();
+        m_representation.heap = {buffer, size, encode_capacity(capacity)};
+    }
+
+    // Replaces the `count` characters at `index` with `chars`, growing the buffer if needed. `chars` may point into
+    // this string.
+    auto replace(size_type index, size_type count, std::string_view chars) -> void {
+        auto size = this->size();
+        auto new_size = size - count + chars.size();
+        auto old_data = data();
+        auto tail = size - index - count;
+
+        if (new_size > capacity()) {
+            // the old buffer is only freed after `chars` has been copied out of it
+            auto capacity = collections::detail::grown_capacity(this->capacity(), new_size);
+            auto buffer = allocator_traits::allocate(m_allocator, capacity + 1);
+            char_traits::copy(buffer, old_data, index);
+            char_traits::copy(buffer + index, chars.data(), chars.size());
+            char_traits::copy(buffer + index + chars.size(), old_data + index + count, tail);
+            buffer[new_size] = '\0';
+            deallocate();
+            m_representation.heap = {buffer, new_size, encode_capacity(capacity)};
+            return;
+        }
+
+        if (aliases(chars) && index + count != size && chars.size() != count) {
+            // the characters would move out from under `chars`
+            auto copy = basic_string{chars, m_allocator};
+            replace(index, count, copy.view());
+            return;
+        }
+
+        char_traits::move(old_data + index + chars.size(), old_data + index + count, tail);
+        char_traits::move(old_data + index, chars.data(), chars.size());
+        set_size(new_size);
+    }
+
+    auto aliases(std::string_view chars) const noexcept -> bool {
+        auto less_equal = std::less_equal<const char*>{};
+        return less_equal(data(), chars.data()) && less_equal(chars.data(), data() + size());
+    }
+
+    representation m_representation{};
+    RTL_NO_UNIQUE_ADDRESS allocator_type m_allocator{};
+}; // class basic_string
+
+using string = basic_string<>;
+
+namespace detail {
+// Output iterator that appends to a string, for `std::format_to`.
+template<typename Allocator>
+class append_iterator {
+public:
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using pointer = void;
+    using reference = void;
+    using difference_type = std::ptrdiff_t;
+
+    explicit append_iterator(basic_string<Allocator>& string) noexcept : m_string{std::addressof(string)} {
+
+    }
+
+    auto operator=(char c) -> append_iterator& {
+        m_string->add(c);
+        return *this;
+    }
+
+    auto operator*() noexcept -> append_iterator& {
+        return *this;
+    }
+
+    auto operator++() noexcept -> append_iterator& {
+        return *this;
+    }
+
+    auto operator++(int) noexcept -> append_iterator {
+        return *this;
+    }
+
+private:
+    basic_string<Allocator>* m_string;
+}; // class append_iterator
+} // namespace detail
+
+// Formats `args` onto the end of `output`.
+template<typename Allocator, typename... Args>
+auto append_format(basic_string<Allocator>& output, std::format_string<Args...> format, Args&&... args) -> void {
+    std::format_to(detail::append_iterator<Allocator>{output}, format, std::forward<Args>(args)...);
+}
+
+// `std::format`, producing an `rtl::strings::string`.
+template<typename... Args>
+auto format(std::format_string<Args...> format, Args&&... args) -> string {
+    auto result = string{};
+    append_format(result, format, std::forward<Args>(args)...);
+    return result;
+}
+} // namespace rtl::strings
+
+template<typename Allocator>
+struct rtl::typing::is_trivially_relocatable<rtl::strings::basic_string<Allocator>>
+    : rtl::typing::is_trivially_relocatable<Allocator> {
+
+};
+
+template<typename Allocator>
+struct std::hash<rtl::strings::basic_string<Allocator>> {
+    auto operator()(const rtl::strings::basic_string<Allocator>& string) const noexcept -> std::size_t {
+        return std::hash<std::string_view>{}(string.view());
+    }
+};
+
+template<typename Allocator>
+struct std::formatter<rtl::strings::basic_string<Allocator>, char> : std::formatter<std::string_view, char> {
+    template<typename FormatContext>
+    auto format(const rtl::strings::basic_string<Allocator>& string, FormatContext& context) const {
+        return std::formatter<std::string_view, char>::format(string.view(), context);
+    }
+};
+
+#endif // #ifndef RTL_STRING_HPP
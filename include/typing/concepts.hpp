@@ -23,6 +23,7 @@
 #include <concepts>
 #include <cstddef>
 #include <iterator>
+#include <memory>
 #include <type_traits>
 
 namespace rtl::typing
@@ -43,6 +44,25 @@ inline constexpr bool is_specialisation_v = false;
 template<template<typename...> typename Template, typename... Ts>
 inline constexpr bool is_specialisation_v<Template<Ts...>, Template> = true;
 
+// Opt-in trait for types whose objects can be moved to a new address by copying their bytes, after which the source
+// is treated as destroyed without running its destructor. Specialise this as `std::true_type` for such types.
+template<typename T>
+struct is_trivially_relocatable
+    : std::bool_constant<std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>> {
+
+};
+
+template<typename T>
+struct is_trivially_relocatable<std::allocator<T>> : std::true_type {
+
+};
+
+template<typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+template<typename T>
+concept trivially_relocatable = is_trivially_relocatable_v<std::remove_cv_t<T>> && !std::is_reference_v<T>;
+
 template<typename T>
 concept is_not = !std::is_same_v<T, void>;
 
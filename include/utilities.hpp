@@ -20,7 +20,13 @@
 #ifndef RTL_UTILITIES_HPP
 #define RTL_UTILITIES_HPP
 
+#include "utilities/attributes.hpp"
+#include "utilities/cpu.hpp"
+#include "utilities/niche.hpp"
 #include "utilities/option.hpp"
 #include "utilities/reference.hpp"
+#include "utilities/result.hpp"
+#include "utilities/simd.hpp"
+#include "utilities/variant.hpp"
 
 #endif // #ifndef RTL_UTILITIES_HPP
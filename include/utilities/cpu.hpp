@@ -0,0 +1,87 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_CPU_HPP
+#define RTL_CPU_HPP
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define RTL_X86 1
+#endif
+
+// Compiles a function for an instruction set that the rest of the program may not be built for, the caller has to
+// check the CPU supports it first. When optimising, everything the function calls is inlined into it, so generic
+// helpers are compiled for the same instruction set. MSVC allows intrinsics from any instruction set without this.
+#if defined(__GNUC__) || defined(__clang__)
+#define RTL_TARGET(isa) __attribute__((target(isa), flatten))
+#else
+#define RTL_TARGET(isa)
+#endif
+
+#if defined(RTL_X86) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+#include <cstddef>
+
+namespace rtl::utilities {
+// Used to keep data written by different threads apart. `std::hardware_destructive_interference_size` would vary with
+// compiler flags, which makes it unsuitable for layouts in headers.
+inline constexpr std::size_t cache_line_size = 64;
+
+// The instruction set extensions that `rtl` has kernels for, detected once at runtime.
+struct cpu_features {
+    bool sse42{};
+    bool avx2{};
+};
+
+namespace detail {
+inline auto detect_cpu_features() noexcept -> cpu_features {
+    auto features = cpu_features{};
+#if defined(RTL_X86) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    features.sse42 = __builtin_cpu_supports("sse4.2");
+    features.avx2 = __builtin_cpu_supports("avx2");
+#elif defined(RTL_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    auto max_leaf = info[0];
+
+    __cpuid(info, 1);
+    features.sse42 = (info[2] & (1 << 20)) != 0;
+    auto has_avx = (info[2] & (1 << 28)) != 0;
+    auto has_osxsave = (info[2] & (1 << 27)) != 0;
+
+    if (max_leaf >= 7 && has_avx && has_osxsave) {
+        // the OS must also save the upper halves of the ymm registers on context switches
+        auto os_saves_ymm = (_xgetbv(0) & 0x6) == 0x6;
+        __cpuidex(info, 7, 0);
+        features.avx2 = os_saves_ymm && (info[1] & (1 << 5)) != 0;
+    }
+#endif
+    return features;
+}
+} // namespace detail
+
+inline auto cpu() noexcept -> const cpu_features& {
+    static const auto features = detail::detect_cpu_features();
+    return features;
+}
+} // namespace rtl::utilities
+
+#endif // #ifndef RTL_CPU_HPP
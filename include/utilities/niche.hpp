@@ -0,0 +1,67 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_NICHE_HPP
+#define RTL_NICHE_HPP
+
+#include <concepts>
+#include <type_traits>
+
+namespace rtl::utilities {
+// Customisation point for types that have a bit pattern which can never be a valid value, so wrappers such as
+// `option` can use it to mean "empty" instead of storing a separate flag. Specialisations must provide
+//
+//     static constexpr auto empty() noexcept -> T;
+//     static constexpr auto is_empty(const T& value) noexcept -> bool;
+//
+// where `empty()` returns an object in that state and `is_empty` tests for it.
+template<typename T>
+struct niche_traits;
+
+template<typename T>
+concept has_niche = requires(const T& value) {
+    { niche_traits<T>::empty() } noexcept -> std::same_as<T>;
+    { niche_traits<T>::is_empty(value) } noexcept -> std::same_as<bool>;
+} && !std::is_reference_v<T>;
+
+// Opt-in for types whose niche is a state no value of the type can ever be in, such as a null `reference`. A null
+// pointer is a perfectly good pointer, so storage that can't tell the niche apart from a value, like the index of a
+// two alternative `variant`, only uses the niche of types that specialise this as true.
+template<typename T>
+struct reserved_niche : std::false_type {
+
+};
+
+template<typename T>
+concept has_reserved_niche = has_niche<T> && reserved_niche<T>::value;
+
+// Null is used as the niche, so an `option` holding a null pointer is empty.
+template<typename T>
+struct niche_traits<T*> {
+    static constexpr auto empty() noexcept -> T* {
+        return nullptr;
+    }
+
+    static constexpr auto is_empty(T* const& value) noexcept -> bool {
+        return value == nullptr;
+    }
+};
+} // namespace rtl::utilities
+
+#endif // #ifndef RTL_NICHE_HPP
@@ -21,8 +21,10 @@
 #define RTL_OPTION_HPP
 
 #include "assertions.hpp"
+#include "niche.hpp"
 #include "typing/concepts.hpp"
 
+#include <concepts>
 #include <functional>
 #include <initializer_list>
 #include <memory>
@@ -36,6 +38,18 @@ struct dummy {
 
     }
 };
+
+// Holds the engaged flag for types without a niche. Types with a niche encode emptiness in the value itself, so they
+// get an empty base instead and `option<T>` stays the size of `T`.
+template<bool HasNiche>
+struct option_flag {
+    bool m_has_value{false};
+};
+
+template<>
+struct option_flag<true> {
+
+};
 } // namespace detail
 
 struct nullopt_t {
@@ -46,154 +60,196 @@ struct nullopt_t {
 
 constexpr inline auto nullopt = nullopt_t{0};
 
-template<typename T>
-class option {
+// How an `option` records that it is empty. With `niche_layout` an option of a type with a niche stores emptiness in
+// that niche and is the size of `T`, but the niche value itself (a null pointer, for example) then reads as empty.
+// With `flag_layout` it always keeps a separate flag, so every value of `T` can be held.
+struct niche_layout {
+
+};
+
+struct flag_layout {
+
+};
+
+template<typename T, typename Layout = niche_layout>
+class option : private detail::option_flag<std::same_as<Layout, niche_layout> && has_niche<std::remove_cv_t<T>>> {
 private:
     static constexpr bool s_is_move_constructible = std::is_move_constructible_v<T>;
     static constexpr bool s_is_nothrow_move_constructible = std::is_nothrow_move_constructible_v<T>;
     static constexpr bool s_is_copy_constructible = std::is_copy_constructible_v<T>;
     static constexpr bool s_is_nothrow_copy_constructible = std::is_nothrow_copy_constructible_v<T>;
+    static constexpr bool s_is_trivially_copyable = std::is_trivially_copy_constructible_v<T>
+        && std::is_trivially_copy_assignable_v<T> && std::is_trivially_destructible_v<T>;
+    static constexpr bool s_is_trivially_movable = std::is_trivially_move_constructible_v<T>
+        && std::is_trivially_move_assignable_v<T> && std::is_trivially_destructible_v<T>;
+    static constexpr bool s_has_niche = std::same_as<Layout, niche_layout> && has_niche<std::remove_cv_t<T>>;
+
+    using niche = niche_traits<std::remove_cv_t<T>>;
 
 public:
-    constexpr option() noexcept
-        : m_dummy{}
-        , m_has_value{false} {
+    constexpr option() noexcept requires(!s_has_niche)
+        : m_dummy{} {
+
     }
 
-    constexpr option(nullopt_t) noexcept
-        : m_dummy{}
-        , m_has_value{false} {
+    constexpr option() noexcept requires(s_has_niche)
+        : m_value{niche::empty()} {
+
     }
 
-    constexpr option(const option& other) noexcept(s_is_nothrow_copy_constructible) requires(s_is_copy_constructible)
-        : m_value{other.value()}
-        , m_has_value{true} {
+    constexpr option(nullopt_t) noexcept
+        : option{} {
 
     }
 
-    constexpr option(option&& other) noexcept(s_is_nothrow_move_constructible) requires(s_is_move_constructible)
-        : m_value{std::move(other.value())}
-        , m_has_value{true} {
+    constexpr option(const option&) noexcept requires(s_is_trivially_copyable) = default;
 
+    constexpr option(const option& other) noexcept(s_is_nothrow_copy_constructible)
+        requires(s_is_copy_constructible && !s_is_trivially_copyable)
+        : option{} {
+        if (other.has_value()) {
+            construct(other.value());
+        }
     }
 
-    template<typename U> requires(std::is_constructible_v<T, const U&>)
-    constexpr explicit(!std::is_convertible_v<const U&, T>) option(const option<U>& other)
-        noexcept(std::is_nothrow_constructible_v<T, U>)
-        : m_value{other.value()}
-        , m_has_value{true} {
+    constexpr option(option&&) noexcept requires(s_is_trivially_movable) = default;
 
+    constexpr option(option&& other) noexcept(s_is_nothrow_move_constructible)
+        requires(s_is_move_constructible && !s_is_trivially_movable)
+        : option{} {
+        if (other.has_value()) {
+            construct(std::move(other.value()));
+        }
     }
 
-    template<typename U> requires(std::is_constructible_v<T, U>)
-    constexpr option(option<U>&& other)
-        noexcept(std::is_nothrow_constructible_v<T, U>)
-        : m_value{std::move(other.value())}
-        , m_has_value{true} {
+    template<typename U, typename L> requires(std::is_constructible_v<T, const U&>)
+    constexpr explicit(!std::is_convertible_v<const U&, T>) option(const option<U, L>& other)
+        noexcept(std::is_nothrow_constructible_v<T, const U&>)
+        : option{} {
+        if (other.has_value()) {
+            construct(other.value());
+        }
+    }
 
+    template<typename U, typename L> requires(std::is_constructible_v<T, U>)
+    constexpr option(option<U, L>&& other)
+        noexcept(std::is_nothrow_constructible_v<T, U>)
+        : option{} {
+        if (other.has_value()) {
+            construct(std::move(other.value()));
+        }
     }
 
     template<typename... Args>
-    constexpr option(std::in_place_t, Args&&... args) noexcept(noexcept(std::is_nothrow_constructible_v<T, Args...>))
-        : m_value{std::forward<Args>(args)...}
-        , m_has_value{true} {
+    constexpr option(std::in_place_t, Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>)
+        : m_value{std::forward<Args>(args)...} {
+        set_has_value(true);
     }
 
     template<typename U, typename... Args> requires(std::is_constructible_v<T, std::initializer_list<U>&, Args...>)
     constexpr option(std::in_place_t, std::initializer_list<U> ilist, Args&&... args)
-        noexcept(noexcept(std::is_nothrow_constructible_v<T, std::initializer_list<U>&, Args...>))
-        : m_value{ilist, std::forward<Args>(args)...}
-        , m_has_value{true} {
+        noexcept(std::is_nothrow_constructible_v<T, std::initializer_list<U>&, Args...>)
+        : m_value{ilist, std::forward<Args>(args)...} {
+        set_has_value(true);
     }
-        
+
     template<typename U = T> requires(!typing::is_specialisation_v<std::remove_cvref_t<U>, option>)
-    constexpr option(U&& value) noexcept(noexcept(std::is_nothrow_constructible_v<T, U>))
-        : m_value{std::forward<U>(value)}
-        , m_has_value{true} {
+    constexpr option(U&& value) noexcept(std::is_nothrow_constructible_v<T, U>)
+        : m_value{std::forward<U>(value)} {
+        set_has_value(true);
     }
 
+    constexpr ~option() noexcept requires(std::is_trivially_destructible_v<T>) = default;
+
     constexpr ~option() noexcept {
-        if (m_has_value) {
-            m_value.~T();
+        if constexpr (s_has_niche) {
+            std::destroy_at(std::addressof(m_value));
+        } else if (this->m_has_value) {
+            std::destroy_at(std::addressof(m_value));
         }
     }
 
     constexpr auto reset() noexcept -> void {
-        if (m_has_value) {
-            m_value.~T();
-            m_has_value = false;
+        if (has_value()) {
+            std::destroy_at(std::addressof(m_value));
+            if constexpr (s_has_niche) {
+                std::construct_at(std::addressof(m_value), niche::empty());
+            } else {
+                std::construct_at(std::addressof(m_dummy));
+                this->m_has_value = false;
+            }
         }
     }
 
     constexpr auto operator=(nullopt_t) noexcept -> option& {
         reset();
+        return *this;
     }
 
+    constexpr auto operator=(const option&) noexcept -> option& requires(s_is_trivially_copyable) = default;
+
     constexpr auto operator=(const option& other) noexcept(s_is_nothrow_copy_constructible)
-        -> option& requires(s_is_copy_constructible) {
+        -> option& requires(s_is_copy_constructible && !s_is_trivially_copyable) {
         if (this == &other) {
             return *this;
         }
 
-        if (m_has_value) {
-            if (other.has_value()) {
-                m_value = other.m_value;
-            } else {
-                reset();
-            }
-        } else if (other.has_value()) {
-            m_value = other.m_value;
-            m_has_value = true;
+        if (other.has_value()) {
+            assign(other.value());
+        } else {
+            reset();
         }
 
         return *this;
     }
 
+    constexpr auto operator=(option&&) noexcept -> option& requires(s_is_trivially_movable) = default;
+
     constexpr auto operator=(option&& other) noexcept(s_is_nothrow_move_constructible)
-        -> option& requires(s_is_move_constructible) {
+        -> option& requires(s_is_move_constructible && !s_is_trivially_movable) {
         if (this == &other) {
             return *this;
         }
 
-        if (m_has_value) {
-            if (other.has_value()) {
-                m_value = std::move(other.m_value);
-            } else {
-                reset();
-            }
-        } else if (other.has_value()) {
-            m_value = std::move(other.m_value);
-            m_has_value = true;
+        if (other.has_value()) {
+            assign(std::move(other.value()));
+        } else {
+            reset();
         }
 
         return *this;
     }
 
     template<typename U = T>
-    requires(!typing::is_specialisation_v<std::remove_cvref_t<U>, option>
-        && std::is_constructible_v<T, U> && std::is_assignable_v<T&, U>)
+    requires(!typing::is_specialisation_v<std::remove_cvref_t<U>, option> && std::is_constructible_v<T, U>)
     constexpr auto operator=(U&& value)
         noexcept(std::is_nothrow_constructible_v<T, U> && std::is_nothrow_assignable_v<T&, U>) -> option& {
-        m_value = std::forward<U>(value);
-        m_has_value = true;
+        assign(std::forward<U>(value));
         return *this;
     }
 
-    template<typename U>
-    requires(std::is_constructible_v<T, U> && std::is_assignable_v<T&, U>)
-    constexpr auto operator=(const option<U>& other)
-        noexcept(std::is_nothrow_constructible_v<T, U> && std::is_nothrow_assignable_v<T&, U>) -> option& {
-        m_value = other.value();
-        m_has_value = true;
+    template<typename U, typename L> requires(std::is_constructible_v<T, const U&>)
+    constexpr auto operator=(const option<U, L>& other)
+        noexcept(std::is_nothrow_constructible_v<T, const U&> && std::is_nothrow_assignable_v<T&, const U&>)
+        -> option& {
+        if (other.has_value()) {
+            assign(other.value());
+        } else {
+            reset();
+        }
+
         return *this;
     }
 
-    template<typename U>
-    requires(std::is_constructible_v<T, U> && std::is_assignable_v<T&, U>)
-    constexpr auto operator=(option<U>&& other)
+    template<typename U, typename L> requires(std::is_constructible_v<T, U>)
+    constexpr auto operator=(option<U, L>&& other)
         noexcept(std::is_nothrow_constructible_v<T, U> && std::is_nothrow_assignable_v<T&, U>) -> option& {
-        m_value = std::move(other.value());
-        m_has_value = true;
+        if (other.has_value()) {
+            assign(std::move(other.value()));
+        } else {
+            reset();
+        }
+
         return *this;
     }
 
@@ -214,18 +270,18 @@ public:
     }
 
     constexpr auto value() const noexcept -> const T& {
-        RTL_ASSERT(m_has_value, "Trying to access value in empty option");
+        RTL_ASSERT(has_value(), "Trying to access value in empty option");
         return m_value;
     }
 
     constexpr auto value() noexcept -> T& {
-        RTL_ASSERT(m_has_value, "Trying to access value in empty option");
+        RTL_ASSERT(has_value(), "Trying to access value in empty option");
         return m_value;
     }
 
     template<typename U> requires(std::is_convertible_v<U&&, T>)
     constexpr auto value_or(U&& value) const noexcept(std::is_nothrow_convertible_v<U&&, T>) -> T {
-        if (m_has_value) {
+        if (has_value()) {
             return m_value;
         }
 
@@ -233,20 +289,23 @@ public:
     }
 
     constexpr explicit operator bool() const noexcept  {
-        return m_has_value;
+        return has_value();
     }
 
     [[nodiscard]] constexpr auto has_value() const noexcept -> bool {
-        return m_has_value;
+        if constexpr (s_has_niche) {
+            return !niche::is_empty(m_value);
+        } else {
+            return this->m_has_value;
+        }
     }
 
     template<typename F>
-    requires(std::invocable<F> && std::is_same_v<std::remove_cvref_t<std::invoke_result_t<F>>, option<T>>)
+    requires(std::invocable<F> && std::is_same_v<std::remove_cvref_t<std::invoke_result_t<F>>, option>)
     constexpr auto or_else(F&& function) const
-        noexcept(noexcept(std::is_nothrow_copy_constructible_v<option<T>>)
-                 && noexcept(std::invoke(std::forward<F>(function))))
-        -> option<T> {
-        if (m_has_value) {
+        noexcept(std::is_nothrow_copy_constructible_v<option> && noexcept(std::invoke(std::forward<F>(function))))
+        -> option {
+        if (has_value()) {
             return *this;
         }
 
@@ -256,7 +315,7 @@ public:
     template<typename F>
     requires(std::invocable<F, T&> && typing::is_specialisation_v<std::invoke_result_t<F, T&>, option>)
     constexpr auto and_then(F&& function) noexcept(noexcept(std::invoke(std::forward<F>(function), m_value))) {
-        if (m_has_value) {
+        if (has_value()) {
             return std::invoke(std::forward<F>(function), m_value);
         }
 
@@ -266,7 +325,7 @@ public:
     template<typename F>
     requires(std::invocable<F, T&> && typing::is_specialisation_v<std::invoke_result_t<F, T&>, option>)
     constexpr auto and_then(F&& function) const noexcept(noexcept(std::invoke(std::forward<F>(function), m_value))) {
-        if (m_has_value) {
+        if (has_value()) {
             return std::invoke(std::forward<F>(function), m_value);
         }
 
@@ -275,39 +334,37 @@ public:
 
     template<typename F> requires(std::invocable<F, T&>)
     constexpr auto map(F&& function) noexcept(noexcept(std::invoke(std::forward<F>(function), m_value))) {
-        using U = std::remove_cvref_t<std::invoke_result_t<F, T&>>;
+        using U = option<std::remove_cvref_t<std::invoke_result_t<F, T&>>, Layout>;
 
-        if (m_has_value) {
-            return option<U>{std::invoke(std::forward<F>(function), m_value)};
+        if (has_value()) {
+            return U{std::invoke(std::forward<F>(function), m_value)};
         }
 
-        return option<U>{};
+        return U{};
     }
 
     template<typename F> requires(std::invocable<F, const T&>)
     constexpr auto map(F&& function) const noexcept(noexcept(std::invoke(std::forward<F>(function), m_value))) {
-        using U = std::remove_cvref_t<std::invoke_result_t<F, const T&>>;
+        using U = option<std::remove_cvref_t<std::invoke_result_t<F, const T&>>, Layout>;
 
-        if (m_has_value) {
-            return option<U>{std::invoke(std::forward<F>(function), m_value)};
+        if (has_value()) {
+            return U{std::invoke(std::forward<F>(function), m_value)};
         }
 
-        return option<U>{};
+        return U{};
     }
 
     constexpr auto unwrap() noexcept(s_is_nothrow_move_constructible) -> T requires(s_is_move_constructible) {
-        RTL_ASSERT(m_has_value, "Trying to unwrap empty option");
+        RTL_ASSERT(has_value(), "Trying to unwrap empty option");
         auto value = std::move(m_value);
-        m_has_value = false;
-        m_value.~T();
-        m_dummy = {};
+        reset();
         return value;
     }
 
     template<typename U> requires(s_is_move_constructible && std::is_constructible_v<T, U>)
     constexpr auto unwrap_or(U&& value)
         noexcept(s_is_nothrow_move_constructible && std::is_nothrow_constructible_v<T, U>) -> T {
-        if (m_has_value) {
+        if (has_value()) {
             return unwrap();
         }
 
@@ -321,7 +378,7 @@ public:
                  && noexcept(std::invoke(std::forward<F>(function)))
                  && std::is_nothrow_constructible_v<T, std::remove_cvref_t<std::invoke_result_t<F>>>)
         -> T {
-        if (m_has_value) {
+        if (has_value()) {
             return unwrap();
         }
 
@@ -329,16 +386,56 @@ public:
     }
 
 private:
+    constexpr auto set_has_value(bool has_value) noexcept -> void {
+        if constexpr (!s_has_niche) {
+            this->m_has_value = has_value;
+        }
+    }
+
+    // Constructs the value in an empty option.
+    template<typename... Args>
+    constexpr auto construct(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>) -> void {
+        if constexpr (s_has_niche) {
+            std::destroy_at(std::addressof(m_value));
+        }
+
+        std::construct_at(std::addressof(m_value), std::forward<Args>(args)...);
+        set_has_value(true);
+    }
+
+    template<typename U>
+    constexpr auto assign(U&& value) noexcept(std::is_nothrow_constructible_v<T, U>) -> void {
+        if constexpr (std::is_assignable_v<T&, U>) {
+            if (has_value()) {
+                m_value = std::forward<U>(value);
+                return;
+            }
+        } else {
+            reset();
+        }
+
+        construct(std::forward<U>(value));
+    }
+
     union {
         std::remove_cv_t<T> m_value;
         detail::dummy m_dummy;
     };
-
-    bool m_has_value;
 }; // class option
 
 template<typename T>
 option(T) -> option<T>;
+
+// An option that can hold every value of `T`, including its niche, for generic code that hands back arbitrary values
+// such as a container's `remove`. It is the same type as `option<T>` when `T` has no niche.
+template<typename T>
+using flagged_option = option<T, std::conditional_t<has_niche<std::remove_cv_t<T>>, flag_layout, niche_layout>>;
 } // namespace rtl::utilities
 
+template<typename T, typename Layout>
+struct rtl::typing::is_trivially_relocatable<rtl::utilities::option<T, Layout>>
+    : rtl::typing::is_trivially_relocatable<T> {
+
+};
+
 #endif // #ifndef RTL_OPTION_HPP
@@ -20,6 +20,10 @@
 #ifndef RTL_REFERENCE_HPP
 #define RTL_REFERENCE_HPP
 
+#include "niche.hpp"
+
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <type_traits>
 
@@ -63,8 +67,33 @@ public:
     }
 
 private:
+    friend struct niche_traits<reference>;
+
+    // Only used to form the niche, a reference obtained through the public interface is never null.
+    constexpr explicit reference(std::nullptr_t) noexcept
+        : m_ptr{nullptr} {
+
+    }
+
     T* m_ptr;
 };
+
+template<typename T>
+struct niche_traits<reference<T>> {
+    static constexpr auto empty() noexcept -> reference<T> {
+        return reference<T>{nullptr};
+    }
+
+    static constexpr auto is_empty(const reference<T>& value) noexcept -> bool {
+        return value.m_ptr == nullptr;
+    }
+};
+
+// only the private constructor above can make a null reference
+template<typename T>
+struct reserved_niche<reference<T>> : std::true_type {
+
+};
 }// namespace rtl::utilities
 
 #endif// #ifndef RTL_REFERENCE_HPP
@@ -0,0 +1,374 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_RESULT_HPP
+#define RTL_RESULT_HPP
+
+#include "assertions.hpp"
+#include "niche.hpp"
+#include "option.hpp"
+#include "typing/concepts.hpp"
+#include "variant.hpp"
+
+#include <concepts>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace rtl::utilities {
+namespace detail {
+// Selects the constructor that adopts a result's storage directly.
+struct result_storage {
+
+};
+} // namespace detail
+
+// Wraps an error so it converts to a `result` holding it, even when the value type could be constructed from it too.
+template<typename E>
+class failure {
+public:
+    constexpr explicit failure(E error) noexcept(std::is_nothrow_move_constructible_v<E>)
+        : m_error{std::move(error)} {
+
+    }
+
+    template<typename... Args> requires(std::is_constructible_v<E, Args...>)
+    constexpr explicit failure(std::in_place_t, Args&&... args) noexcept(std::is_nothrow_constructible_v<E, Args...>)
+        : m_error(std::forward<Args>(args)...) {
+
+    }
+
+    constexpr auto error() & noexcept -> E& {
+        return m_error;
+    }
+
+    constexpr auto error() const& noexcept -> const E& {
+        return m_error;
+    }
+
+    constexpr auto error() && noexcept -> E&& {
+        return std::move(m_error);
+    }
+
+private:
+    E m_error;
+}; // class failure
+
+template<typename E>
+failure(E) -> failure<E>;
+
+// Holds either a value or the error that stopped one being produced. The two share storage through a `variant`, so a
+// result is the size of the larger of `T` and `E` plus a one byte index, and is trivially copyable, and so returned in
+// registers where it fits, when both types are. The index has a value to spare for the niche of an `option<result>`.
+template<typename T, typename E>
+requires(std::is_object_v<T> && !std::is_array_v<T> && std::is_object_v<E> && !std::is_array_v<E>)
+class [[nodiscard]] result {
+private:
+    static constexpr std::size_t s_value = 0;
+    static constexpr std::size_t s_error = 1;
+
+    using storage = variant<T, E>;
+
+public:
+    using value_type = T;
+    using error_type = E;
+
+    template<typename U = T>
+    requires(std::is_constructible_v<T, U>
+             && !typing::is_specialisation_v<std::remove_cvref_t<U>, result>
+             && !typing::is_specialisation_v<std::remove_cvref_t<U>, failure>
+             && !std::is_same_v<std::remove_cvref_t<U>, std::in_place_t>)
+    constexpr explicit(!std::is_convertible_v<U, T>) result(U&& value)
+        noexcept(std::is_nothrow_constructible_v<T, U>)
+        : m_storage{std::in_place_index<s_value>, std::forward<U>(value)} {
+
+    }
+
+    template<typename... Args> requires(std::is_constructible_v<T, Args...>)
+    constexpr explicit result(std::in_place_t, Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>)
+        : m_storage{std::in_place_index<s_value>, std::forward<Args>(args)...} {
+
+    }
+
+    template<typename G> requires(std::is_constructible_v<E, const G&>)
+    constexpr result(const failure<G>& error) noexcept(std::is_nothrow_constructible_v<E, const G&>)
+        : m_storage{std::in_place_index<s_error>, error.error()} {
+
+    }
+
+    template<typename G> requires(std::is_constructible_v<E, G>)
+    constexpr result(failure<G>&& error) noexcept(std::is_nothrow_constructible_v<E, G>)
+        : m_storage{std::in_place_index<s_error>, std::move(error).error()} {
+
+    }
+
+    // access
+
+    [[nodiscard]] constexpr auto has_value() const noexcept -> bool {
+        return m_storage.index() == s_value;
+    }
+
+    [[nodiscard]] constexpr auto has_error() const noexcept -> bool {
+        return m_storage.index() == s_error;
+    }
+
+    constexpr explicit operator bool() const noexcept {
+        return has_value();
+    }
+
+    constexpr auto operator->() const noexcept -> const T* {
+        return std::addressof(value());
+    }
+
+    constexpr auto operator->() noexcept -> T* {
+        return std::addressof(value());
+    }
+
+    constexpr auto operator*() const noexcept -> const T& {
+        return value();
+    }
+
+    constexpr auto operator*() noexcept -> T& {
+        return value();
+    }
+
+    constexpr auto value() const noexcept -> const T& {
+        RTL_ASSERT(has_value(), "Trying to access value in result holding an error");
+        return m_storage.template get_unchecked<s_value>();
+    }
+
+    constexpr auto value() noexcept -> T& {
+        RTL_ASSERT(has_value(), "Trying to access value in result holding an error");
+        return m_storage.template get_unchecked<s_value>();
+    }
+
+    constexpr auto error() const noexcept -> const E& {
+        RTL_ASSERT(has_error(), "Trying to access error in result holding a value");
+        return m_storage.template get_unchecked<s_error>();
+    }
+
+    constexpr auto error() noexcept -> E& {
+        RTL_ASSERT(has_error(), "Trying to access error in result holding a value");
+        return m_storage.template get_unchecked<s_error>();
+    }
+
+    template<typename U> requires(std::is_convertible_v<U&&, T>)
+    constexpr auto value_or(U&& value) const noexcept(std::is_nothrow_convertible_v<U&&, T>) -> T {
+        if (has_value()) {
+            return this->value();
+        }
+
+        return std::forward<U>(value);
+    }
+
+    // The value, discarding the error. A value that is the niche of `T`, such as a null pointer, is still a value.
+    constexpr auto ok() const noexcept(std::is_nothrow_copy_constructible_v<T>) -> flagged_option<T> {
+        if (has_value()) {
+            return value();
+        }
+
+        return nullopt;
+    }
+
+    // monadic operations
+
+    // Replaces the value with `function(value)`, keeping the error.
+    template<typename F> requires(std::invocable<F, T&>)
+    constexpr auto map(F&& function) noexcept(noexcept(std::invoke(std::forward<F>(function), value()))) {
+        using U = std::remove_cvref_t<std::invoke_result_t<F, T&>>;
+
+        if (has_value()) {
+            return result<U, E>{std::in_place, std::invoke(std::forward<F>(function), value())};
+        }
+
+        return result<U, E>{failure<const E&>{error()}};
+    }
+
+    template<typename F> requires(std::invocable<F, const T&>)
+    constexpr auto map(F&& function) const noexcept(noexcept(std::invoke(std::forward<F>(function), value()))) {
+        using U = std::remove_cvref_t<std::invoke_result_t<F, const T&>>;
+
+        if (has_value()) {
+            return result<U, E>{std::in_place, std::invoke(std::forward<F>(function), value())};
+        }
+
+        return result<U, E>{failure<const E&>{error()}};
+    }
+
+    // Replaces the error with `function(error)`, keeping the value.
+    template<typename F> requires(std::invocable<F, E&>)
+    constexpr auto map_error(F&& function) noexcept(noexcept(std::invoke(std::forward<F>(function), error()))) {
+        using G = std::remove_cvref_t<std::invoke_result_t<F, E&>>;
+
+        if (has_error()) {
+            return result<T, G>{failure<G>{std::invoke(std::forward<F>(function), error())}};
+        }
+
+        return result<T, G>{std::in_place, value()};
+    }
+
+    template<typename F> requires(std::invocable<F, const E&>)
+    constexpr auto map_error(F&& function) const noexcept(noexcept(std::invoke(std::forward<F>(function), error()))) {
+        using G = std::remove_cvref_t<std::invoke_result_t<F, const E&>>;
+
+        if (has_error()) {
+            return result<T, G>{failure<G>{std::invoke(std::forward<F>(function), error())}};
+        }
+
+        return result<T, G>{std::in_place, value()};
+    }
+
+    // `function(value)`, which returns a result with the same error type, or the error.
+    template<typename F>
+    requires(std::invocable<F, T&> && typing::is_specialisation_v<std::remove_cvref_t<std::invoke_result_t<F, T&>>, result>)
+    constexpr auto and_then(F&& function) noexcept(noexcept(std::invoke(std::forward<F>(function), value()))) {
+        using R = std::remove_cvref_t<std::invoke_result_t<F, T&>>;
+        static_assert(std::is_same_v<typename R::error_type, E>, "and_then must return a result with the same error");
+
+        if (has_value()) {
+            return std::invoke(std::forward<F>(function), value());
+        }
+
+        return R{failure<const E&>{error()}};
+    }
+
+    template<typename F>
+    requires(std::invocable<F, const T&>
+             && typing::is_specialisation_v<std::remove_cvref_t<std::invoke_result_t<F, const T&>>, result>)
+    constexpr auto and_then(F&& function) const noexcept(noexcept(std::invoke(std::forward<F>(function), value()))) {
+        using R = std::remove_cvref_t<std::invoke_result_t<F, const T&>>;
+        static_assert(std::is_same_v<typename R::error_type, E>, "and_then must return a result with the same error");
+
+        if (has_value()) {
+            return std::invoke(std::forward<F>(function), value());
+        }
+
+        return R{failure<const E&>{error()}};
+    }
+
+    // `function(error)`, which returns a result with the same value type, or the value.
+    template<typename F>
+    requires(std::invocable<F, E&> && typing::is_specialisation_v<std::remove_cvref_t<std::invoke_result_t<F, E&>>, result>)
+    constexpr auto or_else(F&& function) noexcept(noexcept(std::invoke(std::forward<F>(function), error()))) {
+        using R = std::remove_cvref_t<std::invoke_result_t<F, E&>>;
+        static_assert(std::is_same_v<typename R::value_type, T>, "or_else must return a result with the same value");
+
+        if (has_error()) {
+            return std::invoke(std::forward<F>(function), error());
+        }
+
+        return R{std::in_place, value()};
+    }
+
+    template<typename F>
+    requires(std::invocable<F, const E&>
+             && typing::is_specialisation_v<std::remove_cvref_t<std::invoke_result_t<F, const E&>>, result>)
+    constexpr auto or_else(F&& function) const noexcept(noexcept(std::invoke(std::forward<F>(function), error()))) {
+        using R = std::remove_cvref_t<std::invoke_result_t<F, const E&>>;
+        static_assert(std::is_same_v<typename R::value_type, T>, "or_else must return a result with the same value");
+
+        if (has_error()) {
+            return std::invoke(std::forward<F>(function), error());
+        }
+
+        return R{std::in_place, value()};
+    }
+
+    // Moves the value out.
+    constexpr auto unwrap() noexcept(std::is_nothrow_move_constructible_v<T>) -> T {
+        RTL_ASSERT(has_value(), "Trying to unwrap result holding an error");
+        return std::move(m_storage.template get_unchecked<s_value>());
+    }
+
+    template<typename U> requires(std::is_constructible_v<T, U>)
+    constexpr auto unwrap_or(U&& value)
+        noexcept(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_constructible_v<T, U>) -> T {
+        if (has_value()) {
+            return unwrap();
+        }
+
+        return T{std::forward<U>(value)};
+    }
+
+    // The value, or `function(error)`.
+    template<typename F> requires(std::invocable<F, E&> && std::constructible_from<T, std::invoke_result_t<F, E&>>)
+    constexpr auto unwrap_or_else(F&& function)
+        noexcept(std::is_nothrow_move_constructible_v<T> && noexcept(std::invoke(std::forward<F>(function), error())))
+        -> T {
+        if (has_value()) {
+            return unwrap();
+        }
+
+        return std::invoke(std::forward<F>(function), error());
+    }
+
+    // Moves the error out.
+    constexpr auto unwrap_error() noexcept(std::is_nothrow_move_constructible_v<E>) -> E {
+        RTL_ASSERT(has_error(), "Trying to unwrap error from result holding a value");
+        return std::move(m_storage.template get_unchecked<s_error>());
+    }
+
+    // comparison
+
+    friend constexpr auto operator==(const result& a, const result& b) -> bool
+        requires(std::equality_comparable<T> && std::equality_comparable<E>) {
+        return a.m_storage == b.m_storage;
+    }
+
+    template<typename U> requires(!typing::is_specialisation_v<U, result> && std::equality_comparable_with<T, U>)
+    friend constexpr auto operator==(const result& a, const U& b) -> bool {
+        return a.has_value() && a.value() == b;
+    }
+
+    template<typename G> requires(std::equality_comparable_with<E, G>)
+    friend constexpr auto operator==(const result& a, const failure<G>& b) -> bool {
+        return a.has_error() && a.error() == b.error();
+    }
+
+private:
+    template<typename U>
+    friend struct niche_traits;
+
+    constexpr result(detail::result_storage, storage value) noexcept(std::is_nothrow_move_constructible_v<storage>)
+        : m_storage{std::move(value)} {
+
+    }
+
+    storage m_storage;
+}; // class result
+
+template<typename T, typename E> requires(has_niche<variant<T, E>>)
+struct niche_traits<result<T, E>> {
+    static constexpr auto empty() noexcept -> result<T, E> {
+        return result<T, E>{detail::result_storage{}, niche_traits<variant<T, E>>::empty()};
+    }
+
+    static constexpr auto is_empty(const result<T, E>& value) noexcept -> bool {
+        return niche_traits<variant<T, E>>::is_empty(value.m_storage);
+    }
+};
+} // namespace rtl::utilities
+
+template<typename T, typename E>
+struct rtl::typing::is_trivially_relocatable<rtl::utilities::result<T, E>>
+    : rtl::typing::is_trivially_relocatable<rtl::utilities::variant<T, E>> {
+
+};
+
+#endif // #ifndef RTL_RESULT_HPP
@@ -0,0 +1,390 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_SIMD_HPP
+#define RTL_SIMD_HPP
+
+#include "utilities/cpu.hpp"
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#ifdef RTL_X86
+#include <immintrin.h>
+#endif
+
+namespace rtl::utilities::simd {
+// The types that fit in vector lanes.
+template<typename T>
+concept element = std::is_arithmetic_v<T> && !std::same_as<std::remove_cv_t<T>, bool>
+    && !std::same_as<std::remove_cv_t<T>, long double> && sizeof(T) <= 8;
+
+#ifdef RTL_X86
+namespace detail {
+// Passing vector types through std::conditional_t would drop their alignment attributes.
+template<typename T, std::size_t Width>
+struct register_for;
+
+template<typename T>
+struct register_for<T, 32> {
+    using type = __m256i;
+};
+
+template<>
+struct register_for<float, 32> {
+    using type = __m256;
+};
+
+template<>
+struct register_for<double, 32> {
+    using type = __m256d;
+};
+
+template<typename T>
+struct register_for<T, 16> {
+    using type = __m128i;
+};
+
+template<>
+struct register_for<float, 16> {
+    using type = __m128;
+};
+
+template<>
+struct register_for<double, 16> {
+    using type = __m128d;
+};
+} // namespace detail
+
+// Thin wrappers over one vector register of `T` lanes, so kernels can be written once for every element type. The
+// functions need the matching instruction set, so they may only be called from functions marked with `RTL_TARGET`.
+// Vectors are only ever passed by reference and updated in place: when the calls aren't inlined, passing them by value
+// between functions compiled for different instruction sets would disagree on the calling convention.
+namespace avx2 {
+template<element T>
+struct vec {
+    using register_type = typename detail::register_for<T, 32>::type;
+
+    static constexpr std::size_t lanes = sizeof(register_type) / sizeof(T);
+
+    // Loads `lanes` values from `source`, which doesn't need to be aligned.
+    RTL_TARGET("avx2") auto load(const T* source) noexcept -> void {
+        if constexpr (std::same_as<T, float>) {
+            value = _mm256_loadu_ps(source);
+        } else if constexpr (std::same_as<T, double>) {
+            value = _mm256_loadu_pd(source);
+        } else {
+            value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source));
+        }
+    }
+
+    // Sets every lane to `lane`.
+    RTL_TARGET("avx2") auto fill(T lane) noexcept -> void {
+        if constexpr (std::same_as<T, float>) {
+            value = _mm256_set1_ps(lane);
+        } else if constexpr (std::same_as<T, double>) {
+            value = _mm256_set1_pd(lane);
+        } else if constexpr (sizeof(T) == 1) {
+            value = _mm256_set1_epi8(static_cast<char>(lane));
+        } else if constexpr (sizeof(T) == 2) {
+            value = _mm256_set1_epi16(static_cast<short>(lane));
+        } else if constexpr (sizeof(T) == 4) {
+            value = _mm256_set1_epi32(static_cast<int>(lane));
+        } else {
+            value = _mm256_set1_epi64x(static_cast<long long>(lane));
+        }
+    }
+
+    RTL_TARGET("avx2") auto store(T* destination) const noexcept -> void {
+        if constexpr (std::same_as<T, float>) {
+            _mm256_storeu_ps(destination, value);
+        } else if constexpr (std::same_as<T, double>) {
+            _mm256_storeu_pd(destination, value);
+        } else {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination), value);
+        }
+    }
+
+    // One bit per byte, set for every byte of the lanes that equal the lanes of `other`.
+    RTL_TARGET("avx2") auto equal_mask(const vec& other) const noexcept -> std::uint32_t {
+        if constexpr (std::same_as<T, float>) {
+            return to_mask(_mm256_castps_si256(_mm256_cmp_ps(value, other.value, _CMP_EQ_OQ)));
+        } else if constexpr (std::same_as<T, double>) {
+            return to_mask(_mm256_castpd_si256(_mm256_cmp_pd(value, other.value, _CMP_EQ_OQ)));
+        } else if constexpr (sizeof(T) == 1) {
+            return to_mask(_mm256_cmpeq_epi8(value, other.value));
+        } else if constexpr (sizeof(T) == 2) {
+            return to_mask(_mm256_cmpeq_epi16(value, other.value));
+        } else if constexpr (sizeof(T) == 4) {
+            return to_mask(_mm256_cmpeq_epi32(value, other.value));
+        } else {
+            return to_mask(_mm256_cmpeq_epi64(value, other.value));
+        }
+    }
+
+    // Keeps the smaller of each pair of lanes.
+    RTL_TARGET("avx2") auto keep_min(const vec& other) noexcept -> void {
+        if constexpr (std::same_as<T, float>) {
+            value = _mm256_min_ps(value, other.value);
+        } else if constexpr (std::same_as<T, double>) {
+            value = _mm256_min_pd(value, other.value);
+        } else if constexpr (sizeof(T) == 8) {
+            value = _mm256_blendv_epi8(value, other.value, greater_than(other));
+        } else if constexpr (std::is_signed_v<T>) {
+            if constexpr (sizeof(T) == 1) {
+                value = _mm256_min_epi8(value, other.value);
+            } else if constexpr (sizeof(T) == 2) {
+                value = _mm256_min_epi16(value, other.value);
+            } else {
+                value = _mm256_min_epi32(value, other.value);
+            }
+        } else {
+            if constexpr (sizeof(T) == 1) {
+                value = _mm256_min_epu8(value, other.value);
+            } else if constexpr (sizeof(T) == 2) {
+                value = _mm256_min_epu16(value, other.value);
+            } else {
+                value = _mm256_min_epu32(value, other.value);
+            }
+        }
+    }
+
+    // Keeps the larger of each pair of lanes.
+    RTL_TARGET("avx2") auto keep_max(const vec& other) noexcept -> void {
+        if constexpr (std::same_as<T, float>) {
+            value = _mm256_max_ps(value, other.value);
+        } else if constexpr (std::same_as<T, double>) {
+            value = _mm256_max_pd(value, other.value);
+        } else if constexpr (sizeof(T) == 8) {
+            value = _mm256_blendv_epi8(value, other.value, other.greater_than(*this));
+        } else if constexpr (std::is_signed_v<T>) {
+            if constexpr (sizeof(T) == 1) {
+                value = _mm256_max_epi8(value, other.value);
+            } else if constexpr (sizeof(T) == 2) {
+                value = _mm256_max_epi16(value, other.value);
+            } else {
+                value = _mm256_max_epi32(value, other.value);
+            }
+        } else {
+            if constexpr (sizeof(T) == 1) {
+                value = _mm256_max_epu8(value, other.value);
+            } else if constexpr (sizeof(T) == 2) {
+                value = _mm256_max_epu16(value, other.value);
+            } else {
+                value = _mm256_max_epu32(value, other.value);
+            }
+        }
+    }
+
+    // Adds the lanes of `other`, integer lanes wrap around on overflow.
+    RTL_TARGET("avx2") auto add(const vec& other) noexcept -> void {
+        if constexpr (std::same_as<T, float>) {
+            value = _mm256_add_ps(value, other.value);
+        } else if constexpr (std::same_as<T, double>) {
+            value = _mm256_add_pd(value, other.value);
+        } else if constexpr (sizeof(T) == 1) {
+            value = _mm256_add_epi8(value, other.value);
+        } else if constexpr (sizeof(T) == 2) {
+            value = _mm256_add_epi16(value, other.value);
+        } else if constexpr (sizeof(T) == 4) {
+            value = _mm256_add_epi32(value, other.value);
+        } else {
+            value = _mm256_add_epi64(value, other.value);
+        }
+    }
+
+    register_type value;
+
+private:
+    RTL_TARGET("avx2") static auto to_mask(__m256i bytes) noexcept -> std::uint32_t {
+        return static_cast<std::uint32_t>(_mm256_movemask_epi8(bytes));
+    }
+
+    // 64 bit lanes only, AVX2 has no 64 bit minimum or maximum so they are built from a comparison and a blend.
+    RTL_TARGET("avx2") auto greater_than(const vec& other) const noexcept -> __m256i {
+        if constexpr (std::is_signed_v<T>) {
+            return _mm256_cmpgt_epi64(value, other.value);
+        } else {
+            // flipping the sign bit maps unsigned order onto signed order
+            auto bias = _mm256_set1_epi64x(std::numeric_limits<long long>::min());
+            return _mm256_cmpgt_epi64(_mm256_xor_si256(value, bias), _mm256_xor_si256(other.value, bias));
+        }
+    }
+}; // struct vec
+} // namespace avx2
+
+namespace sse42 {
+template<element T>
+struct vec {
+    using register_type = typename detail::register_for<T, 16>::type;
+
+    static constexpr std::size_t lanes = sizeof(register_type) / sizeof(T);
+
+    // Loads `lanes` values from `source`, which doesn't need to be aligned.
+    RTL_TARGET("sse4.2") auto load(const T* source) noexcept -> void {
+        if constexpr (std::same_as<T, float>) {
+            value = _mm_loadu_ps(source);
+        } else if constexpr (std::same_as<T, double>) {
+            value = _mm_loadu_pd(source);
+        } else {
+            value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+        }
+    }
+
+    // Sets every lane to `lane`.
+    RTL_TARGET("sse4.2") auto fill(T lane) noexcept -> void {
+        if constexpr (std::same_as<T, float>) {
+            value = _mm_set1_ps(lane);
+        } else if constexpr (std::same_as<T, double>) {
+            value = _mm_set1_pd(lane);
+        } else if constexpr (sizeof(T) == 1) {
+            value = _mm_set1_epi8(static_cast<char>(lane));
+        } else if constexpr (sizeof(T) == 2) {
+            value = _mm_set1_epi16(static_cast<short>(lane));
+        } else if constexpr (sizeof(T) == 4) {
+            value = _mm_set1_epi32(static_cast<int>(lane));
+        } else {
+            value = _mm_set1_epi64x(static_cast<long long>(lane));
+        }
+    }
+
+    RTL_TARGET("sse4.2") auto store(T* destination) const noexcept -> void {
+        if constexpr (std::same_as<T, float>) {
+            _mm_storeu_ps(destination, value);
+        } else if constexpr (std::same_as<T, double>) {
+            _mm_storeu_pd(destination, value);
+        } else {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination), value);
+        }
+    }
+
+    // One bit per byte, set for every byte of the lanes that equal the lanes of `other`.
+    RTL_TARGET("sse4.2") auto equal_mask(const vec& other) const noexcept -> std::uint32_t {
+        if constexpr (std::same_as<T, float>) {
+            return to_mask(_mm_castps_si128(_mm_cmpeq_ps(value, other.value)));
+        } else if constexpr (std::same_as<T, double>) {
+            return to_mask(_mm_castpd_si128(_mm_cmpeq_pd(value, other.value)));
+        } else if constexpr (sizeof(T) == 1) {
+            return to_mask(_mm_cmpeq_epi8(value, other.value));
+        } else if constexpr (sizeof(T) == 2) {
+            return to_mask(_mm_cmpeq_epi16(value, other.value));
+        } else if constexpr (sizeof(T) == 4) {
+            return to_mask(_mm_cmpeq_epi32(value, other.value));
+        } else {
+            return to_mask(_mm_cmpeq_epi64(value, other.value));
+        }
+    }
+
+    // Keeps the smaller of each pair of lanes.
+    RTL_TARGET("sse4.2") auto keep_min(const vec& other) noexcept -> void {
+        if constexpr (std::same_as<T, float>) {
+            value = _mm_min_ps(value, other.value);
+        } else if constexpr (std::same_as<T, double>) {
+            value = _mm_min_pd(value, other.value);
+        } else if constexpr (sizeof(T) == 8) {
+            value = _mm_blendv_epi8(value, other.value, greater_than(other));
+        } else if constexpr (std::is_signed_v<T>) {
+            if constexpr (sizeof(T) == 1) {
+                value = _mm_min_epi8(value, other.value);
+            } else if constexpr (sizeof(T) == 2) {
+                value = _mm_min_epi16(value, other.value);
+            } else {
+                value = _mm_min_epi32(value, other.value);
+            }
+        } else {
+            if constexpr (sizeof(T) == 1) {
+                value = _mm_min_epu8(value, other.value);
+            } else if constexpr (sizeof(T) == 2) {
+                value = _mm_min_epu16(value, other.value);
+            } else {
+                value = _mm_min_epu32(value, other.value);
+            }
+        }
+    }
+
+    // Keeps the larger of each pair of lanes.
+    RTL_TARGET("sse4.2") auto keep_max(const vec& other) noexcept -> void {
+        if constexpr (std::same_as<T, float>) {
+            value = _mm_max_ps(value, other.value);
+        } else if constexpr (std::same_as<T, double>) {
+            value = _mm_max_pd(value, other.value);
+        } else if constexpr (sizeof(T) == 8) {
+            value = _mm_blendv_epi8(value, other.value, other.greater_than(*this));
+        } else if constexpr (std::is_signed_v<T>) {
+            if constexpr (sizeof(T) == 1) {
+                value = _mm_max_epi8(value, other.value);
+            } else if constexpr (sizeof(T) == 2) {
+                value = _mm_max_epi16(value, other.value);
+            } else {
+                value = _mm_max_epi32(value, other.value);
+            }
+        } else {
+            if constexpr (sizeof(T) == 1) {
+                value = _mm_max_epu8(value, other.value);
+            } else if constexpr (sizeof(T) == 2) {
+                value = _mm_max_epu16(value, other.value);
+            } else {
+                value = _mm_max_epu32(value, other.value);
+            }
+        }
+    }
+
+    // Adds the lanes of `other`, integer lanes wrap around on overflow.
+    RTL_TARGET("sse4.2") auto add(const vec& other) noexcept -> void {
+        if constexpr (std::same_as<T, float>) {
+            value = _mm_add_ps(value, other.value);
+        } else if constexpr (std::same_as<T, double>) {
+            value = _mm_add_pd(value, other.value);
+        } else if constexpr (sizeof(T) == 1) {
+            value = _mm_add_epi8(value, other.value);
+        } else if constexpr (sizeof(T) == 2) {
+            value = _mm_add_epi16(value, other.value);
+        } else if constexpr (sizeof(T) == 4) {
+            value = _mm_add_epi32(value, other.value);
+        } else {
+            value = _mm_add_epi64(value, other.value);
+        }
+    }
+
+    register_type value;
+
+private:
+    RTL_TARGET("sse4.2") static auto to_mask(__m128i bytes) noexcept -> std::uint32_t {
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(bytes));
+    }
+
+    // 64 bit lanes only, there is no 64 bit minimum or maximum so they are built from a comparison and a blend.
+    RTL_TARGET("sse4.2") auto greater_than(const vec& other) const noexcept -> __m128i {
+        if constexpr (std::is_signed_v<T>) {
+            return _mm_cmpgt_epi64(value, other.value);
+        } else {
+            // flipping the sign bit maps unsigned order onto signed order
+            auto bias = _mm_set1_epi64x(std::numeric_limits<long long>::min());
+            return _mm_cmpgt_epi64(_mm_xor_si128(value, bias), _mm_xor_si128(other.value, bias));
+        }
+    }
+}; // struct vec
+} // namespace sse42
+#endif
+} // namespace rtl::utilities::simd
+
+#endif // #ifndef RTL_SIMD_HPP
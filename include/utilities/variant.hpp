@@ -0,0 +1,743 @@
+/*
+ * Copyright 2024 Ryan Jeffares
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+ * and associated documentation files (the “Software”), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge, publish, distribute,
+ * sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or
+ * substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RTL_VARIANT_HPP
+#define RTL_VARIANT_HPP
+
+#include "assertions.hpp"
+#include "attributes.hpp"
+#include "niche.hpp"
+#include "option.hpp"
+#include "reference.hpp"
+#include "typing/concepts.hpp"
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace rtl::utilities {
+template<typename... Ts>
+requires(sizeof...(Ts) > 0 && (... && (std::is_object_v<Ts> && !std::is_array_v<Ts> && !std::is_const_v<Ts>)))
+class variant;
+
+namespace detail {
+template<typename T>
+struct variant_size;
+
+template<typename... Ts>
+struct variant_size<variant<Ts...>> : std::integral_constant<std::size_t, sizeof...(Ts)> {
+
+};
+
+template<std::size_t I, typename... Ts>
+using variant_alternative = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+// The smallest unsigned type that holds every index and one more value, which marks a variant without a value.
+template<std::size_t Count>
+using variant_index = std::conditional_t<(Count < UINT8_MAX), std::uint8_t,
+    std::conditional_t<(Count < UINT16_MAX), std::uint16_t, std::uint32_t>>;
+
+template<typename T, typename... Ts>
+consteval auto variant_index_of() -> std::size_t {
+    constexpr bool matches[] = {std::is_same_v<T, Ts>...};
+    for (std::size_t i = 0; i < sizeof...(Ts); i++) {
+        if (matches[i]) {
+            return i;
+        }
+    }
+
+    return sizeof...(Ts);
+}
+
+// Selects the constructor that leaves a variant without a value.
+struct variant_valueless {
+
+};
+
+template<typename T, typename... Ts>
+inline constexpr bool occurs_once = (std::size_t{std::is_same_v<T, Ts>} + ...) == 1;
+
+// The alternative a variant is converted to from a `U`: the one of the same type, otherwise the only one constructible
+// from a `U`. `sizeof...(Ts)` if there isn't exactly one.
+template<typename U, typename... Ts>
+consteval auto variant_converting_index() -> std::size_t {
+    using value_type = std::remove_cvref_t<U>;
+    if constexpr (occurs_once<value_type, Ts...>) {
+        return variant_index_of<value_type, Ts...>();
+    } else {
+        constexpr bool constructible[] = {std::is_constructible_v<Ts, U>...};
+        auto found = sizeof...(Ts);
+        for (std::size_t i = 0; i < sizeof...(Ts); i++) {
+            if (constructible[i]) {
+                if (found != sizeof...(Ts)) {
+                    return sizeof...(Ts);
+                }
+
+                found = i;
+            }
+        }
+
+        return found;
+    }
+}
+
+// Calls `function(std::integral_constant<std::size_t, I>{})` with `I == index`. The cases are written out sixteen at a
+// time so compilers lower them to a jump table with the calls inlined, rather than an array of function pointers that
+// can't be. More alternatives chain on to another sixteen from the default case.
+template<typename R, std::size_t Count, std::size_t I, typename F>
+constexpr auto dispatch_case(F& function) -> R {
+    if constexpr (I < Count) {
+        return function(std::integral_constant<std::size_t, I>{});
+    } else {
+        std::unreachable();
+    }
+}
+
+template<typename R, std::size_t Count, std::size_t Base = 0, typename F>
+constexpr auto dispatch(std::size_t index, F&& function) -> R {
+    switch (index - Base) {
+        case 0:
+            return dispatch_case<R, Count, Base + 0>(function);
+        case 1:
+            return dispatch_case<R, Count, Base + 1>(function);
+        case 2:
+            return dispatch_case<R, Count, Base + 2>(function);
+        case 3:
+            return dispatch_case<R, Count, Base + 3>(function);
+        case 4:
+            return dispatch_case<R, Count, Base + 4>(function);
+        case 5:
+            return dispatch_case<R, Count, Base + 5>(function);
+        case 6:
+            return dispatch_case<R, Count, Base + 6>(function);
+        case 7:
+            return dispatch_case<R, Count, Base + 7>(function);
+        case 8:
+            return dispatch_case<R, Count, Base + 8>(function);
+        case 9:
+            return dispatch_case<R, Count, Base + 9>(function);
+        case 10:
+            return dispatch_case<R, Count, Base + 10>(function);
+        case 11:
+            return dispatch_case<R, Count, Base + 11>(function);
+        case 12:
+            return dispatch_case<R, Count, Base + 12>(function);
+        case 13:
+            return dispatch_case<R, Count, Base + 13>(function);
+        case 14:
+            return dispatch_case<R, Count, Base + 14>(function);
+        case 15:
+            return dispatch_case<R, Count, Base + 15>(function);
+        default:
+            if constexpr (Base + 16 < Count) {
+                return dispatch<R, Count, Base + 16>(index, function);
+            } else {
+                std::unreachable();
+            }
+    }
+}
+
+// The index of each variant from the index into their flattened combinations, the last variant varying fastest.
+template<std::size_t Flat, std::size_t... Counts>
+consteval auto unflatten() -> std::array<std::size_t, sizeof...(Counts)> {
+    constexpr std::size_t counts[] = {Counts...};
+    auto indices = std::array<std::size_t, sizeof...(Counts)>{};
+    auto flat = Flat;
+    for (std::size_t i = sizeof...(Counts); i-- > 0;) {
+        indices[i] = flat % counts[i];
+        flat /= counts[i];
+    }
+
+    return indices;
+}
+
+// Storage for the alternatives, only one of which is alive at a time.
+template<typename... Ts>
+union variant_union;
+
+template<>
+union variant_union<> {
+
+};
+
+template<typename T, typename... Rest>
+union variant_union<T, Rest...> {
+    constexpr variant_union() noexcept : m_dummy{} {
+
+    }
+
+    template<typename... Args>
+    constexpr explicit variant_union(std::in_place_index_t<0>, Args&&... args)
+        noexcept(std::is_nothrow_constructible_v<T, Args...>)
+        : m_head(std::forward<Args>(args)...) {
+
+    }
+
+    template<std::size_t I, typename... Args>
+    constexpr explicit variant_union(std::in_place_index_t<I>, Args&&... args)
+        noexcept(std::is_nothrow_constructible_v<variant_union<Rest...>, std::in_place_index_t<I - 1>, Args...>)
+        : m_tail(std::in_place_index<I - 1>, std::forward<Args>(args)...) {
+
+    }
+
+    constexpr ~variant_union() requires(std::is_trivially_destructible_v<T>
+                                        && (... && std::is_trivially_destructible_v<Rest>)) = default;
+
+    constexpr ~variant_union() {
+
+    }
+
+    dummy m_dummy;
+    T m_head;
+    variant_union<Rest...> m_tail;
+};
+
+template<std::size_t I, typename U>
+constexpr auto get_alternative(U&& storage) noexcept -> auto&& {
+    if constexpr (I == 0) {
+        return std::forward<U>(storage).m_head;
+    } else {
+        return get_alternative<I - 1>(std::forward<U>(storage).m_tail);
+    }
+}
+
+// The alternatives in a union with the smallest index type that fits. The index is one past the last alternative
+// when there is no value, which only happens when constructing an alternative throws, or as the niche for an `option`.
+template<typename... Ts>
+class tagged_variant_storage {
+public:
+    static constexpr std::size_t npos = sizeof...(Ts);
+
+    constexpr tagged_variant_storage() noexcept = default;
+
+    template<std::size_t I, typename... Args>
+    constexpr explicit tagged_variant_storage(std::in_place_index_t<I> index, Args&&... args)
+        noexcept(std::is_nothrow_constructible_v<variant_alternative<I, Ts...>, Args...>)
+        : m_union(index, std::forward<Args>(args)...)
+        , m_index{static_cast<variant_index<sizeof...(Ts)>>(I)} {
+
+    }
+
+    constexpr tagged_variant_storage(const tagged_variant_storage&) = default;
+    constexpr tagged_variant_storage(tagged_variant_storage&&) = default;
+    constexpr auto operator=(const tagged_variant_storage&) -> tagged_variant_storage& = default;
+    constexpr auto operator=(tagged_variant_storage&&) -> tagged_variant_storage& = default;
+
+    constexpr ~tagged_variant_storage() requires(... && std::is_trivially_destructible_v<Ts>) = default;
+
+    constexpr ~tagged_variant_storage() {
+        destroy();
+    }
+
+    [[nodiscard]] constexpr auto index() const noexcept -> std::size_t {
+        return m_index;
+    }
+
+    template<std::size_t I>
+    constexpr auto get() noexcept -> variant_alternative<I, Ts...>& {
+        return get_alternative<I>(m_union);
+    }
+
+    template<std::size_t I>
+    constexpr auto get() const noexcept -> const variant_alternative<I, Ts...>& {
+        return get_alternative<I>(m_union);
+    }
+
+    // Replaces the current alternative, leaving no value if the constructor throws.
+    template<std::size_t I, typename... Args>
+    constexpr auto emplace(Args&&... args) noexcept(std::is_nothrow_constructible_v<variant_alternative<I, Ts...>, Args...>)
+        -> void {
+        destroy();
+        std::construct_at(std::addressof(get<I>()), std::forward<Args>(args)...);
+        m_index = static_cast<variant_index<sizeof...(Ts)>>(I);
+    }
+
+private:
+    constexpr auto destroy() noexcept -> void {
+        if constexpr (!(... && std::is_trivially_destructible_v<Ts>)) {
+            if (m_index != npos) {
+                dispatch<void, sizeof...(Ts)>(m_index, [this](auto i) {
+                    std::destroy_at(std::addressof(get<i>()));
+                });
+            }
+        }
+
+        m_index = static_cast<variant_index<sizeof...(Ts)>>(npos);
+    }
+
+    variant_union<Ts...> m_union;
+    variant_index<sizeof...(Ts)> m_index{static_cast<variant_index<sizeof...(Ts)>>(npos)};
+}; // class tagged_variant_storage
+
+// Stands in for an alternative that has no state, so it can share the storage of one with a niche.
+template<typename T>
+concept niche_filler = std::is_empty_v<T>
+    && std::is_trivially_default_constructible_v<T>
+    && std::is_trivially_copyable_v<T>;
+
+// The alternative whose niche can mark the other, or two if there isn't one. Only two alternatives can share
+// storage, since `niche_traits` only describes one value that isn't valid, and only when that value is reserved:
+// otherwise `variant<int*, std::monostate>{nullptr}` would read back as the monostate.
+template<typename... Ts>
+consteval auto niche_alternative() -> std::size_t {
+    if constexpr (sizeof...(Ts) == 2) {
+        using first = variant_alternative<0, Ts...>;
+        using second = variant_alternative<1, Ts...>;
+        if constexpr (has_reserved_niche<first> && !std::is_empty_v<first> && niche_filler<second>) {
+            return 0;
+        } else if constexpr (has_reserved_niche<second> && !std::is_empty_v<second> && niche_filler<first>) {
+            return 1;
+        }
+    }
+
+    return 2;
+}
+
+// Two alternatives in the space of one, the other one having no state is marked by the niche of this one, the same
+// way an empty `option` is.
+template<std::size_t Data, typename... Ts>
+class niche_variant_storage {
+private:
+    static constexpr std::size_t s_filler = 1 - Data;
+
+    using data_type = variant_alternative<Data, Ts...>;
+    using filler_type = variant_alternative<s_filler, Ts...>;
+    using niche = niche_traits<data_type>;
+
+public:
+    static constexpr std::size_t npos = 2;
+
+    constexpr niche_variant_storage() noexcept : m_value{niche::empty()} {
+
+    }
+
+    template<typename... Args>
+    constexpr explicit niche_variant_storage(std::in_place_index_t<Data>, Args&&... args)
+        noexcept(std::is_nothrow_constructible_v<data_type, Args...>)
+        : m_value(std::forward<Args>(args)...) {
+
+    }
+
+    // the filler has no state, so there is nothing to construct it from
+    template<typename... Args>
+    constexpr explicit niche_variant_storage(std::in_place_index_t<s_filler>, Args&&...) noexcept
+        : m_value{niche::empty()} {
+
+    }
+
+    [[nodiscard]] constexpr auto index() const noexcept -> std::size_t {
+        return niche::is_empty(m_value) ? s_filler : Data;
+    }
+
+    template<std::size_t I>
+    constexpr auto get() noexcept -> variant_alternative<I, Ts...>& {
+        if constexpr (I == Data) {
+            return m_value;
+        } else {
+            return m_filler;
+        }
+    }
+
+    template<std::size_t I>
+    constexpr auto get() const noexcept -> const variant_alternative<I, Ts...>& {
+        if constexpr (I == Data) {
+            return m_value;
+        } else {
+            return m_filler;
+        }
+    }
+
+    // Replaces the current alternative, leaving the filler if the constructor throws.
+    template<std::size_t I, typename... Args>
+    constexpr auto emplace(Args&&... args) noexcept(std::is_nothrow_constructible_v<variant_alternative<I, Ts...>, Args...>)
+        -> void {
+        std::destroy_at(std::addressof(m_value));
+        if constexpr (I == Data) {
+            struct guard {
+                niche_variant_storage* storage;
+
+                constexpr ~guard() {
+                    if (storage != nullptr) {
+                        std::construct_at(std::addressof(storage->m_value), niche::empty());
+                    }
+                }
+            };
+
+            auto restore = guard{this};
+            std::construct_at(std::addressof(m_value), std::forward<Args>(args)...);
+            restore.storage = nullptr;
+        } else {
+            std::construct_at(std::addressof(m_value), niche::empty());
+        }
+    }
+
+private:
+    data_type m_value;
+    RTL_NO_UNIQUE_ADDRESS filler_type m_filler{};
+}; // class niche_variant_storage
+
+template<typename... Ts>
+using variant_storage = std::conditional_t<niche_alternative<Ts...>() != 2,
+    niche_variant_storage<niche_alternative<Ts...>() % 2, Ts...>,
+    tagged_variant_storage<Ts...>>;
+} // namespace detail
+
+// Holds a value of one of `Ts`. The index is stored in the smallest unsigned type that fits. A variant of two
+// alternatives, one with a reserved niche (see `reserved_niche`) and one without any state (such as `std::monostate`),
+// stores neither an index nor padding for one and is the size of the alternative with the niche.
+//
+// Alternatives are replaced by destroying the current one and constructing the new one in its place. If that
+// constructor throws the variant is left without a value, see `valueless`.
+template<typename... Ts>
+requires(sizeof...(Ts) > 0 && (... && (std::is_object_v<Ts> && !std::is_array_v<Ts> && !std::is_const_v<Ts>)))
+class variant {
+private:
+    template<std::size_t I>
+    using alternative = detail::variant_alternative<I, Ts...>;
+
+    template<typename T>
+    static constexpr std::size_t s_index_of = detail::variant_index_of<T, Ts...>();
+
+    template<typename U>
+    static constexpr std::size_t s_converting_index = detail::variant_converting_index<U, Ts...>();
+
+    static constexpr bool s_is_copy_constructible = (... && std::is_copy_constructible_v<Ts>);
+    static constexpr bool s_is_nothrow_copy_constructible = (... && std::is_nothrow_copy_constructible_v<Ts>);
+    static constexpr bool s_is_move_constructible = (... && std::is_move_constructible_v<Ts>);
+    static constexpr bool s_is_nothrow_move_constructible = (... && std::is_nothrow_move_constructible_v<Ts>);
+    static constexpr bool s_is_trivially_copyable = (... && (std::is_trivially_copy_constructible_v<Ts>
+        && std::is_trivially_copy_assignable_v<Ts> && std::is_trivially_destructible_v<Ts>));
+    static constexpr bool s_is_trivially_movable = (... && (std::is_trivially_move_constructible_v<Ts>
+        && std::is_trivially_move_assignable_v<Ts> && std::is_trivially_destructible_v<Ts>));
+
+public:
+    constexpr variant() noexcept(std::is_nothrow_default_constructible_v<alternative<0>>)
+        requires(std::is_default_constructible_v<alternative<0>>)
+        : m_storage{std::in_place_index<0>} {
+
+    }
+
+    constexpr variant(const variant&) noexcept requires(s_is_trivially_copyable) = default;
+
+    constexpr variant(const variant& other) noexcept(s_is_nothrow_copy_constructible)
+        requires(s_is_copy_constructible && !s_is_trivially_copyable) {
+        other.visit_index([this, &other](auto i) {
+            m_storage.template emplace<i>(other.m_storage.template get<i>());
+        });
+    }
+
+    constexpr variant(variant&&) noexcept requires(s_is_trivially_movable) = default;
+
+    constexpr variant(variant&& other) noexcept(s_is_nothrow_move_constructible)
+        requires(s_is_move_constructible && !s_is_trivially_movable) {
+        other.visit_index([this, &other](auto i) {
+            m_storage.template emplace<i>(std::move(other.m_storage.template get<i>()));
+        });
+    }
+
+    template<std::size_t I, typename... Args> requires(I < sizeof...(Ts) && std::is_constructible_v<alternative<I>, Args...>)
+    constexpr explicit variant(std::in_place_index_t<I> index, Args&&... args)
+        noexcept(std::is_nothrow_constructible_v<alternative<I>, Args...>)
+        : m_storage{index, std::forward<Args>(args)...} {
+
+    }
+
+    template<typename T, typename... Args> requires(detail::occurs_once<T, Ts...> && std::is_constructible_v<T, Args...>)
+    constexpr explicit variant(std::in_place_type_t<T>, Args&&... args)
+        noexcept(std::is_nothrow_constructible_v<T, Args...>)
+        : m_storage{std::in_place_index<s_index_of<T>>, std::forward<Args>(args)...} {
+
+    }
+
+    // Holds the alternative of the same type as `value`, otherwise the only one that can be constructed from it.
+    template<typename U> requires(!std::is_same_v<std::remove_cvref_t<U>, variant>
+        && !typing::is_specialisation_v<std::remove_cvref_t<U>, std::in_place_type_t>
+        && s_converting_index<U> != sizeof...(Ts))
+    constexpr variant(U&& value) noexcept(std::is_nothrow_constructible_v<alternative<s_converting_index<U>>, U>)
+        : m_storage{std::in_place_index<s_converting_index<U>>, std::forward<U>(value)} {
+
+    }
+
+    constexpr ~variant() = default;
+
+    constexpr auto operator=(const variant&) noexcept -> variant& requires(s_is_trivially_copyable) = default;
+
+    constexpr auto operator=(const variant& other) noexcept(s_is_nothrow_copy_constructible)
+        -> variant& requires(s_is_copy_constructible && !s_is_trivially_copyable) {
+        if (this != &other) {
+            other.visit_index([this, &other](auto i) {
+                assign<i>(other.m_storage.template get<i>());
+            });
+        }
+
+        return *this;
+    }
+
+    constexpr auto operator=(variant&&) noexcept -> variant& requires(s_is_trivially_movable) = default;
+
+    constexpr auto operator=(variant&& other) noexcept(s_is_nothrow_move_constructible)
+        -> variant& requires(s_is_move_constructible && !s_is_trivially_movable) {
+        if (this != &other) {
+            other.visit_index([this, &other](auto i) {
+                assign<i>(std::move(other.m_storage.template get<i>()));
+            });
+        }
+
+        return *this;
+    }
+
+    template<typename U> requires(!std::is_same_v<std::remove_cvref_t<U>, variant>
+        && s_converting_index<U> != sizeof...(Ts))
+    constexpr auto operator=(U&& value) noexcept(std::is_nothrow_constructible_v<alternative<s_converting_index<U>>, U>)
+        -> variant& {
+        assign<s_converting_index<U>>(std::forward<U>(value));
+        return *this;
+    }
+
+    // access
+
+    // The index of the current alternative, or `sizeof...(Ts)` if the variant has no value.
+    [[nodiscard]] constexpr auto index() const noexcept -> std::size_t {
+        return m_storage.index();
+    }
+
+    // Only true after constructing an alternative threw.
+    [[nodiscard]] constexpr auto valueless() const noexcept -> bool {
+        return index() == sizeof...(Ts);
+    }
+
+    template<typename T> requires(detail::occurs_once<T, Ts...>)
+    [[nodiscard]] constexpr auto holds() const noexcept -> bool {
+        return index() == s_index_of<T>;
+    }
+
+    template<std::size_t I> requires(I < sizeof...(Ts))
+    constexpr auto get() noexcept -> option<reference<alternative<I>>> {
+        if (index() != I) {
+            return nullopt;
+        }
+
+        return m_storage.template get<I>();
+    }
+
+    template<std::size_t I> requires(I < sizeof...(Ts))
+    constexpr auto get() const noexcept -> option<reference<const alternative<I>>> {
+        if (index() != I) {
+            return nullopt;
+        }
+
+        return m_storage.template get<I>();
+    }
+
+    template<typename T> requires(detail::occurs_once<T, Ts...>)
+    constexpr auto get() noexcept -> option<reference<T>> {
+        return get<s_index_of<T>>();
+    }
+
+    template<typename T> requires(detail::occurs_once<T, Ts...>)
+    constexpr auto get() const noexcept -> option<reference<const T>> {
+        return get<s_index_of<T>>();
+    }
+
+    template<std::size_t I> requires(I < sizeof...(Ts))
+    constexpr auto get_unchecked() & noexcept -> alternative<I>& {
+        RTL_ASSERT(index() == I, "Trying to access an alternative the variant doesn't hold");
+        return m_storage.template get<I>();
+    }
+
+    template<std::size_t I> requires(I < sizeof...(Ts))
+    constexpr auto get_unchecked() const& noexcept -> const alternative<I>& {
+        RTL_ASSERT(index() == I, "Trying to access an alternative the variant doesn't hold");
+        return m_storage.template get<I>();
+    }
+
+    template<std::size_t I> requires(I < sizeof...(Ts))
+    constexpr auto get_unchecked() && noexcept -> alternative<I>&& {
+        RTL_ASSERT(index() == I, "Trying to access an alternative the variant doesn't hold");
+        return std::move(m_storage.template get<I>());
+    }
+
+    template<typename T> requires(detail::occurs_once<T, Ts...>)
+    constexpr auto get_unchecked() & noexcept -> T& {
+        return get_unchecked<s_index_of<T>>();
+    }
+
+    template<typename T> requires(detail::occurs_once<T, Ts...>)
+    constexpr auto get_unchecked() const& noexcept -> const T& {
+        return get_unchecked<s_index_of<T>>();
+    }
+
+    template<typename T> requires(detail::occurs_once<T, Ts...>)
+    constexpr auto get_unchecked() && noexcept -> T&& {
+        return std::move(*this).template get_unchecked<s_index_of<T>>();
+    }
+
+    // Calls `function` with the current alternative, see `utilities::visit`.
+    template<typename F>
+    constexpr auto visit(F&& function) & -> decltype(auto);
+
+    template<typename F>
+    constexpr auto visit(F&& function) const& -> decltype(auto);
+
+    template<typename F>
+    constexpr auto visit(F&& function) && -> decltype(auto);
+
+    // modification
+
+    template<std::size_t I, typename... Args> requires(I < sizeof...(Ts) && std::is_constructible_v<alternative<I>, Args...>)
+    constexpr auto emplace(Args&&... args) noexcept(std::is_nothrow_constructible_v<alternative<I>, Args...>)
+        -> alternative<I>& {
+        m_storage.template emplace<I>(std::forward<Args>(args)...);
+        return m_storage.template get<I>();
+    }
+
+    template<typename T, typename... Args> requires(detail::occurs_once<T, Ts...> && std::is_constructible_v<T, Args...>)
+    constexpr auto emplace(Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>) -> T& {
+        return emplace<s_index_of<T>>(std::forward<Args>(args)...);
+    }
+
+    // comparison
+
+    friend constexpr auto operator==(const variant& a, const variant& b) -> bool
+        requires(... && std::equality_comparable<Ts>) {
+        if (a.index() != b.index()) {
+            return false;
+        }
+
+        return a.valueless() || detail::dispatch<bool, sizeof...(Ts)>(a.index(), [&a, &b](auto i) {
+            return static_cast<bool>(a.m_storage.template get<i>() == b.m_storage.template get<i>());
+        });
+    }
+
+private:
+    template<typename T>
+    friend struct niche_traits;
+
+    constexpr explicit variant(detail::variant_valueless) noexcept {
+
+    }
+
+    // Calls `function(std::integral_constant<std::size_t, I>{})` for the current index `I`, if there is one.
+    template<typename F>
+    constexpr auto visit_index(F&& function) const -> void {
+        if (!valueless()) {
+            detail::dispatch<void, sizeof...(Ts)>(index(), std::forward<F>(function));
+        }
+    }
+
+    template<std::size_t I, typename U>
+    constexpr auto assign(U&& value) -> void {
+        if constexpr (std::is_assignable_v<alternative<I>&, U>) {
+            if (index() == I) {
+                m_storage.template get<I>() = std::forward<U>(value);
+                return;
+            }
+        }
+
+        m_storage.template emplace<I>(std::forward<U>(value));
+    }
+
+    detail::variant_storage<Ts...> m_storage;
+}; // class variant
+
+// Calls `function` with the current alternative of each variant, which must all have a value. The result must be the
+// same type for every combination of alternatives.
+//
+// The combinations are numbered by treating the indices as the digits of one number, which is dispatched through a
+// single jump table, so visiting several variants takes one indirect jump and one call per combination of types
+// rather than a table and a call per variant.
+template<typename F, typename... Vs>
+requires(sizeof...(Vs) > 0 && (... && typing::is_specialisation_v<std::remove_cvref_t<Vs>, variant>))
+constexpr auto visit(F&& function, Vs&&... variants) -> decltype(auto) {
+    constexpr std::size_t counts[] = {detail::variant_size<std::remove_cvref_t<Vs>>::value...};
+    constexpr auto combinations = [&counts] {
+        std::size_t product = 1;
+        for (auto count : counts) {
+            product *= count;
+        }
+
+        return product;
+    }();
+
+    RTL_ASSERT(!(... || variants.valueless()), "Trying to visit a valueless variant");
+
+    std::size_t flat = 0;
+    ((flat = flat * detail::variant_size<std::remove_cvref_t<Vs>>::value + variants.index()), ...);
+
+    using R = std::invoke_result_t<F, decltype(std::forward<Vs>(variants).template get_unchecked<0>())...>;
+    return detail::dispatch<R, combinations>(flat, [&](auto i) -> R {
+        constexpr auto indices = detail::unflatten<i, detail::variant_size<std::remove_cvref_t<Vs>>::value...>();
+        return [&]<std::size_t... K>(std::index_sequence<K...>) -> R {
+            using result = decltype(std::invoke(std::forward<F>(function),
+                std::forward<Vs>(variants).template get_unchecked<indices[K]>()...));
+            static_assert(std::is_same_v<result, R>, "visit requires the same result type for every alternative");
+            return std::invoke(std::forward<F>(function),
+                std::forward<Vs>(variants).template get_unchecked<indices[K]>()...);
+        }(std::index_sequence_for<Vs...>{});
+    });
+}
+
+template<typename... Ts>
+requires(sizeof...(Ts) > 0 && (... && (std::is_object_v<Ts> && !std::is_array_v<Ts> && !std::is_const_v<Ts>)))
+template<typename F>
+constexpr auto variant<Ts...>::visit(F&& function) & -> decltype(auto) {
+    return utilities::visit(std::forward<F>(function), *this);
+}
+
+template<typename... Ts>
+requires(sizeof...(Ts) > 0 && (... && (std::is_object_v<Ts> && !std::is_array_v<Ts> && !std::is_const_v<Ts>)))
+template<typename F>
+constexpr auto variant<Ts...>::visit(F&& function) const& -> decltype(auto) {
+    return utilities::visit(std::forward<F>(function), *this);
+}
+
+template<typename... Ts>
+requires(sizeof...(Ts) > 0 && (... && (std::is_object_v<Ts> && !std::is_array_v<Ts> && !std::is_const_v<Ts>)))
+template<typename F>
+constexpr auto variant<Ts...>::visit(F&& function) && -> decltype(auto) {
+    return utilities::visit(std::forward<F>(function), std::move(*this));
+}
+
+// A variant that stores its index uses the value after the last index as its niche, so an `option` of one is no
+// bigger. A variant already using the niche of an alternative has none left over.
+template<typename... Ts> requires(detail::niche_alternative<Ts...>() == 2)
+struct niche_traits<variant<Ts...>> {
+    static constexpr auto empty() noexcept -> variant<Ts...> {
+        return variant<Ts...>{detail::variant_valueless{}};
+    }
+
+    static constexpr auto is_empty(const variant<Ts...>& value) noexcept -> bool {
+        return value.valueless();
+    }
+};
+} // namespace rtl::utilities
+
+template<typename... Ts>
+struct rtl::typing::is_trivially_relocatable<rtl::utilities::variant<Ts...>>
+    : std::bool_constant<(... && rtl::typing::is_trivially_relocatable_v<Ts>)> {
+
+};
+
+#endif // #ifndef RTL_VARIANT_HPP
@@ -0,0 +1,716 @@
+#include "rtl.hpp"
+#include "test.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace rtl;
+
+namespace {
+// Counts live objects and moves, so tests can see which elements were constructed, moved and destroyed.
+struct tracked {
+    static inline int live = 0;
+    static inline int moves = 0;
+
+    int value;
+
+    tracked(int v) noexcept
+        : value{v} {
+        live++;
+    }
+
+    tracked(const tracked& other) noexcept
+        : value{other.value} {
+        live++;
+    }
+
+    tracked(tracked&& other) noexcept
+        : value{other.value} {
+        live++;
+        moves++;
+    }
+
+    tracked& operator=(const tracked&) = default;
+    tracked& operator=(tracked&&) = default;
+
+    ~tracked() noexcept {
+        live--;
+    }
+};
+
+// Like `tracked`, but opts in to being relocated with memmove.
+struct relocatable : tracked {
+    using tracked::tracked;
+};
+} // namespace
+
+template<>
+struct rtl::typing::is_trivially_relocatable<relocatable> : std::true_type {
+
+};
+
+namespace {
+template<typename T>
+auto test_relocation() -> void {
+    constexpr int count = 100;
+
+    tracked::live = 0;
+    {
+        collections::list<T> list;
+        for (int i = 0; i < count; i++) {
+            list.add(i);
+        }
+
+        tracked::moves = 0;
+        list.reserve(4 * count);
+        RTL_CHECK(list.insert(0, T{-1}).has_value());
+        RTL_CHECK(list.insert(list.size(), T{count}).has_value());
+        RTL_CHECK(!list.insert(list.size() + 1, T{0}).has_value());
+        RTL_CHECK(list.remove(1).has_value());
+        list.shrink_to_fit();
+
+        RTL_CHECK(list.size() == count + 1);
+        RTL_CHECK(list.capacity() == list.size());
+        RTL_CHECK(list.front_unchecked().value == -1);
+        RTL_CHECK(list.at_unchecked(1).value == 1);
+        RTL_CHECK(list.back_unchecked().value == count);
+        RTL_CHECK(tracked::live == count + 1);
+
+        // shifting and reallocating move whole runs with memmove, so only the inserted and removed values are moved
+        if constexpr (typing::trivially_relocatable<T>) {
+            RTL_CHECK(tracked::moves < 10);
+        } else {
+            RTL_CHECK(tracked::moves > count);
+        }
+    }
+    RTL_CHECK(tracked::live == 0);
+}
+// Counts the allocations made through it and every copy of it.
+template<typename T>
+struct counting_allocator {
+    using value_type = T;
+
+    int* allocations;
+
+    explicit counting_allocator(int& count) noexcept
+        : allocations{&count} {
+
+    }
+
+    template<typename U>
+    counting_allocator(const counting_allocator<U>& other) noexcept
+        : allocations{other.allocations} {
+
+    }
+
+    auto allocate(std::size_t n) -> T* {
+        ++*allocations;
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    auto deallocate(T* pointer, std::size_t n) noexcept -> void {
+        std::allocator<T>{}.deallocate(pointer, n);
+    }
+
+    friend auto operator==(const counting_allocator& a, const counting_allocator& b) noexcept -> bool {
+        return a.allocations == b.allocations;
+    }
+};
+
+// A comparison with state and no default constructor.
+struct descending {
+    explicit descending(int) noexcept {
+
+    }
+
+    auto operator()(int a, int b) const noexcept -> bool {
+        return a > b;
+    }
+};
+
+// Checks every algorithm against a plain loop, for every length up to a few vectors and the interesting values at
+// every position, so the vector bodies, the overlapping tails and the scalar fallbacks are all covered.
+template<typename T>
+auto test_algorithms() -> void {
+    for (std::size_t size = 0; size <= 70; size++) {
+        collections::list<T> values;
+        for (std::size_t i = 0; i < size; i++) {
+            values.add(static_cast<T>(i % 5 + 1));
+        }
+
+        for (std::size_t position = 0; position < size; position++) {
+            auto saved = values.at_unchecked(position);
+            values.at_unchecked(position) = static_cast<T>(100);
+            RTL_CHECK(&collections::find(values, static_cast<T>(100)).value().get() == values.data() + position);
+            RTL_CHECK(collections::count(values, static_cast<T>(100)) == 1);
+            RTL_CHECK(collections::max(values).value() == static_cast<T>(100));
+
+            values.at_unchecked(position) = static_cast<T>(0);
+            RTL_CHECK(collections::min(values).value() == static_cast<T>(0));
+            values.at_unchecked(position) = saved;
+        }
+
+        auto expected_count = std::size_t{0};
+        auto expected_sum = T{};
+        for (const auto& value : values) {
+            expected_count += value == static_cast<T>(3) ? 1 : 0;
+            expected_sum = static_cast<T>(expected_sum + value);
+        }
+
+        RTL_CHECK(collections::count(values, static_cast<T>(3)) == expected_count);
+        RTL_CHECK(collections::sum(values) == expected_sum);
+        RTL_CHECK(collections::contains(values, static_cast<T>(3)) == (expected_count != 0));
+        RTL_CHECK(!collections::find(values, static_cast<T>(42)).has_value());
+        RTL_CHECK(collections::minmax(values).has_value() == (size != 0));
+
+#ifdef RTL_X86
+        // the dispatch prefers AVX2, so call the SSE4.2 kernels directly too
+        if (utilities::cpu().sse42) {
+            RTL_CHECK(collections::detail::count_sse42(values.data(), size, static_cast<T>(3)) == expected_count);
+            RTL_CHECK(collections::detail::sum_sse42(values.data(), size) == expected_sum);
+            RTL_CHECK(collections::detail::find_sse42(values.data(), size, static_cast<T>(42)) == size);
+            if (size >= utilities::simd::sse42::vec<T>::lanes) {
+                RTL_CHECK(collections::detail::minmax_sse42(values.data(), size)
+                          == collections::detail::minmax_scalar(values.data(), size));
+            }
+        }
+#endif
+    }
+}
+
+// Sends every key to the same probe sequence, so lookups have to walk past other keys and across groups.
+struct colliding_hash {
+    auto operator()(int) const noexcept -> std::size_t {
+        return 42;
+    }
+};
+} // namespace
+
+int main() {
+    tests::run("list relocates elements it moves", [] {
+        test_relocation<tracked>();
+        test_relocation<relocatable>();
+        RTL_CHECK(typing::trivially_relocatable<collections::list<std::string>>);
+        RTL_CHECK(!typing::trivially_relocatable<tracked>);
+    });
+
+    tests::run("list reuses capacity after clear", [] {
+        collections::list<int> list{1, 2, 3};
+        auto data = list.data();
+        list.clear();
+        list.add(4);
+        RTL_CHECK(list.data() == data);
+        RTL_CHECK(list.size() == 1);
+    });
+
+    tests::run("small_list stores elements inline until it outgrows them", [] {
+        // a list without inline capacity is no bigger for having the option of it
+        struct plain_list {
+            int* array;
+            std::size_t size;
+            std::size_t capacity;
+            std::allocator<int> allocator;
+        };
+        RTL_CHECK(sizeof(collections::list<int>) == sizeof(plain_list));
+
+        tracked::live = 0;
+        {
+            collections::small_list<tracked, 4> list;
+            RTL_CHECK(list.is_inline());
+            RTL_CHECK(list.capacity() == 4);
+            for (int i = 0; i < 4; i++) {
+                list.add(i);
+            }
+            RTL_CHECK(list.is_inline());
+
+            list.add(4);
+            RTL_CHECK(!list.is_inline());
+            RTL_CHECK(list.capacity() > 4);
+
+            RTL_CHECK(list.remove(0).has_value());
+            list.pop();
+            list.shrink_to_fit();
+            RTL_CHECK(list.is_inline());
+            RTL_CHECK(list.size() == 3);
+            RTL_CHECK(list.front_unchecked().value == 1);
+            RTL_CHECK(list.back_unchecked().value == 3);
+            RTL_CHECK(tracked::live == 3);
+        }
+        RTL_CHECK(tracked::live == 0);
+    });
+
+    tests::run("small_list moves and copies inline and allocated elements", [] {
+        collections::small_list<std::string, 2> inline_list{"a", "b"};
+        collections::small_list<std::string, 2> allocated_list{"c", "d", "e"};
+
+        auto copy = inline_list;
+        auto moved_inline = std::move(inline_list);
+        RTL_CHECK(moved_inline.is_inline());
+        RTL_CHECK(moved_inline.size() == 2 && moved_inline.back_unchecked() == "b");
+        RTL_CHECK(inline_list.empty() && inline_list.is_inline());
+        RTL_CHECK(copy.size() == 2 && copy.front_unchecked() == "a");
+
+        auto data = allocated_list.data();
+        auto moved_allocated = std::move(allocated_list);
+        RTL_CHECK(moved_allocated.data() == data);
+        RTL_CHECK(allocated_list.empty() && allocated_list.is_inline());
+
+        moved_allocated = std::move(moved_inline);
+        RTL_CHECK(moved_allocated.is_inline());
+        RTL_CHECK(moved_allocated.size() == 2 && moved_allocated.front_unchecked() == "a");
+
+        allocated_list.add("f");
+        RTL_CHECK(allocated_list.size() == 1 && allocated_list.front_unchecked() == "f");
+    });
+
+    tests::run("only lists without inline elements are trivially relocatable", [] {
+        RTL_CHECK(typing::trivially_relocatable<collections::list<int>>);
+        RTL_CHECK(!typing::trivially_relocatable<collections::small_list<int, 4>>);
+        RTL_CHECK(!collections::list<int>{}.is_inline());
+    });
+
+    tests::run("hash_map inserts, finds and removes across rehashes", [] {
+        collections::hash_map<int, std::string> map;
+        for (int i = 0; i < 1'000; i++) {
+            RTL_CHECK(map.insert(i, std::to_string(i)));
+        }
+        RTL_CHECK(!map.insert(7, "duplicate"));
+        RTL_CHECK(map.size() == 1'000);
+        RTL_CHECK(map.capacity() - map.capacity() / 8 >= map.size());
+
+        for (int i = 0; i < 1'000; i += 2) {
+            auto removed = map.remove(i);
+            RTL_CHECK(removed.has_value() && removed.value() == std::to_string(i));
+        }
+        RTL_CHECK(!map.remove(0).has_value());
+        RTL_CHECK(map.size() == 500);
+
+        auto found = 0;
+        for (int i = 0; i < 1'000; i++) {
+            if (auto value = map.find(i)) {
+                found++;
+                RTL_CHECK(i % 2 == 1 && value->get() == std::to_string(i));
+            }
+        }
+        RTL_CHECK(found == 500);
+
+        auto iterated = 0;
+        for (auto [key, value] : map) {
+            RTL_CHECK(value == std::to_string(key));
+            iterated++;
+        }
+        RTL_CHECK(iterated == 500);
+    });
+
+    tests::run("hash_map reuses deleted slots and probes past collisions", [] {
+        collections::hash_map<int, int, colliding_hash> map;
+        for (int round = 0; round < 10; round++) {
+            for (int i = 0; i < 40; i++) {
+                map.insert(i, i * round);
+            }
+            for (int i = 0; i < 40; i++) {
+                RTL_CHECK(map.find(i).has_value() && map.find(i)->get() == i * round);
+            }
+            for (int i = 0; i < 40; i++) {
+                RTL_CHECK(map.remove(i).has_value());
+            }
+            RTL_CHECK(map.empty());
+        }
+        RTL_CHECK(map.capacity() <= 128);
+    });
+
+    tests::run("hash_map copies, moves and updates values", [] {
+        collections::hash_map<std::string, int> map;
+        map.insert("a", 1);
+        map.insert_or_assign("a", 2);
+        map.find_or_insert("b", 3) += 1;
+        RTL_CHECK(map["a"]->get() == 2 && map["b"]->get() == 4);
+
+        auto copy = map;
+        auto moved = std::move(map);
+        RTL_CHECK(map.empty() && !map.contains("a"));
+        RTL_CHECK(copy.size() == 2 && moved.size() == 2);
+        RTL_CHECK(copy.contains("b") && moved.contains("b"));
+
+        moved.clear();
+        RTL_CHECK(moved.empty() && !moved.contains("a"));
+        moved.insert("c", 5);
+        RTL_CHECK(moved.size() == 1);
+    });
+
+    tests::run("flat_map keeps its keys sorted and the first of duplicate keys", [] {
+        collections::flat_map<int, std::string> map{{3, "c"}, {1, "a"}, {2, "b"}, {1, "duplicate"}};
+        RTL_CHECK(map.size() == 3);
+        RTL_CHECK(map[1]->get() == "a");
+
+        auto expected = 1;
+        for (auto [key, value] : map) {
+            RTL_CHECK(key == expected++);
+        }
+
+        RTL_CHECK(map.insert(0, "z"));
+        RTL_CHECK(!map.insert(0, "y"));
+        map.insert_or_assign(2, "B");
+        RTL_CHECK(map.keys().front_unchecked() == 0 && map[2]->get() == "B");
+        RTL_CHECK(map.lower_bound(2) != map.end() && (*map.lower_bound(2)).first == 2);
+        RTL_CHECK(map.upper_bound(3) == map.end());
+
+        auto removed = map.remove(3);
+        RTL_CHECK(removed.has_value() && removed.value() == "c");
+        RTL_CHECK(!map.remove(3).has_value());
+        RTL_CHECK(map.keys().size() == map.values().size());
+    });
+
+    tests::run("flat_map sorts with the container's allocator", [] {
+        auto allocations = 0;
+        collections::list<int, counting_allocator<int>> keys{counting_allocator<int>{allocations}};
+        collections::list<int, counting_allocator<int>> values{counting_allocator<int>{allocations}};
+        for (int i = 0; i < 10; i++) {
+            keys.add(9 - i);
+            values.add(i);
+        }
+
+        auto before = allocations;
+        collections::flat_map<int, int, std::less<int>, counting_allocator<int>, counting_allocator<int>> map{
+            std::move(keys), std::move(values)};
+        RTL_CHECK(allocations > before);
+        RTL_CHECK(map.keys().front_unchecked() == 0 && map.values().front_unchecked() == 9);
+    });
+
+    tests::run("flat_set sorts, deduplicates and finds keys", [] {
+        collections::flat_set<int> set{5, 1, 3, 1, 5};
+        RTL_CHECK(set.size() == 3);
+        RTL_CHECK(set.contains(3) && !set.contains(2));
+        RTL_CHECK(set.insert(2));
+        RTL_CHECK(!set.insert(2));
+        RTL_CHECK(set.remove(1));
+        RTL_CHECK(!set.remove(1));
+
+        auto expected = std::string{};
+        for (auto key : set) {
+            expected += std::to_string(key);
+        }
+        RTL_CHECK(expected == "235");
+    });
+
+    tests::run("btree_map stays ordered through inserts and removals", [] {
+        collections::btree_map<int, int> map;
+        // a permutation of 0..n-1, so nodes split and merge all over the tree
+        constexpr int count = 5'000;
+        for (int i = 0; i < count; i++) {
+            RTL_CHECK(map.insert(i * 7919 % count, i));
+        }
+        RTL_CHECK(map.size() == count);
+
+        for (int i = 0; i < count; i += 3) {
+            RTL_CHECK(map.remove(i).has_value());
+        }
+
+        auto previous = -1;
+        auto entries = std::size_t{0};
+        for (auto [key, value] : map) {
+            RTL_CHECK(key > previous && key % 3 != 0);
+            RTL_CHECK(value * 7919 % count == key);
+            previous = key;
+            entries++;
+        }
+        RTL_CHECK(entries == map.size());
+
+        RTL_CHECK((*map.lower_bound(3)).first == 4);
+        RTL_CHECK((*map.upper_bound(4)).first == 5);
+        RTL_CHECK(map.lower_bound(count) == map.end());
+
+        auto last = map.end();
+        --last;
+        RTL_CHECK((*last).first == count - 1);
+
+        auto copy = map;
+        map.clear();
+        RTL_CHECK(map.empty() && copy.size() == entries);
+        RTL_CHECK(copy.find(4).has_value() && !copy.find(3).has_value());
+    });
+
+    tests::run("btree containers build from sorted input without default-constructing", [] {
+        int keys[] = {9, 7, 4, 1};
+        collections::btree_set<int, descending> set{collections::sorted_unique, keys, keys + 4, descending{0}};
+        RTL_CHECK(set.size() == 4 && set.contains(7) && !set.contains(8));
+        RTL_CHECK(*set.begin() == 9);
+
+        std::pair<int, int> entries[] = {{1, 10}, {2, 20}, {3, 30}};
+        collections::btree_map<int, int> map{collections::sorted_unique, entries, entries + 3};
+        RTL_CHECK(map.size() == 3 && map.find(2)->get() == 20);
+
+        collections::btree_set<int> built{3, 1, 2, 3};
+        RTL_CHECK(built.size() == 3 && built.insert(0) && !built.insert(0));
+        RTL_CHECK(built.remove(1) && !built.remove(1));
+    });
+
+    tests::run("segmented_list keeps addresses stable and reuses holes", [] {
+        tracked::live = 0;
+        {
+            collections::segmented_list<tracked> list;
+            std::vector<tracked*> addresses;
+            for (int i = 0; i < 1000; i++) {
+                addresses.push_back(&*list.add(i));
+            }
+            RTL_CHECK(list.size() == 1000);
+
+            auto stable = true;
+            for (int i = 0; i < 1000; i++) {
+                stable = stable && addresses[i]->value == i;
+            }
+            RTL_CHECK(stable);
+
+            // remove every odd element while iterating, then refill the holes
+            for (auto it = list.begin(); it != list.end();) {
+                it = it->value % 2 != 0 ? list.remove(it) : std::next(it);
+            }
+            RTL_CHECK(list.size() == 500);
+            RTL_CHECK(tracked::live == 500);
+
+            auto capacity = list.capacity();
+            for (int i = 0; i < 500; i++) {
+                list.add(-1);
+            }
+            RTL_CHECK(list.capacity() == capacity);
+
+            auto even_kept = true;
+            for (int i = 0; i < 1000; i += 2) {
+                even_kept = even_kept && addresses[i]->value == i;
+            }
+            RTL_CHECK(even_kept);
+            RTL_CHECK(list.iterator_to(*addresses[10]) != list.end());
+
+            auto forward = 0;
+            for (auto& value : list) {
+                forward += value.value;
+            }
+            auto backward = 0;
+            for (auto it = list.end(); it != list.begin();) {
+                --it;
+                backward += it->value;
+            }
+            RTL_CHECK(forward == backward);
+        }
+        RTL_CHECK(tracked::live == 0);
+    });
+
+    tests::run("segmented_list matches a reference model under random adds and removes", [] {
+        collections::segmented_list<std::uint32_t> list;
+        std::vector<std::pair<std::uint32_t*, std::uint32_t>> model;
+        auto state = std::uint32_t{7};
+        for (std::uint32_t step = 0; step < 20000; step++) {
+            state = state * 1664525 + 1013904223;
+            if (model.empty() || (state >> 16) % 3 != 0) {
+                model.emplace_back(&*list.add(step), step);
+            } else {
+                auto victim = (state >> 8) % model.size();
+                list.remove(list.iterator_to(*model[victim].first));
+                model[victim] = model.back();
+                model.pop_back();
+            }
+        }
+
+        RTL_CHECK(list.size() == model.size());
+        auto matches = true;
+        for (auto& [address, value] : model) {
+            matches = matches && *address == value;
+        }
+        RTL_CHECK(matches);
+
+        auto visited = std::size_t{0};
+        for ([[maybe_unused]] auto value : list) {
+            visited++;
+        }
+        RTL_CHECK(visited == model.size());
+
+        for (auto& [address, value] : model) {
+            list.remove(list.iterator_to(*address));
+        }
+        RTL_CHECK(list.empty());
+        RTL_CHECK(list.begin() == list.end());
+    });
+
+    tests::run("segmented_list copies, moves and frees the slot of a throwing add", [] {
+        collections::segmented_list<std::string> list{"a", "b", "c"};
+        auto copy = list;
+        RTL_CHECK(copy.size() == 3);
+        auto moved = std::move(copy);
+        RTL_CHECK(moved.size() == 3 && copy.empty());
+
+        struct throwing {
+            explicit throwing(bool fail) {
+                if (fail) {
+                    throw std::runtime_error{"construct"};
+                }
+            }
+        };
+
+        collections::segmented_list<throwing> throwing_list;
+        throwing_list.add(false);
+        auto threw = false;
+        try {
+            throwing_list.add(true);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        RTL_CHECK(threw);
+        RTL_CHECK(throwing_list.size() == 1);
+        RTL_CHECK(std::distance(throwing_list.begin(), throwing_list.end()) == 1);
+    });
+
+    tests::run("vectorised algorithms match a plain loop", [] {
+        test_algorithms<std::int8_t>();
+        test_algorithms<std::uint8_t>();
+        test_algorithms<std::int16_t>();
+        test_algorithms<std::uint32_t>();
+        test_algorithms<std::int64_t>();
+        test_algorithms<std::uint64_t>();
+        test_algorithms<float>();
+        test_algorithms<double>();
+    });
+
+    tests::run("algorithms handle unsigned extremes and non-arithmetic types", [] {
+        std::vector<std::uint64_t> extremes{1, std::numeric_limits<std::uint64_t>::max(), 0, 1ULL << 63, 5, 6, 7, 8, 9};
+        RTL_CHECK(collections::min(extremes).value() == 0);
+        RTL_CHECK(collections::max(extremes).value() == std::numeric_limits<std::uint64_t>::max());
+
+        collections::list<std::string> strings{"b", "a", "c"};
+        RTL_CHECK(collections::min(strings).value() == "a");
+        RTL_CHECK(collections::find(strings, "c").has_value());
+        RTL_CHECK(collections::sum(strings) == "bac");
+        RTL_CHECK(!collections::max(collections::list<int>{}).has_value());
+
+        static_assert(collections::sum(std::array{1, 2, 3}) == 6);
+    });
+
+    tests::run("min and max of pointers can be null", [] {
+        int value = 0;
+        std::array<int*, 2> pointers{&value, nullptr};
+        auto smallest = collections::min(pointers);
+        RTL_CHECK(smallest.has_value() && smallest.value() == nullptr);
+    });
+
+    tests::run("remove returns null pointers as values", [] {
+        int value = 0;
+
+        collections::list<int*> list{nullptr, &value};
+        auto removed = list.remove(0);
+        RTL_CHECK(removed.has_value() && removed.value() == nullptr);
+        RTL_CHECK(list.size() == 1);
+        RTL_CHECK(!list.remove(5).has_value());
+
+        collections::hash_map<int, int*> hash_map;
+        hash_map.insert(1, nullptr);
+        auto from_hash_map = hash_map.remove(1);
+        RTL_CHECK(from_hash_map.has_value() && from_hash_map.value() == nullptr);
+        RTL_CHECK(!hash_map.remove(1).has_value());
+
+        collections::btree_map<int, int*> btree_map;
+        btree_map.insert(1, nullptr);
+        auto from_btree_map = btree_map.remove(1);
+        RTL_CHECK(from_btree_map.has_value() && from_btree_map.value() == nullptr);
+        RTL_CHECK(!btree_map.remove(1).has_value());
+
+        collections::flat_map<int, memory::unique_ptr<int>> flat_map;
+        flat_map.insert(1, memory::unique_ptr<int>{});
+        auto from_flat_map = flat_map.remove(1);
+        RTL_CHECK(from_flat_map.has_value() && from_flat_map.value().get() == nullptr);
+        RTL_CHECK(!flat_map.remove(1).has_value());
+
+        // with no niche in play the return type is a plain option
+        RTL_CHECK(std::is_same_v<decltype(collections::list<int>{}.remove(0)), utilities::option<int>>);
+    });
+
+    tests::run("parallel_for_each and parallel_transform visit every element once", [] {
+        concurrency::thread_pool pool{4};
+        for (std::size_t grain : {0uz, 1uz, 3uz, 100000uz}) {
+            collections::list<int> values;
+            for (int i = 0; i < 10000; i++) {
+                values.add(i);
+            }
+
+            collections::parallel_for_each(pool, values, [](int& value) { value *= 2; }, grain);
+            auto doubled = true;
+            for (int i = 0; i < 10000; i++) {
+                doubled = doubled && values.at_unchecked(i) == i * 2;
+            }
+            RTL_CHECK(doubled);
+
+            collections::list<long> squares(values.size());
+            collections::parallel_transform(pool, values, squares, [](int value) {
+                return long{value} * value;
+            }, grain);
+            auto squared = true;
+            for (int i = 0; i < 10000; i++) {
+                squared = squared && squares.at_unchecked(i) == 4L * i * i;
+            }
+            RTL_CHECK(squared);
+        }
+
+        collections::list<int> empty;
+        collections::parallel_for_each(pool, empty, [](int&) { RTL_CHECK(false); });
+    });
+
+    tests::run("parallel_reduce matches a serial fold", [] {
+        concurrency::thread_pool pool{4};
+        collections::list<std::uint64_t> values;
+        for (std::uint64_t i = 1; i <= 100000; i++) {
+            values.add(i);
+        }
+
+        for (std::size_t grain : {0uz, 1uz, 7uz, 1000000uz}) {
+            RTL_CHECK(collections::parallel_reduce(pool, values, std::uint64_t{10}, std::plus<>{}, grain)
+                == 10 + 100000ull * 100001 / 2);
+        }
+
+        collections::list<std::uint64_t> empty;
+        RTL_CHECK(collections::parallel_reduce(pool, empty, std::uint64_t{5}) == 5);
+
+        // a non-commutative operation still sees the chunks in order
+        collections::list<std::string> words{"a", "b", "c", "d", "e", "f", "g"};
+        RTL_CHECK(collections::parallel_reduce(pool, words, std::string{">"}, std::plus<>{}, 2) == ">abcdefg");
+    });
+
+    tests::run("parallel_reduce keeps null partial results", [] {
+        concurrency::thread_pool pool{2};
+        collections::list<int*> pointers(100);
+        auto first = [](int* left, int* right) { return left != nullptr ? left : right; };
+        RTL_CHECK(collections::parallel_reduce(pool, pointers, static_cast<int*>(nullptr), first, 10) == nullptr);
+    });
+
+    tests::run("parallel_sort sorts stably", [] {
+        concurrency::thread_pool pool{4};
+        for (std::size_t grain : {0uz, 1uz, 5uz, 333uz}) {
+            collections::list<std::pair<int, int>> pairs;
+            auto state = std::uint32_t{12345};
+            for (int i = 0; i < 5000; i++) {
+                state = state * 1664525 + 1013904223;
+                pairs.add(std::pair{static_cast<int>(state >> 24) % 50, i});
+            }
+
+            collections::parallel_sort(pool, pairs, [](const auto& left, const auto& right) {
+                return left.first < right.first;
+            }, grain);
+
+            auto sorted = true;
+            for (std::size_t i = 1; i < pairs.size(); i++) {
+                auto& previous = pairs.at_unchecked(i - 1);
+                auto& current = pairs.at_unchecked(i);
+                sorted = sorted && (previous.first < current.first
+                    || (previous.first == current.first && previous.second < current.second));
+            }
+            RTL_CHECK(sorted);
+        }
+    });
+
+    return tests::exit_code();
+}
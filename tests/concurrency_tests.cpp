@@ -0,0 +1,335 @@
+#include "rtl.hpp"
+#include "test.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace rtl;
+
+int main() {
+    tests::run("chase_lev_deque keeps null elements and grows", [] {
+        concurrency::chase_lev_deque<int*> deque;
+        deque.push(nullptr);
+        for (int i = 0; i < 1000; i++) {
+            deque.push(nullptr);
+        }
+
+        auto count = 0;
+        while (auto value = deque.pop()) {
+            RTL_CHECK(value.value() == nullptr);
+            count++;
+        }
+        RTL_CHECK(count == 1001);
+
+        deque.push(nullptr);
+        auto stolen = deque.steal();
+        RTL_CHECK(stolen.has_value() && stolen.value() == nullptr);
+        RTL_CHECK(!deque.steal().has_value());
+    });
+
+    tests::run("thread_pool returns null pointer and empty unique_ptr results", [] {
+        concurrency::thread_pool pool{2};
+        auto pointer = pool.submit([] { return static_cast<int*>(nullptr); });
+        auto owner = pool.submit([] { return memory::unique_ptr<int>{}; });
+        auto value = pool.submit([] { return 42; });
+
+        RTL_CHECK(pointer.get() == nullptr);
+        RTL_CHECK(owner.get().get() == nullptr);
+        RTL_CHECK(value.get() == 42);
+    });
+
+    tests::run("thread_pool rethrows what a task threw", [] {
+        concurrency::thread_pool pool{2};
+        auto failing = pool.submit([]() -> int { throw std::runtime_error{"task"}; });
+        auto threw = false;
+        try {
+            (void)failing.get();
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        RTL_CHECK(threw);
+    });
+
+    tests::run("thread_pool runs tasks that submit and wait on other tasks", [] {
+        concurrency::thread_pool pool{2};
+        auto outer = pool.submit([&pool] {
+            auto sum = 0;
+            for (int i = 0; i < 16; i++) {
+                sum += pool.submit([i] { return i; }).get();
+            }
+            return sum;
+        });
+        RTL_CHECK(outer.get() == 120);
+    });
+
+    tests::run("thread_pool runs every task submitted from many threads", [] {
+        std::atomic<std::size_t> ran{0};
+        {
+            concurrency::thread_pool pool{4};
+            std::vector<std::thread> submitters;
+            for (int t = 0; t < 4; t++) {
+                submitters.emplace_back([&] {
+                    for (int i = 0; i < 10000; i++) {
+                        (void)pool.submit([&ran] { ran.fetch_add(1, std::memory_order_relaxed); });
+                    }
+                });
+            }
+
+            for (auto& submitter : submitters) {
+                submitter.join();
+            }
+        }
+        RTL_CHECK(ran.load() == 40000);
+    });
+
+    tests::run("parallel_for calls the body once per index", [] {
+        concurrency::thread_pool pool{4};
+        for (std::size_t grain : {0uz, 1uz, 7uz, 1000uz}) {
+            std::vector<std::atomic<std::uint32_t>> calls(10000);
+            pool.parallel_for(0, calls.size(), [&](std::size_t i) {
+                calls[i].fetch_add(1, std::memory_order_relaxed);
+            }, grain);
+
+            auto once = true;
+            for (auto& count : calls) {
+                once = once && count.load() == 1;
+            }
+            RTL_CHECK(once);
+        }
+
+        auto called = false;
+        pool.parallel_for(5, 5, [&](std::size_t) { called = true; });
+        RTL_CHECK(!called);
+    });
+
+    tests::run("parallel_for rethrows and waits for its helpers", [] {
+        concurrency::thread_pool pool{4};
+        for (int round = 0; round < 100; round++) {
+            std::atomic<std::size_t> running{0};
+            auto threw = false;
+            try {
+                pool.parallel_for(0, 1000, [&](std::size_t i) {
+                    running.fetch_add(1, std::memory_order_relaxed);
+                    if (i == 500) {
+                        running.fetch_sub(1, std::memory_order_relaxed);
+                        throw std::runtime_error{"body"};
+                    }
+                    running.fetch_sub(1, std::memory_order_relaxed);
+                }, 10);
+            } catch (const std::runtime_error&) {
+                threw = true;
+            }
+            RTL_CHECK(threw);
+            RTL_CHECK(running.load() == 0);
+        }
+    });
+
+    tests::run("parallel_for nests inside tasks", [] {
+        concurrency::thread_pool pool{2};
+        auto outer = pool.submit([&pool] {
+            std::atomic<std::size_t> sum{0};
+            pool.parallel_for(0, 100, [&](std::size_t i) { sum.fetch_add(i, std::memory_order_relaxed); }, 1);
+            return sum.load();
+        });
+        RTL_CHECK(outer.get() == 4950);
+    });
+
+    tests::run("spsc_queue keeps null elements", [] {
+        concurrency::spsc_queue<int*> queue{4};
+        RTL_CHECK(queue.try_push(nullptr));
+        auto popped = queue.try_pop();
+        RTL_CHECK(popped.has_value() && popped.value() == nullptr);
+        RTL_CHECK(!queue.try_pop().has_value());
+
+        concurrency::spsc_queue<memory::unique_ptr<int>> owners{2};
+        RTL_CHECK(owners.try_push(memory::unique_ptr<int>{}));
+        auto owner = owners.try_pop();
+        RTL_CHECK(owner.has_value() && owner.value().get() == nullptr);
+    });
+
+    tests::run("spsc_queue fills, wraps around and destroys what is left", [] {
+        auto counter = std::make_shared<int>(0);
+        {
+            concurrency::spsc_queue<std::shared_ptr<int>> queue{3};
+            RTL_CHECK(queue.capacity() == 4);
+            for (int round = 0; round < 10; round++) {
+                for (int i = 0; i < 4; i++) {
+                    RTL_CHECK(queue.try_push(counter));
+                }
+                RTL_CHECK(!queue.try_push(counter));
+                RTL_CHECK(queue.try_pop().has_value());
+                RTL_CHECK(queue.try_pop().has_value());
+                RTL_CHECK(queue.try_pop().has_value());
+                RTL_CHECK(queue.size() == 1);
+                RTL_CHECK(queue.try_pop().has_value());
+            }
+
+            std::array<std::shared_ptr<int>, 3> batch{counter, counter, counter};
+            RTL_CHECK(queue.push_n(batch.begin(), batch.size()) == 3);
+            RTL_CHECK(counter.use_count() == 7);
+        }
+        RTL_CHECK(counter.use_count() == 1);
+    });
+
+    tests::run("spsc_queue batches see room and elements left by the other side", [] {
+        concurrency::spsc_queue<int> queue{4};
+        std::array<int, 4> in{1, 2, 3, 4};
+        std::array<int, 4> out{};
+
+        // the producer last saw the queue nearly full and the consumer last saw it empty
+        RTL_CHECK(queue.push_n(in.begin(), 3) == 3);
+        RTL_CHECK(queue.pop_n(out.begin(), 3) == 3);
+        RTL_CHECK(queue.push_n(in.begin(), 4) == 4);
+        RTL_CHECK(queue.pop_n(out.begin(), 4) == 4);
+        RTL_CHECK(out == in);
+
+        RTL_CHECK(queue.try_push(5));
+        RTL_CHECK(queue.pop_n(out.begin(), 4) == 1 && out[0] == 5);
+        RTL_CHECK(queue.push_n(in.begin(), 2) == 2);
+        RTL_CHECK(queue.push_n(in.begin() + 2, 2) == 2);
+        RTL_CHECK(queue.push_n(in.begin(), 1) == 0);
+        RTL_CHECK(queue.pop_n(out.begin(), 4) == 4);
+        RTL_CHECK(out == in);
+    });
+
+    tests::run("spsc_queue hands every element over in order", [] {
+        constexpr std::uint64_t count = 200000;
+        concurrency::spsc_queue<std::uint64_t> queue{64};
+        std::thread producer{[&] {
+            std::array<std::uint64_t, 7> batch{};
+            for (std::uint64_t next = 0; next < count;) {
+                auto pushed = std::uint64_t{0};
+                if (next % 3 == 0) {
+                    pushed = queue.try_push(next) ? 1 : 0;
+                } else {
+                    auto size = std::min<std::uint64_t>(batch.size(), count - next);
+                    for (std::uint64_t i = 0; i < size; i++) {
+                        batch[i] = next + i;
+                    }
+                    pushed = queue.push_n(batch.begin(), size);
+                }
+
+                // on a single core, spinning on a full queue would burn the consumer's time slice
+                if (pushed == 0) {
+                    std::this_thread::yield();
+                }
+                next += pushed;
+            }
+        }};
+
+        auto in_order = true;
+        std::array<std::uint64_t, 5> received{};
+        for (std::uint64_t expected = 0; expected < count;) {
+            auto popped = std::uint64_t{0};
+            if (expected % 2 == 0) {
+                if (auto value = queue.try_pop(); value.has_value()) {
+                    in_order = in_order && value.value() == expected;
+                    popped = 1;
+                }
+            } else {
+                popped = queue.pop_n(received.begin(), received.size());
+                for (std::size_t i = 0; i < popped; i++) {
+                    in_order = in_order && received[i] == expected + i;
+                }
+            }
+
+            if (popped == 0) {
+                std::this_thread::yield();
+            }
+            expected += popped;
+        }
+
+        producer.join();
+        RTL_CHECK(in_order);
+        RTL_CHECK(queue.empty());
+    });
+
+    tests::run("mpmc_queue keeps null elements", [] {
+        concurrency::mpmc_queue<int*> queue{4};
+        RTL_CHECK(queue.try_push(nullptr));
+        queue.push(nullptr);
+        auto popped = queue.try_pop();
+        RTL_CHECK(popped.has_value() && popped.value() == nullptr);
+        RTL_CHECK(queue.pop() == nullptr);
+        RTL_CHECK(!queue.try_pop().has_value());
+
+        concurrency::mpmc_queue<memory::unique_ptr<int>> owners{2};
+        owners.push(memory::unique_ptr<int>{});
+        RTL_CHECK(owners.pop().get() == nullptr);
+    });
+
+    tests::run("mpmc_queue refuses pushes when full and destroys what is left", [] {
+        auto counter = std::make_shared<int>(0);
+        {
+            concurrency::mpmc_queue<std::shared_ptr<int>> queue{2};
+            RTL_CHECK(queue.try_push(counter));
+            RTL_CHECK(queue.try_push(counter));
+            RTL_CHECK(!queue.try_push(counter));
+            RTL_CHECK(queue.size() == 2);
+            RTL_CHECK(counter.use_count() == 3);
+        }
+        RTL_CHECK(counter.use_count() == 1);
+    });
+
+    tests::run("mpmc_queue hands every element to exactly one consumer", [] {
+        constexpr std::size_t producers = 4;
+        constexpr std::size_t consumers = 4;
+        constexpr std::size_t per_producer = 50000;
+        concurrency::mpmc_queue<std::size_t> queue{64};
+        std::vector<std::atomic<std::uint32_t>> received(producers * per_producer);
+
+        std::vector<std::thread> threads;
+        for (std::size_t p = 0; p < producers; p++) {
+            threads.emplace_back([&queue, p] {
+                for (std::size_t i = 0; i < per_producer; i++) {
+                    auto value = p * per_producer + i;
+                    if (i % 2 == 0) {
+                        queue.push(value);
+                    } else {
+                        while (!queue.try_push(value)) {
+                            std::this_thread::yield();
+                        }
+                    }
+                }
+            });
+        }
+
+        for (std::size_t c = 0; c < consumers; c++) {
+            threads.emplace_back([&queue, &received, c] {
+                for (std::size_t i = 0; i < per_producer; i++) {
+                    if ((i + c) % 2 == 0) {
+                        received[queue.pop()].fetch_add(1, std::memory_order_relaxed);
+                        continue;
+                    }
+
+                    auto value = queue.try_pop();
+                    while (!value.has_value()) {
+                        std::this_thread::yield();
+                        value = queue.try_pop();
+                    }
+                    received[value.value()].fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        auto once = true;
+        for (auto& count : received) {
+            once = once && count.load() == 1;
+        }
+        RTL_CHECK(once);
+        RTL_CHECK(queue.empty());
+    });
+
+    return tests::exit_code();
+}
@@ -0,0 +1,192 @@
+#include "rtl.hpp"
+#include "test.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+using namespace rtl;
+
+namespace {
+// A directory under the system's temporary directory, removed with everything in it on destruction.
+class temporary_directory {
+public:
+    temporary_directory()
+        : m_path{std::filesystem::temp_directory_path()
+              / ("rtl-fs-tests-" + std::to_string(std::random_device{}()))} {
+        std::filesystem::create_directories(m_path);
+    }
+
+    temporary_directory(const temporary_directory&) = delete;
+    auto operator=(const temporary_directory&) -> temporary_directory& = delete;
+
+    ~temporary_directory() noexcept {
+        auto error = std::error_code{};
+        std::filesystem::remove_all(m_path, error);
+    }
+
+    [[nodiscard]] auto file(std::string_view name, std::string_view contents) const -> std::filesystem::path {
+        auto path = m_path / name;
+        std::ofstream{path, std::ios::binary}.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        return path;
+    }
+
+    [[nodiscard]] auto path() const noexcept -> const std::filesystem::path& {
+        return m_path;
+    }
+
+private:
+    std::filesystem::path m_path;
+}; // class temporary_directory
+
+// Bytes that aren't all the same, so offsets and truncation show up as mismatches.
+auto pattern(std::size_t size) -> std::string {
+    auto bytes = std::string(size, '\0');
+    for (std::size_t i = 0; i < size; i++) {
+        bytes[i] = static_cast<char>((i * 131 + i / 4096) & 0xff);
+    }
+
+    return bytes;
+}
+} // namespace
+
+int main() {
+    temporary_directory directory;
+
+#ifdef RTL_POSIX
+    tests::run("mapped_file maps the whole file", [&] {
+        auto contents = pattern(3 * 4096 + 17);
+        auto path = directory.file("mapped", contents);
+        for (auto options : {fs::map_options{}, fs::map_options{.pattern = fs::access_pattern::sequential,
+                 .will_need = true, .populate = true, .huge_pages = true}}) {
+            auto file = fs::mapped_file::open(path, options);
+            RTL_CHECK(file.has_value());
+            RTL_CHECK(file->size() == contents.size());
+            RTL_CHECK(file->view() == contents);
+            RTL_CHECK(file->bytes().size() == contents.size());
+            RTL_CHECK(file->advise(fs::access_pattern::random));
+            RTL_CHECK(file->prefetch(4097, 1 << 20));
+            RTL_CHECK(!file->prefetch(contents.size(), 1));
+        }
+    });
+
+    tests::run("mapped_file gives an empty span for an empty file", [&] {
+        auto file = fs::mapped_file::open(directory.file("empty", ""));
+        RTL_CHECK(file.has_value());
+        RTL_CHECK(file->empty() && file->data() == nullptr && file->view().empty());
+    });
+
+    tests::run("mapped_file reports why a file couldn't be mapped", [&] {
+        auto missing = fs::mapped_file::open(directory.path() / "missing");
+        RTL_CHECK(missing.has_error() && missing.error() == std::errc::no_such_file_or_directory);
+
+        auto folder = fs::mapped_file::open(directory.path());
+        RTL_CHECK(folder.has_error() && folder.error() == std::errc::is_a_directory);
+    });
+
+    tests::run("mapped_file moves ownership of the mapping", [&] {
+        auto file = fs::mapped_file::open(directory.file("moved", "moved contents")).unwrap();
+        auto data = file.data();
+        auto moved = std::move(file);
+        RTL_CHECK(moved.data() == data && moved.view() == "moved contents");
+        RTL_CHECK(file.empty() && file.data() == nullptr);
+
+        auto other = fs::mapped_file::open(directory.file("other", "other")).unwrap();
+        other = std::move(moved);
+        RTL_CHECK(other.view() == "moved contents");
+        RTL_CHECK(moved.empty());
+    });
+
+    tests::run("file_writer and file_reader round-trip a file on every backend", [&] {
+        auto contents = pattern(300 * 1024 + 123);
+        auto path = directory.path() / "round-trip";
+        for (auto backend : {fs::io_backend::automatic, fs::io_backend::synchronous, fs::io_backend::io_uring}) {
+            for (std::size_t buffer_count : {1uz, 3uz}) {
+                auto options = fs::io_options{
+                    .buffer_size = 3 * 4096,
+                    .buffer_count = buffer_count,
+                    .backend = backend,
+                };
+                auto writer = fs::file_writer::open(path, options);
+                if (backend == fs::io_backend::io_uring && writer.has_error()) {
+                    // io_uring is often disabled in containers
+                    RTL_CHECK(writer.error() == std::errc::not_supported);
+                    continue;
+                }
+
+                // uneven pieces, with a flush in the middle
+                auto remaining = std::string_view{contents};
+                for (std::size_t piece = 1; !remaining.empty(); piece = piece * 3 % 10007) {
+                    auto count = std::min(piece, remaining.size());
+                    RTL_CHECK(writer->write(remaining.substr(0, count)));
+                    remaining.remove_prefix(count);
+                    if (remaining.size() < contents.size() / 2 && remaining.size() + count >= contents.size() / 2) {
+                        RTL_CHECK(writer->flush());
+                    }
+                }
+                RTL_CHECK(writer->close());
+                RTL_CHECK(!writer->error());
+
+                auto reader = fs::file_reader::open(path, options);
+                RTL_CHECK(reader.has_value());
+                auto read_back = std::string{};
+                for (auto chunk = reader->next(); !chunk.empty(); chunk = reader->next()) {
+                    read_back.append(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+                }
+                RTL_CHECK(!reader->error());
+                RTL_CHECK(read_back == contents);
+
+                auto copier = fs::file_reader::open(path, options).unwrap();
+                auto copied = std::string(contents.size() + 10, '\0');
+                auto bytes = std::as_writable_bytes(std::span{copied});
+                auto first = copier.read(bytes.first(1000));
+                auto rest = copier.read(bytes.subspan(first));
+                RTL_CHECK(first == 1000 && first + rest == contents.size());
+                copied.resize(first + rest);
+                RTL_CHECK(copied == contents);
+            }
+        }
+    });
+
+    tests::run("file_writer with O_DIRECT writes an unaligned tail", [&] {
+        auto contents = pattern(5 * 4096 + 7);
+        auto path = directory.path() / "direct";
+        auto writer = fs::file_writer::open(path, {.buffer_size = 8192, .direct = true});
+        if (writer.has_error()) {
+            // not every file system takes O_DIRECT
+            RTL_CHECK(writer.error() == std::errc::invalid_argument);
+            return;
+        }
+
+        RTL_CHECK(writer->write(contents));
+        RTL_CHECK(writer->flush());
+        RTL_CHECK(writer->close());
+        RTL_CHECK(fs::mapped_file::open(path).unwrap().view() == contents);
+    });
+
+    tests::run("file_reader and file_writer report open errors", [&] {
+        auto missing = fs::file_reader::open(directory.path() / "missing");
+        RTL_CHECK(missing.has_error() && missing.error() == std::errc::no_such_file_or_directory);
+
+        auto folder = fs::file_writer::open(directory.path());
+        RTL_CHECK(folder.has_error() && folder.error() == std::errc::is_a_directory);
+
+        auto empty = fs::file_reader::open(directory.file("empty-read", "")).unwrap();
+        RTL_CHECK(empty.next().empty() && !empty.error());
+    });
+#else
+    tests::run("mapped_file is not supported", [&] {
+        auto file = fs::mapped_file::open(directory.file("mapped", "contents"));
+        RTL_CHECK(file.has_error() && file.error() == std::errc::not_supported);
+    });
+#endif
+
+    return tests::exit_code();
+}
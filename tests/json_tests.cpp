@@ -0,0 +1,361 @@
+#include "rtl.hpp"
+#include "test.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <vector>
+
+using namespace rtl;
+
+namespace {
+template<typename T, typename Layout>
+auto holds(const utilities::option<T, Layout>& option, const T& expected) -> bool {
+    return option.has_value() && option.value() == expected;
+}
+
+auto parse_error_of(std::string_view input) -> json::parse_error {
+    auto document = json::parse(input);
+    return document.has_value() ? json::parse_error::none : document.error();
+}
+
+auto decoded(std::string_view input) -> utilities::option<strings::string> {
+    auto document = json::parse(input);
+    return document->root().decode_string();
+}
+
+struct record {
+    std::int64_t id;
+    double score;
+    std::string_view name;
+    utilities::option<int> rank;
+    std::vector<bool> flags;
+};
+} // namespace
+
+template<>
+struct rtl::json::reflection<record> {
+    static constexpr auto fields = std::tuple{
+        json::member{"id", &record::id},
+        json::member{"score", &record::score},
+        json::member{"name", &record::name},
+        json::member{"rank", &record::rank},
+        json::member{"flags", &record::flags},
+    };
+};
+
+namespace {
+auto write_records(auto& writer, const std::vector<record>& records) -> void {
+    writer.begin_object().member("records", records).key("count").value(records.size()).end_object();
+}
+
+// Checks that `records` parses back out of `text`, which `write_records` wrote.
+auto reads_back(std::string_view text, const std::vector<record>& records) -> bool {
+    auto document = json::parse(text);
+    if (!document.has_value() || !holds(document->root()["count"]->get_uint64(), std::uint64_t{records.size()})) {
+        return false;
+    }
+
+    auto array = *document->root()["records"]->as_array();
+    auto all = array.size() == records.size();
+    for (std::size_t i = 0; all && i < records.size(); i++) {
+        auto element = *array.at(i);
+        auto flags = *element["flags"]->as_array();
+        all = holds(element["id"]->get_int64(), records[i].id)
+            && holds(element["score"]->get_double(), records[i].score)
+            && element["name"]->decode_string()->view() == records[i].name
+            && (records[i].rank.has_value() ? holds(element["rank"]->get_int64(), std::int64_t{*records[i].rank})
+                : element["rank"]->is_null())
+            && flags.size() == records[i].flags.size();
+        for (std::size_t j = 0; all && j < flags.size(); j++) {
+            all = holds(flags.at(j)->get_bool(), bool{records[i].flags[j]});
+        }
+    }
+
+    return all;
+}
+
+auto sample_records() -> std::vector<record> {
+    auto records = std::vector<record>{};
+    for (int i = 0; i < 500; i++) {
+        records.push_back({
+            .id = i * 7919 - 100000,
+            .score = i / 7.0,
+            .name = i % 3 == 0 ? "a \"quoted\"\tname" : "plain",
+            .rank = i % 4 == 0 ? utilities::option<int>{} : utilities::option<int>{i},
+            .flags = {i % 2 == 0, i % 5 == 0},
+        });
+    }
+
+    return records;
+}
+} // namespace
+
+int main() {
+    tests::run("json parses scalars of every type", [] {
+        auto document = json::parse(R"({"int": -42, "big": 18446744073709551615, "real": 2.5e3, "yes": true,
+            "no": false, "nothing": null, "text": "hi"})");
+        RTL_CHECK(document.has_value());
+        auto root = document->root();
+        RTL_CHECK(root.type() == json::value_type::object);
+
+        RTL_CHECK(holds(root["int"]->get_int64(), std::int64_t{-42}));
+        RTL_CHECK(!root["int"]->get_uint64().has_value());
+        RTL_CHECK(holds(root["big"]->get_uint64(), std::uint64_t{18446744073709551615u}));
+        RTL_CHECK(!root["big"]->get_int64().has_value());
+        RTL_CHECK(holds(root["real"]->get_double(), double{2500.0}));
+        RTL_CHECK(holds(root["yes"]->get_bool(), bool{true}));
+        RTL_CHECK(holds(root["no"]->get_bool(), bool{false}));
+        RTL_CHECK(root["nothing"]->is_null());
+        RTL_CHECK(root["nothing"]->type() == json::value_type::null);
+        RTL_CHECK(holds(root["text"]->get_string(), std::string_view{"hi"}));
+        RTL_CHECK(!root["text"]->get_int64().has_value());
+        RTL_CHECK(!root["missing"].has_value());
+        RTL_CHECK(!root.at(0).has_value());
+    });
+
+    tests::run("json walks nested objects and arrays", [] {
+        auto input = std::string{R"({"list": [1, [2, 3], {"four": 4}, "five"], "empty": {}, "none": []})"};
+        auto document = json::parse(input);
+        auto root = document->root();
+        auto list = *root["list"]->as_array();
+        RTL_CHECK(list.size() == 4);
+        RTL_CHECK(holds(list.at(1)->at(1)->get_int64(), std::int64_t{3}));
+        RTL_CHECK(holds((*list.at(2))["four"]->get_int64(), std::int64_t{4}));
+        RTL_CHECK(holds(list.at(3)->get_string(), std::string_view{"five"}));
+        RTL_CHECK(!list.at(4).has_value());
+        RTL_CHECK(list.at(1)->raw() == "[2, 3]");
+
+        auto types = std::vector<json::value_type>{};
+        for (auto element : list) {
+            types.push_back(element.type());
+        }
+        RTL_CHECK((types == std::vector{json::value_type::number, json::value_type::array, json::value_type::object,
+            json::value_type::string}));
+
+        auto keys = std::vector<std::string_view>{};
+        auto object = *root.as_object();
+        for (auto [key, value] : object) {
+            keys.push_back(key);
+        }
+        RTL_CHECK((keys == std::vector<std::string_view>{"list", "empty", "none"}));
+        RTL_CHECK(root["empty"]->as_object()->empty());
+        RTL_CHECK(root["none"]->as_array()->empty());
+        RTL_CHECK(!root["none"]->as_object().has_value());
+    });
+
+    tests::run("json keeps escaped quotes and backslashes inside strings across blocks", [] {
+        // runs of backslashes of every length, placed so they straddle the 64 byte blocks of the index
+        for (std::size_t padding = 0; padding < json::detail::block_size; padding++) {
+            for (std::size_t slashes = 0; slashes < 6; slashes++) {
+                auto body = std::string(padding, 'x') + std::string(2 * slashes, '\\') + "\\\"[{,:}]";
+                auto input = "[\"" + body + "\", 1]";
+                auto document = json::parse(input);
+                RTL_CHECK(document.has_value());
+                auto array = *document->root().as_array();
+                RTL_CHECK(array.size() == 2);
+                RTL_CHECK(holds(array.at(0)->get_string(), std::string_view{body}));
+                RTL_CHECK(holds(array.at(1)->get_int64(), std::int64_t{1}));
+            }
+        }
+    });
+
+    tests::run("json decodes escapes", [] {
+        RTL_CHECK(decoded(R"("a\"b\\c\/d\b\f\n\r\t")")->view() == "a\"b\\c/d\b\f\n\r\t");
+        RTL_CHECK(decoded(R"("é€")")->view() == "\xc3\xa9\xe2\x82\xac");
+        RTL_CHECK(decoded(R"("😀")")->view() == "\xf0\x9f\x98\x80");
+        RTL_CHECK(!decoded(R"("\ud83d")").has_value());
+        RTL_CHECK(!decoded(R"("\ude00")").has_value());
+        RTL_CHECK(!decoded(R"("\x")").has_value());
+        RTL_CHECK(!decoded(R"("\u12g4")").has_value());
+
+        auto document = json::parse(R"(["one", "two"])");
+        auto buffer = strings::string{};
+        RTL_CHECK(document->root().at(0)->decode_string(buffer));
+        RTL_CHECK(document->root().at(1)->decode_string(buffer));
+        RTL_CHECK(buffer == "onetwo");
+        RTL_CHECK(!document->root().decode_string(buffer));
+    });
+
+    tests::run("json reports malformed input", [] {
+        RTL_CHECK(parse_error_of("") == json::parse_error::empty);
+        RTL_CHECK(parse_error_of("   \n") == json::parse_error::empty);
+        RTL_CHECK(parse_error_of(R"(["open)") == json::parse_error::unclosed_string);
+        RTL_CHECK(parse_error_of("[1, 2") == json::parse_error::unbalanced_brackets);
+        RTL_CHECK(parse_error_of("[1}") == json::parse_error::unbalanced_brackets);
+        RTL_CHECK(parse_error_of("]") == json::parse_error::unbalanced_brackets);
+        RTL_CHECK(parse_error_of("[] []") == json::parse_error::trailing_content);
+        RTL_CHECK(parse_error_of(" 7 ") == json::parse_error::none);
+
+        // the rest of the document is only checked where it's looked at
+        auto document = json::parse("[1, tru, x, 3]");
+        RTL_CHECK(document.has_value());
+        RTL_CHECK(!document->root().at(1)->get_bool().has_value());
+        RTL_CHECK(document->root().at(2)->type() == json::value_type::invalid);
+        RTL_CHECK(holds(document->root().at(3)->get_int64(), std::int64_t{3}));
+    });
+
+    tests::run("json vector classifiers match the scalar one", [] {
+        auto input = std::string{};
+        auto state = std::uint32_t{99};
+        constexpr std::string_view alphabet = "\"\\{}[]:, \t\r\nab01";
+        for (std::size_t i = 0; i < 64 * json::detail::block_size; i++) {
+            state = state * 1664525 + 1013904223;
+            input += alphabet[(state >> 16) % alphabet.size()];
+        }
+
+        auto blocks = input.size() / json::detail::block_size;
+        auto expected = std::vector<json::detail::block_masks>{};
+        for (std::size_t i = 0; i < blocks; i++) {
+            expected.push_back(json::detail::classify_scalar(input.data() + i * json::detail::block_size));
+        }
+
+        auto matches = [&](auto classify) {
+            auto masks = std::vector<json::detail::block_masks>(blocks);
+            classify(input.data(), blocks, masks.data());
+            auto all = true;
+            for (std::size_t i = 0; i < blocks; i++) {
+                all = all && masks[i].quote == expected[i].quote && masks[i].backslash == expected[i].backslash
+                    && masks[i].operators == expected[i].operators && masks[i].whitespace == expected[i].whitespace;
+            }
+            return all;
+        };
+
+        RTL_CHECK(matches([](auto... args) { json::detail::classify(args...); }));
+#ifdef RTL_X86
+        if (utilities::cpu().sse42) {
+            RTL_CHECK(matches([](auto... args) { json::detail::classify_sse42(args...); }));
+        }
+
+        if (utilities::cpu().avx2) {
+            RTL_CHECK(matches([](auto... args) { json::detail::classify_avx2(args...); }));
+        }
+#endif
+    });
+
+    tests::run("json writer strings decode back to what was written", [] {
+        // every ASCII character and some UTF-8, at every offset within and past a vector's width
+        auto characters = std::string{};
+        for (int c = 1; c < 128; c++) {
+            characters += static_cast<char>(c);
+        }
+        characters += "\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80";
+
+        auto all = true;
+        auto buffer = collections::list<char>{};
+        for (std::size_t padding = 0; padding < 40; padding++) {
+            auto text = std::string(padding, 'x') + characters + std::string(padding, 'y');
+            buffer.clear();
+            json::writer{buffer}.value(text);
+            auto document = json::parse(std::string_view{buffer.data(), buffer.size()});
+            all = all && document.has_value() && document->root().decode_string()->view() == text;
+        }
+        RTL_CHECK(all);
+
+        auto string = strings::string{};
+        json::writer{string}.value("\x01\x1f");
+        RTL_CHECK(string == R"("\u0001\u001f")");
+    });
+
+    tests::run("json writer writes numbers, nulls and nesting that parse back", [] {
+        auto string = strings::string{};
+        auto writer = json::writer{string};
+        writer.begin_array()
+            .value(std::numeric_limits<std::int64_t>::min())
+            .value(std::numeric_limits<std::uint64_t>::max())
+            .value(0.1)
+            .value(-1e300)
+            .value(std::numeric_limits<double>::infinity())
+            .value(std::nan(""))
+            .value(nullptr)
+            .value(utilities::option<int>{})
+            .value(utilities::option<int>{3})
+            .value(true)
+            .begin_array().end_array()
+            .begin_object().end_object()
+            .value(std::vector<std::vector<int>>{{1, 2}, {}, {3}})
+            .end_array();
+        RTL_CHECK(string == "[-9223372036854775808,18446744073709551615,0.1,-1e+300,null,null,null,null,3,true,[],{},"
+            "[[1,2],[],[3]]]");
+
+        auto document = json::parse(string.view());
+        RTL_CHECK(document.has_value());
+        auto array = *document->root().as_array();
+        RTL_CHECK(holds(array.at(0)->get_int64(), std::numeric_limits<std::int64_t>::min()));
+        RTL_CHECK(holds(array.at(1)->get_uint64(), std::numeric_limits<std::uint64_t>::max()));
+        RTL_CHECK(holds(array.at(2)->get_double(), 0.1));
+        RTL_CHECK(holds(array.at(3)->get_double(), -1e300));
+
+        // values copied out of a document come out unchanged
+        auto copy = strings::string{};
+        json::writer{copy}.value(document->root());
+        RTL_CHECK(copy == string);
+    });
+
+    tests::run("json writer round-trips reflected types", [] {
+        auto records = sample_records();
+        auto buffer = collections::list<char>{};
+        auto writer = json::writer{buffer};
+        write_records(writer, records);
+        RTL_CHECK(reads_back({buffer.data(), buffer.size()}, records));
+    });
+
+#ifdef RTL_X86
+    tests::run("json writer escape kernels match the scalar one", [] {
+        auto text = std::string(200, 'a');
+        auto matches = [&](auto kernel) {
+            auto all = true;
+            for (auto special : {'"', '\\', '\n', '\x1f', '\x7f'}) {
+                for (std::size_t at = 0; at < text.size(); at += 3) {
+                    auto copy = text;
+                    copy[at] = special;
+                    for (std::size_t size = 0; size <= copy.size(); size += 5) {
+                        all = all && kernel(copy.data(), size) == json::detail::find_escape_scalar(copy.data(), size);
+                    }
+                }
+            }
+            return all;
+        };
+
+        if (utilities::cpu().sse42) {
+            RTL_CHECK(matches([](auto... args) { return json::detail::find_escape_sse42(args...); }));
+        }
+
+        if (utilities::cpu().avx2) {
+            RTL_CHECK(matches([](auto... args) { return json::detail::find_escape_avx2(args...); }));
+        }
+    });
+#endif
+
+#ifdef RTL_POSIX
+    tests::run("json writer hands its buffer to a file as it fills", [] {
+        auto name = "rtl-json-tests-" + std::to_string(std::random_device{}());
+        auto path = std::filesystem::temp_directory_path() / name;
+        auto records = sample_records();
+        {
+            auto file = fs::file_writer::open(path).unwrap();
+            auto buffer = strings::string{};
+            auto writer = json::writer{buffer, file, 1000};
+            write_records(writer, records);
+            RTL_CHECK(buffer.size() < 1000);
+            RTL_CHECK(writer.flush());
+            RTL_CHECK(buffer.empty());
+            RTL_CHECK(file.close());
+        }
+
+        auto mapped = fs::mapped_file::open(path);
+        RTL_CHECK(mapped.has_value() && reads_back(mapped->view(), records));
+        auto error = std::error_code{};
+        std::filesystem::remove(path, error);
+    });
+#endif
+
+    return tests::exit_code();
+}
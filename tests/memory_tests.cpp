@@ -0,0 +1,441 @@
+#include "rtl.hpp"
+#include "test.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace rtl;
+
+namespace {
+auto is_aligned(const void* pointer, std::size_t alignment) -> bool {
+    return reinterpret_cast<std::uintptr_t>(pointer) % alignment == 0;
+}
+// Frees a pool block from its destructor. Created before the thread's pool cache, it is destroyed after it.
+struct late_owner {
+    memory::pool_allocator<std::uint64_t> allocator;
+    std::uint64_t* block{};
+
+    ~late_owner() {
+        if (block != nullptr) {
+            allocator.deallocate(block, 1);
+        }
+    }
+};
+
+// Makes the next global allocation on this thread throw, to fail the allocation of a control block.
+thread_local bool fail_next_allocation = false;
+
+// Counts how many times it has deleted something.
+struct counting_deleter {
+    int* deletes;
+
+    auto operator()(int* pointer) const noexcept -> void {
+        ++*deletes;
+        delete pointer;
+    }
+};
+
+// Counts the live instances, and throws instead of constructing one more than `limit`.
+struct tracked {
+    static inline int alive = 0;
+    static inline int limit = std::numeric_limits<int>::max();
+
+    tracked() {
+        if (alive == limit) {
+            throw std::runtime_error{"limit"};
+        }
+        alive++;
+    }
+
+    tracked(const tracked&) = delete;
+    auto operator=(const tracked&) -> tracked& = delete;
+
+    ~tracked() {
+        alive--;
+    }
+};
+
+// Tells a flag when it is destroyed.
+struct node : memory::intrusive_counted<node> {
+    explicit node(bool& destroyed) noexcept : destroyed{&destroyed} {
+
+    }
+
+    ~node() {
+        *destroyed = true;
+    }
+
+    bool* destroyed;
+};
+} // namespace
+
+auto operator new(std::size_t size) -> void* {
+    if (std::exchange(fail_next_allocation, false)) {
+        throw std::bad_alloc{};
+    }
+
+    if (auto pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+
+    throw std::bad_alloc{};
+}
+
+auto operator delete(void* pointer) noexcept -> void {
+    std::free(pointer);
+}
+
+auto operator delete(void* pointer, std::size_t) noexcept -> void {
+    std::free(pointer);
+}
+
+int main() {
+    tests::run("arena hands out aligned memory from its buffer, then from chunks", [] {
+        alignas(std::max_align_t) std::array<std::byte, 64> buffer{};
+        memory::arena arena{buffer, 256};
+
+        auto first = arena.allocate(24, 8);
+        auto second = arena.allocate(8, 16);
+        RTL_CHECK(first == buffer.data());
+        RTL_CHECK(is_aligned(second, 16));
+        RTL_CHECK(static_cast<std::byte*>(second) < buffer.data() + buffer.size());
+
+        auto chunked = arena.allocate(128, 64);
+        RTL_CHECK(is_aligned(chunked, 64));
+        RTL_CHECK(arena.capacity() > buffer.size());
+
+        arena.reset();
+        RTL_CHECK(arena.allocate(24, 8) == buffer.data());
+        RTL_CHECK(arena.allocate(128, 64) == chunked);
+
+        arena.release();
+        RTL_CHECK(arena.capacity() == buffer.size());
+    });
+
+    tests::run("arena allocates blocks larger than its chunk size", [] {
+        memory::arena arena{64};
+        auto large = static_cast<std::byte*>(arena.allocate(1000));
+        large[999] = std::byte{1};
+        RTL_CHECK(arena.capacity() >= 1000);
+    });
+
+    tests::run("arena_allocator rejects sizes that overflow", [] {
+        memory::arena arena;
+        memory::arena_allocator<std::uint64_t> allocator{arena};
+
+        auto threw = false;
+        try {
+            (void)allocator.allocate(std::numeric_limits<std::size_t>::max() / 4);
+        } catch (const std::bad_array_new_length&) {
+            threw = true;
+        }
+        RTL_CHECK(threw);
+        RTL_CHECK(allocator.max_size() == std::numeric_limits<std::size_t>::max() / sizeof(std::uint64_t));
+
+        threw = false;
+        try {
+            (void)arena.allocate(std::numeric_limits<std::size_t>::max() - 8);
+        } catch (const std::bad_alloc&) {
+            threw = true;
+        }
+        RTL_CHECK(threw);
+    });
+
+    tests::run("list can draw from an arena", [] {
+        memory::arena arena;
+        collections::list<std::string, memory::arena_allocator<std::string>> list{
+            memory::arena_allocator<std::string>{arena}};
+        for (int i = 0; i < 100; i++) {
+            list.add(std::to_string(i));
+        }
+        RTL_CHECK(list.size() == 100 && list.back_unchecked() == "99");
+        RTL_CHECK(list.get_allocator() == memory::arena_allocator<std::string>{arena});
+    });
+
+    tests::run("pool_allocator reuses blocks across threads", [] {
+        constexpr int threads = 8;
+        constexpr int blocks = 2'000;
+
+        std::vector<std::thread> workers;
+        std::vector<int> failures(threads);
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([t, &failures] {
+                memory::pool_allocator<std::uint64_t> allocator;
+                std::vector<std::uint64_t*> owned;
+                for (int round = 0; round < 4; round++) {
+                    for (int i = 0; i < blocks; i++) {
+                        auto block = allocator.allocate(1);
+                        *block = static_cast<std::uint64_t>(t * blocks + i);
+                        owned.push_back(block);
+                    }
+
+                    for (int i = 0; i < blocks; i++) {
+                        if (*owned[static_cast<std::size_t>(i)] != static_cast<std::uint64_t>(t * blocks + i)) {
+                            failures[static_cast<std::size_t>(t)]++;
+                        }
+                        allocator.deallocate(owned[static_cast<std::size_t>(i)], 1);
+                    }
+                    owned.clear();
+                }
+            });
+        }
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        for (auto failed : failures) {
+            RTL_CHECK(failed == 0);
+        }
+    });
+
+    tests::run("pool_allocator frees blocks after the thread's cache is destroyed", [] {
+        std::thread{[] {
+            thread_local late_owner owner;
+            owner.block = owner.allocator.allocate(1);
+        }}.join();
+
+        std::thread{[] {
+            memory::pool_allocator<std::uint64_t> allocator;
+            auto block = allocator.allocate(1);
+            *block = 1;
+            allocator.deallocate(block, 1);
+        }}.join();
+    });
+
+    tests::run("pool_allocator serves arrays from the global allocator", [] {
+        memory::pool_allocator<std::uint32_t> allocator;
+        auto array = allocator.allocate(100);
+        array[99] = 1;
+        allocator.deallocate(array, 100);
+
+        auto threw = false;
+        try {
+            (void)allocator.allocate(std::numeric_limits<std::size_t>::max() / 2);
+        } catch (const std::bad_array_new_length&) {
+            threw = true;
+        }
+        RTL_CHECK(threw);
+    });
+
+    tests::run("shared_ptr leaves a unique_ptr owning its object if the control block can't be allocated", [] {
+        auto deletes = 0;
+        auto owner = memory::unique_ptr<int, counting_deleter>{new int{7}, counting_deleter{&deletes}};
+        auto threw = false;
+        try {
+            fail_next_allocation = true;
+            memory::shared_ptr<int> shared{std::move(owner)};
+        } catch (const std::bad_alloc&) {
+            threw = true;
+        }
+        RTL_CHECK(threw);
+        RTL_CHECK(deletes == 0 && owner.get() != nullptr && *owner.get() == 7);
+
+        {
+            memory::shared_ptr<int> shared{std::move(owner)};
+            RTL_CHECK(owner.get() == nullptr && *shared == 7 && shared.use_count() == 1);
+        }
+        RTL_CHECK(deletes == 1);
+
+        memory::shared_ptr<int> empty{memory::unique_ptr<int>{}};
+        RTL_CHECK(empty == nullptr && empty.use_count() == 0);
+    });
+
+    tests::run("shared_ptr deletes a raw pointer if the control block can't be allocated", [] {
+        auto deletes = 0;
+        auto threw = false;
+        try {
+            auto pointer = new int{1};
+            fail_next_allocation = true;
+            memory::shared_ptr<int> shared{pointer, counting_deleter{&deletes}};
+        } catch (const std::bad_alloc&) {
+            threw = true;
+        }
+        RTL_CHECK(threw && deletes == 1);
+    });
+
+    tests::run("shared_ptr and weak_ptr count their references", [] {
+        auto shared = memory::make_shared<std::string>("text");
+        RTL_CHECK(shared.use_count() == 1 && *shared == "text");
+
+        memory::weak_ptr<std::string> weak = shared;
+        auto copy = shared;
+        RTL_CHECK(shared.use_count() == 2 && weak.use_count() == 2 && !weak.expired());
+
+        // an aliasing pointer shares the count but points inside the object
+        memory::shared_ptr<char> first{shared, shared->data()};
+        RTL_CHECK(*first == 't' && shared.use_count() == 3);
+
+        auto locked = weak.lock();
+        RTL_CHECK(locked == shared && shared.use_count() == 4);
+
+        shared.reset();
+        copy.reset();
+        first.reset();
+        locked.reset();
+        RTL_CHECK(weak.expired() && weak.lock() == nullptr);
+
+        auto local = memory::make_shared<int, memory::local_count>(3);
+        auto local_copy = local;
+        RTL_CHECK(local_copy.use_count() == 2 && *local_copy == 3);
+    });
+
+    tests::run("shared_ptr and weak_ptr survive copies and locks from many threads", [] {
+        auto deletes = 0;
+        {
+            memory::shared_ptr<int> shared{new int{5}, counting_deleter{&deletes}};
+            memory::weak_ptr<int> weak = shared;
+            std::atomic<bool> all_alive{true};
+            std::vector<std::thread> threads;
+            for (int t = 0; t < 4; t++) {
+                threads.emplace_back([shared, weak, &all_alive] {
+                    for (int i = 0; i < 10000; i++) {
+                        auto copy = shared;
+                        auto locked = weak.lock();
+                        if (locked == nullptr || *copy != 5) {
+                            all_alive.store(false, std::memory_order_relaxed);
+                        }
+                    }
+                });
+            }
+
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            RTL_CHECK(all_alive.load());
+            RTL_CHECK(shared.use_count() == 1 && deletes == 0);
+        }
+        RTL_CHECK(deletes == 1);
+    });
+
+    tests::run("intrusive_ptr shares the count embedded in the object", [] {
+        auto destroyed = false;
+        {
+            auto pointer = memory::make_intrusive<node>(destroyed);
+            RTL_CHECK(pointer->use_count() == 1);
+
+            // recreated from the raw pointer without a separate control block
+            memory::intrusive_ptr<node> again{pointer.get()};
+            RTL_CHECK(again == pointer && pointer->use_count() == 2);
+
+            auto raw = again.detach();
+            RTL_CHECK(again == nullptr && pointer->use_count() == 2);
+            memory::intrusive_ptr<node> adopted{raw, false};
+            RTL_CHECK(pointer->use_count() == 2);
+
+            auto moved = std::move(adopted);
+            RTL_CHECK(adopted == nullptr && moved == pointer && pointer->use_count() == 2);
+            RTL_CHECK(sizeof(utilities::option<memory::intrusive_ptr<node>>) == sizeof(node*));
+        }
+        RTL_CHECK(destroyed);
+    });
+
+    tests::run("unique_ptr<T[]> owns and destroys a whole array", [] {
+        RTL_CHECK(sizeof(memory::unique_ptr<int[]>) == sizeof(int*));
+        {
+            auto array = memory::make_unique<tracked[]>(5);
+            RTL_CHECK(tracked::alive == 5);
+            auto moved = std::move(array);
+            RTL_CHECK(array.get() == nullptr && moved.get() != nullptr && tracked::alive == 5);
+            moved.reset();
+            RTL_CHECK(tracked::alive == 0);
+            moved = memory::make_unique_for_overwrite<tracked[]>(2);
+            RTL_CHECK(tracked::alive == 2);
+        }
+        RTL_CHECK(tracked::alive == 0);
+
+        auto zeros = memory::make_unique<int[]>(4);
+        RTL_CHECK(zeros[0] == 0 && zeros[3] == 0);
+        zeros[3] = 7;
+        auto raw = zeros.release();
+        RTL_CHECK(zeros.get() == nullptr && raw[3] == 7);
+        delete[] raw;
+    });
+
+    tests::run("unique_ptr keeps a stateful deleter alongside the pointer", [] {
+        RTL_CHECK(sizeof(memory::unique_ptr<int>) == sizeof(int*));
+        RTL_CHECK(sizeof(memory::unique_ptr<int, counting_deleter>) == 2 * sizeof(int*));
+
+        auto first_deletes = 0;
+        auto second_deletes = 0;
+        {
+            memory::unique_ptr<int, counting_deleter> first{new int{1}, counting_deleter{&first_deletes}};
+            memory::unique_ptr<int, counting_deleter> second{new int{2}, counting_deleter{&second_deletes}};
+            first.swap(second);
+            RTL_CHECK(*first.get() == 2 && first.get_deleter().deletes == &second_deletes);
+
+            // the old object goes through the old deleter, then the deleter is replaced
+            first = std::move(second);
+            RTL_CHECK(second_deletes == 1 && first_deletes == 0);
+            RTL_CHECK(*first.get() == 1 && first.get_deleter().deletes == &first_deletes);
+            RTL_CHECK(second.get() == nullptr);
+        }
+        RTL_CHECK(first_deletes == 1 && second_deletes == 1);
+    });
+
+    tests::run("allocate_unique builds objects and arrays from an allocator", [] {
+        memory::arena arena;
+        auto text = memory::allocate_unique<std::string>(memory::arena_allocator<std::string>{arena}, "text");
+        RTL_CHECK(*text.get() == "text");
+
+        auto numbers = memory::allocate_unique<std::uint64_t[]>(memory::arena_allocator<std::uint64_t>{arena}, 8);
+        RTL_CHECK(numbers.get_deleter().size() == 8 && numbers[0] == 0 && numbers[7] == 0);
+        RTL_CHECK(is_aligned(numbers.get(), alignof(std::uint64_t)));
+
+        auto value = memory::allocate_unique_for_overwrite<std::uint64_t>(std::allocator<std::uint64_t>{});
+        *value.get() = 3;
+        RTL_CHECK(sizeof(value) == sizeof(std::uint64_t*));
+
+        {
+            auto array = memory::allocate_unique<tracked[]>(std::allocator<tracked>{}, 4);
+            RTL_CHECK(tracked::alive == 4);
+        }
+        RTL_CHECK(tracked::alive == 0);
+
+        // the elements already created are destroyed when a later one throws
+        tracked::limit = 3;
+        auto threw = false;
+        try {
+            (void)memory::allocate_unique<tracked[]>(std::allocator<tracked>{}, 5);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        tracked::limit = std::numeric_limits<int>::max();
+        RTL_CHECK(threw && tracked::alive == 0);
+    });
+
+    tests::run("allocate_unique_for_overwrite leaves arena memory as it was", [] {
+        alignas(std::max_align_t) std::array<std::byte, 256> buffer{};
+        memory::arena arena{buffer};
+        memory::arena_allocator<std::byte> allocator{arena};
+
+        auto scratch = memory::allocate_unique_for_overwrite<std::byte[]>(allocator, buffer.size());
+        RTL_CHECK(scratch.get() == buffer.data());
+        for (std::size_t i = 0; i < buffer.size(); i++) {
+            scratch[i] = std::byte{0xab};
+        }
+        scratch.reset();
+
+        // the arena hands the same memory out again, which is only zeroed when asked for
+        arena.reset();
+        scratch = memory::allocate_unique_for_overwrite<std::byte[]>(allocator, buffer.size());
+        RTL_CHECK(scratch.get() == buffer.data() && scratch[buffer.size() - 1] == std::byte{0xab});
+        scratch.reset();
+
+        arena.reset();
+        auto zeroed = memory::allocate_unique<std::byte[]>(allocator, buffer.size());
+        RTL_CHECK(zeroed.get() == buffer.data() && zeroed[buffer.size() - 1] == std::byte{0});
+    });
+
+    return tests::exit_code();
+}
@@ -2,7 +2,6 @@
 
 #include <print>
 #include <string>
-#include <vector>
 
 using namespace rtl;
 
@@ -58,10 +57,7 @@ int main() {
     print_all();
 
     const collections::list<std::string> const_strings;
-    for (auto it = strings.cbegin(); it != const_strings.cend(); ++it) {
+    for (auto it = strings.cbegin(); it != strings.cend(); ++it) {
         std::println("{}, {}", *it, it->size());
     }
-
-    std::vector<int> v;
-    auto it = typename decltype(v)::iterator{};
 }
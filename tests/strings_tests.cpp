@@ -0,0 +1,254 @@
+#include "rtl.hpp"
+#include "test.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace rtl;
+
+namespace {
+// Compares every search of `text` against `std::string_view`, from every starting index.
+auto check_searches(std::string_view text, std::string_view needle) -> void {
+    auto string = strings::string{text};
+    auto all_match = true;
+    for (std::size_t from = 0; from <= text.size(); from++) {
+        auto expected = text.find(needle, from);
+        auto found = string.find(needle, from);
+        all_match = all_match && (expected == std::string_view::npos
+            ? !found.has_value() : found.has_value() && found.value() == expected);
+
+        expected = text.find_first_of(needle, from);
+        found = string.find_first_of(needle, from);
+        all_match = all_match && (expected == std::string_view::npos
+            ? !found.has_value() : found.has_value() && found.value() == expected);
+    }
+    RTL_CHECK(all_match);
+}
+} // namespace
+
+int main() {
+    tests::run("string stores short strings inline and longer ones on the heap", [] {
+        auto inline_chars = std::string(strings::string::inline_capacity, 'a');
+        auto short_string = strings::string{inline_chars};
+        RTL_CHECK(short_string.is_inline());
+        RTL_CHECK(short_string.size() == strings::string::inline_capacity);
+        RTL_CHECK(short_string.c_str()[short_string.size()] == '\0');
+        RTL_CHECK(short_string == inline_chars);
+
+        short_string.add('b');
+        RTL_CHECK(!short_string.is_inline());
+        RTL_CHECK(short_string.c_str()[short_string.size()] == '\0');
+        RTL_CHECK(short_string == inline_chars + "b");
+
+        short_string.pop();
+        short_string.shrink_to_fit();
+        RTL_CHECK(short_string.is_inline());
+        RTL_CHECK(short_string == inline_chars);
+
+        auto empty = strings::string{};
+        RTL_CHECK(empty.empty() && empty.is_inline() && *empty.c_str() == '\0');
+        RTL_CHECK(!empty.front().has_value());
+    });
+
+    tests::run("string copies, moves and compares", [] {
+        for (auto text : {std::string_view{"short"}, std::string_view{"a string that is too long to be inline"}}) {
+            auto original = strings::string{text};
+            auto copy = original;
+            RTL_CHECK(copy == text && copy.data() != original.data());
+
+            auto moved = std::move(copy);
+            RTL_CHECK(moved == text);
+            RTL_CHECK(copy.empty());
+
+            auto assigned = strings::string{"x"};
+            assigned = moved;
+            RTL_CHECK(assigned == text);
+            assigned = std::move(moved);
+            RTL_CHECK(assigned == text);
+
+            RTL_CHECK((original <=> std::string_view{"a"}) == (text <=> std::string_view{"a"}));
+            RTL_CHECK(std::hash<strings::string>{}(original) == std::hash<std::string_view>{}(text));
+        }
+    });
+
+    tests::run("string edits round-trip against std::string", [] {
+        auto string = strings::string{"hello"};
+        auto expected = std::string{"hello"};
+
+        string.append(" world");
+        expected.append(" world");
+        RTL_CHECK(string.insert(0, ">> "));
+        expected.insert(0, ">> ");
+        RTL_CHECK(!string.insert(string.size() + 1, "x"));
+        RTL_CHECK(string.remove(3, 6));
+        expected.erase(3, 6);
+        RTL_CHECK(string.remove(string.size() - 2, 100));
+        expected.erase(expected.size() - 2);
+        RTL_CHECK(string == expected);
+
+        // appending and inserting a string into itself, inline and on the heap
+        for (int i = 0; i < 4; i++) {
+            string.append(string.view());
+            expected.append(expected);
+            RTL_CHECK(string.insert(2, string.view().substr(1, 5)));
+            expected.insert(2, expected.substr(1, 5));
+        }
+        RTL_CHECK(string == expected);
+
+        string.resize(string.size() + 3, '!');
+        expected.resize(expected.size() + 3, '!');
+        string.truncate(string.size() - 1);
+        expected.pop_back();
+        RTL_CHECK(string == expected);
+
+        string.assign("abc");
+        RTL_CHECK(string == "abc");
+        RTL_CHECK(string + "def" == "abcdef");
+
+        string.clear();
+        strings::append_format(string, "{}-{}", 1, "two");
+        RTL_CHECK(string == "1-two");
+        RTL_CHECK(strings::format("{}!", strings::string{"x"}) == "x!");
+    });
+
+    tests::run("string search matches std::string_view", [] {
+        auto text = std::string{};
+        for (int i = 0; i < 200; i++) {
+            text += static_cast<char>('a' + (i * 7) % 13);
+        }
+        text += "needle";
+
+        check_searches(text, "needle");
+        check_searches(text, "ab");
+        check_searches(text, "xyz");
+        check_searches(text, "m");
+        check_searches(text, "lk");
+        check_searches(text, "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa");
+        check_searches("short", "or");
+        check_searches("", "x");
+
+        auto string = strings::string{text};
+        RTL_CHECK(string.find("", string.size()).has_value());
+        RTL_CHECK(!string.find("", string.size() + 1).has_value());
+        RTL_CHECK(!string.find_first_of("").has_value());
+        RTL_CHECK(string.contains('n') && !string.contains('z'));
+        RTL_CHECK(string.contains("needle") && string.ends_with("needle") && string.starts_with("ah"));
+    });
+
+#ifdef RTL_X86
+    tests::run("vector search kernels match the scalar ones", [] {
+        auto text = std::string(300, 'a');
+        text[150] = 'b';
+        text[151] = 'c';
+        text[299] = 'z';
+
+        auto matches = [&](auto kernel, auto scalar) {
+            auto all = true;
+            for (std::size_t size = 0; size <= text.size(); size += 7) {
+                for (auto needle : {std::string_view{"bc"}, std::string_view{"az"}, std::string_view{"aab"}}) {
+                    all = all && kernel(text.data(), size, needle.data(), needle.size())
+                        == scalar(text.data(), size, needle.data(), needle.size());
+                }
+            }
+            return all;
+        };
+
+        auto scalar_substring = [](auto... args) { return strings::detail::find_substring_scalar(args...); };
+        auto scalar_first_of = [](auto... args) { return strings::detail::find_first_of_scalar(args...); };
+        if (utilities::cpu().sse42) {
+            RTL_CHECK(matches([](auto... args) { return strings::detail::find_substring_sse42(args...); },
+                scalar_substring));
+            RTL_CHECK(matches([](auto... args) { return strings::detail::find_first_of_sse42(args...); },
+                scalar_first_of));
+        }
+
+        if (utilities::cpu().avx2) {
+            RTL_CHECK(matches([](auto... args) { return strings::detail::find_substring_avx2(args...); },
+                scalar_substring));
+            RTL_CHECK(matches([](auto... args) { return strings::detail::find_first_of_avx2(args...); },
+                scalar_first_of));
+        }
+    });
+#endif
+
+    tests::run("interner hands out one handle per distinct string", [] {
+        strings::interner interner{256};
+        auto empty = interner.intern("");
+        auto hello = interner.intern("hello");
+        RTL_CHECK(interner.intern("hello") == hello);
+        RTL_CHECK(hello != empty);
+        RTL_CHECK(interner.view(empty).empty() && *interner.view(empty).data() == '\0');
+        RTL_CHECK(!interner.find("missing").has_value());
+        RTL_CHECK(interner.size() == 2);
+
+        // enough strings to rehash and spill over many arena chunks and entry blocks
+        auto first_view = interner.view(hello);
+        std::vector<strings::interned> handles;
+        for (int i = 0; i < 5000; i++) {
+            handles.push_back(interner.intern(std::to_string(i) + " some padding to fill the chunks"));
+        }
+        RTL_CHECK(interner.size() == 5002);
+        RTL_CHECK(interner.view(hello).data() == first_view.data());
+
+        auto round_trips = true;
+        for (int i = 0; i < 5000; i++) {
+            auto chars = std::to_string(i) + " some padding to fill the chunks";
+            auto view = interner.view(handles[static_cast<std::size_t>(i)]);
+            auto found = interner.find(chars);
+            round_trips = round_trips && view == chars && view.data()[view.size()] == '\0'
+                && found.has_value() && found.value() == handles[static_cast<std::size_t>(i)]
+                && interner.hash(found.value()) == interner.hash(interner.intern(chars));
+        }
+        RTL_CHECK(round_trips);
+        RTL_CHECK(interner.size() == 5002);
+
+        RTL_CHECK(sizeof(utilities::option<strings::interned>) == sizeof(strings::interned));
+        auto moved = std::move(interner);
+        RTL_CHECK(moved.view(hello) == "hello");
+    });
+
+    tests::run("concurrent_interner agrees on handles across threads", [] {
+        strings::concurrent_interner interner{3};
+        RTL_CHECK(interner.shard_count() == 4);
+
+        constexpr int thread_count = 4;
+        constexpr int string_count = 2000;
+        std::vector<std::vector<strings::interned>> handles(thread_count);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; t++) {
+            threads.emplace_back([&interner, &handles, t] {
+                // every thread interns the same strings, starting at a different one
+                for (int i = 0; i < string_count; i++) {
+                    auto n = (i + t * 500) % string_count;
+                    auto handle = interner.intern("string " + std::to_string(n));
+                    handles[static_cast<std::size_t>(t)].push_back(handle);
+                }
+            });
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        RTL_CHECK(interner.size() == string_count);
+        auto agree = true;
+        for (int t = 0; t < thread_count; t++) {
+            for (int i = 0; i < string_count; i++) {
+                auto n = (i + t * 500) % string_count;
+                auto handle = handles[static_cast<std::size_t>(t)][static_cast<std::size_t>(i)];
+                auto found = interner.find("string " + std::to_string(n));
+                agree = agree && interner.view(handle) == "string " + std::to_string(n)
+                    && found.has_value() && found.value() == handle;
+            }
+        }
+        RTL_CHECK(agree);
+        RTL_CHECK(!interner.find("string -1").has_value());
+    });
+
+    return tests::exit_code();
+}
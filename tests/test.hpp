@@ -0,0 +1,34 @@
+#ifndef RTL_TESTS_TEST_HPP
+#define RTL_TESTS_TEST_HPP
+
+#include <print>
+#include <source_location>
+#include <string_view>
+
+namespace rtl::tests {
+inline int failures = 0;
+
+inline auto check(bool condition, std::string_view expression,
+                  std::source_location location = std::source_location::current()) -> void {
+    if (!condition) {
+        std::println(stderr, "{}:{}: check failed: {}", location.file_name(), location.line(), expression);
+        failures++;
+    }
+}
+
+// Runs one test case, printing its name first so a failure or crash can be traced back to it.
+template<typename F>
+auto run(std::string_view name, F&& test) -> void {
+    std::println("{}", name);
+    test();
+}
+
+// The exit code for `main`, non-zero if any check failed.
+inline auto exit_code() -> int {
+    return failures == 0 ? 0 : 1;
+}
+} // namespace rtl::tests
+
+#define RTL_CHECK(...) ::rtl::tests::check(static_cast<bool>(__VA_ARGS__), #__VA_ARGS__)
+
+#endif // #ifndef RTL_TESTS_TEST_HPP
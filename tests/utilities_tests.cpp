@@ -0,0 +1,207 @@
+#include "rtl.hpp"
+#include "test.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <variant>
+
+using namespace rtl;
+
+namespace {
+// Throws from its constructor when asked to, to leave a variant without a value.
+struct throws_on_construction {
+    explicit throws_on_construction(bool should_throw) {
+        if (should_throw) {
+            throw std::runtime_error{"construction"};
+        }
+    }
+
+    friend auto operator==(const throws_on_construction&, const throws_on_construction&) -> bool = default;
+};
+} // namespace
+
+int main() {
+    tests::run("option uses the niche of references and pointers", [] {
+        RTL_CHECK(sizeof(utilities::option<utilities::reference<int>>) == sizeof(int*));
+        RTL_CHECK(sizeof(utilities::option<memory::unique_ptr<int>>) == sizeof(int*));
+        RTL_CHECK(sizeof(utilities::option<int*>) == sizeof(int*));
+        RTL_CHECK(std::is_trivially_copyable_v<utilities::option<utilities::reference<int>>>);
+
+        int value = 1;
+        utilities::option<utilities::reference<int>> ref = value;
+        RTL_CHECK(ref.has_value() && &ref.value().get() == &value);
+        ref.reset();
+        RTL_CHECK(!ref.has_value());
+
+        // null is the niche, so a null pointer reads as empty
+        RTL_CHECK(!utilities::option<int*>{nullptr}.has_value());
+        RTL_CHECK(utilities::option<int*>{&value}.has_value());
+    });
+
+    tests::run("option without a niche keeps a flag", [] {
+        utilities::option<std::string> empty;
+        RTL_CHECK(!empty.has_value());
+
+        auto copy = empty;
+        auto moved = std::move(copy);
+        RTL_CHECK(!moved.has_value());
+
+        utilities::option<std::string> full = std::string{"text"};
+        moved = full;
+        RTL_CHECK(moved.has_value() && moved.value() == "text");
+        moved = utilities::nullopt;
+        RTL_CHECK(!moved.has_value());
+
+        RTL_CHECK(full.unwrap() == "text");
+        RTL_CHECK(!full.has_value());
+        RTL_CHECK(full.unwrap_or("other") == "other");
+    });
+
+    tests::run("option of a unique_ptr owns it", [] {
+        utilities::option<memory::unique_ptr<int>> owner = memory::make_unique<int>(5);
+        RTL_CHECK(owner.has_value() && *owner.value().get() == 5);
+        auto moved = std::move(owner);
+        RTL_CHECK(moved.has_value() && *moved.value().get() == 5);
+        auto pointer = moved.unwrap();
+        RTL_CHECK(!moved.has_value() && *pointer.get() == 5);
+    });
+
+    tests::run("flagged_option holds the niche value as a value", [] {
+        utilities::flagged_option<int*> null = nullptr;
+        RTL_CHECK(null.has_value() && null.value() == nullptr);
+        null.reset();
+        RTL_CHECK(!null.has_value());
+
+        utilities::flagged_option<memory::unique_ptr<int>> empty_pointer = memory::unique_ptr<int>{};
+        RTL_CHECK(empty_pointer.has_value());
+        RTL_CHECK(sizeof(empty_pointer) > sizeof(memory::unique_ptr<int>));
+
+        RTL_CHECK(std::is_same_v<utilities::flagged_option<int>, utilities::option<int>>);
+        RTL_CHECK(!std::is_same_v<utilities::flagged_option<int*>, utilities::option<int*>>);
+
+        int value = 3;
+        utilities::option<int*> converted = utilities::flagged_option<int*>{&value};
+        RTL_CHECK(converted.has_value() && *converted.value() == 3);
+        auto mapped = utilities::flagged_option<int*>{nullptr}.map([](int* pointer) {
+            return pointer;
+        });
+        RTL_CHECK(mapped.has_value());
+    });
+
+    tests::run("variant keeps null pointers and empty unique_ptrs as values", [] {
+        utilities::variant<int*, std::monostate> null = nullptr;
+        RTL_CHECK(null.index() == 0);
+        RTL_CHECK(null.holds<int*>() && null.get_unchecked<0>() == nullptr);
+
+        utilities::variant<std::monostate, int*> second = nullptr;
+        RTL_CHECK(second.index() == 1);
+        second = std::monostate{};
+        RTL_CHECK(second.index() == 0);
+
+        utilities::variant<memory::unique_ptr<int>, std::monostate> empty_pointer = memory::unique_ptr<int>{};
+        RTL_CHECK(empty_pointer.index() == 0);
+        auto moved = std::move(empty_pointer);
+        RTL_CHECK(moved.index() == 0 && moved.get_unchecked<0>().get() == nullptr);
+        moved.emplace<1>();
+        RTL_CHECK(moved.index() == 1);
+    });
+
+    tests::run("variant uses the niche of a reference", [] {
+        using variant = utilities::variant<utilities::reference<int>, std::monostate>;
+        RTL_CHECK(sizeof(variant) == sizeof(int*));
+        RTL_CHECK(sizeof(utilities::variant<int*, std::monostate>) > sizeof(int*));
+
+        int value = 4;
+        variant ref = utilities::reference<int>{value};
+        RTL_CHECK(ref.index() == 0 && &ref.get_unchecked<0>().get() == &value);
+        ref = std::monostate{};
+        RTL_CHECK(ref.index() == 1);
+    });
+
+    tests::run("variant visits one and several variants", [] {
+        using variant = utilities::variant<int, double, std::string>;
+        auto describe = [](const auto& value) -> std::string {
+            if constexpr (std::is_same_v<std::remove_cvref_t<decltype(value)>, std::string>) {
+                return "string " + value;
+            } else {
+                return std::to_string(static_cast<int>(value));
+            }
+        };
+
+        RTL_CHECK(utilities::visit(describe, variant{3}) == "3");
+        RTL_CHECK(variant{2.5}.visit(describe) == "2");
+        RTL_CHECK(variant{std::string{"s"}}.visit(describe) == "string s");
+
+        // every combination of two variants of three alternatives
+        auto all = true;
+        auto values = std::vector<variant>{1, 2.0, std::string{"x"}};
+        for (const auto& a : values) {
+            for (const auto& b : values) {
+                auto combined = utilities::visit([&](const auto& x, const auto& y) {
+                    return describe(x) + "," + describe(y);
+                }, a, b);
+                all = all && combined == a.visit(describe) + "," + b.visit(describe);
+            }
+        }
+        RTL_CHECK(all);
+    });
+
+    tests::run("variant is left without a value when replacing an alternative throws", [] {
+        utilities::variant<std::string, throws_on_construction> value = std::string{"text"};
+        auto threw = false;
+        try {
+            value.emplace<1>(true);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        RTL_CHECK(threw);
+        RTL_CHECK(value.valueless() && value.index() == 2);
+
+        auto copy = value;
+        RTL_CHECK(copy.valueless() && copy == value);
+        value.emplace<0>("again");
+        RTL_CHECK(value.holds<std::string>() && value.get_unchecked<0>() == "again");
+        RTL_CHECK(!value.get<1>().has_value());
+        RTL_CHECK(sizeof(utilities::option<utilities::variant<int, char>>) == sizeof(utilities::variant<int, char>));
+    });
+
+    tests::run("result keeps null pointers and empty unique_ptrs as values", [] {
+        utilities::result<int*, int> null = nullptr;
+        RTL_CHECK(null.has_value() && !null.has_error() && null.value() == nullptr);
+        auto ok = null.ok();
+        RTL_CHECK(ok.has_value() && ok.value() == nullptr);
+
+        utilities::result<memory::unique_ptr<int>, std::monostate> empty_pointer = nullptr;
+        RTL_CHECK(empty_pointer.has_value() && empty_pointer.value().get() == nullptr);
+        RTL_CHECK(empty_pointer.unwrap().get() == nullptr);
+
+        utilities::result<memory::unique_ptr<int>, std::monostate> failed = utilities::failure{std::monostate{}};
+        RTL_CHECK(failed.has_error() && !failed.has_value());
+    });
+
+    tests::run("result maps and chains values and errors", [] {
+        using result = utilities::result<int, std::string>;
+        auto half = [](int value) -> result {
+            return value % 2 == 0 ? result{value / 2} : result{utilities::failure{std::string{"odd"}}};
+        };
+
+        RTL_CHECK(result{8}.and_then(half).and_then(half) == 2);
+        auto odd = result{6}.and_then(half).and_then(half);
+        RTL_CHECK(odd.has_error() && odd.error() == "odd");
+        RTL_CHECK(odd == utilities::failure{std::string{"odd"}});
+        RTL_CHECK(odd.map([](int value) { return value + 1; }).has_error());
+        RTL_CHECK(odd.map_error([](const std::string& error) { return error.size(); }).error() == 3);
+        RTL_CHECK(odd.or_else([](const std::string&) { return result{0}; }) == 0);
+        RTL_CHECK(result{4}.map([](int value) { return value * 1.5; }) == 6.0);
+        RTL_CHECK(odd.unwrap_or(-1) == -1);
+        RTL_CHECK(odd.unwrap_error() == "odd");
+
+        RTL_CHECK(sizeof(utilities::option<result>) == sizeof(result));
+        utilities::option<result> wrapped = result{1};
+        RTL_CHECK(wrapped.has_value() && wrapped.value() == 1);
+        wrapped.reset();
+        RTL_CHECK(!wrapped.has_value());
+    });
+
+    return tests::exit_code();
+}